@@ -15,6 +15,22 @@ namespace irr
 namespace video
 {
 
+//! Filters IImage::copyToScalingFiltered can scale images with
+enum E_RESAMPLE_FILTER
+{
+	//! Average of the covered source pixels
+	ERF_BOX = 0,
+
+	//! Linear interpolation, widened to a tent over the covered pixels when downscaling
+	ERF_BILINEAR,
+
+	//! Cubic Catmull-Rom spline, sharper than bilinear
+	ERF_CATMULL_ROM,
+
+	//! Lanczos windowed sinc with 3 lobes, sharpest but may ring at hard edges
+	ERF_LANCZOS3
+};
+
 //! Interface for software image data.
 /** Image loaders create these images from files. IVideoDrivers convert
 these images into their (hardware) textures.
@@ -98,6 +114,14 @@ public:
 	//! fills the surface with given color
 	virtual void fill(const SColor &color) =0;
 
+	//! copies this surface into another, scaling it to fit with the given filter
+	/** Colors are filtered premultiplied by alpha, so the color of fully
+	transparent pixels doesn't show up at the borders of opaque ones.
+	copyToScaling and copyToScalingBoxFilter keep their own filtering.
+	\param target Image to scale into, its size is the target size.
+	\param filter Filter to use. */
+	virtual void copyToScalingFiltered(IImage* target, E_RESAMPLE_FILTER filter = ERF_BILINEAR) = 0;
+
 	//! get the amount of Bits per Pixel of the given color format
 	static u32 getBitsPerPixelFromFormat(const ECOLOR_FORMAT format)
 	{
@@ -177,6 +177,25 @@ comment this define out */
 #undef _IRR_COMPILE_WITH_BURNINGSVIDEO_
 #endif
 
+//! Define _IRR_COMPILE_WITH_SIMD_BLITTER_ to use SIMD versions of the 2D blitters
+/** Used by the software drivers, IImage::copyTo and IImage::copyToScaling. On x86
+the best of SSE2, SSSE3 and AVX2 is picked at runtime, on ARM NEON is used when
+the build targets it.
+Comment this define out to always use the plain C blitters. */
+#define _IRR_COMPILE_WITH_SIMD_BLITTER_
+#ifdef NO_IRR_COMPILE_WITH_SIMD_BLITTER_
+#undef _IRR_COMPILE_WITH_SIMD_BLITTER_
+#endif
+
+//! Define _IRR_COMPILE_WITH_THREADED_RESAMPLER_ to scale large images on several threads
+/** Used by IImage::copyToScaling and friends. Needs std::thread, so it only has
+an effect with C++11 compilers, otherwise images are scaled on the calling thread.
+Comment this define out to always scale on the calling thread. */
+#define _IRR_COMPILE_WITH_THREADED_RESAMPLER_
+#ifdef NO_IRR_COMPILE_WITH_THREADED_RESAMPLER_
+#undef _IRR_COMPILE_WITH_THREADED_RESAMPLER_
+#endif
+
 //! Define _IRR_COMPILE_WITH_X11_ to compile the Irrlicht engine with X11 support.
 /** If you do not wish the engine to be compiled with X11, comment this
 define out. */
@@ -630,6 +649,18 @@ currently only supports zip archives, though. */
 #ifdef NO_IRR_COMPILE_WITH_LZMA_
 #undef _IRR_COMPILE_WITH_LZMA_
 #endif
+//! Maximum memory in bytes each zip archive uses to keep decompressed entries.
+/** Compressed entries which are opened again are read from this cache instead
+of being decompressed again, the least recently opened ones are dropped first.
+Set to 0 to disable the cache. */
+#ifndef _IRR_ZIP_ENTRY_CACHE_SIZE_
+#define _IRR_ZIP_ENTRY_CACHE_SIZE_ (16*1024*1024)
+#endif
+//! Deflated zip entries larger than this many bytes are inflated while being read.
+/** Smaller ones are decompressed into memory at once when they are opened. */
+#ifndef _IRR_ZIP_STREAMING_SIZE_
+#define _IRR_ZIP_STREAMING_SIZE_ (4*1024*1024)
+#endif
 #endif
 
 //! Define __IRR_COMPILE_WITH_MOUNT_ARCHIVE_LOADER_ if you want to mount folders as archives
@@ -0,0 +1,164 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt / Thomas Alten
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+// Micro-benchmark of the blitters of CBlit.h, not part of the library.
+// Runs every entry of blitTable and the SIMD blitter getBlitter2 picks for it on a
+// 1024x1024 job, checks that both give the same pixels and prints megapixels per second.
+// Build with "make blitbench" or compile this file alone with ../../include on the path.
+
+#include "CBlit.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <vector>
+#include <chrono>
+
+using namespace irr;
+
+namespace
+{
+
+const s32 SIZE = 1024;
+const u32 MIN_ITERATIONS = 4;
+const double MIN_SECONDS = 0.25;
+
+u32 bytesPerPixel(s32 format)
+{
+	switch (format)
+	{
+	case video::ECF_A1R5G5B5:
+		return 2;
+	case video::ECF_R8G8B8:
+		return 3;
+	default:
+		return 4;
+	}
+}
+
+const char* formatName(s32 format)
+{
+	switch (format)
+	{
+	case video::ECF_A1R5G5B5:
+		return "16";
+	case video::ECF_R8G8B8:
+		return "24";
+	case video::ECF_A8R8G8B8:
+		return "32";
+	case -2:
+		return "x";
+	default:
+		return "-";
+	}
+}
+
+const char* operationName(eBlitter operation)
+{
+	switch (operation)
+	{
+	case BLITTER_TEXTURE:
+		return "Texture";
+	case BLITTER_TEXTURE_ALPHA_BLEND:
+		return "TextureBlend";
+	case BLITTER_TEXTURE_ALPHA_COLOR_BLEND:
+		return "TextureBlendColor";
+	case BLITTER_COLOR:
+		return "Color";
+	case BLITTER_COLOR_ALPHA:
+		return "ColorAlpha";
+	default:
+		return "?";
+	}
+}
+
+void fill(std::vector<u8> &buffer, u32 seed)
+{
+	for (size_t i = 0; i != buffer.size(); ++i)
+	{
+		seed = seed * 1664525 + 1013904223;
+		buffer[i] = (u8)(seed >> 24);
+	}
+}
+
+// megapixels per second of Blitter on Job, the destination is restored from Original first
+double measure(tExecuteBlit blitter, SBlitJob &job, std::vector<u8> &dst, const std::vector<u8> &original)
+{
+	u32 iterations = 0;
+	double seconds = 0.0;
+
+	while (iterations < MIN_ITERATIONS || seconds < MIN_SECONDS)
+	{
+		memcpy(&dst[0], &original[0], dst.size());
+
+		const std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		blitter(&job);
+		seconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+		++iterations;
+	}
+
+	return (double)job.width * job.height * iterations / seconds / 1000000.0;
+}
+
+}
+
+int main()
+{
+	int failures = 0;
+
+	printf("%-18s %-3s %-3s %12s %12s %8s\n", "blitter", "dst", "src", "C MP/s", "SIMD MP/s", "speedup");
+
+	for (const blitterTable* b = blitTable; b->operation != BLITTER_INVALID; ++b)
+	{
+		const s32 destFormat = (b->destFormat == -2 ? video::ECF_A8R8G8B8 : b->destFormat);
+		const s32 sourceFormat = (b->destFormat == -2 ? video::ECF_A8R8G8B8 : b->sourceFormat == -1 ? destFormat : b->sourceFormat);
+
+		const u32 dstPitch = SIZE * bytesPerPixel(destFormat);
+		// without a source, the color blitters take srcPitch as the width of a line, like Blit sets it
+		const u32 srcPitch = (b->sourceFormat == -1 ? dstPitch : SIZE * bytesPerPixel(sourceFormat));
+
+		std::vector<u8> src(srcPitch * SIZE);
+		std::vector<u8> original(dstPitch * SIZE);
+		std::vector<u8> dst(dstPitch * SIZE);
+		std::vector<u8> result(dstPitch * SIZE);
+
+		fill(src, 1);
+		fill(original, 2);
+
+		SBlitJob job;
+		job.argb = 0x80FF8040;
+		job.src = (b->sourceFormat == -1 ? 0 : &src[0]);
+		job.dst = &dst[0];
+		job.width = SIZE;
+		job.height = SIZE;
+		job.srcPitch = srcPitch;
+		job.dstPitch = dstPitch;
+		job.srcPixelMul = bytesPerPixel(sourceFormat);
+		job.dstPixelMul = bytesPerPixel(destFormat);
+
+		const double scalar = measure(b->func, job, dst, original);
+		result = dst;
+
+		tExecuteBlit simd = 0;
+#ifdef _IRR_COMPILE_WITH_SIMD_BLITTER_
+		simd = getBlitterSIMD(b->operation, destFormat, sourceFormat);
+#endif
+
+		if (!simd || simd == b->func)
+		{
+			printf("%-18s %-3s %-3s %12.0f %12s %8s\n", operationName(b->operation), formatName(b->destFormat), formatName(b->sourceFormat), scalar, "-", "-");
+			continue;
+		}
+
+		const double vector = measure(simd, job, dst, original);
+		const bool same = (dst == result);
+
+		if (!same)
+			++failures;
+
+		printf("%-18s %-3s %-3s %12.0f %12.0f %7.1fx%s\n", operationName(b->operation), formatName(b->destFormat), formatName(b->sourceFormat), scalar, vector, vector / scalar, (same ? "" : "  DIFFERENT"));
+	}
+
+	return (failures ? 1 : 0);
+}
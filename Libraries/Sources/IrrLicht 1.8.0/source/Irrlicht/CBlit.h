@@ -811,9 +811,9 @@ static void executeBlit_TextureBlend_16_to_16( const SBlitJob * job )
 				const u32 src_x = (u32)(dx*wscale);
 				dst[dx] = PixelBlend16_simd( dst[dx], src[src_x] );
 			}
-			if ( off )
+			if ( w & 1 )
 			{
-				((u16*) dst)[off] = PixelBlend16( ((u16*) dst)[off], ((u16*) src)[off] );
+				((u16*) dst)[w-1] = PixelBlend16( ((u16*) dst)[w-1], ((u16*) src)[off] );
 			}
 
 			dst = (u32*) ( (u8*) (dst) + job->dstPitch );
@@ -829,7 +829,7 @@ static void executeBlit_TextureBlend_16_to_16( const SBlitJob * job )
 				dst[dx] = PixelBlend16_simd( dst[dx], src[dx] );
 			}
 
-			if ( off )
+			if ( w & 1 )
 			{
 				((u16*) dst)[off] = PixelBlend16( ((u16*) dst)[off], ((u16*) src)[off] );
 			}
@@ -1034,13 +1034,8 @@ static const blitterTable blitTable[] =
 };
 
 
-static inline tExecuteBlit getBlitter2( eBlitter operation,const video::IImage * dest,const video::IImage * source )
+static inline tExecuteBlit findBlitter( const blitterTable * b, eBlitter operation, s32 destFormat, s32 sourceFormat )
 {
-	video::ECOLOR_FORMAT sourceFormat = (video::ECOLOR_FORMAT) ( source ? source->getColorFormat() : -1 );
-	video::ECOLOR_FORMAT destFormat = (video::ECOLOR_FORMAT) ( dest ? dest->getColorFormat() : -1 );
-
-	const blitterTable * b = blitTable;
-
 	while ( b->operation != BLITTER_INVALID )
 	{
 		if ( b->operation == operation )
@@ -1057,6 +1052,25 @@ static inline tExecuteBlit getBlitter2( eBlitter operation,const video::IImage *
 	return 0;
 }
 
+#ifdef _IRR_COMPILE_WITH_SIMD_BLITTER_
+// in CBlitSIMD.h
+static tExecuteBlit getBlitterSIMD( eBlitter operation, s32 destFormat, s32 sourceFormat );
+#endif
+
+static inline tExecuteBlit getBlitter2( eBlitter operation,const video::IImage * dest,const video::IImage * source )
+{
+	video::ECOLOR_FORMAT sourceFormat = (video::ECOLOR_FORMAT) ( source ? source->getColorFormat() : -1 );
+	video::ECOLOR_FORMAT destFormat = (video::ECOLOR_FORMAT) ( dest ? dest->getColorFormat() : -1 );
+
+#ifdef _IRR_COMPILE_WITH_SIMD_BLITTER_
+	const tExecuteBlit blitter = getBlitterSIMD( operation, destFormat, sourceFormat );
+	if ( blitter )
+		return blitter;
+#endif
+
+	return findBlitter( blitTable, operation, destFormat, sourceFormat );
+}
+
 
 // bounce clipping to texture
 inline void setClip ( AbsRectangle &out, const core::rect<s32> *clip,
@@ -1269,5 +1283,9 @@ static void drawLine(video::IImage* img, const core::position2d<s32>& from,
 
 }
 
+#ifdef _IRR_COMPILE_WITH_SIMD_BLITTER_
+#include "CBlitSIMD.h"
+#endif
+
 #endif
 
@@ -0,0 +1,1177 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt / Thomas Alten
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef _C_BLIT_SIMD_H_INCLUDED_
+#define _C_BLIT_SIMD_H_INCLUDED_
+
+// SIMD versions of the blitTable entries, only included by CBlit.h.
+// Every blitter gives the same bits as its plain C version in CBlit.h, the
+// u32 arithmetic (including the carries between packed channels) is done
+// in 32 bit lanes where the plain C version relies on it.
+// Stretched jobs are passed to the plain C version.
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+	#define _IRR_BLIT_SIMD_X86_
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+	#define _IRR_BLIT_SIMD_NEON_
+#endif
+
+#if defined(_IRR_BLIT_SIMD_X86_)
+	#include <emmintrin.h>
+	#include <tmmintrin.h>
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#else
+		#include <cpuid.h>
+	#endif
+
+	// gcc only emits the instruction sets it has been told about,
+	// msvc allows all intrinsics everywhere.
+	#if defined(_MSC_VER)
+		#define _IRR_BLIT_TARGET_SSE2_
+		#define _IRR_BLIT_TARGET_SSSE3_
+		#define _IRR_BLIT_TARGET_AVX2_
+	#else
+		#define _IRR_BLIT_TARGET_SSE2_ __attribute__((target("sse2")))
+		#define _IRR_BLIT_TARGET_SSSE3_ __attribute__((target("ssse3")))
+		#define _IRR_BLIT_TARGET_AVX2_ __attribute__((target("avx2")))
+	#endif
+#elif defined(_IRR_BLIT_SIMD_NEON_)
+	#include <arm_neon.h>
+#endif
+
+namespace irr
+{
+
+#if defined(_IRR_BLIT_SIMD_X86_)
+
+/*!
+	cpu features the blitters are selected by, queried once
+*/
+struct SBlitCPUFeatures
+{
+	SBlitCPUFeatures() : SSE2(false), SSSE3(false), AVX2(false)
+	{
+		u32 maxLeaf, ebx, ecx, edx;
+		cpuid(0, maxLeaf, ebx, ecx, edx);
+		if ( maxLeaf < 1 )
+			return;
+
+		u32 eax;
+		cpuid(1, eax, ebx, ecx, edx);
+		SSE2 = 0 != ( edx & ( 1 << 26 ) );
+		SSSE3 = 0 != ( ecx & ( 1 << 9 ) );
+
+		// AVX needs the os to save the ymm registers
+		const bool osxsave = 0 != ( ecx & ( 1 << 27 ) );
+		const bool avx = 0 != ( ecx & ( 1 << 28 ) );
+		if ( maxLeaf < 7 || !osxsave || !avx || ( xgetbv() & 6 ) != 6 )
+			return;
+
+		cpuid(7, eax, ebx, ecx, edx);
+		AVX2 = 0 != ( ebx & ( 1 << 5 ) );
+	}
+
+	bool SSE2;
+	bool SSSE3;
+	bool AVX2;
+
+private:
+	static void cpuid(u32 leaf, u32 &eax, u32 &ebx, u32 &ecx, u32 &edx)
+	{
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuidex(info, (int) leaf, 0);
+		eax = info[0];
+		ebx = info[1];
+		ecx = info[2];
+		edx = info[3];
+#else
+		__cpuid_count(leaf, 0, eax, ebx, ecx, edx);
+#endif
+	}
+
+	static u32 xgetbv()
+	{
+#if defined(_MSC_VER)
+		return (u32) _xgetbv(0);
+#else
+		u32 eax, edx;
+		__asm__ __volatile__ ( "xgetbv" : "=a" (eax), "=d" (edx) : "c" (0) );
+		return eax;
+#endif
+	}
+};
+
+static inline const SBlitCPUFeatures &getBlitCPUFeatures()
+{
+	static const SBlitCPUFeatures features;
+	return features;
+}
+
+// ----------------------- SSE2 ----------------------------------
+
+/*
+	( x * a ) mod 2^32 for each 32 bit lane, like the u32 math of the plain C blitters.
+	a < 0x10000, splatted to both 16 bit halves of the lane
+*/
+static inline _IRR_BLIT_TARGET_SSE2_ __m128i blitMul32_SSE2(const __m128i x, const __m128i a)
+{
+	return _mm_add_epi32(_mm_mullo_epi16(x, a), _mm_slli_epi32(_mm_mulhi_epu16(x, a), 16));
+}
+
+/*
+	PixelBlend32 ( c2, c1, alpha ) for 4 pixel
+	alpha [0;256], splatted to both 16 bit halves
+*/
+static inline _IRR_BLIT_TARGET_SSE2_ __m128i blitLerp32_SSE2(const __m128i c2, const __m128i c1, const __m128i alpha)
+{
+	const __m128i maskRB = _mm_set1_epi32(0x00FF00FF);
+	const __m128i maskXG = _mm_set1_epi32(0x0000FF00);
+
+	const __m128i dstRB = _mm_and_si128(c2, maskRB);
+	const __m128i dstXG = _mm_and_si128(c2, maskXG);
+
+	__m128i rb = _mm_sub_epi32(_mm_and_si128(c1, maskRB), dstRB);
+	__m128i xg = _mm_sub_epi32(_mm_and_si128(c1, maskXG), dstXG);
+
+	rb = _mm_srli_epi32(blitMul32_SSE2(rb, alpha), 8);
+	xg = _mm_srli_epi32(blitMul32_SSE2(xg, alpha), 8);
+
+	rb = _mm_and_si128(_mm_add_epi32(rb, dstRB), maskRB);
+	xg = _mm_and_si128(_mm_add_epi32(xg, dstXG), maskXG);
+
+	return _mm_or_si128(rb, xg);
+}
+
+/*
+	PixelBlend32 ( c2, c1 ) for 4 pixel
+*/
+static inline _IRR_BLIT_TARGET_SSE2_ __m128i blitBlend32_SSE2(const __m128i c2, const __m128i c1)
+{
+	const __m128i a8 = _mm_srli_epi32(c1, 24);
+
+	// add highbit alpha, if ( alpha > 127 ) alpha += 1;
+	__m128i alpha = _mm_add_epi32(a8, _mm_srli_epi32(c1, 31));
+	alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+
+	__m128i r = _mm_or_si128(_mm_and_si128(c1, _mm_set1_epi32((s32) 0xFF000000)),
+				blitLerp32_SSE2(c2, c1, alpha));
+
+	// alpha test
+	const __m128i solid = _mm_cmpeq_epi32(a8, _mm_set1_epi32(0xFF));
+	const __m128i clear = _mm_cmpeq_epi32(a8, _mm_setzero_si128());
+	r = _mm_or_si128(_mm_andnot_si128(solid, r), _mm_and_si128(solid, c1));
+	return _mm_or_si128(_mm_andnot_si128(clear, r), _mm_and_si128(clear, c2));
+}
+
+/*
+	PixelMul32_2 ( c0, c1 ) for 4 pixel
+*/
+static inline _IRR_BLIT_TARGET_SSE2_ __m128i blitMul32_2_SSE2(const __m128i c0, const __m128i c1)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(c0, zero), _mm_unpacklo_epi8(c1, zero)), 8);
+	const __m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(c0, zero), _mm_unpackhi_epi8(c1, zero)), 8);
+	return _mm_packus_epi16(lo, hi);
+}
+
+/*
+	A8R8G8B8toA1R5G5B5 for 4 pixel, result in the low 16 bit of each lane
+*/
+static inline _IRR_BLIT_TARGET_SSE2_ __m128i blitTo16_SSE2(const __m128i c)
+{
+	return _mm_or_si128(
+		_mm_or_si128(_mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32((s32) 0x80000000)), 16),
+					_mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x00F80000)), 9)),
+		_mm_or_si128(_mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x0000F800)), 6),
+					_mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x000000F8)), 3)));
+}
+
+/*
+	A1R5G5B5toA8R8G8B8 for 4 pixel in the low 16 bit of each lane
+*/
+static inline _IRR_BLIT_TARGET_SSE2_ __m128i blitTo32_SSE2(const __m128i c)
+{
+	const __m128i a = _mm_and_si128(_mm_srai_epi32(_mm_slli_epi32(c, 16), 31), _mm_set1_epi32((s32) 0xFF000000));
+	const __m128i r = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x00007C00)), 9),
+								_mm_slli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x00007000)), 4));
+	const __m128i g = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x000003E0)), 6),
+								_mm_slli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x00000380)), 1));
+	const __m128i b = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x0000001F)), 3),
+								_mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x0000001C)), 2));
+	return _mm_or_si128(_mm_or_si128(a, r), _mm_or_si128(g, b));
+}
+
+/*
+	packs the low 16 bit of each 32 bit lane of a and b
+*/
+static inline _IRR_BLIT_TARGET_SSE2_ __m128i blitPack16_SSE2(const __m128i a, const __m128i b)
+{
+	return _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16), _mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+}
+
+/*!
+*/
+static _IRR_BLIT_TARGET_SSE2_ void executeBlit_TextureCopy_32_to_16_SSE2( const SBlitJob * job )
+{
+	if (job->stretch)
+	{
+		executeBlit_TextureCopy_32_to_16(job);
+		return;
+	}
+
+	const u32 w = job->width;
+	const u32 h = job->height;
+	const u32 *src = static_cast<const u32*>(job->src);
+	u16 *dst = static_cast<u16*>(job->dst);
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i solid = _mm_set1_epi32((s32) 0xFF000000);
+
+	for ( u32 dy = 0; dy != h; ++dy )
+	{
+		u32 dx = 0;
+		for ( ; dx + 4 <= w; dx += 4 )
+		{
+			const __m128i s = _mm_loadu_si128((const __m128i*) (src + dx));
+
+			//16 bit Blitter depends on pre-multiplied color
+			__m128i alpha = _mm_add_epi32(_mm_srli_epi32(s, 24), _mm_srli_epi32(s, 31));
+			alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+
+			const __m128i c = _mm_or_si128(s, solid);
+			const __m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi32(alpha, alpha)), 8);
+			const __m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi32(alpha, alpha)), 8);
+
+			const __m128i d = blitTo16_SSE2(_mm_packus_epi16(lo, hi));
+			_mm_storel_epi64((__m128i*) (dst + dx), blitPack16_SSE2(d, d));
+		}
+
+		for ( ; dx != w; ++dx )
+		{
+			const u32 s = PixelLerp32( src[dx] | 0xFF000000, extractAlpha( src[dx] ) );
+			dst[dx] = video::A8R8G8B8toA1R5G5B5( s );
+		}
+
+		src = (u32*) ( (u8*) (src) + job->srcPitch );
+		dst = (u16*) ( (u8*) (dst) + job->dstPitch );
+	}
+}
+
+/*!
+*/
+static _IRR_BLIT_TARGET_SSE2_ void executeBlit_TextureCopy_16_to_32_SSE2( const SBlitJob * job )
+{
+	if (job->stretch)
+	{
+		executeBlit_TextureCopy_16_to_32(job);
+		return;
+	}
+
+	const u32 w = job->width;
+	const u32 h = job->height;
+	const u16 *src = static_cast<const u16*>(job->src);
+	u32 *dst = static_cast<u32*>(job->dst);
+
+	const __m128i zero = _mm_setzero_si128();
+
+	for ( u32 dy = 0; dy != h; ++dy )
+	{
+		u32 dx = 0;
+		for ( ; dx + 8 <= w; dx += 8 )
+		{
+			const __m128i s = _mm_loadu_si128((const __m128i*) (src + dx));
+			_mm_storeu_si128((__m128i*) (dst + dx), blitTo32_SSE2(_mm_unpacklo_epi16(s, zero)));
+			_mm_storeu_si128((__m128i*) (dst + dx + 4), blitTo32_SSE2(_mm_unpackhi_epi16(s, zero)));
+		}
+
+		for ( ; dx != w; ++dx )
+			dst[dx] = video::A1R5G5B5toA8R8G8B8( src[dx] );
+
+		src = (u16*) ( (u8*) (src) + job->srcPitch );
+		dst = (u32*) ( (u8*) (dst) + job->dstPitch );
+	}
+}
+
+/*!
+*/
+static _IRR_BLIT_TARGET_SSE2_ void executeBlit_TextureBlend_16_to_16_SSE2( const SBlitJob * job )
+{
+	if (job->stretch)
+	{
+		executeBlit_TextureBlend_16_to_16(job);
+		return;
+	}
+
+	const u32 w = job->width;
+	const u32 h = job->height;
+	const u16 *src = static_cast<const u16*>(job->src);
+	u16 *dst = static_cast<u16*>(job->dst);
+
+	const __m128i bias = _mm_set1_epi16(0x7fff);
+
+	for ( u32 dy = 0; dy != h; ++dy )
+	{
+		u32 dx = 0;
+		for ( ; dx + 8 <= w; dx += 8 )
+		{
+			const __m128i s = _mm_loadu_si128((const __m128i*) (src + dx));
+			const __m128i d = _mm_loadu_si128((const __m128i*) (dst + dx));
+
+			// same mask as PixelBlend16
+			const __m128i mask = _mm_add_epi16(_mm_srli_epi16(s, 15), bias);
+			_mm_storeu_si128((__m128i*) (dst + dx), _mm_or_si128(_mm_and_si128(d, mask), _mm_andnot_si128(mask, s)));
+		}
+
+		for ( ; dx != w; ++dx )
+			dst[dx] = PixelBlend16( dst[dx], src[dx] );
+
+		src = (u16*) ( (u8*) (src) + job->srcPitch );
+		dst = (u16*) ( (u8*) (dst) + job->dstPitch );
+	}
+}
+
+/*!
+*/
+static _IRR_BLIT_TARGET_SSE2_ void executeBlit_TextureBlend_32_to_32_SSE2( const SBlitJob * job )
+{
+	if (job->stretch)
+	{
+		executeBlit_TextureBlend_32_to_32(job);
+		return;
+	}
+
+	const u32 w = job->width;
+	const u32 h = job->height;
+	const u32 *src = static_cast<const u32*>(job->src);
+	u32 *dst = static_cast<u32*>(job->dst);
+
+	const __m128i alphaMask = _mm_set1_epi32((s32) 0xFF000000);
+	const __m128i zero = _mm_setzero_si128();
+
+	for ( u32 dy = 0; dy != h; ++dy )
+	{
+		u32 dx = 0;
+		for ( ; dx + 4 <= w; dx += 4 )
+		{
+			const __m128i s = _mm_loadu_si128((const __m128i*) (src + dx));
+
+			// sprites are mostly empty space, leave the dest alone
+			if ( 0xFFFF == _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(s, alphaMask), zero)) )
+				continue;
+
+			const __m128i d = _mm_loadu_si128((const __m128i*) (dst + dx));
+			_mm_storeu_si128((__m128i*) (dst + dx), blitBlend32_SSE2(d, s));
+		}
+
+		for ( ; dx != w; ++dx )
+			dst[dx] = PixelBlend32( dst[dx], src[dx] );
+
+		src = (u32*) ( (u8*) (src) + job->srcPitch );
+		dst = (u32*) ( (u8*) (dst) + job->dstPitch );
+	}
+}
+
+/*!
+*/
+static _IRR_BLIT_TARGET_SSE2_ void executeBlit_TextureBlendColor_16_to_16_SSE2( const SBlitJob * job )
+{
+	const u16 *src = static_cast<const u16*>(job->src);
+	u16 *dst = static_cast<u16*>(job->dst);
+
+	const u16 blend = video::A8R8G8B8toA1R5G5B5 ( job->argb );
+
+	const __m128i mask5 = _mm_set1_epi16(0x1F);
+	const __m128i blendR = _mm_set1_epi16((blend >> 10) & 0x1F);
+	const __m128i blendG = _mm_set1_epi16((blend >> 5) & 0x1F);
+	const __m128i blendB = _mm_set1_epi16(blend & 0x1F);
+	const __m128i blendA = _mm_set1_epi16((s16) (blend & 0x8000));
+
+	for ( s32 dy = 0; dy != job->height; ++dy )
+	{
+		s32 dx = 0;
+		for ( ; dx + 8 <= job->width; dx += 8 )
+		{
+			const __m128i s = _mm_loadu_si128((const __m128i*) (src + dx));
+			const __m128i d = _mm_loadu_si128((const __m128i*) (dst + dx));
+
+			// PixelMul16_2, channel = ( c0 * c1 ) >> 5
+			const __m128i r = _mm_srli_epi16(_mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(s, 10), mask5), blendR), 5);
+			const __m128i g = _mm_srli_epi16(_mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(s, 5), mask5), blendG), 5);
+			const __m128i b = _mm_srli_epi16(_mm_mullo_epi16(_mm_and_si128(s, mask5), blendB), 5);
+			const __m128i m = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r, 10), _mm_slli_epi16(g, 5)),
+										_mm_or_si128(b, _mm_and_si128(s, blendA)));
+
+			// source pixels without alpha keep the dest
+			const __m128i visible = _mm_srai_epi16(s, 15);
+			_mm_storeu_si128((__m128i*) (dst + dx), _mm_or_si128(_mm_and_si128(visible, m), _mm_andnot_si128(visible, d)));
+		}
+
+		for ( ; dx != job->width; ++dx )
+		{
+			if ( 0 == (src[dx] & 0x8000) )
+				continue;
+
+			dst[dx] = PixelMul16_2( src[dx], blend );
+		}
+		src = (u16*) ( (u8*) (src) + job->srcPitch );
+		dst = (u16*) ( (u8*) (dst) + job->dstPitch );
+	}
+}
+
+/*!
+*/
+static _IRR_BLIT_TARGET_SSE2_ void executeBlit_TextureBlendColor_32_to_32_SSE2( const SBlitJob * job )
+{
+	const u32 *src = static_cast<const u32*>(job->src);
+	u32 *dst = static_cast<u32*>(job->dst);
+
+	const __m128i argb = _mm_set1_epi32((s32) job->argb);
+
+	for ( s32 dy = 0; dy != job->height; ++dy )
+	{
+		s32 dx = 0;
+		for ( ; dx + 4 <= job->width; dx += 4 )
+		{
+			const __m128i s = blitMul32_2_SSE2(_mm_loadu_si128((const __m128i*) (src + dx)), argb);
+			const __m128i d = _mm_loadu_si128((const __m128i*) (dst + dx));
+			_mm_storeu_si128((__m128i*) (dst + dx), blitBlend32_SSE2(d, s));
+		}
+
+		for ( ; dx != job->width; ++dx )
+			dst[dx] = PixelBlend32( dst[dx], PixelMul32_2( src[dx], job->argb ) );
+
+		src = (u32*) ( (u8*) (src) + job->srcPitch );
+		dst = (u32*) ( (u8*) (dst) + job->dstPitch );
+	}
+}
+
+/*!
+*/
+static _IRR_BLIT_TARGET_SSE2_ void executeBlit_Color_16_to_16_SSE2( const SBlitJob * job )
+{
+	const u16 c = video::A8R8G8B8toA1R5G5B5(job->argb);
+	u16 *dst = static_cast<u16*>(job->dst);
+
+	// srcPitch holds the bytes of one dest line for color operations
+	const u32 w = job->srcPitch >> 1;
+	const __m128i color = _mm_set1_epi16((s16) c);
+
+	for ( s32 dy = 0; dy != job->height; ++dy )
+	{
+		u32 dx = 0;
+		for ( ; dx + 8 <= w; dx += 8 )
+			_mm_storeu_si128((__m128i*) (dst + dx), color);
+
+		for ( ; dx != w; ++dx )
+			dst[dx] = c;
+
+		dst = (u16*) ( (u8*) (dst) + job->dstPitch );
+	}
+}
+
+/*!
+*/
+static _IRR_BLIT_TARGET_SSE2_ void executeBlit_Color_32_to_32_SSE2( const SBlitJob * job )
+{
+	u32 *dst = static_cast<u32*>(job->dst);
+
+	// srcPitch holds the bytes of one dest line for color operations
+	const u32 w = job->srcPitch >> 2;
+	const __m128i color = _mm_set1_epi32((s32) job->argb);
+
+	for ( s32 dy = 0; dy != job->height; ++dy )
+	{
+		u32 dx = 0;
+		for ( ; dx + 4 <= w; dx += 4 )
+			_mm_storeu_si128((__m128i*) (dst + dx), color);
+
+		for ( ; dx != w; ++dx )
+			dst[dx] = job->argb;
+
+		dst = (u32*) ( (u8*) (dst) + job->dstPitch );
+	}
+}
+
+/*!
+*/
+static _IRR_BLIT_TARGET_SSE2_ void executeBlit_ColorAlpha_16_to_16_SSE2( const SBlitJob * job )
+{
+	u16 *dst = static_cast<u16*>(job->dst);
+
+	const u16 alpha = extractAlpha( job->argb ) >> 3;
+	if ( 0 == alpha )
+		return;
+	const u32 src = video::A8R8G8B8toA1R5G5B5( job->argb );
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i maskRB = _mm_set1_epi32(0x7C1F);
+	const __m128i maskXG = _mm_set1_epi32(0x03E0);
+	const __m128i srcRB = _mm_set1_epi32(src & 0x7C1F);
+	const __m128i srcXG = _mm_set1_epi32(src & 0x03E0);
+	const __m128i a = _mm_set1_epi32(alpha | alpha << 16);
+	const __m128i visible = _mm_set1_epi16((s16) 0x8000);
+
+	for ( s32 dy = 0; dy != job->height; ++dy )
+	{
+		s32 dx = 0;
+		for ( ; dx + 8 <= job->width; dx += 8 )
+		{
+			const __m128i d = _mm_loadu_si128((const __m128i*) (dst + dx));
+			__m128i r[2];
+
+			// PixelBlend16 in 32 bit lanes
+			for ( u32 i = 0; i != 2; ++i )
+			{
+				const __m128i c2 = i ? _mm_unpackhi_epi16(d, zero) : _mm_unpacklo_epi16(d, zero);
+				const __m128i dstRB = _mm_and_si128(c2, maskRB);
+				const __m128i dstXG = _mm_and_si128(c2, maskXG);
+
+				__m128i rb = _mm_srli_epi32(blitMul32_SSE2(_mm_sub_epi32(srcRB, dstRB), a), 5);
+				__m128i xg = _mm_srli_epi32(blitMul32_SSE2(_mm_sub_epi32(srcXG, dstXG), a), 5);
+
+				rb = _mm_and_si128(_mm_add_epi32(rb, dstRB), maskRB);
+				xg = _mm_and_si128(_mm_add_epi32(xg, dstXG), maskXG);
+				r[i] = _mm_or_si128(rb, xg);
+			}
+
+			_mm_storeu_si128((__m128i*) (dst + dx), _mm_or_si128(_mm_packs_epi32(r[0], r[1]), visible));
+		}
+
+		for ( ; dx != job->width; ++dx )
+			dst[dx] = 0x8000 | PixelBlend16( dst[dx], src, alpha );
+
+		dst = (u16*) ( (u8*) (dst) + job->dstPitch );
+	}
+}
+
+/*!
+*/
+static _IRR_BLIT_TARGET_SSE2_ void executeBlit_ColorAlpha_32_to_32_SSE2( const SBlitJob * job )
+{
+	u32 *dst = static_cast<u32*>(job->dst);
+
+	const u32 alpha = extractAlpha( job->argb );
+	const u32 src = job->argb;
+
+	const __m128i a = _mm_set1_epi32(alpha | alpha << 16);
+	const __m128i c = _mm_set1_epi32((s32) src);
+	const __m128i top = _mm_set1_epi32((s32) (src & 0xFF000000));
+
+	for ( s32 dy = 0; dy != job->height; ++dy )
+	{
+		s32 dx = 0;
+		for ( ; dx + 4 <= job->width; dx += 4 )
+		{
+			const __m128i d = _mm_loadu_si128((const __m128i*) (dst + dx));
+			_mm_storeu_si128((__m128i*) (dst + dx), _mm_or_si128(top, blitLerp32_SSE2(d, c, a)));
+		}
+
+		for ( ; dx != job->width; ++dx )
+			dst[dx] = (job->argb & 0xFF000000 ) | PixelBlend32( dst[dx], src, alpha );
+
+		dst = (u32*) ( (u8*) (dst) + job->dstPitch );
+	}
+}
+
+// ----------------------- SSSE3 ---------------------------------
+
+/*
+	loads 4 pixel of 24 bit without touching the bytes behind them
+*/
+static inline _IRR_BLIT_TARGET_SSE2_ __m128i blitLoad24_SSE2(const u8 *src)
+{
+	return _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*) src), _mm_cvtsi32_si128(*(const s32*) (src + 8)));
+}
+
+/*
+	stores 4 pixel of 24 bit without touching the bytes behind them
+*/
+static inline _IRR_BLIT_TARGET_SSE2_ void blitStore24_SSE2(u8 *dst, const __m128i c)
+{
+	_mm_storel_epi64((__m128i*) dst, c);
+	*(s32*) (dst + 8) = _mm_cvtsi128_si32(_mm_srli_si128(c, 8));
+}
+
+/*
+	4 pixel of 24 bit { r, g, b } to 0x00RRGGBB
+*/
+static inline _IRR_BLIT_TARGET_SSSE3_ __m128i blitExpand24_SSSE3(const __m128i c)
+{
+	const __m128i shuffle = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+	return _mm_shuffle_epi8(c, shuffle);
+}
+
+/*
+	4 pixel 0x??RRGGBB to 24 bit { r, g, b }
+*/
+static inline _IRR_BLIT_TARGET_SSSE3_ __m128i blitCompact24_SSSE3(const __m128i c)
+{
+	const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+	return _mm_shuffle_epi8(c, shuffle);
+}
+
+/*!
+*/
+static _IRR_BLIT_TARGET_SSSE3_ void executeBlit_TextureCopy_24_to_16_SSSE3( const SBlitJob * job )
+{
+	if (job->stretch)
+	{
+		executeBlit_TextureCopy_24_to_16(job);
+		return;
+	}
+
+	const u32 w = job->width;
+	const u32 h = job->height;
+	const u8 *src = static_cast<const u8*>(job->src);
+	u16 *dst = static_cast<u16*>(job->dst);
+
+	const __m128i solid = _mm_set1_epi32((s32) 0xFF000000);
+
+	for ( u32 dy = 0; dy != h; ++dy )
+	{
+		const u8* s = src;
+		u32 dx = 0;
+		for ( ; dx + 4 <= w; dx += 4 )
+		{
+			// RGBA16 with full alpha
+			const __m128i d = blitTo16_SSE2(_mm_or_si128(blitExpand24_SSSE3(blitLoad24_SSE2(s)), solid));
+			_mm_storel_epi64((__m128i*) (dst + dx), blitPack16_SSE2(d, d));
+			s += 12;
+		}
+
+		for ( ; dx != w; ++dx )
+		{
+			dst[dx] = video::RGBA16(s[0], s[1], s[2]);
+			s += 3;
+		}
+
+		src = src+job->srcPitch;
+		dst = (u16*) ( (u8*) (dst) + job->dstPitch );
+	}
+}
+
+/*!
+*/
+static _IRR_BLIT_TARGET_SSSE3_ void executeBlit_TextureCopy_16_to_24_SSSE3( const SBlitJob * job )
+{
+	if (job->stretch)
+	{
+		executeBlit_TextureCopy_16_to_24(job);
+		return;
+	}
+
+	const u32 w = job->width;
+	const u32 h = job->height;
+	const u16 *src = static_cast<const u16*>(job->src);
+	u8 *dst = static_cast<u8*>(job->dst);
+
+	const __m128i zero = _mm_setzero_si128();
+
+	for ( u32 dy = 0; dy != h; ++dy )
+	{
+		u32 dx = 0;
+		for ( ; dx + 4 <= w; dx += 4 )
+		{
+			const __m128i s = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*) (src + dx)), zero);
+			blitStore24_SSE2(&dst[dx * 3], blitCompact24_SSSE3(blitTo32_SSE2(s)));
+		}
+
+		for ( ; dx != w; ++dx )
+		{
+			u32 color = video::A1R5G5B5toA8R8G8B8(src[dx]);
+			u8 * writeTo = &dst[dx * 3];
+			*writeTo++ = (color >> 16)& 0xFF;
+			*writeTo++ = (color >> 8) & 0xFF;
+			*writeTo++ = color & 0xFF;
+		}
+
+		src = (u16*) ( (u8*) (src) + job->srcPitch );
+		dst += job->dstPitch;
+	}
+}
+
+/*!
+*/
+static _IRR_BLIT_TARGET_SSSE3_ void executeBlit_TextureCopy_24_to_32_SSSE3( const SBlitJob * job )
+{
+	if (job->stretch)
+	{
+		executeBlit_TextureCopy_24_to_32(job);
+		return;
+	}
+
+	const u8 *src = static_cast<const u8*>(job->src);
+	u32 *dst = static_cast<u32*>(job->dst);
+
+	const __m128i solid = _mm_set1_epi32((s32) 0xFF000000);
+
+	for ( s32 dy = 0; dy != job->height; ++dy )
+	{
+		const u8* s = src;
+		s32 dx = 0;
+		for ( ; dx + 4 <= job->width; dx += 4 )
+		{
+			_mm_storeu_si128((__m128i*) (dst + dx), _mm_or_si128(blitExpand24_SSSE3(blitLoad24_SSE2(s)), solid));
+			s += 12;
+		}
+
+		for ( ; dx != job->width; ++dx )
+		{
+			dst[dx] = 0xFF000000 | s[0] << 16 | s[1] << 8 | s[2];
+			s += 3;
+		}
+
+		src = src + job->srcPitch;
+		dst = (u32*) ( (u8*) (dst) + job->dstPitch );
+	}
+}
+
+/*!
+*/
+static _IRR_BLIT_TARGET_SSSE3_ void executeBlit_TextureCopy_32_to_24_SSSE3( const SBlitJob * job )
+{
+	if (job->stretch)
+	{
+		executeBlit_TextureCopy_32_to_24(job);
+		return;
+	}
+
+	const u32 w = job->width;
+	const u32 h = job->height;
+	const u32 *src = static_cast<const u32*>(job->src);
+	u8 *dst = static_cast<u8*>(job->dst);
+
+	for ( u32 dy = 0; dy != h; ++dy )
+	{
+		u32 dx = 0;
+		for ( ; dx + 4 <= w; dx += 4 )
+			blitStore24_SSE2(&dst[dx * 3], blitCompact24_SSSE3(_mm_loadu_si128((const __m128i*) (src + dx))));
+
+		for ( ; dx != w; ++dx )
+		{
+			u8 * writeTo = &dst[dx * 3];
+			*writeTo++ = (src[dx] >> 16)& 0xFF;
+			*writeTo++ = (src[dx] >> 8) & 0xFF;
+			*writeTo++ = src[dx] & 0xFF;
+		}
+
+		src = (u32*) ( (u8*) (src) + job->srcPitch );
+		dst += job->dstPitch;
+	}
+}
+
+// ----------------------- AVX2 ----------------------------------
+
+/*
+	PixelBlend32 ( c2, c1, alpha ) for 8 pixel
+*/
+static inline _IRR_BLIT_TARGET_AVX2_ __m256i blitLerp32_AVX2(const __m256i c2, const __m256i c1, const __m256i alpha)
+{
+	const __m256i maskRB = _mm256_set1_epi32(0x00FF00FF);
+	const __m256i maskXG = _mm256_set1_epi32(0x0000FF00);
+
+	const __m256i dstRB = _mm256_and_si256(c2, maskRB);
+	const __m256i dstXG = _mm256_and_si256(c2, maskXG);
+
+	__m256i rb = _mm256_sub_epi32(_mm256_and_si256(c1, maskRB), dstRB);
+	__m256i xg = _mm256_sub_epi32(_mm256_and_si256(c1, maskXG), dstXG);
+
+	rb = _mm256_srli_epi32(_mm256_mullo_epi32(rb, alpha), 8);
+	xg = _mm256_srli_epi32(_mm256_mullo_epi32(xg, alpha), 8);
+
+	rb = _mm256_and_si256(_mm256_add_epi32(rb, dstRB), maskRB);
+	xg = _mm256_and_si256(_mm256_add_epi32(xg, dstXG), maskXG);
+
+	return _mm256_or_si256(rb, xg);
+}
+
+/*
+	PixelBlend32 ( c2, c1 ) for 8 pixel
+*/
+static inline _IRR_BLIT_TARGET_AVX2_ __m256i blitBlend32_AVX2(const __m256i c2, const __m256i c1)
+{
+	const __m256i a8 = _mm256_srli_epi32(c1, 24);
+
+	// add highbit alpha, if ( alpha > 127 ) alpha += 1;
+	const __m256i alpha = _mm256_add_epi32(a8, _mm256_srli_epi32(c1, 31));
+
+	const __m256i r = _mm256_or_si256(_mm256_and_si256(c1, _mm256_set1_epi32((s32) 0xFF000000)),
+				blitLerp32_AVX2(c2, c1, alpha));
+
+	// alpha test
+	const __m256i solid = _mm256_cmpeq_epi32(a8, _mm256_set1_epi32(0xFF));
+	const __m256i clear = _mm256_cmpeq_epi32(a8, _mm256_setzero_si256());
+	return _mm256_blendv_epi8(_mm256_blendv_epi8(r, c1, solid), c2, clear);
+}
+
+/*
+	PixelMul32_2 ( c0, c1 ) for 8 pixel
+*/
+static inline _IRR_BLIT_TARGET_AVX2_ __m256i blitMul32_2_AVX2(const __m256i c0, const __m256i c1)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i lo = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(c0, zero), _mm256_unpacklo_epi8(c1, zero)), 8);
+	const __m256i hi = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(c0, zero), _mm256_unpackhi_epi8(c1, zero)), 8);
+	return _mm256_packus_epi16(lo, hi);
+}
+
+/*!
+*/
+static _IRR_BLIT_TARGET_AVX2_ void executeBlit_TextureBlend_32_to_32_AVX2( const SBlitJob * job )
+{
+	if (job->stretch)
+	{
+		executeBlit_TextureBlend_32_to_32(job);
+		return;
+	}
+
+	const u32 w = job->width;
+	const u32 h = job->height;
+	const u32 *src = static_cast<const u32*>(job->src);
+	u32 *dst = static_cast<u32*>(job->dst);
+
+	const __m256i alphaMask = _mm256_set1_epi32((s32) 0xFF000000);
+
+	for ( u32 dy = 0; dy != h; ++dy )
+	{
+		u32 dx = 0;
+		for ( ; dx + 8 <= w; dx += 8 )
+		{
+			const __m256i s = _mm256_loadu_si256((const __m256i*) (src + dx));
+
+			// sprites are mostly empty space, leave the dest alone
+			if ( _mm256_testz_si256(s, alphaMask) )
+				continue;
+
+			const __m256i d = _mm256_loadu_si256((const __m256i*) (dst + dx));
+			_mm256_storeu_si256((__m256i*) (dst + dx), blitBlend32_AVX2(d, s));
+		}
+
+		for ( ; dx != w; ++dx )
+			dst[dx] = PixelBlend32( dst[dx], src[dx] );
+
+		src = (u32*) ( (u8*) (src) + job->srcPitch );
+		dst = (u32*) ( (u8*) (dst) + job->dstPitch );
+	}
+}
+
+/*!
+*/
+static _IRR_BLIT_TARGET_AVX2_ void executeBlit_TextureBlendColor_32_to_32_AVX2( const SBlitJob * job )
+{
+	const u32 *src = static_cast<const u32*>(job->src);
+	u32 *dst = static_cast<u32*>(job->dst);
+
+	const __m256i argb = _mm256_set1_epi32((s32) job->argb);
+
+	for ( s32 dy = 0; dy != job->height; ++dy )
+	{
+		s32 dx = 0;
+		for ( ; dx + 8 <= job->width; dx += 8 )
+		{
+			const __m256i s = blitMul32_2_AVX2(_mm256_loadu_si256((const __m256i*) (src + dx)), argb);
+			const __m256i d = _mm256_loadu_si256((const __m256i*) (dst + dx));
+			_mm256_storeu_si256((__m256i*) (dst + dx), blitBlend32_AVX2(d, s));
+		}
+
+		for ( ; dx != job->width; ++dx )
+			dst[dx] = PixelBlend32( dst[dx], PixelMul32_2( src[dx], job->argb ) );
+
+		src = (u32*) ( (u8*) (src) + job->srcPitch );
+		dst = (u32*) ( (u8*) (dst) + job->dstPitch );
+	}
+}
+
+/*!
+*/
+static _IRR_BLIT_TARGET_AVX2_ void executeBlit_Color_32_to_32_AVX2( const SBlitJob * job )
+{
+	u32 *dst = static_cast<u32*>(job->dst);
+
+	// srcPitch holds the bytes of one dest line for color operations
+	const u32 w = job->srcPitch >> 2;
+	const __m256i color = _mm256_set1_epi32((s32) job->argb);
+
+	for ( s32 dy = 0; dy != job->height; ++dy )
+	{
+		u32 dx = 0;
+		for ( ; dx + 8 <= w; dx += 8 )
+			_mm256_storeu_si256((__m256i*) (dst + dx), color);
+
+		for ( ; dx != w; ++dx )
+			dst[dx] = job->argb;
+
+		dst = (u32*) ( (u8*) (dst) + job->dstPitch );
+	}
+}
+
+/*!
+*/
+static _IRR_BLIT_TARGET_AVX2_ void executeBlit_ColorAlpha_32_to_32_AVX2( const SBlitJob * job )
+{
+	u32 *dst = static_cast<u32*>(job->dst);
+
+	const u32 alpha = extractAlpha( job->argb );
+	const u32 src = job->argb;
+
+	const __m256i a = _mm256_set1_epi32((s32) alpha);
+	const __m256i c = _mm256_set1_epi32((s32) src);
+	const __m256i top = _mm256_set1_epi32((s32) (src & 0xFF000000));
+
+	for ( s32 dy = 0; dy != job->height; ++dy )
+	{
+		s32 dx = 0;
+		for ( ; dx + 8 <= job->width; dx += 8 )
+		{
+			const __m256i d = _mm256_loadu_si256((const __m256i*) (dst + dx));
+			_mm256_storeu_si256((__m256i*) (dst + dx), _mm256_or_si256(top, blitLerp32_AVX2(d, c, a)));
+		}
+
+		for ( ; dx != job->width; ++dx )
+			dst[dx] = (job->argb & 0xFF000000 ) | PixelBlend32( dst[dx], src, alpha );
+
+		dst = (u32*) ( (u8*) (dst) + job->dstPitch );
+	}
+}
+
+static const blitterTable blitTable_AVX2[] =
+{
+	{ BLITTER_TEXTURE_ALPHA_BLEND, video::ECF_A8R8G8B8, video::ECF_A8R8G8B8, executeBlit_TextureBlend_32_to_32_AVX2 },
+	{ BLITTER_TEXTURE_ALPHA_COLOR_BLEND, video::ECF_A8R8G8B8, video::ECF_A8R8G8B8, executeBlit_TextureBlendColor_32_to_32_AVX2 },
+	{ BLITTER_COLOR, video::ECF_A8R8G8B8, -1, executeBlit_Color_32_to_32_AVX2 },
+	{ BLITTER_COLOR_ALPHA, video::ECF_A8R8G8B8, -1, executeBlit_ColorAlpha_32_to_32_AVX2 },
+	{ BLITTER_INVALID, -1, -1, 0 }
+};
+
+static const blitterTable blitTable_SSSE3[] =
+{
+	{ BLITTER_TEXTURE, video::ECF_A1R5G5B5, video::ECF_R8G8B8, executeBlit_TextureCopy_24_to_16_SSSE3 },
+	{ BLITTER_TEXTURE, video::ECF_A8R8G8B8, video::ECF_R8G8B8, executeBlit_TextureCopy_24_to_32_SSSE3 },
+	{ BLITTER_TEXTURE, video::ECF_R8G8B8, video::ECF_A1R5G5B5, executeBlit_TextureCopy_16_to_24_SSSE3 },
+	{ BLITTER_TEXTURE, video::ECF_R8G8B8, video::ECF_A8R8G8B8, executeBlit_TextureCopy_32_to_24_SSSE3 },
+	{ BLITTER_INVALID, -1, -1, 0 }
+};
+
+static const blitterTable blitTable_SSE2[] =
+{
+	{ BLITTER_TEXTURE, video::ECF_A1R5G5B5, video::ECF_A8R8G8B8, executeBlit_TextureCopy_32_to_16_SSE2 },
+	{ BLITTER_TEXTURE, video::ECF_A8R8G8B8, video::ECF_A1R5G5B5, executeBlit_TextureCopy_16_to_32_SSE2 },
+	{ BLITTER_TEXTURE_ALPHA_BLEND, video::ECF_A1R5G5B5, video::ECF_A1R5G5B5, executeBlit_TextureBlend_16_to_16_SSE2 },
+	{ BLITTER_TEXTURE_ALPHA_BLEND, video::ECF_A8R8G8B8, video::ECF_A8R8G8B8, executeBlit_TextureBlend_32_to_32_SSE2 },
+	{ BLITTER_TEXTURE_ALPHA_COLOR_BLEND, video::ECF_A1R5G5B5, video::ECF_A1R5G5B5, executeBlit_TextureBlendColor_16_to_16_SSE2 },
+	{ BLITTER_TEXTURE_ALPHA_COLOR_BLEND, video::ECF_A8R8G8B8, video::ECF_A8R8G8B8, executeBlit_TextureBlendColor_32_to_32_SSE2 },
+	{ BLITTER_COLOR, video::ECF_A1R5G5B5, -1, executeBlit_Color_16_to_16_SSE2 },
+	{ BLITTER_COLOR, video::ECF_A8R8G8B8, -1, executeBlit_Color_32_to_32_SSE2 },
+	{ BLITTER_COLOR_ALPHA, video::ECF_A1R5G5B5, -1, executeBlit_ColorAlpha_16_to_16_SSE2 },
+	{ BLITTER_COLOR_ALPHA, video::ECF_A8R8G8B8, -1, executeBlit_ColorAlpha_32_to_32_SSE2 },
+	{ BLITTER_INVALID, -1, -1, 0 }
+};
+
+#elif defined(_IRR_BLIT_SIMD_NEON_)
+
+// ----------------------- NEON ----------------------------------
+
+/*
+	PixelBlend32 ( c2, c1, alpha ) for 4 pixel
+*/
+static inline uint32x4_t blitLerp32_NEON(const uint32x4_t c2, const uint32x4_t c1, const uint32x4_t alpha)
+{
+	const uint32x4_t maskRB = vdupq_n_u32(0x00FF00FF);
+	const uint32x4_t maskXG = vdupq_n_u32(0x0000FF00);
+
+	const uint32x4_t dstRB = vandq_u32(c2, maskRB);
+	const uint32x4_t dstXG = vandq_u32(c2, maskXG);
+
+	uint32x4_t rb = vsubq_u32(vandq_u32(c1, maskRB), dstRB);
+	uint32x4_t xg = vsubq_u32(vandq_u32(c1, maskXG), dstXG);
+
+	rb = vshrq_n_u32(vmulq_u32(rb, alpha), 8);
+	xg = vshrq_n_u32(vmulq_u32(xg, alpha), 8);
+
+	rb = vandq_u32(vaddq_u32(rb, dstRB), maskRB);
+	xg = vandq_u32(vaddq_u32(xg, dstXG), maskXG);
+
+	return vorrq_u32(rb, xg);
+}
+
+/*
+	PixelBlend32 ( c2, c1 ) for 4 pixel
+*/
+static inline uint32x4_t blitBlend32_NEON(const uint32x4_t c2, const uint32x4_t c1)
+{
+	const uint32x4_t a8 = vshrq_n_u32(c1, 24);
+
+	// add highbit alpha, if ( alpha > 127 ) alpha += 1;
+	const uint32x4_t alpha = vaddq_u32(a8, vshrq_n_u32(c1, 31));
+
+	const uint32x4_t r = vorrq_u32(vandq_u32(c1, vdupq_n_u32(0xFF000000)), blitLerp32_NEON(c2, c1, alpha));
+
+	// alpha test
+	const uint32x4_t solid = vceqq_u32(a8, vdupq_n_u32(0xFF));
+	const uint32x4_t clear = vceqq_u32(a8, vdupq_n_u32(0));
+	return vbslq_u32(clear, c2, vbslq_u32(solid, c1, r));
+}
+
+/*
+	PixelMul32_2 ( c0, c1 ) for 4 pixel
+*/
+static inline uint32x4_t blitMul32_2_NEON(const uint32x4_t c0, const uint32x4_t c1)
+{
+	const uint8x16_t a = vreinterpretq_u8_u32(c0);
+	const uint8x16_t b = vreinterpretq_u8_u32(c1);
+	const uint8x8_t lo = vshrn_n_u16(vmull_u8(vget_low_u8(a), vget_low_u8(b)), 8);
+	const uint8x8_t hi = vshrn_n_u16(vmull_u8(vget_high_u8(a), vget_high_u8(b)), 8);
+	return vreinterpretq_u32_u8(vcombine_u8(lo, hi));
+}
+
+/*!
+*/
+static void executeBlit_TextureBlend_32_to_32_NEON( const SBlitJob * job )
+{
+	if (job->stretch)
+	{
+		executeBlit_TextureBlend_32_to_32(job);
+		return;
+	}
+
+	const u32 w = job->width;
+	const u32 h = job->height;
+	const u32 *src = static_cast<const u32*>(job->src);
+	u32 *dst = static_cast<u32*>(job->dst);
+
+	for ( u32 dy = 0; dy != h; ++dy )
+	{
+		u32 dx = 0;
+		for ( ; dx + 4 <= w; dx += 4 )
+		{
+			const uint32x4_t s = vld1q_u32(src + dx);
+			const uint32x4_t d = vld1q_u32(dst + dx);
+			vst1q_u32(dst + dx, blitBlend32_NEON(d, s));
+		}
+
+		for ( ; dx != w; ++dx )
+			dst[dx] = PixelBlend32( dst[dx], src[dx] );
+
+		src = (u32*) ( (u8*) (src) + job->srcPitch );
+		dst = (u32*) ( (u8*) (dst) + job->dstPitch );
+	}
+}
+
+/*!
+*/
+static void executeBlit_TextureBlendColor_32_to_32_NEON( const SBlitJob * job )
+{
+	const u32 *src = static_cast<const u32*>(job->src);
+	u32 *dst = static_cast<u32*>(job->dst);
+
+	const uint32x4_t argb = vdupq_n_u32(job->argb);
+
+	for ( s32 dy = 0; dy != job->height; ++dy )
+	{
+		s32 dx = 0;
+		for ( ; dx + 4 <= job->width; dx += 4 )
+		{
+			const uint32x4_t s = blitMul32_2_NEON(vld1q_u32(src + dx), argb);
+			const uint32x4_t d = vld1q_u32(dst + dx);
+			vst1q_u32(dst + dx, blitBlend32_NEON(d, s));
+		}
+
+		for ( ; dx != job->width; ++dx )
+			dst[dx] = PixelBlend32( dst[dx], PixelMul32_2( src[dx], job->argb ) );
+
+		src = (u32*) ( (u8*) (src) + job->srcPitch );
+		dst = (u32*) ( (u8*) (dst) + job->dstPitch );
+	}
+}
+
+/*!
+*/
+static void executeBlit_Color_32_to_32_NEON( const SBlitJob * job )
+{
+	u32 *dst = static_cast<u32*>(job->dst);
+
+	// srcPitch holds the bytes of one dest line for color operations
+	const u32 w = job->srcPitch >> 2;
+	const uint32x4_t color = vdupq_n_u32(job->argb);
+
+	for ( s32 dy = 0; dy != job->height; ++dy )
+	{
+		u32 dx = 0;
+		for ( ; dx + 4 <= w; dx += 4 )
+			vst1q_u32(dst + dx, color);
+
+		for ( ; dx != w; ++dx )
+			dst[dx] = job->argb;
+
+		dst = (u32*) ( (u8*) (dst) + job->dstPitch );
+	}
+}
+
+/*!
+*/
+static void executeBlit_ColorAlpha_32_to_32_NEON( const SBlitJob * job )
+{
+	u32 *dst = static_cast<u32*>(job->dst);
+
+	const u32 alpha = extractAlpha( job->argb );
+	const u32 src = job->argb;
+
+	const uint32x4_t a = vdupq_n_u32(alpha);
+	const uint32x4_t c = vdupq_n_u32(src);
+	const uint32x4_t top = vdupq_n_u32(src & 0xFF000000);
+
+	for ( s32 dy = 0; dy != job->height; ++dy )
+	{
+		s32 dx = 0;
+		for ( ; dx + 4 <= job->width; dx += 4 )
+			vst1q_u32(dst + dx, vorrq_u32(top, blitLerp32_NEON(vld1q_u32(dst + dx), c, a)));
+
+		for ( ; dx != job->width; ++dx )
+			dst[dx] = (job->argb & 0xFF000000 ) | PixelBlend32( dst[dx], src, alpha );
+
+		dst = (u32*) ( (u8*) (dst) + job->dstPitch );
+	}
+}
+
+static const blitterTable blitTable_NEON[] =
+{
+	{ BLITTER_TEXTURE_ALPHA_BLEND, video::ECF_A8R8G8B8, video::ECF_A8R8G8B8, executeBlit_TextureBlend_32_to_32_NEON },
+	{ BLITTER_TEXTURE_ALPHA_COLOR_BLEND, video::ECF_A8R8G8B8, video::ECF_A8R8G8B8, executeBlit_TextureBlendColor_32_to_32_NEON },
+	{ BLITTER_COLOR, video::ECF_A8R8G8B8, -1, executeBlit_Color_32_to_32_NEON },
+	{ BLITTER_COLOR_ALPHA, video::ECF_A8R8G8B8, -1, executeBlit_ColorAlpha_32_to_32_NEON },
+	{ BLITTER_INVALID, -1, -1, 0 }
+};
+
+#endif
+
+/*!
+	best SIMD blitter for the running cpu, 0 if there is none
+*/
+static tExecuteBlit getBlitterSIMD( eBlitter operation, s32 destFormat, s32 sourceFormat )
+{
+	tExecuteBlit blitter = 0;
+
+#if defined(_IRR_BLIT_SIMD_X86_)
+	const SBlitCPUFeatures &cpu = getBlitCPUFeatures();
+
+	if ( cpu.AVX2 )
+		blitter = findBlitter( blitTable_AVX2, operation, destFormat, sourceFormat );
+	if ( !blitter && cpu.SSSE3 )
+		blitter = findBlitter( blitTable_SSSE3, operation, destFormat, sourceFormat );
+	if ( !blitter && cpu.SSE2 )
+		blitter = findBlitter( blitTable_SSE2, operation, destFormat, sourceFormat );
+#elif defined(_IRR_BLIT_SIMD_NEON_)
+	// NEON is part of the build target, there is nothing to query
+	blitter = findBlitter( blitTable_NEON, operation, destFormat, sourceFormat );
+#endif
+
+	return blitter;
+}
+
+}
+
+#endif
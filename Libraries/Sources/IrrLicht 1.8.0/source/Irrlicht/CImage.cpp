@@ -6,6 +6,7 @@
 #include "irrString.h"
 #include "CColorConverter.h"
 #include "CBlit.h"
+#include "CImageResampler.h"
 
 namespace irr
 {
@@ -386,6 +387,79 @@ void CImage::copyToScalingBoxFilter(IImage* target, s32 bias, bool blend)
 }
 
 
+//! copies this surface into another, scaling it to fit with the given filter
+void CImage::copyToScalingFiltered(IImage* target, E_RESAMPLE_FILTER filter)
+{
+	if (!target)
+		return;
+
+	const core::dimension2d<u32>& targetSize = target->getDimension();
+
+	if (targetSize==Size)
+	{
+		copyTo(target);
+		return;
+	}
+
+	const bool done = copyToResampled(target->lock(), targetSize.Width, targetSize.Height,
+			target->getColorFormat(), target->getPitch(), filter);
+	target->unlock();
+
+	if (!done)
+		copyToScaling(target);
+}
+
+
+//! scales into target with CImageResampler, which works on A8R8G8B8 only.
+//! Other formats are converted to A8R8G8B8 and back.
+bool CImage::copyToResampled(void* target, u32 width, u32 height, ECOLOR_FORMAT format, u32 pitch, E_RESAMPLE_FILTER filter)
+{
+	if (!target || !width || !height)
+		return true;
+
+	if (!CImageResampler::isFormatSupported(Format) || !CImageResampler::isFormatSupported(format))
+		return false;
+
+	if (0==pitch)
+		pitch = width*getBitsPerPixelFromFormat(format)/8;
+
+	const u8* source = Data;
+	u32 sourcePitch = Pitch;
+	u8* sourceTemp = 0;
+	if (Format != ECF_A8R8G8B8)
+	{
+		sourcePitch = Size.Width*4;
+		sourceTemp = new u8[sourcePitch*Size.Height];
+		for (u32 y=0; y<Size.Height; ++y)
+			CColorConverter::convert_viaFormat(Data + y*Pitch, Format, Size.Width, sourceTemp + y*sourcePitch, ECF_A8R8G8B8);
+		source = sourceTemp;
+	}
+
+	u8* dest = (u8*) target;
+	u32 destPitch = pitch;
+	u8* destTemp = 0;
+	if (format != ECF_A8R8G8B8)
+	{
+		destPitch = width*4;
+		destTemp = new u8[destPitch*height];
+		dest = destTemp;
+	}
+
+	CImageResampler::resample(filter, source, Size.Width, Size.Height, sourcePitch,
+			dest, width, height, destPitch);
+
+	if (destTemp)
+	{
+		for (u32 y=0; y<height; ++y)
+			CColorConverter::convert_viaFormat(destTemp + y*destPitch, ECF_A8R8G8B8, width, (u8*)target + y*pitch, format);
+	}
+
+	delete [] sourceTemp;
+	delete [] destTemp;
+	return true;
+}
+
+
 //! fills the surface with given color
 void CImage::fill(const SColor &color)
 {
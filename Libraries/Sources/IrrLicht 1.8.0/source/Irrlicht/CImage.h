@@ -103,6 +103,9 @@ public:
 	//! fills the surface with given color
 	virtual void fill(const SColor &color);
 
+	//! copies this surface into another, scaling it to fit with the given filter
+	virtual void copyToScalingFiltered(IImage* target, E_RESAMPLE_FILTER filter = ERF_BILINEAR);
+
 private:
 
 	//! assumes format and size has been set and creates the rest
@@ -110,6 +113,9 @@ private:
 
 	inline SColor getPixelBox ( s32 x, s32 y, s32 fx, s32 fy, s32 bias ) const;
 
+	//! scales into target with CImageResampler, false if a format is not supported
+	bool copyToResampled(void* target, u32 width, u32 height, ECOLOR_FORMAT format, u32 pitch, E_RESAMPLE_FILTER filter);
+
 	u8* Data;
 	core::dimension2d<u32> Size;
 	u32 BytesPerPixel;
@@ -0,0 +1,573 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt / Thomas Alten
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CImageResampler.h"
+#include "CBlit.h"
+#include "irrMath.h"
+
+#if defined(_IRR_COMPILE_WITH_THREADED_RESAMPLER_) && \
+	( __cplusplus >= 201103L || ( defined(_MSC_VER) && _MSC_VER >= 1700 ) )
+	#define _IRR_RESAMPLE_THREADS_
+	#include <thread>
+	#include <functional>
+#endif
+
+#if defined(_IRR_COMPILE_WITH_SIMD_BLITTER_) && defined(_IRR_BLIT_SIMD_X86_)
+	#define _IRR_RESAMPLE_SSE2_
+#endif
+
+namespace irr
+{
+namespace video
+{
+
+namespace
+{
+
+//! fixed point precision of the filter weights
+const s32 RESAMPLE_BITS = 14;
+const s32 RESAMPLE_ONE = 1 << RESAMPLE_BITS;
+
+//! don't split images with less target pixels than this into bands
+const u32 RESAMPLE_MIN_THREADED_PIXELS = 256 * 256;
+const u32 RESAMPLE_MAX_THREADS = 16;
+
+//! radius of the filter, in source pixels when not downscaling
+f64 getFilterSupport(E_RESAMPLE_FILTER filter)
+{
+	switch (filter)
+	{
+		case ERF_BOX:
+			return 0.5;
+		case ERF_BILINEAR:
+			return 1.0;
+		case ERF_CATMULL_ROM:
+			return 2.0;
+		case ERF_LANCZOS3:
+			return 3.0;
+	}
+	return 1.0;
+}
+
+f64 sinc(f64 x)
+{
+	if (x == 0.0)
+		return 1.0;
+	x *= core::PI64;
+	return sin(x) / x;
+}
+
+//! filter weight at distance x from the filter center
+f64 getFilterWeight(E_RESAMPLE_FILTER filter, f64 x)
+{
+	x = fabs(x);
+
+	switch (filter)
+	{
+		case ERF_BOX:
+			return x <= 0.5 ? 1.0 : 0.0;
+		case ERF_BILINEAR:
+			return x < 1.0 ? 1.0 - x : 0.0;
+		case ERF_CATMULL_ROM:
+			if (x < 1.0)
+				return (1.5 * x - 2.5) * x * x + 1.0;
+			if (x < 2.0)
+				return ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0;
+			return 0.0;
+		case ERF_LANCZOS3:
+			return x < 3.0 ? sinc(x) * sinc(x / 3.0) : 0.0;
+	}
+	return 0.0;
+}
+
+//! weights of the source pixels contributing to each target pixel along one axis
+/** Every target pixel uses the same number of taps starting at Start[i],
+taps outside of the filter have a weight of 0. The weights of a target
+pixel always add up to RESAMPLE_ONE. */
+struct SResampleWeights
+{
+	SResampleWeights() : Taps(0), Start(0), Weights(0) {}
+
+	~SResampleWeights()
+	{
+		delete [] Start;
+		delete [] Weights;
+	}
+
+	void build(E_RESAMPLE_FILTER filter, u32 sourceSize, u32 targetSize)
+	{
+		const f64 scale = (f64) targetSize / (f64) sourceSize;
+
+		// when downscaling the filter is stretched over 1/scale source pixels
+		f64 width = getFilterSupport(filter);
+		f64 filterScale = 1.0;
+		if (scale < 1.0)
+		{
+			width /= scale;
+			filterScale = scale;
+		}
+
+		Taps = core::min_((u32) core::ceil32((f32) (2.0 * width)) + 1, sourceSize);
+
+		Start = new s32[targetSize];
+		Weights = new s16[targetSize * Taps];
+		memset(Weights, 0, targetSize * Taps * sizeof(s16));
+
+		f64* contribution = new f64[Taps];
+
+		for (u32 i = 0; i != targetSize; ++i)
+		{
+			const f64 center = ((f64) i + 0.5) / scale;
+
+			// source pixels with their center inside the filter
+			s32 left = core::max_((s32) ceil(center - width - 0.5), 0);
+			s32 right = core::min_((s32) floor(center + width - 0.5), (s32) sourceSize - 1);
+
+			f64 total = 0.0;
+			s32 count = 0;
+			for (s32 j = left; j <= right && count != (s32) Taps; ++j, ++count)
+			{
+				contribution[count] = getFilterWeight(filter, ((f64) j + 0.5 - center) * filterScale);
+				total += contribution[count];
+			}
+
+			// drop the empty taps at both ends
+			while (count && contribution[count - 1] == 0.0)
+				--count;
+			s32 skip = 0;
+			while (skip < count && contribution[skip] == 0.0)
+				++skip;
+
+			if (skip == count || total == 0.0)
+			{
+				// nothing in reach, take the nearest pixel
+				left = core::s32_clamp((s32) center, 0, (s32) sourceSize - 1);
+				contribution[0] = 1.0;
+				total = 1.0;
+				skip = 0;
+				count = 1;
+			}
+			else
+			{
+				left += skip;
+				count -= skip;
+			}
+
+			// keep all taps inside the source
+			const s32 start = core::min_(left, (s32) (sourceSize - Taps));
+			Start[i] = start;
+
+			s16* w = Weights + i * Taps + (left - start);
+			s32 sum = 0;
+			s32 largest = 0;
+			for (s32 j = 0; j != count; ++j)
+			{
+				w[j] = (s16) core::round32((f32) (contribution[skip + j] / total * RESAMPLE_ONE));
+				sum += w[j];
+				if (core::abs_(w[j]) > core::abs_(w[largest]))
+					largest = j;
+			}
+
+			// rounding must not change the brightness
+			w[largest] = (s16) (w[largest] + RESAMPLE_ONE - sum);
+		}
+
+		delete [] contribution;
+	}
+
+	u32 Taps;
+	s32* Start;
+	s16* Weights;
+};
+
+struct SResampleJob
+{
+	const u8* Source;
+	u32 SourceWidth;
+	u32 SourcePitch;
+
+	u32* Temp;
+	u32 TempWidth;
+
+	u8* Target;
+	u32 TargetPitch;
+
+	SResampleWeights Horizontal;
+	SResampleWeights Vertical;
+
+	bool SSE2;
+};
+
+typedef void (*tResampleRows)(const SResampleJob& job, u32* buffer, u32 first, u32 last);
+
+inline u32 clampResampled(s32 v)
+{
+	v = (v + (RESAMPLE_ONE >> 1)) >> RESAMPLE_BITS;
+	return (u32) core::s32_clamp(v, 0, 255);
+}
+
+//! premultiplied colors can't be brighter than their alpha, the sharper filters overshoot
+inline u32 clampToAlpha(u32 c)
+{
+	const u32 a = c >> 24;
+	const u32 r = core::min_((c >> 16) & 0xFF, a);
+	const u32 g = core::min_((c >> 8) & 0xFF, a);
+	const u32 b = core::min_(c & 0xFF, a);
+	return (a << 24) | (r << 16) | (g << 8) | b;
+}
+
+//! c * a / 255, rounded
+inline u32 mulAlpha(u32 c, u32 a)
+{
+	const u32 t = c * a + 128;
+	return (t + (t >> 8)) >> 8;
+}
+
+inline u32 premultiply(u32 c)
+{
+	const u32 a = c >> 24;
+	if (a == 255)
+		return c;
+	return (a << 24) |
+		(mulAlpha((c >> 16) & 0xFF, a) << 16) |
+		(mulAlpha((c >> 8) & 0xFF, a) << 8) |
+		mulAlpha(c & 0xFF, a);
+}
+
+//! inverse of premultiply for a row of pixels
+void unpremultiplyRow(u32* row, u32 count)
+{
+	for (u32 x = 0; x != count; ++x)
+	{
+		const u32 c = row[x];
+		const u32 a = c >> 24;
+		if (a == 255)
+			continue;
+		if (a == 0)
+		{
+			row[x] = 0;
+			continue;
+		}
+
+		// colors are <= a, so this stays <= 255
+		const u32 half = a >> 1;
+		row[x] = (a << 24) |
+			(((((c >> 16) & 0xFF) * 255 + half) / a) << 16) |
+			(((((c >> 8) & 0xFF) * 255 + half) / a) << 8) |
+			(((c & 0xFF) * 255 + half) / a);
+	}
+}
+
+// ----------------------- plain C --------------------------------
+
+void premultiplyRow(const u32* src, u32* dst, u32 count)
+{
+	for (u32 x = 0; x != count; ++x)
+		dst[x] = premultiply(src[x]);
+}
+
+void resampleRowsHorizontal(const SResampleJob& job, u32* buffer, u32 first, u32 last)
+{
+	const u32 taps = job.Horizontal.Taps;
+
+	for (u32 y = first; y != last; ++y)
+	{
+		premultiplyRow((const u32*) (job.Source + y * job.SourcePitch), buffer, job.SourceWidth);
+
+		u32* dst = job.Temp + y * job.TempWidth;
+		const s16* w = job.Horizontal.Weights;
+		for (u32 x = 0; x != job.TempWidth; ++x, w += taps)
+		{
+			const u32* src = buffer + job.Horizontal.Start[x];
+			s32 a = 0, r = 0, g = 0, b = 0;
+			for (u32 t = 0; t != taps; ++t)
+			{
+				const u32 c = src[t];
+				a += w[t] * (s32) (c >> 24);
+				r += w[t] * (s32) ((c >> 16) & 0xFF);
+				g += w[t] * (s32) ((c >> 8) & 0xFF);
+				b += w[t] * (s32) (c & 0xFF);
+			}
+			dst[x] = clampToAlpha((clampResampled(a) << 24) | (clampResampled(r) << 16) |
+				(clampResampled(g) << 8) | clampResampled(b));
+		}
+	}
+}
+
+void resampleRowsVertical(const SResampleJob& job, u32* buffer, u32 first, u32 last)
+{
+	const u32 taps = job.Vertical.Taps;
+
+	for (u32 y = first; y != last; ++y)
+	{
+		const u32* src = job.Temp + job.Vertical.Start[y] * job.TempWidth;
+		const s16* w = job.Vertical.Weights + y * taps;
+		u32* dst = (u32*) (job.Target + y * job.TargetPitch);
+
+		for (u32 x = 0; x != job.TempWidth; ++x)
+		{
+			s32 a = 0, r = 0, g = 0, b = 0;
+			for (u32 t = 0; t != taps; ++t)
+			{
+				const u32 c = src[t * job.TempWidth + x];
+				a += w[t] * (s32) (c >> 24);
+				r += w[t] * (s32) ((c >> 16) & 0xFF);
+				g += w[t] * (s32) ((c >> 8) & 0xFF);
+				b += w[t] * (s32) (c & 0xFF);
+			}
+			dst[x] = clampToAlpha((clampResampled(a) << 24) | (clampResampled(r) << 16) |
+				(clampResampled(g) << 8) | clampResampled(b));
+		}
+
+		unpremultiplyRow(dst, job.TempWidth);
+	}
+}
+
+// ----------------------- SSE2 ----------------------------------
+
+#if defined(_IRR_RESAMPLE_SSE2_)
+
+//! two 14 bit weights for _mm_madd_epi16 on interleaved channels
+inline _IRR_BLIT_TARGET_SSE2_ __m128i resampleWeights_SSE2(s16 w0, s16 w1)
+{
+	return _mm_set1_epi32((s32) (((u32) (u16) w1 << 16) | (u16) w0));
+}
+
+//! round, drop the fraction and saturate four pixels to 0..255
+inline _IRR_BLIT_TARGET_SSE2_ __m128i resamplePack_SSE2(__m128i p0, __m128i p1, __m128i p2, __m128i p3)
+{
+	const __m128i round = _mm_set1_epi32(RESAMPLE_ONE >> 1);
+	p0 = _mm_srai_epi32(_mm_add_epi32(p0, round), RESAMPLE_BITS);
+	p1 = _mm_srai_epi32(_mm_add_epi32(p1, round), RESAMPLE_BITS);
+	p2 = _mm_srai_epi32(_mm_add_epi32(p2, round), RESAMPLE_BITS);
+	p3 = _mm_srai_epi32(_mm_add_epi32(p3, round), RESAMPLE_BITS);
+	return _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+}
+
+//! clampToAlpha for four pixels
+inline _IRR_BLIT_TARGET_SSE2_ __m128i resampleClampToAlpha_SSE2(const __m128i c)
+{
+	__m128i a = _mm_srli_epi32(c, 24);
+	a = _mm_or_si128(a, _mm_slli_epi32(a, 8));
+	a = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+	return _mm_min_epu8(c, a);
+}
+
+_IRR_BLIT_TARGET_SSE2_ void premultiplyRow_SSE2(const u32* src, u32* dst, u32 count)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alphaMask = _mm_set1_epi32(0xFF000000);
+	const __m128i round = _mm_set1_epi16(128);
+
+	u32 x = 0;
+	for (; x + 4 <= count; x += 4)
+	{
+		const __m128i c = _mm_loadu_si128((const __m128i*) (src + x));
+
+		// the alpha channel is multiplied by 255 and stays the same
+		__m128i a = _mm_srli_epi32(c, 24);
+		a = _mm_or_si128(a, _mm_slli_epi32(a, 8));
+		a = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+		a = _mm_or_si128(a, alphaMask);
+
+		__m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(a, zero)), round);
+		__m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(a, zero)), round);
+		lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+		hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+
+		_mm_storeu_si128((__m128i*) (dst + x), _mm_packus_epi16(lo, hi));
+	}
+
+	for (; x != count; ++x)
+		dst[x] = premultiply(src[x]);
+}
+
+_IRR_BLIT_TARGET_SSE2_ void resampleRowsHorizontal_SSE2(const SResampleJob& job, u32* buffer, u32 first, u32 last)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const u32 taps = job.Horizontal.Taps;
+
+	for (u32 y = first; y != last; ++y)
+	{
+		premultiplyRow_SSE2((const u32*) (job.Source + y * job.SourcePitch), buffer, job.SourceWidth);
+
+		u32* dst = job.Temp + y * job.TempWidth;
+		const s16* w = job.Horizontal.Weights;
+		for (u32 x = 0; x != job.TempWidth; ++x, w += taps)
+		{
+			const u32* src = buffer + job.Horizontal.Start[x];
+			__m128i sum = zero;
+
+			u32 t = 0;
+			for (; t + 2 <= taps; t += 2)
+			{
+				// [b0 g0 r0 a0 b1 g1 r1 a1] -> [b0 b1 g0 g1 r0 r1 a0 a1]
+				__m128i c = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*) (src + t)), zero);
+				c = _mm_unpacklo_epi16(c, _mm_srli_si128(c, 8));
+				sum = _mm_add_epi32(sum, _mm_madd_epi16(c, resampleWeights_SSE2(w[t], w[t + 1])));
+			}
+			if (t != taps)
+			{
+				__m128i c = _mm_unpacklo_epi8(_mm_cvtsi32_si128((s32) src[t]), zero);
+				c = _mm_unpacklo_epi16(c, zero);
+				sum = _mm_add_epi32(sum, _mm_madd_epi16(c, resampleWeights_SSE2(w[t], 0)));
+			}
+
+			dst[x] = (u32) _mm_cvtsi128_si32(resampleClampToAlpha_SSE2(resamplePack_SSE2(sum, zero, zero, zero)));
+		}
+	}
+}
+
+_IRR_BLIT_TARGET_SSE2_ void resampleRowsVertical_SSE2(const SResampleJob& job, u32* buffer, u32 first, u32 last)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const u32 taps = job.Vertical.Taps;
+	const u32 width = job.TempWidth;
+
+	for (u32 y = first; y != last; ++y)
+	{
+		const u32* src = job.Temp + job.Vertical.Start[y] * width;
+		const s16* w = job.Vertical.Weights + y * taps;
+		u32* dst = (u32*) (job.Target + y * job.TargetPitch);
+
+		// four pixels, each channel weighted by two rows per _mm_madd_epi16
+		u32 x = 0;
+		for (; x + 4 <= width; x += 4)
+		{
+			__m128i p0 = zero, p1 = zero, p2 = zero, p3 = zero;
+
+			for (u32 t = 0; t < taps; t += 2)
+			{
+				const __m128i c0 = _mm_loadu_si128((const __m128i*) (src + t * width + x));
+				__m128i c1 = zero;
+				s16 w1 = 0;
+				if (t + 1 != taps)
+				{
+					c1 = _mm_loadu_si128((const __m128i*) (src + (t + 1) * width + x));
+					w1 = w[t + 1];
+				}
+				const __m128i weights = resampleWeights_SSE2(w[t], w1);
+
+				const __m128i lo0 = _mm_unpacklo_epi8(c0, zero);
+				const __m128i hi0 = _mm_unpackhi_epi8(c0, zero);
+				const __m128i lo1 = _mm_unpacklo_epi8(c1, zero);
+				const __m128i hi1 = _mm_unpackhi_epi8(c1, zero);
+
+				p0 = _mm_add_epi32(p0, _mm_madd_epi16(_mm_unpacklo_epi16(lo0, lo1), weights));
+				p1 = _mm_add_epi32(p1, _mm_madd_epi16(_mm_unpackhi_epi16(lo0, lo1), weights));
+				p2 = _mm_add_epi32(p2, _mm_madd_epi16(_mm_unpacklo_epi16(hi0, hi1), weights));
+				p3 = _mm_add_epi32(p3, _mm_madd_epi16(_mm_unpackhi_epi16(hi0, hi1), weights));
+			}
+
+			_mm_storeu_si128((__m128i*) (dst + x), resampleClampToAlpha_SSE2(resamplePack_SSE2(p0, p1, p2, p3)));
+		}
+
+		for (; x != width; ++x)
+		{
+			s32 a = 0, r = 0, g = 0, b = 0;
+			for (u32 t = 0; t != taps; ++t)
+			{
+				const u32 c = src[t * width + x];
+				a += w[t] * (s32) (c >> 24);
+				r += w[t] * (s32) ((c >> 16) & 0xFF);
+				g += w[t] * (s32) ((c >> 8) & 0xFF);
+				b += w[t] * (s32) (c & 0xFF);
+			}
+			dst[x] = clampToAlpha((clampResampled(a) << 24) | (clampResampled(r) << 16) |
+				(clampResampled(g) << 8) | clampResampled(b));
+		}
+
+		unpremultiplyRow(dst, width);
+	}
+}
+
+#endif
+
+//! runs a pass over rows [0,rows), split into bands when it is worth it
+void resampleRows(tResampleRows pass, const SResampleJob& job, u32 rows, u32 bufferSize, u32 pixels)
+{
+	u32 bands = 1;
+
+#if !defined(_IRR_RESAMPLE_THREADS_)
+	(void) pixels;
+#else
+	if (pixels >= RESAMPLE_MIN_THREADED_PIXELS)
+	{
+		bands = core::min_(core::max_((u32) std::thread::hardware_concurrency(), 1u), RESAMPLE_MAX_THREADS);
+		bands = core::min_(bands, rows);
+	}
+#endif
+
+	u32* buffer = new u32[bufferSize * bands];
+
+	if (bands == 1)
+	{
+		pass(job, buffer, 0, rows);
+	}
+#if defined(_IRR_RESAMPLE_THREADS_)
+	else
+	{
+		// the calling thread takes the first band
+		std::thread* threads = new std::thread[bands - 1];
+		for (u32 i = 1; i != bands; ++i)
+			threads[i - 1] = std::thread(pass, std::cref(job), buffer + i * bufferSize,
+				rows * i / bands, rows * (i + 1) / bands);
+
+		pass(job, buffer, 0, rows / bands);
+
+		for (u32 i = 0; i != bands - 1; ++i)
+			threads[i].join();
+		delete [] threads;
+	}
+#endif
+
+	delete [] buffer;
+}
+
+} // end anonymous namespace
+
+
+void CImageResampler::resample(E_RESAMPLE_FILTER filter,
+		const void* source, u32 sourceWidth, u32 sourceHeight, u32 sourcePitch,
+		void* target, u32 targetWidth, u32 targetHeight, u32 targetPitch)
+{
+	if (!source || !target || !sourceWidth || !sourceHeight || !targetWidth || !targetHeight)
+		return;
+
+	SResampleJob job;
+	job.Source = (const u8*) source;
+	job.SourceWidth = sourceWidth;
+	job.SourcePitch = sourcePitch;
+	job.TempWidth = targetWidth;
+	job.Target = (u8*) target;
+	job.TargetPitch = targetPitch;
+	job.Horizontal.build(filter, sourceWidth, targetWidth);
+	job.Vertical.build(filter, sourceHeight, targetHeight);
+
+	job.SSE2 = false;
+#if defined(_IRR_RESAMPLE_SSE2_)
+	job.SSE2 = getBlitCPUFeatures().SSE2;
+#endif
+
+	// the rows scaled to the target width, premultiplied
+	job.Temp = new u32[targetWidth * sourceHeight];
+
+	tResampleRows horizontal = resampleRowsHorizontal;
+	tResampleRows vertical = resampleRowsVertical;
+#if defined(_IRR_RESAMPLE_SSE2_)
+	if (job.SSE2)
+	{
+		horizontal = resampleRowsHorizontal_SSE2;
+		vertical = resampleRowsVertical_SSE2;
+	}
+#endif
+
+	resampleRows(horizontal, job, sourceHeight, sourceWidth, targetWidth * sourceHeight);
+	resampleRows(vertical, job, targetHeight, 0, targetWidth * targetHeight);
+
+	delete [] job.Temp;
+}
+
+} // end namespace video
+} // end namespace irr
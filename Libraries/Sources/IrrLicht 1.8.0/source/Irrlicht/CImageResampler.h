@@ -0,0 +1,63 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt / Thomas Alten
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_IMAGE_RESAMPLER_H_INCLUDED__
+#define __C_IMAGE_RESAMPLER_H_INCLUDED__
+
+#include "IImage.h"
+
+namespace irr
+{
+namespace video
+{
+
+//! Separable resampler for A8R8G8B8 image data.
+/** Scales in two passes, first along the rows into a temporary image of
+the target width, then along the columns into the target. The filter
+weights are precomputed per target row and column in 14 bit fixed point,
+when downscaling the filter is widened so every source pixel contributes.
+Color channels are filtered premultiplied by alpha, so transparent pixels
+don't bleed their color into the result.
+Both passes have SSE2 versions giving the same bits as the plain C code,
+large images are split into bands of rows which are scaled in parallel. */
+class CImageResampler
+{
+public:
+
+	//! Scales an A8R8G8B8 image into another A8R8G8B8 image.
+	/** \param filter Filter to use.
+	\param source Pointer to the first row of the source image.
+	\param sourceWidth Width of the source image in pixels.
+	\param sourceHeight Height of the source image in pixels.
+	\param sourcePitch Size of a source row in bytes.
+	\param target Pointer to the first row of the target image.
+	\param targetWidth Width of the target image in pixels.
+	\param targetHeight Height of the target image in pixels.
+	\param targetPitch Size of a target row in bytes. */
+	static void resample(E_RESAMPLE_FILTER filter,
+			const void* source, u32 sourceWidth, u32 sourceHeight, u32 sourcePitch,
+			void* target, u32 targetWidth, u32 targetHeight, u32 targetPitch);
+
+	//! Returns if images of the given format can be scaled.
+	/** Formats other than A8R8G8B8 are converted through A8R8G8B8 by
+	the caller, this is possible for all formats CColorConverter knows. */
+	static bool isFormatSupported(ECOLOR_FORMAT format)
+	{
+		switch (format)
+		{
+			case ECF_A1R5G5B5:
+			case ECF_R5G6B5:
+			case ECF_R8G8B8:
+			case ECF_A8R8G8B8:
+				return true;
+			default:
+				return false;
+		}
+	}
+};
+
+} // end namespace video
+} // end namespace irr
+
+#endif
@@ -0,0 +1,273 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_RENDER_QUEUE_H_INCLUDED__
+#define __C_RENDER_QUEUE_H_INCLUDED__
+
+#include "ISceneNode.h"
+#include "irrArray.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! List of scene nodes to render in one pass, sorted by an integer key.
+/** The scene manager refills the queue every frame. Keys are sorted
+ascending with a LSD radix sort, byte positions where all keys are equal
+are skipped. The order of the previous frame is kept, if the same nodes
+are registered in the same order again it is tried first and fixed with
+an insertion sort, which is nearly free when only a few nodes swapped.
+Nodes with equal keys stay in registration order. The arrays keep their
+memory between frames. */
+class CRenderQueue
+{
+public:
+
+	//! statistics of the last sort()
+	struct SStats
+	{
+		SStats() : Nodes(0), RadixPasses(0), InsertionMoves(0), Coherent(false) {}
+
+		//! number of sorted nodes
+		u32 Nodes;
+
+		//! radix passes done, 0 when the insertion sort was enough
+		u32 RadixPasses;
+
+		//! element moves done by the insertion sort
+		u32 InsertionMoves;
+
+		//! true if the order of the previous frame was reused
+		bool Coherent;
+	};
+
+	CRenderQueue() : Sorted(true) {}
+
+	//! removes all nodes, but keeps the memory
+	void clear()
+	{
+		Entries.set_used(0);
+		Sorted = true;
+	}
+
+	//! adds a node, nodes with a lower key are rendered first
+	void push_back(ISceneNode* node, u64 key)
+	{
+		SEntry e;
+		e.Key = key;
+		e.Node = node;
+		e.Index = Entries.size();
+		Entries.push_back(e);
+		Sorted = false;
+	}
+
+	u32 size() const
+	{
+		return Entries.size();
+	}
+
+	bool empty() const
+	{
+		return Entries.empty();
+	}
+
+	//! returns the i-th node, in sorted order after sort()
+	ISceneNode* operator[](u32 i) const
+	{
+		return Entries[i].Node;
+	}
+
+	//! sorts the nodes by key
+	void sort()
+	{
+		Stats = SStats();
+		Stats.Nodes = Entries.size();
+
+		if (Sorted)
+			return;
+		Sorted = true;
+
+		const u32 n = Entries.size();
+		Temp.set_used(n);
+
+		bool done = false;
+
+		// same nodes as in the previous frame, try their old order first
+		if (n == PreviousNodes.size() && n > 1)
+		{
+			u32 i = 0;
+			while (i < n && Entries[i].Node == PreviousNodes[i])
+				++i;
+
+			if (i == n)
+			{
+				for (i = 0; i < n; ++i)
+					Temp[i] = Entries[PreviousOrder[i]];
+
+				Stats.Coherent = true;
+				done = insertionSort(Temp.pointer(), n, n * 4);
+				if (done)
+					swapEntries();
+			}
+		}
+
+		if (!done)
+		{
+			if (n <= 16)
+				insertionSort(Entries.pointer(), n, n * n);
+			else
+				radixSort();
+		}
+
+		// remember the order for the next frame
+		PreviousNodes.set_used(n);
+		PreviousOrder.set_used(n);
+		for (u32 i = 0; i < n; ++i)
+		{
+			PreviousNodes[Entries[i].Index] = Entries[i].Node;
+			PreviousOrder[i] = Entries[i].Index;
+		}
+	}
+
+	//! statistics of the last sort()
+	const SStats& getStats() const
+	{
+		return Stats;
+	}
+
+	//! key for sorting front to back by a distance, smaller distances first
+	static u64 getDistanceKey(f64 distance)
+	{
+		// the bits of a positive double sort like the double itself
+		if (!(distance > 0.0))
+			return 0;
+
+		u64 bits;
+		memcpy(&bits, &distance, sizeof(bits));
+		return bits;
+	}
+
+	//! key for sorting back to front by a distance, larger distances first
+	static u64 getReverseDistanceKey(f64 distance)
+	{
+		return ~getDistanceKey(distance);
+	}
+
+private:
+
+	struct SEntry
+	{
+		u64 Key;
+		ISceneNode* Node;
+		u32 Index;
+	};
+
+	//! equal keys are ordered by registration, like the radix sort does
+	static bool isBefore(const SEntry& a, const SEntry& b)
+	{
+		return a.Key < b.Key || (a.Key == b.Key && a.Index < b.Index);
+	}
+
+	//! insertion sort, gives up after maxMoves moves
+	bool insertionSort(SEntry* e, u32 n, u32 maxMoves)
+	{
+		u32 moves = 0;
+
+		for (u32 i = 1; i < n; ++i)
+		{
+			if (!isBefore(e[i], e[i-1]))
+				continue;
+
+			const SEntry t = e[i];
+			u32 j = i;
+			do
+			{
+				e[j] = e[j-1];
+				--j;
+				++moves;
+			} while (j > 0 && isBefore(t, e[j-1]));
+			e[j] = t;
+
+			if (moves > maxMoves)
+			{
+				Stats.InsertionMoves += moves;
+				return false;
+			}
+		}
+
+		Stats.InsertionMoves += moves;
+		return true;
+	}
+
+	//! LSD radix sort of Entries, 8 bits per pass
+	void radixSort()
+	{
+		const u32 n = Entries.size();
+
+		u32 count[8][256];
+		memset(count, 0, sizeof(count));
+
+		const SEntry* e = Entries.const_pointer();
+		for (u32 i = 0; i < n; ++i)
+		{
+			u64 key = e[i].Key;
+			for (u32 b = 0; b < 8; ++b, key >>= 8)
+				++count[b][key & 0xFF];
+		}
+
+		SEntry* src = Entries.pointer();
+		SEntry* dst = Temp.pointer();
+		u32 passes = 0;
+
+		for (u32 b = 0; b < 8; ++b)
+		{
+			u32* c = count[b];
+
+			// all keys have the same byte here, nothing to do
+			const u32 first = (u32) ((src[0].Key >> (b * 8)) & 0xFF);
+			if (c[first] == n)
+				continue;
+
+			u32 offset = 0;
+			for (u32 i = 0; i < 256; ++i)
+			{
+				const u32 t = c[i];
+				c[i] = offset;
+				offset += t;
+			}
+
+			for (u32 i = 0; i < n; ++i)
+				dst[c[(src[i].Key >> (b * 8)) & 0xFF]++] = src[i];
+
+			SEntry* t = src;
+			src = dst;
+			dst = t;
+			++passes;
+		}
+
+		// an odd number of passes left the result in Temp
+		if (passes & 1)
+			swapEntries();
+
+		Stats.RadixPasses = passes;
+	}
+
+	void swapEntries()
+	{
+		Entries.swap(Temp);
+	}
+
+	core::array<SEntry> Entries;
+	core::array<SEntry> Temp;
+	core::array<ISceneNode*> PreviousNodes;
+	core::array<u32> PreviousOrder;
+	SStats Stats;
+	bool Sorted;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
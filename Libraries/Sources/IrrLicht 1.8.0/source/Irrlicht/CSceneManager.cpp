@@ -1268,21 +1268,21 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 	case ESNRP_SOLID:
 		if (!isCulled(node))
 		{
-			SolidNodeList.push_back(node);
+			SolidNodeList.push_back(node, getSolidNodeKey(node));
 			taken = 1;
 		}
 		break;
 	case ESNRP_TRANSPARENT:
 		if (!isCulled(node))
 		{
-			TransparentNodeList.push_back(TransparentNodeEntry(node, camWorldPos));
+			TransparentNodeList.push_back(node, getTransparentNodeKey(node));
 			taken = 1;
 		}
 		break;
 	case ESNRP_TRANSPARENT_EFFECT:
 		if (!isCulled(node))
 		{
-			TransparentEffectNodeList.push_back(TransparentNodeEntry(node, camWorldPos));
+			TransparentEffectNodeList.push_back(node, getTransparentNodeKey(node));
 			taken = 1;
 		}
 		break;
@@ -1299,8 +1299,7 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 				if (rnd && rnd->isTransparent())
 				{
 					// register as transparent node
-					TransparentNodeEntry e(node, camWorldPos);
-					TransparentNodeList.push_back(e);
+					TransparentNodeList.push_back(node, getTransparentNodeKey(node));
 					taken = 1;
 					break;
 				}
@@ -1309,7 +1308,7 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 			// not transparent, register as solid
 			if (!taken)
 			{
-				SolidNodeList.push_back(node);
+				SolidNodeList.push_back(node, getSolidNodeKey(node));
 				taken = 1;
 			}
 		}
@@ -1354,6 +1353,10 @@ void CSceneManager::drawAll()
 	Parameters.setAttribute ( "drawn_solid", 0 );
 	Parameters.setAttribute ( "drawn_transparent", 0 );
 	Parameters.setAttribute ( "drawn_transparent_effect", 0 );
+	Parameters.setAttribute ( "sorted_nodes", 0 );
+	Parameters.setAttribute ( "sort_radix_passes", 0 );
+	Parameters.setAttribute ( "sort_insertion_moves", 0 );
+	Parameters.setAttribute ( "sort_coherent_passes", 0 );
 
 	u32 i; // new ISO for scoping problem in some compilers
 
@@ -1482,13 +1485,14 @@ void CSceneManager::drawAll()
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRendertime) != 0);
 
 		SolidNodeList.sort(); // sort by textures
+		addRenderQueueStats(SolidNodeList);
 
 		if (LightManager)
 		{
 			LightManager->OnRenderPassPreRender(CurrentRendertime);
 			for (i=0; i<SolidNodeList.size(); ++i)
 			{
-				ISceneNode* node = SolidNodeList[i].Node;
+				ISceneNode* node = SolidNodeList[i];
 				LightManager->OnNodePreRender(node);
 				node->render();
 				LightManager->OnNodePostRender(node);
@@ -1497,11 +1501,11 @@ void CSceneManager::drawAll()
 		else
 		{
 			for (i=0; i<SolidNodeList.size(); ++i)
-				SolidNodeList[i].Node->render();
+				SolidNodeList[i]->render();
 		}
 
 		Parameters.setAttribute("drawn_solid", (s32) SolidNodeList.size() );
-		SolidNodeList.set_used(0);
+		SolidNodeList.clear();
 
 		if (LightManager)
 			LightManager->OnRenderPassPostRender(CurrentRendertime);
@@ -1545,13 +1549,14 @@ void CSceneManager::drawAll()
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRendertime) != 0);
 
 		TransparentNodeList.sort(); // sort by distance from camera
+		addRenderQueueStats(TransparentNodeList);
 		if (LightManager)
 		{
 			LightManager->OnRenderPassPreRender(CurrentRendertime);
 
 			for (i=0; i<TransparentNodeList.size(); ++i)
 			{
-				ISceneNode* node = TransparentNodeList[i].Node;
+				ISceneNode* node = TransparentNodeList[i];
 				LightManager->OnNodePreRender(node);
 				node->render();
 				LightManager->OnNodePostRender(node);
@@ -1560,11 +1565,11 @@ void CSceneManager::drawAll()
 		else
 		{
 			for (i=0; i<TransparentNodeList.size(); ++i)
-				TransparentNodeList[i].Node->render();
+				TransparentNodeList[i]->render();
 		}
 
 		Parameters.setAttribute ( "drawn_transparent", (s32) TransparentNodeList.size() );
-		TransparentNodeList.set_used(0);
+		TransparentNodeList.clear();
 
 		if (LightManager)
 			LightManager->OnRenderPassPostRender(CurrentRendertime);
@@ -1576,6 +1581,7 @@ void CSceneManager::drawAll()
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRendertime) != 0);
 
 		TransparentEffectNodeList.sort(); // sort by distance from camera
+		addRenderQueueStats(TransparentEffectNodeList);
 
 		if (LightManager)
 		{
@@ -1583,7 +1589,7 @@ void CSceneManager::drawAll()
 
 			for (i=0; i<TransparentEffectNodeList.size(); ++i)
 			{
-				ISceneNode* node = TransparentEffectNodeList[i].Node;
+				ISceneNode* node = TransparentEffectNodeList[i];
 				LightManager->OnNodePreRender(node);
 				node->render();
 				LightManager->OnNodePostRender(node);
@@ -1592,11 +1598,11 @@ void CSceneManager::drawAll()
 		else
 		{
 			for (i=0; i<TransparentEffectNodeList.size(); ++i)
-				TransparentEffectNodeList[i].Node->render();
+				TransparentEffectNodeList[i]->render();
 		}
 
 		Parameters.setAttribute ( "drawn_transparent_effect", (s32) TransparentEffectNodeList.size() );
-		TransparentEffectNodeList.set_used(0);
+		TransparentEffectNodeList.clear();
 	}
 
 	if (LightManager)
@@ -1608,6 +1614,42 @@ void CSceneManager::drawAll()
 	CurrentRendertime = ESNRP_NONE;
 }
 
+//! sort key of solid nodes, groups them by their first texture
+u64 CSceneManager::getSolidNodeKey(ISceneNode* node)
+{
+	if (!node->getMaterialCount())
+		return 0;
+	return (u64) (size_t) node->getMaterial(0).getTexture(0);
+}
+
+
+//! sort key of transparent nodes, back to front from the camera
+u64 CSceneManager::getTransparentNodeKey(ISceneNode* node) const
+{
+	return CRenderQueue::getReverseDistanceKey(
+		node->getAbsoluteTransformation().getTranslation().getDistanceFromSQ(camWorldPos));
+}
+
+
+//! adds the sort statistics of a render pass to the parameters
+void CSceneManager::addRenderQueueStats(const CRenderQueue& queue)
+{
+	const CRenderQueue::SStats& stats = queue.getStats();
+
+	s32 index = Parameters.findAttribute ( "sorted_nodes" );
+	Parameters.setAttribute ( index, Parameters.getAttributeAsInt ( index ) + (s32) stats.Nodes );
+	index = Parameters.findAttribute ( "sort_radix_passes" );
+	Parameters.setAttribute ( index, Parameters.getAttributeAsInt ( index ) + (s32) stats.RadixPasses );
+	index = Parameters.findAttribute ( "sort_insertion_moves" );
+	Parameters.setAttribute ( index, Parameters.getAttributeAsInt ( index ) + (s32) stats.InsertionMoves );
+	if (stats.Coherent)
+	{
+		index = Parameters.findAttribute ( "sort_coherent_passes" );
+		Parameters.setAttribute ( index, Parameters.getAttributeAsInt ( index ) + 1 );
+	}
+}
+
+
 void CSceneManager::setLightManager(ILightManager* lightManager)
 {
     if (lightManager)
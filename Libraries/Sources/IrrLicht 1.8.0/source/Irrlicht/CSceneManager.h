@@ -13,6 +13,7 @@
 #include "IMeshLoader.h"
 #include "CAttributes.h"
 #include "ILightManager.h"
+#include "CRenderQueue.h"
 
 namespace irr
 {
@@ -529,43 +530,14 @@ namespace scene
 		//! writes a scene node
 		void writeSceneNode(io::IXMLWriter* writer, ISceneNode* node, ISceneUserDataSerializer* userDataSerializer, const fschar_t* currentPath=0, bool init=false);
 
-		struct DefaultNodeEntry
-		{
-			DefaultNodeEntry(ISceneNode* n) :
-				Node(n), TextureValue(0)
-			{
-				if (n->getMaterialCount())
-					TextureValue = (n->getMaterial(0).getTexture(0));
-			}
-
-			bool operator < (const DefaultNodeEntry& other) const
-			{
-				return (TextureValue < other.TextureValue);
-			}
-
-			ISceneNode* Node;
-			private:
-			void* TextureValue;
-		};
+		//! sort key of solid nodes, groups them by their first texture
+		static u64 getSolidNodeKey(ISceneNode* node);
 
-		//! sort on distance (center) to camera
-		struct TransparentNodeEntry
-		{
-			TransparentNodeEntry(ISceneNode* n, const core::vector3df& camera)
-				: Node(n)
-			{
-				Distance = Node->getAbsoluteTransformation().getTranslation().getDistanceFromSQ(camera);
-			}
-
-			bool operator < (const TransparentNodeEntry& other) const
-			{
-				return Distance > other.Distance;
-			}
+		//! sort key of transparent nodes, back to front from the camera
+		u64 getTransparentNodeKey(ISceneNode* node) const;
 
-			ISceneNode* Node;
-			private:
-				f64 Distance;
-		};
+		//! adds the sort statistics of a render pass to the parameters
+		void addRenderQueueStats(const CRenderQueue& queue);
 
 		//! sort on distance (sphere) to camera
 		struct DistanceNodeEntry
@@ -613,9 +585,9 @@ namespace scene
 		core::array<ISceneNode*> LightList;
 		core::array<ISceneNode*> ShadowNodeList;
 		core::array<ISceneNode*> SkyBoxList;
-		core::array<DefaultNodeEntry> SolidNodeList;
-		core::array<TransparentNodeEntry> TransparentNodeList;
-		core::array<TransparentNodeEntry> TransparentEffectNodeList;
+		CRenderQueue SolidNodeList;
+		CRenderQueue TransparentNodeList;
+		CRenderQueue TransparentEffectNodeList;
 
 		core::array<IMeshLoader*> MeshLoaderList;
 		core::array<ISceneLoader*> SceneLoaderList;
@@ -138,7 +138,8 @@ bool CArchiveLoaderZIP::isALoadableFileFormat(io::IReadFile* file) const
 // -----------------------------------------------------------------------------
 
 CZipReader::CZipReader(IReadFile* file, bool ignoreCase, bool ignorePaths, bool isGZip)
- : CFileList((file ? file->getFileName() : io::path("")), ignoreCase, ignorePaths), File(file), IsGZip(isGZip)
+ : CFileList((file ? file->getFileName() : io::path("")), ignoreCase, ignorePaths), File(file),
+	CacheSize(0), CacheUses(0), IsGZip(isGZip)
 {
 	#ifdef _DEBUG
 	setDebugName("CZipReader");
@@ -160,6 +161,9 @@ CZipReader::CZipReader(IReadFile* file, bool ignoreCase, bool ignorePaths, bool
 
 CZipReader::~CZipReader()
 {
+	for (u32 i=0; i<Cache.size(); ++i)
+		Cache[i].Buffer->drop();
+
 	if (File)
 		File->drop();
 }
@@ -520,6 +524,11 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 	//98 - PPMd - Compression Method, WinZip 10
 	//99 - AES encryption, WinZip 9
 
+	// decompressed before, no need to do it again
+	IReadFile* cached = openCachedEntry(index);
+	if (cached)
+		return cached;
+
 	const SZipFileEntry &e = FileInfo[Files[index].ID];
 	wchar_t buf[64];
 	s16 actualCompressionMethod=e.header.CompressionMethod;
@@ -617,6 +626,11 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
   			#ifdef _IRR_COMPILE_WITH_ZLIB_
 
 			const u32 uncompressedSize = e.header.DataDescriptor.UncompressedSize;
+
+			// too large to keep in memory, inflated while it's read
+			if (!decrypted && uncompressedSize > _IRR_ZIP_STREAMING_SIZE_)
+				return new CZipInflateReadFile(File, e.Offset, decryptedSize, uncompressedSize, Files[index].FullName);
+
 			c8* pBuf = new c8[ uncompressedSize ];
 			if (!pBuf)
 			{
@@ -680,7 +694,7 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 				return 0;
 			}
 			else
-				return io::createMemoryReadFile(pBuf, uncompressedSize, Files[index].FullName, true);
+				return createEntryReadFile(index, pBuf, uncompressedSize);
 
 			#else
 			return 0; // zlib not compiled, we cannot decompress the data.
@@ -751,7 +765,7 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 				return 0;
 			}
 			else
-				return io::createMemoryReadFile(pBuf, uncompressedSize, Files[index].FullName, true);
+				return createEntryReadFile(index, pBuf, uncompressedSize);
 
 			#else
 			os::Printer::log("bzip2 decompression not supported. File cannot be read.", ELL_ERROR);
@@ -814,7 +828,7 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 				return 0;
 			}
 			else
-				return io::createMemoryReadFile(pBuf, uncompressedSize, Files[index].FullName, true);
+				return createEntryReadFile(index, pBuf, uncompressedSize);
 
 			#else
 			os::Printer::log("lzma decompression not supported. File cannot be read.", ELL_ERROR);
@@ -833,6 +847,278 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 
 }
 
+
+//! returns a reader of the cached entry, 0 if it isn't cached
+IReadFile* CZipReader::openCachedEntry(u32 index)
+{
+	for (u32 i=0; i<Cache.size(); ++i)
+	{
+		if (Cache[i].Index == index)
+		{
+			Cache[i].LastUse = ++CacheUses;
+			return new CZipEntryReadFile(Cache[i].Buffer, Files[index].FullName);
+		}
+	}
+
+	return 0;
+}
+
+
+//! returns a reader of a decompressed entry, caches it if it fits into the cache
+IReadFile* CZipReader::createEntryReadFile(u32 index, c8* data, u32 size)
+{
+	if (size > _IRR_ZIP_ENTRY_CACHE_SIZE_)
+		return io::createMemoryReadFile(data, size, Files[index].FullName, true);
+
+	// make room by dropping the least recently used entries, files still
+	// reading them keep their buffers alive
+	while (Cache.size() && CacheSize + size > _IRR_ZIP_ENTRY_CACHE_SIZE_)
+	{
+		u32 oldest = 0;
+		for (u32 i=1; i<Cache.size(); ++i)
+			if (Cache[i].LastUse < Cache[oldest].LastUse)
+				oldest = i;
+
+		CacheSize -= Cache[oldest].Buffer->Size;
+		Cache[oldest].Buffer->drop();
+		Cache.erase(oldest);
+	}
+
+	SCachedEntry entry;
+	entry.Index = index;
+	entry.LastUse = ++CacheUses;
+	entry.Buffer = new CZipEntryBuffer(data, size);
+	Cache.push_back(entry);
+	CacheSize += size;
+
+	return new CZipEntryReadFile(entry.Buffer, Files[index].FullName);
+}
+
+
+// -----------------------------------------------------------------------------
+// decompressed zip entry
+// -----------------------------------------------------------------------------
+
+CZipEntryReadFile::CZipEntryReadFile(CZipEntryBuffer* buffer, const io::path& fileName)
+: Buffer(buffer), Pos(0), Filename(fileName)
+{
+	#ifdef _DEBUG
+	setDebugName("CZipEntryReadFile");
+	#endif
+
+	Buffer->grab();
+}
+
+
+CZipEntryReadFile::~CZipEntryReadFile()
+{
+	Buffer->drop();
+}
+
+
+//! returns how much was read
+s32 CZipEntryReadFile::read(void* buffer, u32 sizeToRead)
+{
+	const long amount = core::min_((long)sizeToRead, (long)Buffer->Size - Pos);
+	if (amount <= 0)
+		return 0;
+
+	memcpy(buffer, Buffer->Data + Pos, amount);
+	Pos += amount;
+
+	return (s32)amount;
+}
+
+
+//! changes position in file, returns true if successful
+bool CZipEntryReadFile::seek(long finalPos, bool relativeMovement)
+{
+	if (relativeMovement)
+		finalPos += Pos;
+
+	if (finalPos < 0 || finalPos > (long)Buffer->Size)
+		return false;
+
+	Pos = finalPos;
+	return true;
+}
+
+
+//! returns size of file
+long CZipEntryReadFile::getSize() const
+{
+	return Buffer->Size;
+}
+
+
+//! returns where in the file we are.
+long CZipEntryReadFile::getPos() const
+{
+	return Pos;
+}
+
+
+//! returns name of file
+const io::path& CZipEntryReadFile::getFileName() const
+{
+	return Filename;
+}
+
+
+#ifdef _IRR_COMPILE_WITH_ZLIB_
+// -----------------------------------------------------------------------------
+// streamed deflated zip entry
+// -----------------------------------------------------------------------------
+
+CZipInflateReadFile::CZipInflateReadFile(IReadFile* archive, long offset, u32 compressedSize,
+		u32 uncompressedSize, const io::path& fileName)
+: Archive(archive), Offset(offset), CompressedSize(compressedSize),
+	UncompressedSize(uncompressedSize), CompressedPos(0), Pos(0), Filename(fileName),
+	Stream(0), Failed(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CZipInflateReadFile");
+	#endif
+
+	Archive->grab();
+	restart();
+}
+
+
+CZipInflateReadFile::~CZipInflateReadFile()
+{
+	if (Stream)
+	{
+		inflateEnd((z_stream*)Stream);
+		delete (z_stream*)Stream;
+	}
+
+	Archive->drop();
+}
+
+
+//! starts inflating from the beginning of the entry
+bool CZipInflateReadFile::restart()
+{
+	if (Stream)
+		inflateEnd((z_stream*)Stream);
+	else
+		Stream = new z_stream;
+
+	z_stream* stream = (z_stream*)Stream;
+	stream->next_in = (Bytef*)Input;
+	stream->avail_in = 0;
+	stream->zalloc = (alloc_func)0;
+	stream->zfree = (free_func)0;
+	stream->opaque = (voidpf)0;
+
+	CompressedPos = 0;
+	Pos = 0;
+
+	// wbits < 0 indicates no zlib header inside the data.
+	Failed = (inflateInit2(stream, -MAX_WBITS) != Z_OK);
+	if (Failed)
+	{
+		delete stream;
+		Stream = 0;
+		os::Printer::log("Error decompressing", Filename, ELL_ERROR);
+	}
+
+	return !Failed;
+}
+
+
+//! returns how much was read
+s32 CZipInflateReadFile::read(void* buffer, u32 sizeToRead)
+{
+	if (Failed)
+		return 0;
+
+	z_stream* stream = (z_stream*)Stream;
+	stream->next_out = (Bytef*)buffer;
+	stream->avail_out = (uInt)core::min_((long)sizeToRead, (long)UncompressedSize - Pos);
+
+	while (stream->avail_out)
+	{
+		if (!stream->avail_in)
+		{
+			const u32 size = core::min_(CompressedSize - CompressedPos, (u32)sizeof(Input));
+			if (!size || !Archive->seek(Offset + CompressedPos))
+				break;
+
+			const s32 r = Archive->read(Input, size);
+			if (r <= 0)
+				break;
+
+			CompressedPos += r;
+			stream->next_in = (Bytef*)Input;
+			stream->avail_in = r;
+		}
+
+		const int err = inflate(stream, Z_NO_FLUSH);
+		if (err == Z_STREAM_END)
+			break;
+
+		if (err != Z_OK && err != Z_BUF_ERROR)
+		{
+			os::Printer::log("Error decompressing", Filename, ELL_ERROR);
+			Failed = true;
+			break;
+		}
+	}
+
+	const s32 amount = (s32)((u8*)stream->next_out - (u8*)buffer);
+	Pos += amount;
+
+	return amount;
+}
+
+
+//! changes position in file, returns true if successful
+bool CZipInflateReadFile::seek(long finalPos, bool relativeMovement)
+{
+	if (relativeMovement)
+		finalPos += Pos;
+
+	if (finalPos < 0 || finalPos > (long)UncompressedSize)
+		return false;
+
+	if (finalPos < Pos && !restart())
+		return false;
+
+	// inflate up to the new position
+	u8 skipped[4096];
+	while (Pos < finalPos)
+	{
+		if (read(skipped, (u32)core::min_(finalPos - Pos, (long)sizeof(skipped))) <= 0)
+			return false;
+	}
+
+	return true;
+}
+
+
+//! returns size of file
+long CZipInflateReadFile::getSize() const
+{
+	return UncompressedSize;
+}
+
+
+//! returns where in the file we are.
+long CZipInflateReadFile::getPos() const
+{
+	return Pos;
+}
+
+
+//! returns name of file
+const io::path& CZipInflateReadFile::getFileName() const
+{
+	return Filename;
+}
+#endif // _IRR_COMPILE_WITH_ZLIB_
+
 } // end namespace io
 } // end namespace irr
 
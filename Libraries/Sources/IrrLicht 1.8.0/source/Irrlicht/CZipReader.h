@@ -135,6 +135,92 @@ namespace io
 		SZIPFileHeader header;
 	};
 
+	//! Decompressed zip entry, shared by the entry cache and the files reading it
+	class CZipEntryBuffer : public IReferenceCounted
+	{
+	public:
+
+		//! Takes ownership of data, which must be allocated with new []
+		CZipEntryBuffer(c8* data, u32 size) : Data(data), Size(size) {}
+
+		virtual ~CZipEntryBuffer()
+		{
+			delete [] Data;
+		}
+
+		c8* Data;
+		u32 Size;
+	};
+
+	//! Reads a decompressed zip entry from memory without copying it
+	class CZipEntryReadFile : public IReadFile
+	{
+	public:
+
+		CZipEntryReadFile(CZipEntryBuffer* buffer, const io::path& fileName);
+
+		virtual ~CZipEntryReadFile();
+
+		virtual s32 read(void* buffer, u32 sizeToRead);
+
+		virtual bool seek(long finalPos, bool relativeMovement = false);
+
+		virtual long getSize() const;
+
+		virtual long getPos() const;
+
+		virtual const io::path& getFileName() const;
+
+	private:
+
+		CZipEntryBuffer* Buffer;
+		long Pos;
+		io::path Filename;
+	};
+
+#ifdef _IRR_COMPILE_WITH_ZLIB_
+	//! Inflates a deflated zip entry while it is read, for entries too large to decompress at once
+	/** Seeking forward inflates and skips the data in between, seeking
+	backwards starts inflating again from the beginning of the entry. */
+	class CZipInflateReadFile : public IReadFile
+	{
+	public:
+
+		CZipInflateReadFile(IReadFile* archive, long offset, u32 compressedSize,
+			u32 uncompressedSize, const io::path& fileName);
+
+		virtual ~CZipInflateReadFile();
+
+		virtual s32 read(void* buffer, u32 sizeToRead);
+
+		virtual bool seek(long finalPos, bool relativeMovement = false);
+
+		virtual long getSize() const;
+
+		virtual long getPos() const;
+
+		virtual const io::path& getFileName() const;
+
+	private:
+
+		//! starts inflating from the beginning of the entry
+		bool restart();
+
+		IReadFile* Archive;
+		long Offset;
+		u32 CompressedSize;
+		u32 UncompressedSize;
+		u32 CompressedPos;
+		long Pos;
+		io::path Filename;
+
+		//! z_stream, kept opaque to not include zlib here
+		void* Stream;
+		bool Failed;
+		u8 Input[32768];
+	};
+#endif
+
 	//! Archiveloader capable of loading ZIP Archives
 	class CArchiveLoaderZIP : public IArchiveLoader
 	{
@@ -210,8 +296,26 @@ namespace io
 
 		bool scanCentralDirectoryHeader();
 
+		//! returns a reader of the cached entry, 0 if it isn't cached
+		IReadFile* openCachedEntry(u32 index);
+
+		//! returns a reader of a decompressed entry, caches it if it fits into the cache
+		IReadFile* createEntryReadFile(u32 index, c8* data, u32 size);
+
 		IReadFile* File;
 
+		struct SCachedEntry
+		{
+			u32 Index;
+			u32 LastUse;
+			CZipEntryBuffer* Buffer;
+		};
+
+		//! decompressed entries, the least recently used one is dropped first
+		core::array<SCachedEntry> Cache;
+		u32 CacheSize;
+		u32 CacheUses;
+
 		// holds extended info about files
 		core::array<SZipFileEntry> FileInfo;
 
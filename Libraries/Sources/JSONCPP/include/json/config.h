@@ -18,6 +18,11 @@
 /// as if it was a POD) that may cause some validation tool to report errors.
 /// Only has effects if JSON_VALUE_USE_INTERNAL_MAP is defined.
 //#  define JSON_USE_SIMPLE_INTERNAL_ALLOCATOR 1
+/// If defined, the nodes of the std::map used as object and array container, the strings
+/// and the member names are allocated from memory pools (see json_batchallocator.h)
+/// instead of one malloc each. Blocks are recycled, but the pools never give memory back
+/// to the system. Has no effects if JSON_VALUE_USE_INTERNAL_MAP is defined.
+//#  define JSON_USE_BATCH_ALLOCATOR 1
 
 /// If defined, indicates that Json use exception to report invalid type manipulation
 /// instead of C assert macro.
@@ -11,6 +11,7 @@ namespace Json {
 
    // reader.h
    class Reader;
+   class ReaderHandler;
 
    // features.h
    class Features;
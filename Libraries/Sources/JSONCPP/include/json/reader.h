@@ -10,6 +10,31 @@
 
 namespace Json {
 
+   /** \brief Receives the values of a document read by Reader::parse() without building a Value.
+    *
+    * Strings and member names are UTF-8 encoded, not null terminated, and only valid
+    * during the call. Returning \c false from any event stops the parsing. The default
+    * implementations ignore the event.
+    */
+   class JSON_API ReaderHandler
+   {
+   public:
+      virtual ~ReaderHandler();
+
+      virtual bool null();
+      virtual bool boolean( bool value );
+      virtual bool integer( Int value );
+      virtual bool uinteger( UInt value );
+      virtual bool real( double value );
+      virtual bool string( const char *value, unsigned int length );
+      virtual bool startObject();
+      /// Called before the value of each member of an object.
+      virtual bool memberName( const char *name, unsigned int length );
+      virtual bool endObject();
+      virtual bool startArray();
+      virtual bool endArray();
+   };
+
    /** \brief Unserialize a <a HREF="http://www.json.org">JSON</a> document into a Value.
     *
     */
@@ -63,6 +88,19 @@ namespace Json {
                   Value &root,
                   bool collectComments = true );
 
+      /** \brief Read a <a HREF="http://www.json.org">JSON</a> document as a sequence of events,
+       * without building a Value tree. Strings without escape sequences are passed
+       * straight from the document. Comments are skipped.
+       * \param beginDoc Pointer on the beginning of the UTF-8 encoded string of the document.
+       *                 It must stay alive to call getFormatedErrorMessages().
+       * \param endDoc Pointer on the end of the document.
+       * \param handler Receives the values of the document.
+       * \return \c true if the document was successfully parsed, \c false if an error occurred
+       *         or the handler stopped the parsing.
+       */
+      bool parse( const char *beginDoc, const char *endDoc, 
+                  ReaderHandler &handler );
+
       /** \brief Returns a user friendly string that list errors in the parsed document.
        * \return Formatted error message with the list of errors with their location in 
        *         the parsed document. An empty string is returned if no error occurred
@@ -120,10 +158,16 @@ namespace Json {
       bool readValue();
       bool readObject( Token &token );
       bool readArray( Token &token );
+      bool readValue( Token &token, ReaderHandler &handler );
+      bool readObject( Token &token, ReaderHandler &handler );
+      bool readArray( Token &token, ReaderHandler &handler );
+      bool readString( Token &token, ReaderHandler &handler, bool isMemberName );
+      bool handlerResult( bool result, Token &token );
       bool decodeNumber( Token &token );
+      bool decodeNumber( Token &token, Value &decoded );
       bool decodeString( Token &token );
       bool decodeString( Token &token, std::string &decoded );
-      bool decodeDouble( Token &token );
+      bool decodeDouble( Token &token, Value &decoded );
       bool decodeUnicodeCodePoint( Token &token, 
                                    Location &current, 
                                    Location end, 
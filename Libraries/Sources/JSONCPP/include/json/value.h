@@ -7,6 +7,8 @@
 
 # ifndef JSON_USE_CPPTL_SMALLMAP
 #  include <map>
+#  include <new>
+#  include <cstddef>
 # else
 #  include <cpptl/smallmap.h>
 # endif
@@ -81,6 +83,61 @@ namespace Json {
       const char *str_;
    };
 
+# if defined(JSON_USE_BATCH_ALLOCATOR) && !defined(JSON_VALUE_USE_INTERNAL_MAP) && !defined(JSON_USE_CPPTL_SMALLMAP)
+   /// Allocates a block of \c size bytes from the memory pools. Thread safe.
+   void JSON_API *batchAllocate( size_t size );
+   /// Gives back a block from batchAllocate(). \c size must be the allocated size.
+   void JSON_API batchRelease( void *block, size_t size );
+
+   /** \brief STL allocator taking the nodes of the Value containers from the memory pools.
+    * \see JSON_USE_BATCH_ALLOCATOR
+    */
+   template<typename T>
+   class BatchNodeAllocator
+   {
+   public:
+      typedef T value_type;
+      typedef T *pointer;
+      typedef const T *const_pointer;
+      typedef T &reference;
+      typedef const T &const_reference;
+      typedef size_t size_type;
+      typedef ptrdiff_t difference_type;
+
+      template<typename Other>
+      struct rebind
+      {
+         typedef BatchNodeAllocator<Other> other;
+      };
+
+      BatchNodeAllocator() {}
+      BatchNodeAllocator( const BatchNodeAllocator & ) {}
+      template<typename Other>
+      BatchNodeAllocator( const BatchNodeAllocator<Other> & ) {}
+
+      pointer address( reference value ) const { return &value; }
+      const_pointer address( const_reference value ) const { return &value; }
+
+      pointer allocate( size_type count, const void * = 0 )
+      {
+         return static_cast<pointer>( batchAllocate( count * sizeof(T) ) );
+      }
+
+      void deallocate( pointer block, size_type count )
+      {
+         batchRelease( block, count * sizeof(T) );
+      }
+
+      size_type max_size() const { return size_type(-1) / sizeof(T); }
+
+      void construct( pointer block, const T &value ) { new ( block ) T( value ); }
+      void destroy( pointer block ) { block->~T(); }
+
+      bool operator ==( const BatchNodeAllocator & ) const { return true; }
+      bool operator !=( const BatchNodeAllocator & ) const { return false; }
+   };
+# endif
+
    /** \brief Represents a <a HREF="http://www.json.org">JSON</a> value.
     *
     * This class is a discriminated union wrapper that can represents a:
@@ -157,7 +214,10 @@ namespace Json {
       };
 
    public:
-#  ifndef JSON_USE_CPPTL_SMALLMAP
+#  if defined(JSON_USE_BATCH_ALLOCATOR) && !defined(JSON_USE_CPPTL_SMALLMAP)
+      typedef std::map<CZString, Value, std::less<CZString>, 
+                       BatchNodeAllocator<std::pair<const CZString, Value> > > ObjectValues;
+#  elif !defined(JSON_USE_CPPTL_SMALLMAP)
       typedef std::map<CZString, Value> ObjectValues;
 #  else
       typedef CppTL::SmallMap<CZString, Value> ObjectValues;
@@ -44,6 +44,56 @@ namespace Json {
       bool yamlCompatiblityEnabled_;
    };
 
+   /** \brief Outputs a Value in the same format as FastWriter, to a stream through a fixed size buffer.
+    *
+    * The document is serialized straight into the buffer, which is written to the stream
+    * whenever it is full, so no string is built for the document or any of its values.
+    * Intended for writing large or many documents, e.g. logs or network messages.
+    * \sa FastWriter
+    */
+   class JSON_API BufferedWriter
+   {
+   public:
+      BufferedWriter( std::ostream &out, unsigned int bufferSize = 65536 );
+      /// Flushes the buffer.
+      ~BufferedWriter();
+
+      void enableYAMLCompatibility();
+
+      /// Serializes root followed by a line break, like FastWriter::write().
+      void write( const Value &root );
+
+      /// Writes the buffered output to the stream.
+      void flush();
+
+   private:
+      BufferedWriter( const BufferedWriter &other );
+      BufferedWriter &operator =( const BufferedWriter &other );
+
+      class Buffer
+      {
+      public:
+         Buffer( std::ostream &out, unsigned int size );
+         ~Buffer();
+
+         void append( const char *data, size_t length );
+         void push_back( char c );
+         void flush();
+
+      private:
+         Buffer( const Buffer &other );
+         Buffer &operator =( const Buffer &other );
+
+         std::ostream &out_;
+         char *data_;
+         unsigned int size_;
+         unsigned int used_;
+      };
+
+      Buffer buffer_;
+      bool yamlCompatiblityEnabled_;
+   };
+
    /** \brief Writes a Value in <a HREF="http://www.json.org">JSON</a> format in a human friendly way.
     *
     * The rules for line break and indent are as follow:
@@ -2,6 +2,8 @@
 #include <json/value.h>
 #include <utility>
 #include <cstdio>
+#include <cstdlib>
+#include <clocale>
 #include <cassert>
 #include <cstring>
 #include <iostream>
@@ -103,6 +105,197 @@ static std::string codePointToUTF8(unsigned int cp)
 }
 
 
+// Powers of ten that are exact in a double.
+static const double exactPowersOfTen[] = 
+{
+   1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+
+// strtod() expects the decimal point of the current locale.
+static bool 
+parseDoubleWithLocale( Reader::Location begin, 
+                       Reader::Location end, 
+                       double &value )
+{
+   const char *decimalPoint = localeconv()->decimal_point;
+   std::string buffer;
+   buffer.reserve( end - begin + 4 );
+   for ( ; begin != end; ++begin )
+   {
+      if ( *begin == '.' )
+         buffer += decimalPoint;
+      else
+         buffer += *begin;
+   }
+   char *stop = 0;
+   value = strtod( buffer.c_str(), &stop );
+   return stop == buffer.c_str() + buffer.length();
+}
+
+
+// Reads a number with '.' as decimal point whatever the locale is. When the digits
+// fit in the mantissa of a double and the exponent is small, both the digits and
+// the power of ten are exact, so one multiplication or division rounds correctly.
+// The other numbers are rare enough to go through strtod().
+static bool 
+parseDouble( Reader::Location begin, 
+             Reader::Location end, 
+             double &value )
+{
+   Reader::Location current = begin;
+   bool isNegative = false;
+   if ( current != end  &&  ( *current == '-'  ||  *current == '+' ) )
+      isNegative = *current++ == '-';
+
+   double mantissa = 0;
+   int digits = 0;
+   int exponent = 0;
+   bool hasDigits = false;
+   bool isExact = true;
+   for ( ; current != end  &&  *current >= '0'  &&  *current <= '9'; ++current )
+   {
+      hasDigits = true;
+      if ( digits == 15 )
+         isExact = false;
+      else if ( ( mantissa = mantissa * 10 + ( *current - '0' ) ) != 0 )
+         ++digits;
+   }
+   if ( current != end  &&  *current == '.' )
+   {
+      for ( ++current; current != end  &&  *current >= '0'  &&  *current <= '9'; ++current )
+      {
+         hasDigits = true;
+         if ( digits == 15 )
+            isExact = false;
+         else if ( ( mantissa = mantissa * 10 + ( *current - '0' ) ) != 0 )
+            ++digits;
+         --exponent;
+      }
+   }
+   if ( !hasDigits )
+      return false;
+
+   if ( current != end  &&  ( *current == 'e'  ||  *current == 'E' ) )
+   {
+      ++current;
+      bool isNegativeExponent = false;
+      if ( current != end  &&  ( *current == '-'  ||  *current == '+' ) )
+         isNegativeExponent = *current++ == '-';
+      if ( current == end  ||  *current < '0'  ||  *current > '9' )
+         return false;
+      int explicitExponent = 0;
+      for ( ; current != end  &&  *current >= '0'  &&  *current <= '9'; ++current )
+      {
+         if ( explicitExponent < 100000 )
+            explicitExponent = explicitExponent * 10 + ( *current - '0' );
+      }
+      exponent += isNegativeExponent ? -explicitExponent : explicitExponent;
+   }
+   if ( current != end )
+      return false;
+
+   if ( !isExact  ||  ( mantissa != 0  &&  ( exponent < -22  ||  exponent > 22 ) ) )
+      return parseDoubleWithLocale( begin, end, value );
+
+   if ( exponent < 0 )
+      value = mantissa / exactPowersOfTen[-exponent];
+   else if ( mantissa != 0 )
+      value = mantissa * exactPowersOfTen[exponent];
+   else
+      value = 0;
+   if ( isNegative )
+      value = -value;
+   return true;
+}
+
+
+// Class ReaderHandler
+// //////////////////////////////////////////////////////////////////
+
+ReaderHandler::~ReaderHandler()
+{
+}
+
+
+bool 
+ReaderHandler::null()
+{
+   return true;
+}
+
+
+bool 
+ReaderHandler::boolean( bool )
+{
+   return true;
+}
+
+
+bool 
+ReaderHandler::integer( Int )
+{
+   return true;
+}
+
+
+bool 
+ReaderHandler::uinteger( UInt )
+{
+   return true;
+}
+
+
+bool 
+ReaderHandler::real( double )
+{
+   return true;
+}
+
+
+bool 
+ReaderHandler::string( const char *, unsigned int )
+{
+   return true;
+}
+
+
+bool 
+ReaderHandler::startObject()
+{
+   return true;
+}
+
+
+bool 
+ReaderHandler::memberName( const char *, unsigned int )
+{
+   return true;
+}
+
+
+bool 
+ReaderHandler::endObject()
+{
+   return true;
+}
+
+
+bool 
+ReaderHandler::startArray()
+{
+   return true;
+}
+
+
+bool 
+ReaderHandler::endArray()
+{
+   return true;
+}
+
+
 // Class Reader
 // //////////////////////////////////////////////////////////////////
 
@@ -191,6 +384,33 @@ Reader::parse( const char *beginDoc, const char *endDoc,
 }
 
 
+bool 
+Reader::parse( const char *beginDoc, const char *endDoc, 
+               ReaderHandler &handler )
+{
+   begin_ = beginDoc;
+   end_ = endDoc;
+   collectComments_ = false;
+   current_ = begin_;
+   lastValueEnd_ = 0;
+   lastValue_ = 0;
+   commentsBefore_ = "";
+   errors_.clear();
+   while ( !nodes_.empty() )
+      nodes_.pop();
+
+   Token token;
+   skipCommentTokens( token );
+   if ( features_.strictRoot_  &&  
+        token.type_ != tokenObjectBegin  &&  token.type_ != tokenArrayBegin )
+   {
+      return addError( "A valid JSON document must be either an array or an object value.",
+                       token );
+   }
+   return readValue( token, handler );
+}
+
+
 bool
 Reader::readValue()
 {
@@ -220,13 +440,13 @@ Reader::readValue()
       successful = decodeString( token );
       break;
    case tokenTrue:
-      currentValue() = true;
+      Value( true ).swap( currentValue() );
       break;
    case tokenFalse:
-      currentValue() = false;
+      Value( false ).swap( currentValue() );
       break;
    case tokenNull:
-      currentValue() = Value();
+      Value().swap( currentValue() );
       break;
    default:
       return addError( "Syntax error: value, object or array expected.", token );
@@ -481,7 +701,7 @@ Reader::readObject( Token &tokenStart )
 {
    Token tokenName;
    std::string name;
-   currentValue() = Value( objectValue );
+   Value( objectValue ).swap( currentValue() );
    while ( readToken( tokenName ) )
    {
       bool initialTokenOk = true;
@@ -538,7 +758,7 @@ Reader::readObject( Token &tokenStart )
 bool 
 Reader::readArray( Token &tokenStart )
 {
-   currentValue() = Value( arrayValue );
+   Value( arrayValue ).swap( currentValue() );
    skipSpaces();
    if ( *current_ == ']' ) // empty array
    {
@@ -578,8 +798,155 @@ Reader::readArray( Token &tokenStart )
 }
 
 
+bool 
+Reader::readValue( Token &token, ReaderHandler &handler )
+{
+   switch ( token.type_ )
+   {
+   case tokenObjectBegin:
+      return readObject( token, handler );
+   case tokenArrayBegin:
+      return readArray( token, handler );
+   case tokenNumber:
+      {
+         Value decoded;
+         if ( !decodeNumber( token, decoded ) )
+            return false;
+         switch ( decoded.type() )
+         {
+         case intValue:
+            return handlerResult( handler.integer( decoded.asInt() ), token );
+         case uintValue:
+            return handlerResult( handler.uinteger( decoded.asUInt() ), token );
+         default:
+            return handlerResult( handler.real( decoded.asDouble() ), token );
+         }
+      }
+   case tokenString:
+      return readString( token, handler, false );
+   case tokenTrue:
+      return handlerResult( handler.boolean( true ), token );
+   case tokenFalse:
+      return handlerResult( handler.boolean( false ), token );
+   case tokenNull:
+      return handlerResult( handler.null(), token );
+   default:
+      return addError( "Syntax error: value, object or array expected.", token );
+   }
+}
+
+
+bool 
+Reader::readObject( Token &tokenStart, ReaderHandler &handler )
+{
+   if ( !handlerResult( handler.startObject(), tokenStart ) )
+      return false;
+
+   Token tokenName;
+   skipCommentTokens( tokenName );
+   if ( tokenName.type_ == tokenObjectEnd )  // empty object
+      return handlerResult( handler.endObject(), tokenName );
+
+   while ( true )
+   {
+      if ( tokenName.type_ != tokenString )
+         return addError( "Missing '}' or object member name", tokenName );
+      if ( !readString( tokenName, handler, true ) )
+         return false;
+
+      Token colon;
+      readToken( colon );
+      if ( colon.type_ != tokenMemberSeparator )
+         return addError( "Missing ':' after object member name", colon );
+
+      Token token;
+      skipCommentTokens( token );
+      if ( !readValue( token, handler ) )
+         return false;
+
+      Token comma;
+      skipCommentTokens( comma );
+      if ( comma.type_ == tokenObjectEnd )
+         return handlerResult( handler.endObject(), comma );
+      if ( comma.type_ != tokenArraySeparator )
+         return addError( "Missing ',' or '}' in object declaration", comma );
+      skipCommentTokens( tokenName );
+   }
+}
+
+
+bool 
+Reader::readArray( Token &tokenStart, ReaderHandler &handler )
+{
+   if ( !handlerResult( handler.startArray(), tokenStart ) )
+      return false;
+
+   Token token;
+   skipCommentTokens( token );
+   if ( token.type_ == tokenArrayEnd )  // empty array
+      return handlerResult( handler.endArray(), token );
+
+   while ( true )
+   {
+      if ( !readValue( token, handler ) )
+         return false;
+
+      skipCommentTokens( token );
+      if ( token.type_ == tokenArrayEnd )
+         return handlerResult( handler.endArray(), token );
+      if ( token.type_ != tokenArraySeparator )
+         return addError( "Missing ',' or ']' in array declaration", token );
+      skipCommentTokens( token );
+   }
+}
+
+
+bool 
+Reader::readString( Token &token, ReaderHandler &handler, bool isMemberName )
+{
+   Location begin = token.start_ + 1; // skip '"'
+   Location end = token.end_ - 1;      // do not include '"'
+   bool result;
+   if ( !memchr( begin, '\\', end - begin ) )
+   {
+      // nothing to decode, passed straight from the document
+      result = isMemberName ? handler.memberName( begin, (unsigned int)(end - begin) )
+                            : handler.string( begin, (unsigned int)(end - begin) );
+   }
+   else
+   {
+      std::string decoded;
+      if ( !decodeString( token, decoded ) )
+         return false;
+      result = isMemberName ? handler.memberName( decoded.data(), (unsigned int)decoded.length() )
+                            : handler.string( decoded.data(), (unsigned int)decoded.length() );
+   }
+   return handlerResult( result, token );
+}
+
+
+bool 
+Reader::handlerResult( bool result, Token &token )
+{
+   if ( !result )
+      return addError( "Parsing stopped by the handler.", token );
+   return true;
+}
+
+
 bool 
 Reader::decodeNumber( Token &token )
+{
+   Value decoded;
+   if ( !decodeNumber( token, decoded ) )
+      return false;
+   decoded.swap( currentValue() );
+   return true;
+}
+
+
+bool 
+Reader::decodeNumber( Token &token, Value &decoded )
 {
    bool isDouble = false;
    for ( Location inspect = token.start_; inspect != token.end_; ++inspect )
@@ -589,7 +956,7 @@ Reader::decodeNumber( Token &token )
                  ||  ( *inspect == '-'  &&  inspect != token.start_ );
    }
    if ( isDouble )
-      return decodeDouble( token );
+      return decodeDouble( token, decoded );
    Location current = token.start_;
    bool isNegative = *current == '-';
    if ( isNegative )
@@ -603,42 +970,26 @@ Reader::decodeNumber( Token &token )
       if ( c < '0'  ||  c > '9' )
          return addError( "'" + std::string( token.start_, token.end_ ) + "' is not a number.", token );
       if ( value >= threshold )
-         return decodeDouble( token );
+         return decodeDouble( token, decoded );
       value = value * 10 + Value::UInt(c - '0');
    }
    if ( isNegative )
-      currentValue() = -Value::Int( value );
+      decoded = -Value::Int( value );
    else if ( value <= Value::UInt(Value::maxInt) )
-      currentValue() = Value::Int( value );
+      decoded = Value::Int( value );
    else
-      currentValue() = value;
+      decoded = value;
    return true;
 }
 
 
 bool 
-Reader::decodeDouble( Token &token )
+Reader::decodeDouble( Token &token, Value &decoded )
 {
    double value = 0;
-   const int bufferSize = 32;
-   int count;
-   int length = int(token.end_ - token.start_);
-   if ( length <= bufferSize )
-   {
-      Char buffer[bufferSize];
-      memcpy( buffer, token.start_, length );
-      buffer[length] = 0;
-      count = sscanf( buffer, "%lf", &value );
-   }
-   else
-   {
-      std::string buffer( token.start_, token.end_ );
-      count = sscanf( buffer.c_str(), "%lf", &value );
-   }
-
-   if ( count != 1 )
+   if ( !parseDouble( token.start_, token.end_, value ) )
       return addError( "'" + std::string( token.start_, token.end_ ) + "' is not a number.", token );
-   currentValue() = value;
+   decoded = value;
    return true;
 }
 
@@ -646,10 +997,19 @@ Reader::decodeDouble( Token &token )
 bool 
 Reader::decodeString( Token &token )
 {
+   Location begin = token.start_ + 1; // skip '"'
+   Location end = token.end_ - 1;      // do not include '"'
+   if ( !memchr( begin, '\\', end - begin ) )
+   {
+      Value decoded( begin, end );
+      decoded.swap( currentValue() );
+      return true;
+   }
+
    std::string decoded;
    if ( !decodeString( token, decoded ) )
       return false;
-   currentValue() = decoded;
+   Value( decoded ).swap( currentValue() );
    return true;
 }
 
@@ -657,9 +1017,15 @@ Reader::decodeString( Token &token )
 bool 
 Reader::decodeString( Token &token, std::string &decoded )
 {
-   decoded.reserve( token.end_ - token.start_ - 2 );
    Location current = token.start_ + 1; // skip '"'
    Location end = token.end_ - 1;      // do not include '"'
+   if ( !memchr( current, '\\', end - current ) )
+   {
+      decoded.append( current, end );
+      return true;
+   }
+
+   decoded.reserve( decoded.length() + ( end - current ) );
    while ( current != end )
    {
       Char c = *current++;
@@ -9,9 +9,13 @@
 # include <cpptl/conststring.h>
 #endif
 #include <cstddef>    // size_t
-#ifndef JSON_USE_SIMPLE_INTERNAL_ALLOCATOR
+#if !defined(JSON_USE_SIMPLE_INTERNAL_ALLOCATOR) || defined(JSON_USE_BATCH_ALLOCATOR)
 # include "json_batchallocator.h"
-#endif // #ifndef JSON_USE_SIMPLE_INTERNAL_ALLOCATOR
+#endif // #if !defined(JSON_USE_SIMPLE_INTERNAL_ALLOCATOR) || defined(JSON_USE_BATCH_ALLOCATOR)
+#if defined(JSON_USE_BATCH_ALLOCATOR) && !defined(JSON_VALUE_USE_INTERNAL_MAP) && !defined(JSON_USE_CPPTL_SMALLMAP)
+# define JSON_VALUE_USE_BATCH_POOLS 1
+# include <atomic>
+#endif
 
 #define JSON_ASSERT_UNREACHABLE assert( false )
 #define JSON_ASSERT( condition ) assert( condition );  // @todo <= change this into an exception throw
@@ -95,9 +99,178 @@ public:
    }
 };
 
+#ifdef JSON_VALUE_USE_BATCH_POOLS
+// Memory pools of JSON_USE_BATCH_ALLOCATOR
+// //////////////////////////////////////////////////////////////////
+
+// Blocks up to batchGranularity * batchPoolCount bytes come from the pools,
+// one pool for each multiple of batchGranularity.
+enum 
+{
+   batchGranularity = 8,
+   batchPoolCount = 16
+};
+
+template<int blockSize>
+class BatchPool
+{
+   struct Block
+   {
+      double data_[blockSize / sizeof(double)];
+   };
+
+public:
+   static void *allocate()
+   {
+      return allocator().allocate();
+   }
+
+   static void release( void *block )
+   {
+      allocator().release( static_cast<Block *>( block ) );
+   }
+
+   static BatchAllocator<Block,1> &allocator()
+   {
+      // Never destroyed: values in static storage may be released after it.
+      static BatchAllocator<Block,1> *allocator = new BatchAllocator<Block,1>( 255 );
+      return *allocator;
+   }
+};
+
+struct BatchPoolFunctions
+{
+   void *(*allocate)();
+   void (*release)( void *block );
+};
+
+static const BatchPoolFunctions batchPools[batchPoolCount] = 
+{
+   { &BatchPool<8>::allocate, &BatchPool<8>::release },
+   { &BatchPool<16>::allocate, &BatchPool<16>::release },
+   { &BatchPool<24>::allocate, &BatchPool<24>::release },
+   { &BatchPool<32>::allocate, &BatchPool<32>::release },
+   { &BatchPool<40>::allocate, &BatchPool<40>::release },
+   { &BatchPool<48>::allocate, &BatchPool<48>::release },
+   { &BatchPool<56>::allocate, &BatchPool<56>::release },
+   { &BatchPool<64>::allocate, &BatchPool<64>::release },
+   { &BatchPool<72>::allocate, &BatchPool<72>::release },
+   { &BatchPool<80>::allocate, &BatchPool<80>::release },
+   { &BatchPool<88>::allocate, &BatchPool<88>::release },
+   { &BatchPool<96>::allocate, &BatchPool<96>::release },
+   { &BatchPool<104>::allocate, &BatchPool<104>::release },
+   { &BatchPool<112>::allocate, &BatchPool<112>::release },
+   { &BatchPool<120>::allocate, &BatchPool<120>::release },
+   { &BatchPool<128>::allocate, &BatchPool<128>::release }
+};
+
+// Held only for a few instructions, a spin lock is enough.
+static std::atomic_flag batchPoolsLock = ATOMIC_FLAG_INIT;
+
+class BatchPoolsLock
+{
+public:
+   BatchPoolsLock()
+   {
+      while ( batchPoolsLock.test_and_set( std::memory_order_acquire ) )
+         ;
+   }
+
+   ~BatchPoolsLock()
+   {
+      batchPoolsLock.clear( std::memory_order_release );
+   }
+};
+
+
+void *batchAllocate( size_t size )
+{
+   const size_t pool = size ? ( size - 1 ) / batchGranularity : 0;
+   if ( pool >= batchPoolCount )
+      return ::operator new( size );
+
+   BatchPoolsLock lock;
+   return batchPools[pool].allocate();
+}
+
+
+void batchRelease( void *block, size_t size )
+{
+   if ( !block )
+      return;
+
+   const size_t pool = size ? ( size - 1 ) / batchGranularity : 0;
+   if ( pool >= batchPoolCount )
+   {
+      ::operator delete( block );
+      return;
+   }
+
+   BatchPoolsLock lock;
+   batchPools[pool].release( block );
+}
+
+
+// Strings are preceded by one byte telling the pool they came from, 0 for malloc.
+class BatchValueAllocator : public ValueAllocator
+{
+public:
+   virtual ~BatchValueAllocator()
+   {
+   }
+
+   virtual char *makeMemberName( const char *memberName )
+   {
+      return duplicateStringValue( memberName );
+   }
+
+   virtual void releaseMemberName( char *memberName )
+   {
+      releaseStringValue( memberName );
+   }
+
+   virtual char *duplicateStringValue( const char *value, 
+                                       unsigned int length = unknown )
+   {
+      if ( length == unknown )
+         length = (unsigned int)strlen(value);
+      const size_t size = size_t(length) + 2;
+      char *block;
+      if ( size <= batchGranularity * batchPoolCount )
+      {
+         block = static_cast<char *>( batchAllocate( size ) );
+         block[0] = char( ( size - 1 ) / batchGranularity + 1 );
+      }
+      else
+      {
+         block = static_cast<char *>( malloc( size ) );
+         block[0] = 0;
+      }
+      memcpy( block + 1, value, length );
+      block[length + 1] = 0;
+      return block + 1;
+   }
+
+   virtual void releaseStringValue( char *value )
+   {
+      if ( !value )
+         return;
+      char *block = value - 1;
+      if ( block[0] )
+         batchRelease( block, size_t(block[0]) * batchGranularity );
+      else
+         free( block );
+   }
+};
+#endif // ifdef JSON_VALUE_USE_BATCH_POOLS
+
 static ValueAllocator *&valueAllocator()
 {
+#ifdef JSON_VALUE_USE_BATCH_POOLS
+   static BatchValueAllocator defaultAllocator;
+#else
    static DefaultValueAllocator defaultAllocator;
+#endif
    static ValueAllocator *valueAllocator = &defaultAllocator;
    return valueAllocator;
 }
@@ -3,6 +3,7 @@
 #include <assert.h>
 #include <stdio.h>
 #include <string.h>
+#include <locale.h>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
@@ -18,15 +19,6 @@ static bool isControlCharacter(char ch)
    return ch > 0 && ch <= 0x1F;
 }
 
-static bool containsControlCharacter( const char* str )
-{
-   while ( *str ) 
-   {
-      if ( isControlCharacter( *(str++) ) )
-         return true;
-   }
-   return false;
-}
 static void uintToString( unsigned int value, 
                           char *&current )
 {
@@ -63,14 +55,22 @@ std::string valueToString( UInt value )
    return current;
 }
 
-std::string valueToString( double value )
+/// Formats value in buffer, which must hold at least 32 chars.
+/// JSON always uses '.' as decimal point, whatever the current locale is.
+static const char *doubleToString( double value, char *buffer )
 {
-   char buffer[32];
 #if defined(_MSC_VER) && defined(__STDC_SECURE_LIB__) // Use secure version with visual studio 2005 to avoid warning. 
-   sprintf_s(buffer, sizeof(buffer), "%#.16g", value); 
+   sprintf_s(buffer, 32, "%#.16g", value); 
 #else	
    sprintf(buffer, "%#.16g", value); 
 #endif
+   const char decimalPoint = *localeconv()->decimal_point;
+   if ( decimalPoint != '.' )
+   {
+      char *point = strchr( buffer, decimalPoint );
+      if ( point )
+         *point = '.';
+   }
    char* ch = buffer + strlen(buffer) - 1;
    if (*ch != '0') return buffer; // nothing to truncate, so save time
    while(ch > buffer && *ch == '0'){
@@ -103,71 +103,152 @@ std::string valueToString( double value )
 }
 
 
+std::string valueToString( double value )
+{
+   char buffer[32];
+   return doubleToString( value, buffer );
+}
+
+
 std::string valueToString( bool value )
 {
    return value ? "true" : "false";
 }
 
-std::string valueToQuotedString( const char *value )
+/// Appends the JSON representation of value to output.
+///
+/// Output is anything with append( const char *, size_t ) and push_back( char ),
+/// such as std::string or BufferedWriter's buffer, so the writers serialize
+/// without building a temporary string for each value.
+template<typename Output>
+static void writeQuotedString( const char *value, Output &output )
 {
-   // Not sure how to handle unicode...
-   if (strpbrk(value, "\"\\\b\f\n\r\t") == NULL && !containsControlCharacter( value ))
-      return std::string("\"") + value + "\"";
-   // We have to walk value and escape any special characters.
-   // Appending to std::string is not efficient, but this should be rare.
-   // (Note: forward slashes are *not* rare, but I am not escaping them.)
-   unsigned maxsize = strlen(value)*2 + 3; // allescaped+quotes+NULL
-   std::string result;
-   result.reserve(maxsize); // to avoid lots of mallocs
-   result += "\"";
-   for (const char* c=value; *c != 0; ++c)
+   static const char hexDigits[] = "0123456789ABCDEF";
+   output.push_back( '\"' );
+   const char *begin = value;
+   const char *c = value;
+   for ( ; *c != 0; ++c )
    {
-      switch(*c)
+      const char *escape;
+      switch ( *c )
       {
-         case '\"':
-            result += "\\\"";
-            break;
-         case '\\':
-            result += "\\\\";
-            break;
-         case '\b':
-            result += "\\b";
-            break;
-         case '\f':
-            result += "\\f";
-            break;
-         case '\n':
-            result += "\\n";
-            break;
-         case '\r':
-            result += "\\r";
-            break;
-         case '\t':
-            result += "\\t";
-            break;
-         //case '/':
-            // Even though \/ is considered a legal escape in JSON, a bare
-            // slash is also legal, so I see no reason to escape it.
-            // (I hope I am not misunderstanding something.
-            // blep notes: actually escaping \/ may be useful in javascript to avoid </ 
-            // sequence.
-            // Should add a flag to allow this compatibility mode and prevent this 
-            // sequence from occurring.
-         default:
-            if ( isControlCharacter( *c ) )
-            {
-               std::ostringstream oss;
-               oss << "\\u" << std::hex << std::uppercase << std::setfill('0') << std::setw(4) << static_cast<int>(*c);
-               result += oss.str();
-            }
+      case '\"':  escape = "\\\""; break;
+      case '\\': escape = "\\\\"; break;
+      case '\b':  escape = "\\b"; break;
+      case '\f':  escape = "\\f"; break;
+      case '\n':  escape = "\\n"; break;
+      case '\r':  escape = "\\r"; break;
+      case '\t':  escape = "\\t"; break;
+      default:
+         if ( !isControlCharacter( *c ) )
+            continue;
+         escape = 0;
+         break;
+      }
+      output.append( begin, c - begin );
+      begin = c + 1;
+      if ( escape )
+      {
+         output.append( escape, 2 );
+      }
+      else
+      {
+         const char unicode[6] = { '\\', 'u', '0', '0', 
+                                   hexDigits[(*c >> 4) & 0xF], hexDigits[*c & 0xF] };
+         output.append( unicode, 6 );
+      }
+   }
+   output.append( begin, c - begin );
+   output.push_back( '\"' );
+}
+
+
+template<typename Output>
+static void writeCompactValue( const Value &value, Output &output, 
+                               bool yamlCompatiblityEnabled )
+{
+   char buffer[32];
+   const char *text;
+   switch ( value.type() )
+   {
+   case nullValue:
+      output.append( "null", 4 );
+      break;
+   case intValue:
+      {
+         Int intValue = value.asInt();
+         char *current = buffer + sizeof(buffer);
+         uintToString( intValue < 0 ? UInt(0) - UInt(intValue) : UInt(intValue), current );
+         if ( intValue < 0 )
+            *--current = '-';
+         output.append( current, buffer + sizeof(buffer) - 1 - current );
+      }
+      break;
+   case uintValue:
+      {
+         char *current = buffer + sizeof(buffer);
+         uintToString( value.asUInt(), current );
+         output.append( current, buffer + sizeof(buffer) - 1 - current );
+      }
+      break;
+   case realValue:
+      text = doubleToString( value.asDouble(), buffer );
+      output.append( text, strlen( text ) );
+      break;
+   case stringValue:
+      writeQuotedString( value.asCString(), output );
+      break;
+   case booleanValue:
+      if ( value.asBool() )
+         output.append( "true", 4 );
+      else
+         output.append( "false", 5 );
+      break;
+   case arrayValue:
+      {
+         output.push_back( '[' );
+         // arrays may have holes, those are written as null
+         UInt index = 0;
+         for ( Value::const_iterator it = value.begin(); it != value.end(); ++it )
+         {
+            for ( UInt end = it.index(); index < end; ++index )
+               output.append( index > 0 ? ",null" : "null", index > 0 ? 5 : 4 );
+            if ( index > 0 )
+               output.push_back( ',' );
+            writeCompactValue( *it, output, yamlCompatiblityEnabled );
+            ++index;
+         }
+         for ( UInt size = value.size(); index < size; ++index )
+            output.append( index > 0 ? ",null" : "null", index > 0 ? 5 : 4 );
+         output.push_back( ']' );
+      }
+      break;
+   case objectValue:
+      {
+         output.push_back( '{' );
+         for ( Value::const_iterator it = value.begin(); it != value.end(); ++it )
+         {
+            if ( it != value.begin() )
+               output.push_back( ',' );
+            writeQuotedString( it.memberName(), output );
+            if ( yamlCompatiblityEnabled )
+               output.append( ": ", 2 );
             else
-            {
-               result += *c;
-            }
-            break;
+               output.push_back( ':' );
+            writeCompactValue( *it, output, yamlCompatiblityEnabled );
+         }
+         output.push_back( '}' );
       }
+      break;
    }
-   result += "\"";
+}
+
+
+std::string valueToQuotedString( const char *value )
+{
+   std::string result;
+   result.reserve( strlen( value ) + 2 );
+   writeQuotedString( value, result );
    return result;
 }
 
@@ -207,59 +288,95 @@ FastWriter::write( const Value &root )
 void 
 FastWriter::writeValue( const Value &value )
 {
-   switch ( value.type() )
+   writeCompactValue( value, document_, yamlCompatiblityEnabled_ );
+}
+
+
+// Class BufferedWriter
+// //////////////////////////////////////////////////////////////////
+
+BufferedWriter::Buffer::Buffer( std::ostream &out, unsigned int size )
+   : out_( out )
+   , data_( new char[size < 16 ? 16 : size] )
+   , size_( size < 16 ? 16 : size )
+   , used_( 0 )
+{
+}
+
+
+BufferedWriter::Buffer::~Buffer()
+{
+   delete [] data_;
+}
+
+
+void 
+BufferedWriter::Buffer::append( const char *data, size_t length )
+{
+   if ( length > size_ - used_ )
    {
-   case nullValue:
-      document_ += "null";
-      break;
-   case intValue:
-      document_ += valueToString( value.asInt() );
-      break;
-   case uintValue:
-      document_ += valueToString( value.asUInt() );
-      break;
-   case realValue:
-      document_ += valueToString( value.asDouble() );
-      break;
-   case stringValue:
-      document_ += valueToQuotedString( value.asCString() );
-      break;
-   case booleanValue:
-      document_ += valueToString( value.asBool() );
-      break;
-   case arrayValue:
-      {
-         document_ += "[";
-         int size = value.size();
-         for ( int index =0; index < size; ++index )
-         {
-            if ( index > 0 )
-               document_ += ",";
-            writeValue( value[index] );
-         }
-         document_ += "]";
-      }
-      break;
-   case objectValue:
+      flush();
+      if ( length >= size_ )
       {
-         Value::Members members( value.getMemberNames() );
-         document_ += "{";
-         for ( Value::Members::iterator it = members.begin(); 
-               it != members.end(); 
-               ++it )
-         {
-            const std::string &name = *it;
-            if ( it != members.begin() )
-               document_ += ",";
-            document_ += valueToQuotedString( name.c_str() );
-            document_ += yamlCompatiblityEnabled_ ? ": " 
-                                                  : ":";
-            writeValue( value[name] );
-         }
-         document_ += "}";
+         out_.write( data, length );
+         return;
       }
-      break;
    }
+   memcpy( data_ + used_, data, length );
+   used_ += (unsigned int)length;
+}
+
+
+void 
+BufferedWriter::Buffer::push_back( char c )
+{
+   if ( used_ == size_ )
+      flush();
+   data_[used_++] = c;
+}
+
+
+void 
+BufferedWriter::Buffer::flush()
+{
+   if ( used_ )
+      out_.write( data_, used_ );
+   used_ = 0;
+}
+
+
+BufferedWriter::BufferedWriter( std::ostream &out, unsigned int bufferSize )
+   : buffer_( out, bufferSize )
+   , yamlCompatiblityEnabled_( false )
+{
+}
+
+
+BufferedWriter::~BufferedWriter()
+{
+   buffer_.flush();
+}
+
+
+void 
+BufferedWriter::enableYAMLCompatibility()
+{
+   yamlCompatiblityEnabled_ = true;
+}
+
+
+void 
+BufferedWriter::write( const Value &root )
+{
+   writeCompactValue( root, buffer_, yamlCompatiblityEnabled_ );
+   buffer_.push_back( '\n' );
+}
+
+
+void 
+BufferedWriter::flush()
+{
+   buffer_.flush();
 }
 
 
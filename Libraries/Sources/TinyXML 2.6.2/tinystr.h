@@ -125,10 +125,10 @@ class TiXmlString
 
 
 	// Convert a TiXmlString into a null-terminated char *
-	const char * c_str () const { return rep_->str; }
+	const char * c_str () const { return rep_->data; }
 
 	// Convert a TiXmlString into a char * (need not be null terminated).
-	const char * data () const { return rep_->str; }
+	const char * data () const { return rep_->data; }
 
 	// Return the length of a TiXmlString
 	size_type length () const { return rep_->size; }
@@ -147,14 +147,14 @@ class TiXmlString
 	const char& at (size_type index) const
 	{
 		assert( index < length() );
-		return rep_->str[ index ];
+		return rep_->data[ index ];
 	}
 
 	// [] operator
 	char& operator [] (size_type index) const
 	{
 		assert( index < length() );
-		return rep_->str[ index ];
+		return rep_->data[ index ];
 	}
 
 	// find a char in a string. Return TiXmlString::npos if not found
@@ -201,16 +201,34 @@ class TiXmlString
 		other.rep_ = r;
 	}
 
+	/*	Makes the string use len characters at str in place, instead of a copy. The header
+		is referenceSize() bytes of memory for the string's bookkeeping. Both have to outlive
+		the string, and the caller null terminates the characters. Changing the string makes
+		it a copy again. Used by the arena parsing of TiXmlDocument.
+	*/
+	void reference (void* header, const char* str, size_type len)
+	{
+		quit();
+		rep_ = static_cast<Rep*>(header);
+		rep_->size = len;
+		rep_->capacity = 0;
+		rep_->data = const_cast<char*>(str);
+	}
+
+	static size_type referenceSize () { return sizeof(Rep); }
+
   private:
 
 	void init(size_type sz) { init(sz, sz); }
-	void set_size(size_type sz) { rep_->str[ rep_->size = sz ] = '\0'; }
-	char* start() const { return rep_->str; }
-	char* finish() const { return rep_->str + rep_->size; }
+	void set_size(size_type sz) { rep_->data[ rep_->size = sz ] = '\0'; }
+	char* start() const { return rep_->data; }
+	char* finish() const { return rep_->data + rep_->size; }
 
+	// data points to str, or to characters used in place, which have no capacity
 	struct Rep
 	{
 		size_type size, capacity;
+		char* data;
 		char str[1];
 	};
 
@@ -227,7 +245,8 @@ class TiXmlString
 			const size_type intsNeeded = ( bytesNeeded + sizeof(int) - 1 ) / sizeof( int ); 
 			rep_ = reinterpret_cast<Rep*>( new int[ intsNeeded ] );
 
-			rep_->str[ rep_->size = sz ] = '\0';
+			rep_->data = rep_->str;
+			rep_->data[ rep_->size = sz ] = '\0';
 			rep_->capacity = cap;
 		}
 		else
@@ -238,7 +257,8 @@ class TiXmlString
 
 	void quit()
 	{
-		if (rep_ != &nullrep_)
+		// references have no capacity, their memory isn't ours
+		if (rep_ != &nullrep_ && rep_->capacity)
 		{
 			// The rep_ is really an array of ints. (see the allocator, above).
 			// Cast it back before delete, so the compiler won't incorrectly call destructors.
@@ -49,6 +49,89 @@ FILE* TiXmlFOpen( const char* filename, const char* mode )
 	#endif
 }
 
+
+void* TiXmlArena::AllocBlock( size_t bytes )
+{
+	// Large requests, like the document text, get a block of their own and
+	// leave the current block to the small ones.
+	const bool large = bytes > BLOCK_SIZE / 4;
+	const size_t blockSize = ALIGNMENT + ( large ? bytes : (size_t)BLOCK_SIZE );
+
+	char* block = static_cast<char*>( ::operator new( blockSize ) );
+	size += blockSize;
+
+	*reinterpret_cast<char**>( block ) = blocks;
+	blocks = block;
+
+	char* result = block + ALIGNMENT;
+	if ( !large )
+	{
+		cursor = result + bytes;
+		end = block + blockSize;
+	}
+	return result;
+}
+
+
+void TiXmlArena::Reference( TIXML_STRING* str, const char* text, size_t length )
+{
+	#ifdef TIXML_USE_STL
+	str->assign( text, length );
+	#else
+	str->reference( Alloc( TiXmlString::referenceSize() ), text, length );
+	#endif
+}
+
+
+void TiXmlArena::Clear()
+{
+	while ( blocks )
+	{
+		char* next = *reinterpret_cast<char**>( blocks );
+		::operator delete( blocks );
+		blocks = next;
+	}
+	cursor = end = 0;
+	size = 0;
+}
+
+
+// Every allocation starts with the arena it came from, null for the heap.
+void* TiXmlBase::operator new( size_t size )
+{
+	char* mem = static_cast<char*>( ::operator new( size + TiXmlArena::ALIGNMENT ) );
+	*reinterpret_cast<TiXmlArena**>( mem ) = 0;
+	return mem + TiXmlArena::ALIGNMENT;
+}
+
+
+void* TiXmlBase::operator new( size_t size, TiXmlArena* arena )
+{
+	if ( !arena )
+		return operator new( size );
+
+	char* mem = static_cast<char*>( arena->Alloc( size + TiXmlArena::ALIGNMENT ) );
+	*reinterpret_cast<TiXmlArena**>( mem ) = arena;
+	return mem + TiXmlArena::ALIGNMENT;
+}
+
+
+void TiXmlBase::operator delete( void* p )
+{
+	if ( !p )
+		return;
+
+	char* mem = static_cast<char*>( p ) - TiXmlArena::ALIGNMENT;
+	if ( !*reinterpret_cast<TiXmlArena**>( mem ) )
+		::operator delete( mem );
+}
+
+
+void TiXmlBase::operator delete( void* p, TiXmlArena* )
+{
+	operator delete( p );
+}
+
 void TiXmlBase::EncodeString( const TIXML_STRING& str, TIXML_STRING* outString )
 {
 	int i=0;
@@ -914,6 +997,9 @@ TiXmlDocument::TiXmlDocument() : TiXmlNode( TiXmlNode::TINYXML_DOCUMENT )
 {
 	tabsize = 4;
 	useMicrosoftBOM = false;
+	useArena = false;
+	parsingInArena = false;
+	arena = 0;
 	ClearError();
 }
 
@@ -921,6 +1007,9 @@ TiXmlDocument::TiXmlDocument( const char * documentName ) : TiXmlNode( TiXmlNode
 {
 	tabsize = 4;
 	useMicrosoftBOM = false;
+	useArena = false;
+	parsingInArena = false;
+	arena = 0;
 	value = documentName;
 	ClearError();
 }
@@ -931,6 +1020,9 @@ TiXmlDocument::TiXmlDocument( const std::string& documentName ) : TiXmlNode( TiX
 {
 	tabsize = 4;
 	useMicrosoftBOM = false;
+	useArena = false;
+	parsingInArena = false;
+	arena = 0;
     value = documentName;
 	ClearError();
 }
@@ -939,10 +1031,20 @@ TiXmlDocument::TiXmlDocument( const std::string& documentName ) : TiXmlNode( TiX
 
 TiXmlDocument::TiXmlDocument( const TiXmlDocument& copy ) : TiXmlNode( TiXmlNode::TINYXML_DOCUMENT )
 {
+	parsingInArena = false;
+	arena = 0;
 	copy.CopyTo( this );
 }
 
 
+TiXmlDocument::~TiXmlDocument()
+{
+	// The nodes may live in the arena, they go first.
+	Clear();
+	delete arena;
+}
+
+
 TiXmlDocument& TiXmlDocument::operator=( const TiXmlDocument& copy )
 {
 	Clear();
@@ -994,6 +1096,8 @@ bool TiXmlDocument::LoadFile( FILE* file, TiXmlEncoding encoding )
 	// Delete the existing data:
 	Clear();
 	location.Clear();
+	if ( arena )
+		arena->Clear();
 
 	// Get the file size, so we can pre-allocate the string. HUGE speed impact.
 	long length = 0;
@@ -1029,11 +1133,22 @@ bool TiXmlDocument::LoadFile( FILE* file, TiXmlEncoding encoding )
 	}
 	*/
 
-	char* buf = new char[ length+1 ];
+	char* buf = 0;
+	if ( useArena )
+	{
+		if ( !arena )
+			arena = new TiXmlArena();
+		buf = static_cast<char*>( arena->Alloc( length+1 ) );
+	}
+	else
+	{
+		buf = new char[ length+1 ];
+	}
 	buf[0] = 0;
 
 	if ( fread( buf, length, 1, file ) != 1 ) {
-		delete [] buf;
+		if ( !useArena )
+			delete [] buf;
 		SetError( TIXML_ERROR_OPENING_FILE, 0, 0, TIXML_ENCODING_UNKNOWN );
 		return false;
 	}
@@ -1074,6 +1189,13 @@ bool TiXmlDocument::LoadFile( FILE* file, TiXmlEncoding encoding )
 	assert( q <= (buf+length) );
 	*q = 0;
 
+	if ( useArena )
+	{
+		// The buffer stays with the arena, the strings point into it.
+		ParseInArena( buf, 0, encoding );
+		return !Error();
+	}
+
 	Parse( buf, 0, encoding );
 
 	delete [] buf;
@@ -1122,6 +1244,7 @@ void TiXmlDocument::CopyTo( TiXmlDocument* target ) const
 	target->tabsize = tabsize;
 	target->errorLocation = errorLocation;
 	target->useMicrosoftBOM = useMicrosoftBOM;
+	target->useArena = useArena;
 
 	TiXmlNode* node = 0;
 	for ( node = firstChild; node; node = node->NextSibling() )
@@ -1580,6 +1703,20 @@ TiXmlAttribute* TiXmlAttributeSet::Find( const char* name ) const
 }
 
 
+#ifndef TIXML_USE_STL
+TiXmlAttribute* TiXmlAttributeSet::Find( const TiXmlString& name ) const
+{
+	for( TiXmlAttribute* node = sentinel.next; node != &sentinel; node = node->next )
+	{
+		if (    node->name.length() == name.length()
+			 && memcmp( node->name.data(), name.data(), name.length() ) == 0 )
+			return node;
+	}
+	return 0;
+}
+#endif
+
+
 TiXmlAttribute* TiXmlAttributeSet::FindOrCreate( const char* _name )
 {
 	TiXmlAttribute* attrib = Find( _name );
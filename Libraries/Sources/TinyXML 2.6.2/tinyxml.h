@@ -88,11 +88,63 @@ class TiXmlAttribute;
 class TiXmlText;
 class TiXmlDeclaration;
 class TiXmlParsingData;
+class TiXmlArena;
 
 const int TIXML_MAJOR_VERSION = 2;
 const int TIXML_MINOR_VERSION = 6;
 const int TIXML_PATCH_VERSION = 2;
 
+/*	Bump allocator behind the arena parsing of TiXmlDocument. Nodes, attributes
+	and the document text are carved out of large blocks, which are only freed
+	all at once by Clear() or the destructor.
+*/
+class TiXmlArena
+{
+public:
+	enum
+	{
+		ALIGNMENT = 8,
+		BLOCK_SIZE = 64 * 1024
+	};
+
+	TiXmlArena() : blocks( 0 ), cursor( 0 ), end( 0 ), size( 0 )	{}
+	~TiXmlArena()													{ Clear(); }
+
+	void* Alloc( size_t bytes )
+	{
+		bytes = ( bytes + ALIGNMENT - 1 ) & ~size_t( ALIGNMENT - 1 );
+		if ( bytes > size_t( end - cursor ) )
+			return AllocBlock( bytes );
+
+		void* result = cursor;
+		cursor += bytes;
+		return result;
+	}
+
+	/*	Makes str use length characters at text in place. The characters have to
+		live in the arena, the caller null terminates them once parsing is done.
+		The STL string can't do that, it gets a copy.
+	*/
+	void Reference( TIXML_STRING* str, const char* text, size_t length );
+
+	/// Frees all the blocks.
+	void Clear();
+
+	/// Bytes taken from the heap.
+	size_t Size() const		{ return size; }
+
+private:
+	TiXmlArena( const TiXmlArena& );			// not allowed.
+	void operator=( const TiXmlArena& );		// not allowed.
+
+	void* AllocBlock( size_t bytes );
+
+	char* blocks;	// each block starts with the pointer to the next one
+	char* cursor;
+	char* end;
+	size_t size;
+};
+
 /*	Internal structure for tracking location of items 
 	in the XML file.
 */
@@ -201,6 +253,14 @@ public:
 	TiXmlBase()	:	userData(0)		{}
 	virtual ~TiXmlBase()			{}
 
+	/*	Nodes and attributes remember whether they came from an arena, delete
+		gives the memory of those back with the arena only.
+	*/
+	static void* operator new( size_t size );
+	static void* operator new( size_t size, TiXmlArena* arena );
+	static void operator delete( void* p );
+	static void operator delete( void* p, TiXmlArena* arena );
+
 	/**	All TinyXml classes can print themselves to a filestream
 		or the string class (TiXmlString in non-STL mode, std::string
 		in STL mode.) Either or both cfile and str can be null.
@@ -307,7 +367,7 @@ protected:
 		a pointer just past the last character of the name,
 		or 0 if the function has an error.
 	*/
-	static const char* ReadName( const char* p, TIXML_STRING* name, TiXmlEncoding encoding );
+	static const char* ReadName( const char* p, TIXML_STRING* name, TiXmlEncoding encoding, TiXmlArena* arena = 0 );
 
 	/*	Reads text. Returns a pointer past the given end tag.
 		Wickedly complex options, but it keeps the (sensitive) code in one place.
@@ -317,7 +377,26 @@ protected:
 									bool ignoreWhiteSpace,		// whether to keep the white space
 									const char* endTag,			// what ends this text
 									bool ignoreCase,			// whether to ignore case in the end tag
-									TiXmlEncoding encoding );	// the current encoding
+									TiXmlEncoding encoding,		// the current encoding
+									TiXmlArena* arena = 0 );	// if set, the text is used in place when possible
+
+	// Finds text ReadText() can use in place. Sets p to the end tag if so.
+	static bool FindTextInPlace(	const char** p,
+									const char** start,
+									const char** end,
+									bool condense,
+									const char* endTag,
+									bool caseInsensitive,
+									TiXmlEncoding encoding );
+
+	// Sets str to length characters at p, in place if there is an arena.
+	static void AssignText( TIXML_STRING* str, const char* p, size_t length, TiXmlArena* arena )
+	{
+		if ( arena )
+			arena->Reference( str, p, length );
+		else
+			str->assign( p, length );
+	}
 
 	// If an entity has been found, transform it into a character.
 	static const char* GetEntity( const char* in, char* value, int* length, TiXmlEncoding encoding );
@@ -779,6 +858,7 @@ private:
 class TiXmlAttribute : public TiXmlBase
 {
 	friend class TiXmlAttributeSet;
+	friend class TiXmlDocument;
 
 public:
 	/// Construct an empty attribute.
@@ -920,6 +1000,9 @@ public:
 #	ifdef TIXML_USE_STL
 	TiXmlAttribute*	Find( const std::string& _name ) const;
 	TiXmlAttribute* FindOrCreate( const std::string& _name );
+#	else
+	// Compares by length, works while the names are not null terminated yet.
+	TiXmlAttribute*	Find( const TiXmlString& _name ) const;
 #	endif
 
 
@@ -1406,7 +1489,7 @@ public:
 	TiXmlDocument( const TiXmlDocument& copy );
 	TiXmlDocument& operator=( const TiXmlDocument& copy );
 
-	virtual ~TiXmlDocument() {}
+	virtual ~TiXmlDocument();
 
 	/** Load a file using the current document value.
 		Returns true if successful. Will delete any existing
@@ -1445,6 +1528,27 @@ public:
 	*/
 	virtual const char* Parse( const char* p, TiXmlParsingData* data = 0, TiXmlEncoding encoding = TIXML_DEFAULT_ENCODING );
 
+	/** Arena parsing allocates the nodes and attributes of Parse() and LoadFile() from
+		large blocks owned by the document, instead of one heap allocation each. The
+		text is copied into the arena once, and names and values without entities
+		are used in place (in non-STL mode), null terminated in the copy.
+
+		All of it is freed when the document is destroyed or the next file is loaded,
+		so nodes of the document must not be kept or linked elsewhere after that.
+		Changing a name or value works as usual, it just makes a copy. Off by default.
+	*/
+	void SetArenaParsing( bool enable )		{ useArena = enable; }
+
+	/// Return whether arena parsing is enabled. See SetArenaParsing().
+	bool ArenaParsing() const				{ return useArena; }
+
+	/// Bytes the arena took from the heap, 0 when the document did not use one.
+	size_t ArenaSize() const				{ return arena ? arena->Size() : 0; }
+
+	// [internal use]
+	// The arena to parse nodes into, null when not parsing with an arena.
+	TiXmlArena* ParseArena() const			{ return parsingInArena ? arena : 0; }
+
 	/** Get the root element -- the only top level element -- of the document.
 		In well formed XML, there should only be one. TinyXml is tolerant of
 		multiple elements at the document level.
@@ -1546,12 +1650,19 @@ protected :
 private:
 	void CopyTo( TiXmlDocument* target ) const;
 
+	const char* ParseDocument( const char* p, TiXmlParsingData* data, TiXmlEncoding encoding );
+	// Parses text that lives in the arena and null terminates the strings used in place.
+	const char* ParseInArena( const char* p, TiXmlParsingData* data, TiXmlEncoding encoding );
+
 	bool error;
 	int  errorId;
 	TIXML_STRING errorDesc;
 	int tabsize;
 	TiXmlCursor errorLocation;
 	bool useMicrosoftBOM;		// the UTF-8 BOM were found when read. Note this, and try to write.
+	bool useArena;
+	bool parsingInArena;
+	TiXmlArena* arena;
 };
 
 
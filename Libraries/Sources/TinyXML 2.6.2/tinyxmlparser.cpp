@@ -398,7 +398,7 @@ const char* TiXmlBase::SkipWhiteSpace( const char* p, TiXmlEncoding encoding )
 // One of TinyXML's more performance demanding functions. Try to keep the memory overhead down. The
 // "assign" optimization removes over 10% of the execution time.
 //
-const char* TiXmlBase::ReadName( const char* p, TIXML_STRING * name, TiXmlEncoding encoding )
+const char* TiXmlBase::ReadName( const char* p, TIXML_STRING * name, TiXmlEncoding encoding, TiXmlArena* arena )
 {
 	// Oddly, not supported on some comilers,
 	//name->clear();
@@ -428,7 +428,7 @@ const char* TiXmlBase::ReadName( const char* p, TIXML_STRING * name, TiXmlEncodi
 			++p;
 		}
 		if ( p-start > 0 ) {
-			name->assign( start, p-start );
+			AssignText( name, start, p-start, arena );
 		}
 		return p;
 	}
@@ -571,16 +571,80 @@ bool TiXmlBase::StringEqual( const char* p,
 	return false;
 }
 
+// Most text has no entities, and when condensing white space, no white space but single
+// spaces between the words. It reads the same in the source as decoded, so it can be
+// used in place.
+bool TiXmlBase::FindTextInPlace(	const char** p, 
+									const char** start, 
+									const char** end, 
+									bool condense, 
+									const char* endTag, 
+									bool caseInsensitive,
+									TiXmlEncoding encoding )
+{
+	const char* q = *p;
+	if ( condense )
+		q = SkipWhiteSpace( q, encoding );
+	if ( !q || !*q )
+		return false;
+
+	*start = q;
+	const char* last = q;		// past the last character that isn't white space
+	bool irregularWhiteSpace = false;
+
+	while ( *q && !StringEqual( q, endTag, caseInsensitive, encoding ) )
+	{
+		if ( *q == '&' )
+			return false;
+
+		if ( condense && IsWhiteSpace( *q ) )
+		{
+			// q > start here, the leading white space is skipped
+			if ( *q != ' ' || IsWhiteSpace( *(q-1) ) )
+				irregularWhiteSpace = true;
+			++q;
+			continue;
+		}
+		if ( irregularWhiteSpace )
+			return false;
+
+		int length = 1;
+		if ( encoding == TIXML_ENCODING_UTF8 )
+			length = utf8ByteTable[ *((const unsigned char*)q) ];
+		if ( !length )
+			return false;
+		for ( int i=1; i<length; ++i )
+		{
+			if ( !q[i] )
+				return false;
+		}
+		q += length;
+		last = q;
+	}
+
+	*end = condense ? last : q;
+	*p = q;
+	return true;
+}
+
 const char* TiXmlBase::ReadText(	const char* p, 
 									TIXML_STRING * text, 
 									bool trimWhiteSpace, 
 									const char* endTag, 
 									bool caseInsensitive,
-									TiXmlEncoding encoding )
+									TiXmlEncoding encoding,
+									TiXmlArena* arena )
 {
     *text = "";
-	if (    !trimWhiteSpace			// certain tags always keep whitespace
-		 || !condenseWhiteSpace )	// if true, whitespace is always kept
+	const char* start = 0;
+	const char* end = 0;
+	if (    arena
+		 && FindTextInPlace( &p, &start, &end, trimWhiteSpace && condenseWhiteSpace, endTag, caseInsensitive, encoding ) )
+	{
+		arena->Reference( text, start, end - start );
+	}
+	else if (    !trimWhiteSpace			// certain tags always keep whitespace
+			  || !condenseWhiteSpace )	// if true, whitespace is always kept
 	{
 		// Keep all the white space.
 		while (	   p && *p
@@ -702,6 +766,64 @@ void TiXmlDocument::StreamIn( std::istream * in, TIXML_STRING * tag )
 #endif
 
 const char* TiXmlDocument::Parse( const char* p, TiXmlParsingData* prevData, TiXmlEncoding encoding )
+{
+	if ( !useArena || !p )
+		return ParseDocument( p, prevData, encoding );
+
+	// Parse a copy that lives as long as the nodes, the strings are used in place.
+	if ( !arena )
+		arena = new TiXmlArena();
+	size_t length = strlen( p );
+	char* buf = static_cast<char*>( arena->Alloc( length+1 ) );
+	memcpy( buf, p, length+1 );
+
+	const char* end = ParseInArena( buf, prevData, encoding );
+	return end ? p + ( end - buf ) : 0;
+}
+
+// Null terminates a string used in place. The character after it is
+// not needed anymore once the document is parsed.
+static void TerminateInPlace( const TIXML_STRING& str )
+{
+	const_cast<char*>( str.data() )[ str.length() ] = 0;
+}
+
+const char* TiXmlDocument::ParseInArena( const char* p, TiXmlParsingData* prevData, TiXmlEncoding encoding )
+{
+	parsingInArena = true;
+	p = ParseDocument( p, prevData, encoding );
+	parsingInArena = false;
+
+	#ifndef TIXML_USE_STL
+	TiXmlNode* node = firstChild;
+	while ( node )
+	{
+		TerminateInPlace( node->value );
+
+		TiXmlElement* element = node->ToElement();
+		if ( element )
+		{
+			for ( TiXmlAttribute* attrib = element->FirstAttribute(); attrib; attrib = attrib->Next() )
+			{
+				TerminateInPlace( attrib->name );
+				TerminateInPlace( attrib->value );
+			}
+		}
+
+		if ( node->firstChild )
+		{
+			node = node->firstChild;
+			continue;
+		}
+		while ( node != this && !node->next )
+			node = node->parent;
+		node = ( node != this ) ? node->next : 0;
+	}
+	#endif
+	return p;
+}
+
+const char* TiXmlDocument::ParseDocument( const char* p, TiXmlParsingData* prevData, TiXmlEncoding encoding )
 {
 	ClearError();
 
@@ -844,26 +966,29 @@ TiXmlNode* TiXmlNode::Identify( const char* p, TiXmlEncoding encoding )
 	const char* dtdHeader = { "<!" };
 	const char* cdataHeader = { "<![CDATA[" };
 
+	TiXmlDocument* document = GetDocument();
+	TiXmlArena* arena = document ? document->ParseArena() : 0;
+
 	if ( StringEqual( p, xmlHeader, true, encoding ) )
 	{
 		#ifdef DEBUG_PARSER
 			TIXML_LOG( "XML parsing Declaration\n" );
 		#endif
-		returnNode = new TiXmlDeclaration();
+		returnNode = new ( arena ) TiXmlDeclaration();
 	}
 	else if ( StringEqual( p, commentHeader, false, encoding ) )
 	{
 		#ifdef DEBUG_PARSER
 			TIXML_LOG( "XML parsing Comment\n" );
 		#endif
-		returnNode = new TiXmlComment();
+		returnNode = new ( arena ) TiXmlComment();
 	}
 	else if ( StringEqual( p, cdataHeader, false, encoding ) )
 	{
 		#ifdef DEBUG_PARSER
 			TIXML_LOG( "XML parsing CDATA\n" );
 		#endif
-		TiXmlText* text = new TiXmlText( "" );
+		TiXmlText* text = new ( arena ) TiXmlText( "" );
 		text->SetCDATA( true );
 		returnNode = text;
 	}
@@ -872,7 +997,7 @@ TiXmlNode* TiXmlNode::Identify( const char* p, TiXmlEncoding encoding )
 		#ifdef DEBUG_PARSER
 			TIXML_LOG( "XML parsing Unknown(1)\n" );
 		#endif
-		returnNode = new TiXmlUnknown();
+		returnNode = new ( arena ) TiXmlUnknown();
 	}
 	else if (    IsAlpha( *(p+1), encoding )
 			  || *(p+1) == '_' )
@@ -880,14 +1005,14 @@ TiXmlNode* TiXmlNode::Identify( const char* p, TiXmlEncoding encoding )
 		#ifdef DEBUG_PARSER
 			TIXML_LOG( "XML parsing Element\n" );
 		#endif
-		returnNode = new TiXmlElement( "" );
+		returnNode = new ( arena ) TiXmlElement( "" );
 	}
 	else
 	{
 		#ifdef DEBUG_PARSER
 			TIXML_LOG( "XML parsing Unknown(2)\n" );
 		#endif
-		returnNode = new TiXmlUnknown();
+		returnNode = new ( arena ) TiXmlUnknown();
 	}
 
 	if ( returnNode )
@@ -1044,6 +1169,7 @@ const char* TiXmlElement::Parse( const char* p, TiXmlParsingData* data, TiXmlEnc
 {
 	p = SkipWhiteSpace( p, encoding );
 	TiXmlDocument* document = GetDocument();
+	TiXmlArena* arena = document ? document->ParseArena() : 0;
 
 	if ( !p || !*p )
 	{
@@ -1068,16 +1194,13 @@ const char* TiXmlElement::Parse( const char* p, TiXmlParsingData* data, TiXmlEnc
 	// Read the name.
 	const char* pErr = p;
 
-    p = ReadName( p, &value, encoding );
+    p = ReadName( p, &value, encoding, arena );
 	if ( !p || !*p )
 	{
 		if ( document )	document->SetError( TIXML_ERROR_FAILED_TO_READ_ELEMENT_NAME, pErr, data, encoding );
 		return 0;
 	}
 
-    TIXML_STRING endTag ("</");
-	endTag += value;
-
 	// Check for and read attributes. Also look for an empty
 	// tag or an end tag.
 	while ( p && *p )
@@ -1119,9 +1242,10 @@ const char* TiXmlElement::Parse( const char* p, TiXmlParsingData* data, TiXmlEnc
 			// </foo > and
 			// </foo> 
 			// are both valid end tags.
-			if ( StringEqual( p, endTag.c_str(), false, encoding ) )
+			if (    StringEqual( p, "</", false, encoding )
+				 && strncmp( p+2, value.data(), value.length() ) == 0 )
 			{
-				p += endTag.length();
+				p += 2 + value.length();
 				p = SkipWhiteSpace( p, encoding );
 				if ( p && *p && *p == '>' ) {
 					++p;
@@ -1139,7 +1263,7 @@ const char* TiXmlElement::Parse( const char* p, TiXmlParsingData* data, TiXmlEnc
 		else
 		{
 			// Try to read an attribute:
-			TiXmlAttribute* attrib = new TiXmlAttribute();
+			TiXmlAttribute* attrib = new ( arena ) TiXmlAttribute();
 			if ( !attrib )
 			{
 				return 0;
@@ -1157,11 +1281,7 @@ const char* TiXmlElement::Parse( const char* p, TiXmlParsingData* data, TiXmlEnc
 			}
 
 			// Handle the strange case of double attributes:
-			#ifdef TIXML_USE_STL
 			TiXmlAttribute* node = attributeSet.Find( attrib->NameTStr() );
-			#else
-			TiXmlAttribute* node = attributeSet.Find( attrib->Name() );
-			#endif
 			if ( node )
 			{
 				if ( document ) document->SetError( TIXML_ERROR_PARSING_ELEMENT, pErr, data, encoding );
@@ -1179,6 +1299,7 @@ const char* TiXmlElement::Parse( const char* p, TiXmlParsingData* data, TiXmlEnc
 const char* TiXmlElement::ReadValue( const char* p, TiXmlParsingData* data, TiXmlEncoding encoding )
 {
 	TiXmlDocument* document = GetDocument();
+	TiXmlArena* arena = document ? document->ParseArena() : 0;
 
 	// Read in text and elements in any order.
 	const char* pWithWhiteSpace = p;
@@ -1189,7 +1310,7 @@ const char* TiXmlElement::ReadValue( const char* p, TiXmlParsingData* data, TiXm
 		if ( *p != '<' )
 		{
 			// Take what we have, make a text element.
-			TiXmlText* textNode = new TiXmlText( "" );
+			TiXmlText* textNode = new ( arena ) TiXmlText( "" );
 
 			if ( !textNode )
 			{
@@ -1275,6 +1396,7 @@ void TiXmlUnknown::StreamIn( std::istream * in, TIXML_STRING * tag )
 const char* TiXmlUnknown::Parse( const char* p, TiXmlParsingData* data, TiXmlEncoding encoding )
 {
 	TiXmlDocument* document = GetDocument();
+	TiXmlArena* arena = document ? document->ParseArena() : 0;
 	p = SkipWhiteSpace( p, encoding );
 
 	if ( data )
@@ -1290,11 +1412,12 @@ const char* TiXmlUnknown::Parse( const char* p, TiXmlParsingData* data, TiXmlEnc
 	++p;
     value = "";
 
+	const char* start = p;
 	while ( p && *p && *p != '>' )
 	{
-		value += *p;
 		++p;
 	}
+	AssignText( &value, start, p - start, arena );
 
 	if ( !p )
 	{
@@ -1337,6 +1460,7 @@ void TiXmlComment::StreamIn( std::istream * in, TIXML_STRING * tag )
 const char* TiXmlComment::Parse( const char* p, TiXmlParsingData* data, TiXmlEncoding encoding )
 {
 	TiXmlDocument* document = GetDocument();
+	TiXmlArena* arena = document ? document->ParseArena() : 0;
 	value = "";
 
 	p = SkipWhiteSpace( p, encoding );
@@ -1377,11 +1501,12 @@ const char* TiXmlComment::Parse( const char* p, TiXmlParsingData* data, TiXmlEnc
 
     value = "";
 	// Keep all the white space.
+	const char* start = p;
 	while (	p && *p && !StringEqual( p, endTag, false, encoding ) )
 	{
-		value.append( p, 1 );
 		++p;
 	}
+	AssignText( &value, start, p - start, arena );
 	if ( p && *p ) 
 		p += strlen( endTag );
 
@@ -1399,9 +1524,11 @@ const char* TiXmlAttribute::Parse( const char* p, TiXmlParsingData* data, TiXmlE
 		data->Stamp( p, encoding );
 		location = data->Cursor();
 	}
+	TiXmlArena* arena = document ? document->ParseArena() : 0;
+
 	// Read the name, the '=' and the value.
 	const char* pErr = p;
-	p = ReadName( p, &name, encoding );
+	p = ReadName( p, &name, encoding, arena );
 	if ( !p || !*p )
 	{
 		if ( document ) document->SetError( TIXML_ERROR_READING_ATTRIBUTES, pErr, data, encoding );
@@ -1430,13 +1557,13 @@ const char* TiXmlAttribute::Parse( const char* p, TiXmlParsingData* data, TiXmlE
 	{
 		++p;
 		end = "\'";		// single quote in string
-		p = ReadText( p, &value, false, end, false, encoding );
+		p = ReadText( p, &value, false, end, false, encoding, arena );
 	}
 	else if ( *p == DOUBLE_QUOTE )
 	{
 		++p;
 		end = "\"";		// double quote in string
-		p = ReadText( p, &value, false, end, false, encoding );
+		p = ReadText( p, &value, false, end, false, encoding, arena );
 	}
 	else
 	{
@@ -1444,6 +1571,7 @@ const char* TiXmlAttribute::Parse( const char* p, TiXmlParsingData* data, TiXmlE
 		// But this is such a common error that the parser will try
 		// its best, even without them.
 		value = "";
+		const char* start = p;
 		while (    p && *p											// existence
 				&& !IsWhiteSpace( *p )								// whitespace
 				&& *p != '/' && *p != '>' )							// tag end
@@ -1455,9 +1583,9 @@ const char* TiXmlAttribute::Parse( const char* p, TiXmlParsingData* data, TiXmlE
 				if ( document ) document->SetError( TIXML_ERROR_READING_ATTRIBUTES, p, data, encoding );
 				return 0;
 			}
-			value += *p;
 			++p;
 		}
+		AssignText( &value, start, p - start, arena );
 	}
 	return p;
 }
@@ -1498,6 +1626,7 @@ const char* TiXmlText::Parse( const char* p, TiXmlParsingData* data, TiXmlEncodi
 {
 	value = "";
 	TiXmlDocument* document = GetDocument();
+	TiXmlArena* arena = document ? document->ParseArena() : 0;
 
 	if ( data )
 	{
@@ -1521,13 +1650,14 @@ const char* TiXmlText::Parse( const char* p, TiXmlParsingData* data, TiXmlEncodi
 		p += strlen( startTag );
 
 		// Keep all the white space, ignore the encoding, etc.
+		const char* start = p;
 		while (	   p && *p
 				&& !StringEqual( p, endTag, false, encoding )
 			  )
 		{
-			value += *p;
 			++p;
 		}
+		AssignText( &value, start, p - start, arena );
 
 		TIXML_STRING dummy; 
 		p = ReadText( p, &dummy, false, endTag, false, encoding );
@@ -0,0 +1,247 @@
+///////////////////////////////////////////////////////////////////////////////////
+///
+///  Impressive Engine 2D
+///
+/// Copyright (c) 2012-2013 Impressive Reality team
+///
+/// The license is
+///
+/// Permission is denied, to any person or company
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Project leader : O.Shahbazi <sh_omid_m@yahoo.com>
+///////////////////////////////////////////////////////////////////////////////////
+#include "FileIO.h"
+#include "Utility.h"
+#include "CookedTree.h"
+#include "PackFile.h"
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <list>
+
+USING_NAMESPACE
+
+//Cook -scene|-animation|-material [-ext <extension>]... <file or directory>...
+//Writes <file>.cooked next to every file, which is loaded instead of the file while it's up to date.
+//Directories are cooked with their subdirectories, only the files with one of the -ext extensions,
+//or without -ext every file which isn't a texture, a sound or another kind of asset
+//
+//Cook -pack <directory> <pack file> [-store]
+//Packs all files under the directory, to be mounted by PackFileSystem over it
+
+bool CookFile(const FileIO::FileType &Type, const String &FilePath)
+{
+	if (FilePath.EndsWith(".cooked", true))
+		return true;
+
+	ITreeParser *parser = FileIO::GetReference().CreateTreeParser(Type, FilePath);
+
+	if (!parser || !parser->GetRoot())
+	{
+		std::cout << "Couldn't read " << FilePath << std::endl;
+
+		if (parser)
+			delete parser;
+
+		return false;
+	}
+
+	std::vector<char> buffer;
+	CookedTree::Write(parser->GetRoot(), Type, buffer);
+
+	delete parser;
+
+	const String cookedFilePath = CookedTree::GetCookedFilePath(FilePath);
+
+	std::ofstream file(cookedFilePath.GetBuffer(), std::ios::binary | std::ios::trunc);
+
+	if (buffer.size())
+		file.write(&buffer[0], buffer.size());
+
+	if (!file)
+	{
+		std::cout << "Couldn't write " << cookedFilePath << std::endl;
+		return false;
+	}
+
+	std::cout << FilePath << " -> " << cookedFilePath << " (" << buffer.size() << " bytes)" << std::endl;
+
+	return true;
+}
+
+typedef std::vector<String> ExtensionsList;
+
+// the assets which aren't tree files, when there isn't an -ext
+const char *NOT_TREE_EXTENSIONS[] = { ".cooked", ".png", ".jpg", ".jpeg", ".bmp", ".tga", ".dds", ".psd", ".pcx", ".ppm", ".wal", ".rgb",
+	".wav", ".ogg", ".mp3", ".flac", ".ttf", ".otf", ".fnt", ".avi", ".ogv", ".mp4", ".wmv", ".dll", ".exe", ".zip", ".pak" };
+
+bool IsTreeFile(const String &FileName, const ExtensionsList &Extensions)
+{
+	if (Extensions.size())
+	{
+		for (unsigned int i = 0; i < Extensions.size(); i++)
+			if (FileName.EndsWith(Extensions[i], true))
+				return true;
+
+		return false;
+	}
+
+	for (unsigned int i = 0; i < sizeof(NOT_TREE_EXTENSIONS) / sizeof(NOT_TREE_EXTENSIONS[0]); i++)
+		if (FileName.EndsWith(NOT_TREE_EXTENSIONS[i], true))
+			return false;
+
+	return true;
+}
+
+unsigned int CookDirectory(const FileIO::FileType &Type, const String &Directory, const ExtensionsList &Extensions)
+{
+	unsigned int failed = 0;
+
+	StringsList files = Utility::GetFiles(Directory);
+
+	FOR_EACH(file, files)
+		if (IsTreeFile(*file, Extensions) && !CookFile(Type, Directory + *file))
+			failed++;
+
+	StringsList directories = Utility::GetDirectories(Directory);
+
+	FOR_EACH(directory, directories)
+	{
+		if (*directory == "." || *directory == "..")
+			continue;
+
+		failed += CookDirectory(Type, Directory + *directory + "\\", Extensions);
+	}
+
+	return failed;
+}
+
+typedef std::list<std::vector<char> > ContentsList;
+
+bool CollectFiles(const String &Directory, const std::string &RelativePath, PackFile::SourceFilesList &Files, ContentsList &Contents)
+{
+	StringsList files = Utility::GetFiles(Directory);
+
+	FOR_EACH(file, files)
+	{
+		const String filePath = Directory + *file;
+
+		std::ifstream stream(filePath.GetBuffer(), std::ios::binary);
+
+		if (!stream)
+		{
+			std::cout << "Couldn't read " << filePath << std::endl;
+			return false;
+		}
+
+		Contents.push_back(std::vector<char>((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>()));
+		std::vector<char> &content = Contents.back();
+
+		Files.push_back(PackFile::SourceFile(RelativePath + (*file).GetBuffer(), (content.size() ? &content[0] : NULL), content.size()));
+	}
+
+	StringsList directories = Utility::GetDirectories(Directory);
+
+	FOR_EACH(directory, directories)
+	{
+		if (*directory == "." || *directory == "..")
+			continue;
+
+		if (!CollectFiles(Directory + *directory + "\\", RelativePath + (*directory).GetBuffer() + "/", Files, Contents))
+			return false;
+	}
+
+	return true;
+}
+
+bool PackDirectory(const String &DirectoryPath, const String &PackFilePath, const bool &Compress)
+{
+	String directory = DirectoryPath;
+	if (!directory.EndsWith("\\") && !directory.EndsWith("/"))
+		directory += "\\";
+
+	PackFile::SourceFilesList files;
+	ContentsList contents;
+
+	if (!CollectFiles(directory, "", files, contents))
+		return false;
+
+	std::vector<char> buffer;
+	PackFile::Write(files, buffer, Compress);
+
+	std::ofstream file(PackFilePath.GetBuffer(), std::ios::binary | std::ios::trunc);
+
+	if (buffer.size())
+		file.write(&buffer[0], buffer.size());
+
+	if (!file)
+	{
+		std::cout << "Couldn't write " << PackFilePath << std::endl;
+		return false;
+	}
+
+	std::cout << DirectoryPath << " -> " << PackFilePath << " (" << files.size() << " files, " << buffer.size() << " bytes)" << std::endl;
+
+	return true;
+}
+
+int main(int ArgumentCount, char *Arguments[])
+{
+	if (ArgumentCount >= 4 && String(Arguments[1]) == "-pack")
+		return (PackDirectory(Arguments[2], Arguments[3], !(ArgumentCount >= 5 && String(Arguments[4]) == "-store")) ? 0 : 1);
+
+	FileIO::FileType type = FileIO::FT_SCENE;
+	ExtensionsList extensions;
+	unsigned int failed = 0;
+	bool hasFile = false;
+
+	for (int i = 1; i < ArgumentCount; i++)
+	{
+		const String argument(Arguments[i]);
+
+		if (argument == "-scene")
+			type = FileIO::FT_SCENE;
+		else if (argument == "-animation")
+			type = FileIO::FT_ANIMATION;
+		else if (argument == "-material")
+			type = FileIO::FT_MATERIAL;
+		else if (argument == "-ext" && i + 1 < ArgumentCount)
+		{
+			String extension(Arguments[++i]);
+
+			if (!extension.StartsWith("."))
+				extension = "." + extension;
+
+			extensions.push_back(extension);
+		}
+		else if (Utility::DirectoryExists(argument))
+		{
+			hasFile = true;
+
+			String directory = argument;
+			if (!directory.EndsWith("\\") && !directory.EndsWith("/"))
+				directory += "\\";
+
+			failed += CookDirectory(type, directory, extensions);
+		}
+		else
+		{
+			hasFile = true;
+
+			if (!CookFile(type, argument))
+				failed++;
+		}
+	}
+
+	if (!hasFile)
+	{
+		std::cout << "Usage: Cook [-scene|-animation|-material] [-ext <extension>]... <file or directory>..." << std::endl;
+		std::cout << "       Cook -pack <directory> <pack file> [-store]" << std::endl;
+		return 1;
+	}
+
+	return (failed ? 1 : 0);
+}
\ No newline at end of file
@@ -0,0 +1,715 @@
+///////////////////////////////////////////////////////////////////////////////////
+///
+///  Impressive Engine 2D
+///
+/// Copyright (c) 2012-2013 Impressive Reality team
+///
+/// The license is
+///
+/// Permission is denied, to any person or company
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Project leader : O.Shahbazi <sh_omid_m@yahoo.com>
+///////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Core.h"
+#include "FileIO.h"
+#include "IScene.h"
+#include "IThreadWorker.h"
+#include "ThreadManager.h"
+#include "HashedAttributes.h"
+#include "StreamTreeParser.h"
+#include "Profiler.h"
+#include "Renderer\IRenderEngine.h"
+#include "Renderer\ITexture.h"
+#include <Windows.h>
+#include <map>
+#include <string>
+#include <mutex>
+
+BEGIN_NAMESPACE
+
+//<Description>
+//Reloads the assets whose files change while the game runs.
+//Textures, animation sets, materials and scenes are tracked with the file they were
+//loaded from, the data directory is watched on a thread and a tracked file is reloaded
+//once it has been quiet for the debounce time, so a tool saving a file in steps costs one
+//reload. Changes to other files are dropped on the watching thread.
+//The files are read and parsed on the watching thread, with a StreamTreeParser and not the
+//tree parser of the engine. The new content is swapped into the assets at the start of
+//the next frame: textures are reloaded, animation sets and materials deserialized in
+//place, and a scene is loaded asynchronously and replaces the old one when it's ready.
+//Only the assets loaded through it are tracked
+class AssetWatcher : public IThreadWorker, public Core::IListener
+{
+public:
+	enum AssetType
+	{
+		AT_TEXTURE = 0,
+		AT_ANIMATION_SET,
+		AT_MATERIAL,
+		AT_SCENE
+	};
+
+	//<Description>
+	//Notified on the main thread after an asset was reloaded, to update what was made of it.
+	//For a scene Asset is the new scene, the old one is destroyed after the call
+	class IReloadListener
+	{
+	public:
+		virtual void OnAssetReloaded(const AssetType &Type, void *Asset, const String &FilePath) = 0;
+	};
+
+private:
+	struct TrackedAsset
+	{
+	public:
+		AssetType Type;
+		void *Asset;
+	};
+
+	struct TrackedFile
+	{
+	public:
+		String FilePath;
+		Vector<TrackedAsset> Assets;
+
+		//Tick count of the last change which isn't loaded yet, 0 if none
+		unsigned long ChangeTime;
+	};
+
+	//Read on the watching thread, to be swapped in on the main thread
+	struct LoadedChange
+	{
+	public:
+		String FilePath;
+
+		//Of an animation set or a material, otherwise NULL
+		HashedAttributes *Attributes;
+	};
+
+	struct LoadingScene
+	{
+	public:
+		IScene *OldScene;
+		IScene *NewScene;
+		String FilePath;
+	};
+
+	//The key is the normalized full path
+	typedef std::map<std::string, TrackedFile> TrackedFilesMap;
+	typedef Vector<LoadedChange> LoadedChangesList;
+	typedef Vector<LoadingScene> LoadingScenesList;
+	typedef Vector<IReloadListener*> IReloadListenersList;
+
+	static const unsigned int BUFFER_SIZE = 64 * 1024;
+
+public:
+	AssetWatcher(void) :
+		m_Thread(NULL),
+		m_Directory(INVALID_HANDLE_VALUE),
+		m_DebounceTime(250),
+		m_ReloadCount(0)
+	{
+		m_StopEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+	}
+
+	~AssetWatcher(void)
+	{
+		Stop();
+
+		CloseHandle(m_StopEvent);
+	}
+
+	static AssetWatcher &GetReference(void)
+	{
+		static AssetWatcher instance;
+
+		return instance;
+	}
+
+	//Starts watching the data directory, a file is reloaded DebounceTime milliseconds after its last change
+	bool Start(const unsigned int &DebounceTime = 250)
+	{
+		if (m_Thread)
+			return true;
+
+		m_DataPath = Core::GetReference().GetDataPath();
+
+		m_Directory = CreateFileA(m_DataPath.GetBuffer(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+
+		if (m_Directory == INVALID_HANDLE_VALUE)
+		{
+			LOG_ERROR("Couldn't watch [" + m_DataPath + "] for changes")
+			return false;
+		}
+
+		m_DebounceTime = DebounceTime;
+
+		ResetEvent(m_StopEvent);
+
+		Core::GetReference().AddListener(this);
+
+		m_Thread = ThreadManager::GetReference().CreateThread(this);
+
+		return true;
+	}
+
+	//Stops watching, the changes which aren't swapped in yet are dropped
+	void Stop(void)
+	{
+		if (!m_Thread)
+			return;
+
+		SetEvent(m_StopEvent);
+
+		m_Thread->Join();
+		ThreadManager::GetReference().DestroyThread(m_Thread);
+		m_Thread = NULL;
+
+		CloseHandle(m_Directory);
+		m_Directory = INVALID_HANDLE_VALUE;
+
+		Core::GetReference().RemoveListener(this);
+
+		for (unsigned int i = 0; i < m_LoadedChanges.GetSize(); i++)
+			if (m_LoadedChanges[i].Attributes)
+				delete m_LoadedChanges[i].Attributes;
+		m_LoadedChanges.Clear();
+	}
+
+	const bool IsRunning(void) const
+	{
+		return (m_Thread != NULL);
+	}
+
+	//FilePath is relative to Core::GetTexturePath(), like IRenderEngine::LoadTexture
+	ITexture *LoadTexture(const String &RelativeFilePath)
+	{
+		ITexture *texture = Core::GetReference().GetRenderer()->LoadTexture(RelativeFilePath);
+
+		if (texture)
+			Track(AT_TEXTURE, texture, Core::GetReference().GetTexturePath() + RelativeFilePath);
+
+		return texture;
+	}
+
+	IAnimationSet *LoadAnimationSet(const String &FileName)
+	{
+		IAnimationSet *animationSet = Core::GetReference().GetRenderer()->LoadAnimationSet(FileName);
+
+		if (animationSet)
+			Track(AT_ANIMATION_SET, animationSet, Core::GetReference().GetAnimationPath() + FileName);
+
+		return animationSet;
+	}
+
+	IMaterial *LoadMaterial(const String &FileName)
+	{
+		IMaterial *material = Core::GetReference().GetRenderer()->LoadMaterial(FileName);
+
+		if (material)
+			Track(AT_MATERIAL, material, Core::GetReference().GetMaterialPath() + FileName);
+
+		return material;
+	}
+
+	//Like Core::CreateScene, a scene without a file isn't tracked
+	IScene *CreateScene(const String &FileName, const bool &InternalUse = false, const bool &LoadSync = false)
+	{
+		IScene *scene = Core::GetReference().CreateScene(FileName, InternalUse, LoadSync);
+
+		if (scene && FileName.GetLength())
+			Track(AT_SCENE, scene, Core::GetReference().GetScenePath() + FileName);
+
+		return scene;
+	}
+
+	//FilePath is the full path of the file Asset was loaded from, Asset is an ITexture, IAnimationSet, IMaterial or IScene
+	void Track(const AssetType &Type, void *Asset, const String &FilePath)
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+
+		TrackedFile &file = m_Files[Normalize(FilePath.GetBuffer())];
+
+		if (file.Assets.GetSize() == 0)
+		{
+			file.FilePath = FilePath;
+			file.ChangeTime = 0;
+		}
+
+		for (unsigned int i = 0; i < file.Assets.GetSize(); i++)
+			if (file.Assets[i].Asset == Asset)
+				return;
+
+		TrackedAsset asset;
+		asset.Type = Type;
+		asset.Asset = Asset;
+		file.Assets.Add(asset);
+	}
+
+	//Has to be called before a tracked texture, animation set or material is destroyed, scenes are untracked by Core
+	void Untrack(void *Asset)
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+
+		UntrackAsset(Asset);
+	}
+
+	void AddListener(IReloadListener *Listener)
+	{
+		m_Listeners.Add(Listener);
+	}
+
+	void RemoveListener(IReloadListener *Listener)
+	{
+		for (unsigned int i = 0; i < m_Listeners.GetSize(); i++)
+			if (m_Listeners[i] == Listener)
+			{
+				m_Listeners.Remove(i);
+				return;
+			}
+	}
+
+	//Number of assets reloaded since the start
+	const unsigned int &GetReloadCount(void) const
+	{
+		return m_ReloadCount;
+	}
+
+private:
+	void Do(void)
+	{
+		PROFILE_THREAD_NAME("AssetWatcher")
+
+		char *buffer = new char[BUFFER_SIZE];
+
+		OVERLAPPED overlapped;
+		memset(&overlapped, 0, sizeof(OVERLAPPED));
+		overlapped.hEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+
+		HANDLE events[] = { overlapped.hEvent, m_StopEvent };
+
+		bool watching = ReadChanges(buffer, overlapped);
+
+		while (watching)
+		{
+			const DWORD result = WaitForMultipleObjects(2, events, FALSE, GetWaitTime());
+
+			if (result == WAIT_OBJECT_0 + 1)
+				break;
+
+			if (result == WAIT_OBJECT_0)
+			{
+				DWORD size = 0;
+
+				if (GetOverlappedResult(m_Directory, &overlapped, &size, FALSE))
+				{
+					// 0 when the buffer overflowed, the changes are lost and only the next ones are seen
+					if (size)
+						AddChanges(buffer);
+				}
+
+				watching = ReadChanges(buffer, overlapped);
+			}
+
+			LoadSettledChanges();
+		}
+
+		CancelIo(m_Directory);
+		WaitForSingleObject(overlapped.hEvent, INFINITE);
+
+		CloseHandle(overlapped.hEvent);
+		delete []buffer;
+	}
+
+	bool ReadChanges(char *Buffer, OVERLAPPED &Overlapped)
+	{
+		ResetEvent(Overlapped.hEvent);
+
+		if (ReadDirectoryChangesW(m_Directory, Buffer, BUFFER_SIZE, TRUE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE, NULL, &Overlapped, NULL))
+			return true;
+
+		LOG_ERROR("Watching [" + m_DataPath + "] for changes failed")
+
+		return false;
+	}
+
+	//Marks the tracked files among the changed ones, a tool saving through a temporary file changes it by renaming
+	void AddChanges(const char *Buffer)
+	{
+		const unsigned long now = GetTickCount();
+
+		const std::string dataPath = Normalize(m_DataPath.GetBuffer());
+
+		std::lock_guard<std::mutex> lock(m_Lock);
+
+		const FILE_NOTIFY_INFORMATION *information = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(Buffer);
+
+		while (true)
+		{
+			if (information->Action == FILE_ACTION_MODIFIED || information->Action == FILE_ACTION_ADDED || information->Action == FILE_ACTION_RENAMED_NEW_NAME)
+			{
+				char name[MAX_PATH];
+				const int length = WideCharToMultiByte(CP_ACP, 0, information->FileName, information->FileNameLength / sizeof(WCHAR), name, MAX_PATH - 1, NULL, NULL);
+
+				if (length > 0)
+				{
+					name[length] = '\0';
+
+					TrackedFilesMap::iterator it = m_Files.find(dataPath + Normalize(name));
+
+					// 0 means no pending change
+					if (it != m_Files.end())
+						it->second.ChangeTime = (now ? now : 1);
+				}
+			}
+
+			if (!information->NextEntryOffset)
+				break;
+
+			information = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(reinterpret_cast<const char*>(information) + information->NextEntryOffset);
+		}
+	}
+
+	//Milliseconds until the next pending change settles, INFINITE if there's none
+	DWORD GetWaitTime(void)
+	{
+		const unsigned long now = GetTickCount();
+
+		DWORD wait = INFINITE;
+
+		std::lock_guard<std::mutex> lock(m_Lock);
+
+		FOR_EACH_MAP(it, m_Files)
+		{
+			if (!it->second.ChangeTime)
+				continue;
+
+			const unsigned long elapsed = now - it->second.ChangeTime;
+			const DWORD remaining = (elapsed >= m_DebounceTime ? 0 : m_DebounceTime - elapsed);
+
+			if (remaining < wait)
+				wait = remaining;
+		}
+
+		return wait;
+	}
+
+	//Reads the files which haven't changed for the debounce time
+	void LoadSettledChanges(void)
+	{
+		const unsigned long now = GetTickCount();
+
+		Vector<TrackedFile> settled;
+
+		{
+			std::lock_guard<std::mutex> lock(m_Lock);
+
+			FOR_EACH_MAP(it, m_Files)
+				if (it->second.ChangeTime && now - it->second.ChangeTime >= m_DebounceTime)
+				{
+					settled.Add(it->second);
+					it->second.ChangeTime = 0;
+				}
+		}
+
+		for (unsigned int i = 0; i < settled.GetSize(); i++)
+		{
+			const TrackedFile &file = settled[i];
+
+			LoadedChange change;
+			change.FilePath = file.FilePath;
+			change.Attributes = NULL;
+
+			if (!LoadFile(file, change))
+			{
+				// still being written, tried again after the debounce time
+				std::lock_guard<std::mutex> lock(m_Lock);
+
+				TrackedFilesMap::iterator it = m_Files.find(Normalize(file.FilePath.GetBuffer()));
+				if (it != m_Files.end() && !it->second.ChangeTime)
+					it->second.ChangeTime = GetTickCount();
+
+				continue;
+			}
+
+			std::lock_guard<std::mutex> lock(m_Lock);
+
+			m_LoadedChanges.Add(change);
+		}
+	}
+
+	//Textures are read through once so they come from the system cache when they're reloaded,
+	//the attributes of animation sets and materials are read, scenes are loaded by Core asynchronously
+	bool LoadFile(const TrackedFile &File, LoadedChange &Change)
+	{
+		PROFILE_SCOPE("AssetWatcher::LoadFile")
+
+		HANDLE file = CreateFileA(File.FilePath.GetBuffer(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		const AssetType &type = File.Assets[0].Type;
+
+		if (type == AT_TEXTURE)
+		{
+			char buffer[64 * 1024];
+			DWORD read;
+
+			while (ReadFile(file, buffer, sizeof(buffer), &read, NULL) && read)
+				;
+		}
+
+		CloseHandle(file);
+
+		if (type == AT_ANIMATION_SET || type == AT_MATERIAL)
+		{
+			// ReadText only reads and decrypts, the attributes of the top element are read here
+			StreamTreeParser parser(FileIO::GetReference().ReadText((type == AT_ANIMATION_SET ? FileIO::FT_ANIMATION : FileIO::FT_MATERIAL), File.FilePath));
+
+			StreamTreeParser::EventType event;
+			while ((event = parser.Next()) != StreamTreeParser::ET_ENTER && event != StreamTreeParser::ET_END && event != StreamTreeParser::ET_ERROR)
+				;
+
+			Change.Attributes = new HashedAttributes;
+
+			if (event != StreamTreeParser::ET_ENTER || !parser.ReadAttributes(Change.Attributes))
+			{
+				LOG_WARNING("Couldn't parse the changed file [" + File.FilePath + "]")
+
+				delete Change.Attributes;
+				Change.Attributes = NULL;
+
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	//Swaps the loaded changes in, on the main thread between frames
+	void OnBeforeUpdate(void)
+	{
+		PROFILE_SCOPE("AssetWatcher::OnBeforeUpdate")
+
+		UpdateLoadingScenes();
+
+		LoadedChangesList changes;
+
+		{
+			std::lock_guard<std::mutex> lock(m_Lock);
+
+			if (!m_LoadedChanges.GetSize())
+				return;
+
+			changes = m_LoadedChanges;
+			m_LoadedChanges.Clear();
+		}
+
+		for (unsigned int i = 0; i < changes.GetSize(); i++)
+		{
+			LoadedChange &change = changes[i];
+
+			Vector<TrackedAsset> assets;
+
+			{
+				std::lock_guard<std::mutex> lock(m_Lock);
+
+				TrackedFilesMap::iterator it = m_Files.find(Normalize(change.FilePath.GetBuffer()));
+				if (it != m_Files.end())
+					assets = it->second.Assets;
+			}
+
+			for (unsigned int j = 0; j < assets.GetSize(); j++)
+				Reload(assets[j], change);
+
+			if (change.Attributes)
+				delete change.Attributes;
+		}
+	}
+
+	void Reload(const TrackedAsset &Asset, const LoadedChange &Change)
+	{
+		LOG_INFO("Reloading [" + Change.FilePath + "]")
+
+		switch (Asset.Type)
+		{
+		case AT_TEXTURE:
+			static_cast<ITexture*>(Asset.Asset)->Reload();
+			break;
+
+		case AT_ANIMATION_SET:
+		case AT_MATERIAL:
+			{
+				if (!Change.Attributes)
+					return;
+
+				ISerializable *serializable = (Asset.Type == AT_ANIMATION_SET ? static_cast<ISerializable*>(static_cast<IAnimationSet*>(Asset.Asset)) : static_cast<ISerializable*>(static_cast<IMaterial*>(Asset.Asset)));
+
+				if (!serializable->Deserialize(Change.Attributes))
+				{
+					LOG_WARNING("Couldn't reload [" + Change.FilePath + "]")
+					return;
+				}
+			} break;
+
+		case AT_SCENE:
+			{
+				IScene *oldScene = static_cast<IScene*>(Asset.Asset);
+
+				for (unsigned int i = 0; i < m_LoadingScenes.GetSize(); i++)
+					if (m_LoadingScenes[i].OldScene == oldScene)
+						return;
+
+				LoadingScene loading;
+				loading.OldScene = oldScene;
+				loading.NewScene = Core::GetReference().CreateScene(oldScene->GetName(), false, false);
+				loading.FilePath = Change.FilePath;
+
+				if (!loading.NewScene || loading.NewScene == oldScene)
+				{
+					LOG_WARNING("Couldn't reload [" + Change.FilePath + "]")
+					return;
+				}
+
+				m_LoadingScenes.Add(loading);
+			} return;
+		}
+
+		m_ReloadCount++;
+
+		for (unsigned int i = 0; i < m_Listeners.GetSize(); i++)
+			m_Listeners[i]->OnAssetReloaded(Asset.Type, Asset.Asset, Change.FilePath);
+	}
+
+	//Replaces the old scenes with the reloaded ones which are ready
+	void UpdateLoadingScenes(void)
+	{
+		for (unsigned int i = 0; i < m_LoadingScenes.GetSize();)
+		{
+			const LoadingScene loading = m_LoadingScenes[i];
+
+			if (!loading.NewScene->GetLoaded())
+			{
+				i++;
+				continue;
+			}
+
+			m_LoadingScenes.Remove(i);
+
+			if (!loading.OldScene)
+			{
+				Core::GetReference().DestroyScene(loading.NewScene);
+				continue;
+			}
+
+			Track(AT_SCENE, loading.NewScene, loading.FilePath);
+
+			if (Core::GetReference().GetCurrentScene() == loading.OldScene)
+				Core::GetReference().SetCurrentScene(loading.NewScene);
+
+			m_ReloadCount++;
+
+			for (unsigned int j = 0; j < m_Listeners.GetSize(); j++)
+				m_Listeners[j]->OnAssetReloaded(AT_SCENE, loading.NewScene, loading.FilePath);
+
+			Core::GetReference().DestroyScene(loading.OldScene);
+		}
+	}
+
+	void OnBeforeSceneRemoved(IScene *Scene)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Lock);
+
+			UntrackAsset(Scene);
+		}
+
+		// destroyed while its reload is loading, the reloaded one is dropped
+		for (unsigned int i = 0; i < m_LoadingScenes.GetSize(); i++)
+			if (m_LoadingScenes[i].OldScene == Scene)
+			{
+				m_LoadingScenes[i].OldScene = NULL;
+				return;
+			}
+	}
+
+	void OnSceneAdded(IScene *Scene)
+	{
+	}
+
+	void OnSetCurrentScene(IScene *Scene)
+	{
+	}
+
+	void OnAfterUpdate(void)
+	{
+	}
+
+	void OnBeforeRender(void)
+	{
+	}
+
+	void OnAfterRender(void)
+	{
+	}
+
+	void UntrackAsset(void *Asset)
+	{
+		for (TrackedFilesMap::iterator it = m_Files.begin(); it != m_Files.end();)
+		{
+			Vector<TrackedAsset> &assets = it->second.Assets;
+
+			for (unsigned int i = 0; i < assets.GetSize(); i++)
+				if (assets[i].Asset == Asset)
+				{
+					assets.Remove(i);
+					break;
+				}
+
+			if (assets.GetSize() == 0)
+				it = m_Files.erase(it);
+			else
+				it++;
+		}
+	}
+
+	//Lower case with '/' separators, like the paths of packs
+	static std::string Normalize(const char *FilePath)
+	{
+		std::string path;
+
+		for (; *FilePath; FilePath++)
+			path += (*FilePath == '\\' ? '/' : (*FilePath >= 'A' && *FilePath <= 'Z' ? *FilePath - 'A' + 'a' : *FilePath));
+
+		return path;
+	}
+
+private:
+	AssetWatcher(const AssetWatcher &Other);
+	void operator =(const AssetWatcher &Other);
+
+private:
+	IThread *m_Thread;
+	HANDLE m_Directory;
+	HANDLE m_StopEvent;
+
+	String m_DataPath;
+	unsigned int m_DebounceTime;
+
+	std::mutex m_Lock;
+	TrackedFilesMap m_Files;
+	LoadedChangesList m_LoadedChanges;
+
+	//Only used on the main thread
+	LoadingScenesList m_LoadingScenes;
+	IReloadListenersList m_Listeners;
+	unsigned int m_ReloadCount;
+};
+
+END_NAMESPACE
\ No newline at end of file
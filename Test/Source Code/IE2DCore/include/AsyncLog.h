@@ -0,0 +1,925 @@
+///////////////////////////////////////////////////////////////////////////////////
+///
+///  Impressive Engine 2D
+///
+/// Copyright (c) 2012-2013 Impressive Reality team
+///
+/// The license is
+///
+/// Permission is denied, to any person or company
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Project leader : O.Shahbazi <sh_omid_m@yahoo.com>
+///////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Common.h"
+
+#ifdef USE_LOG
+
+#include "Log.h"
+#include "IFile.h"
+#include "IThreadWorker.h"
+#include "ThreadManager.h"
+#include <Windows.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <stdio.h>
+#include <string.h>
+
+
+//Logs Format with its arguments, every {} of Format is replaced by the next argument.
+//Format is interned once per call site, so it has to be a string literal.
+//The ID of the call site is a constant initialized static set with a compare exchange,
+//function-local statics initialized by a call aren't thread safe in VS2013
+#define LOG_FORMAT(Type, Format, ...) \
+	{ \
+		static volatile long logFormatSiteID = 0; \
+		AsyncLog::GetReference().AddFormat(Type, AsyncLog::GetReference().GetFormatID(logFormatSiteID, Format), __VA_ARGS__); \
+	}
+
+#define LOG_TEXT_FORMAT(Format, ...) LOG_FORMAT(AsyncLog::MT_TEXT, Format, __VA_ARGS__)
+#define LOG_INFO_FORMAT(Format, ...) LOG_FORMAT(AsyncLog::MT_INFO, Format, __VA_ARGS__)
+#define LOG_WARNING_FORMAT(Format, ...) LOG_FORMAT(AsyncLog::MT_WARNING, Format, __VA_ARGS__)
+#define LOG_ERROR_FORMAT(Format, ...) LOG_FORMAT(AsyncLog::MT_ERROR, Format, __VA_ARGS__)
+
+#define GET_ASYNC_LOG_FUNCTION IE2DGetAsyncLog
+
+#define GET_ASYNC_LOG_FUNCTION_STRING "IE2DGetAsyncLog"
+
+//In one source file of the executable which starts the AsyncLog. The scripts and the plugins
+//are modules with their own copy of AsyncLog::GetReference, with this they find the AsyncLog
+//of the executable and log through it. A module which logs formats mustn't be unloaded
+//while the log runs, its format strings are read on the logging thread
+#define EXPORT_ASYNC_LOG extern "C" __declspec(dllexport) AsyncLog *GET_ASYNC_LOG_FUNCTION(void) \
+							{ \
+								return &AsyncLog::GetModuleReference(); \
+							}
+
+
+BEGIN_NAMESPACE
+
+//<Description>
+//Logs from any thread without waiting on formatting, the file or the listeners.
+//Every thread copies its messages as fixed size records, stamped with the time, into
+//its own lock free ring. The logging thread merges the rings by time, formats the
+//records, writes them to the file in one go and notifies the listeners.
+//Until Start and after Stop messages go straight to Log, like before.
+//A message either holds its text, or an interned format and up to four arguments
+//which are only turned into text on the logging thread, see LOG_INFO_FORMAT
+class AsyncLog : public IThreadWorker
+{
+public:
+	enum MessageType
+	{
+		MT_TEXT = 0,
+		MT_INFO,
+		MT_WARNING,
+		MT_ERROR
+	};
+
+	//What a thread does when its ring is full
+	enum OverflowPolicy
+	{
+		//The message is dropped, the logging thread reports how many were dropped
+		OP_DROP = 0,
+		//The thread waits until the logging thread makes room
+		OP_BLOCK
+	};
+
+	//Listeners are notified on the logging thread
+	typedef Log::IListener IListener;
+
+	typedef AsyncLog *(*GetAsyncLogFunction)(void);
+
+	//<Description>
+	//Argument of a formatted message, copied into the record by value
+	class Argument
+	{
+		friend class AsyncLog;
+
+	public:
+		enum Type
+		{
+			T_NONE = 0,
+			T_INTEGER,
+			T_UNSIGNED,
+			T_FLOAT,
+			T_BOOL,
+			T_TEXT
+		};
+
+	public:
+		Argument(void) :
+			m_Type(T_NONE),
+			m_Unsigned(0)
+		{
+		}
+
+		Argument(const int &Value) :
+			m_Type(T_INTEGER),
+			m_Integer(Value)
+		{
+		}
+
+		Argument(const long &Value) :
+			m_Type(T_INTEGER),
+			m_Integer(Value)
+		{
+		}
+
+		Argument(const long long &Value) :
+			m_Type(T_INTEGER),
+			m_Integer(Value)
+		{
+		}
+
+		Argument(const unsigned int &Value) :
+			m_Type(T_UNSIGNED),
+			m_Unsigned(Value)
+		{
+		}
+
+		Argument(const unsigned long &Value) :
+			m_Type(T_UNSIGNED),
+			m_Unsigned(Value)
+		{
+		}
+
+		Argument(const unsigned long long &Value) :
+			m_Type(T_UNSIGNED),
+			m_Unsigned(Value)
+		{
+		}
+
+		Argument(const float &Value) :
+			m_Type(T_FLOAT),
+			m_Float(Value)
+		{
+		}
+
+		Argument(const double &Value) :
+			m_Type(T_FLOAT),
+			m_Float(Value)
+		{
+		}
+
+		Argument(const bool &Value) :
+			m_Type(T_BOOL),
+			m_Unsigned(Value)
+		{
+		}
+
+		Argument(const char *Value) :
+			m_Type(T_TEXT),
+			m_Text(Value ? Value : ""),
+			m_TextLength(Value ? (unsigned int)strlen(Value) : 0)
+		{
+		}
+
+		Argument(const String &Value) :
+			m_Type(T_TEXT),
+			m_Text(Value.GetBuffer()),
+			m_TextLength(Value.GetLength())
+		{
+		}
+
+	private:
+		//Copies the argument to Buffer, returns the size written or 0 if it doesn't fit
+		unsigned int Write(unsigned char *Buffer, const unsigned int &Available) const
+		{
+			if (m_Type == T_TEXT)
+			{
+				if (Available < 3)
+					return 0;
+
+				const unsigned short length = (unsigned short)(m_TextLength < Available - 3 ? m_TextLength : Available - 3);
+
+				Buffer[0] = (unsigned char)m_Type;
+				memcpy(Buffer + 1, &length, 2);
+				memcpy(Buffer + 3, m_Text, length);
+
+				return 3 + length;
+			}
+
+			if (Available < 9)
+				return 0;
+
+			Buffer[0] = (unsigned char)m_Type;
+			memcpy(Buffer + 1, &m_Unsigned, 8);
+
+			return 9;
+		}
+
+	private:
+		Type m_Type;
+
+		union
+		{
+			long long m_Integer;
+			unsigned long long m_Unsigned;
+			double m_Float;
+		};
+
+		const char *m_Text;
+		unsigned int m_TextLength;
+	};
+
+private:
+	static const unsigned int SLOT_SIZE = 64;
+	static const unsigned int MAX_RECORD_SIZE = 4096;
+	static const unsigned char PADDING_TYPE = 0xFF;
+
+	//Followed by Size bytes of text, or of the arguments when FormatID isn't 0
+	struct RecordHeader
+	{
+	public:
+		unsigned long long Time;
+		unsigned short FormatID;
+		unsigned short SlotCount;
+		unsigned short Size;
+		unsigned char Type;
+		unsigned char ArgumentCount;
+	};
+
+	struct Slot
+	{
+	public:
+		unsigned long long Data[SLOT_SIZE / sizeof(unsigned long long)];
+	};
+
+	//Written only by its own thread and read only by the logging thread.
+	//A record takes whole slots and never wraps, the slots left at the end are skipped by a padding record
+	class ThreadRing
+	{
+	public:
+		ThreadRing(const unsigned int &SlotCount) :
+			Slots(new Slot[SlotCount]),
+			SlotCount(SlotCount),
+			Read(0),
+			Write(0),
+			Dropped(0)
+		{
+			// touches the pages now, not while the thread logs
+			memset(Slots, 0, SlotCount * sizeof(Slot));
+		}
+
+		~ThreadRing(void)
+		{
+			delete []Slots;
+		}
+
+		RecordHeader &GetRecord(const unsigned int &Index)
+		{
+			return *reinterpret_cast<RecordHeader*>(&Slots[Index & (SlotCount - 1)]);
+		}
+
+	public:
+		Slot *Slots;
+		const unsigned int SlotCount;
+
+		std::atomic<unsigned int> Read;
+		std::atomic<unsigned int> Write;
+		std::atomic<unsigned int> Dropped;
+	};
+
+	struct RingCursor
+	{
+	public:
+		ThreadRing *Ring;
+		unsigned int Read;
+		unsigned int End;
+	};
+
+	typedef Vector<ThreadRing*> ThreadRingsList;
+	typedef Vector<RingCursor> RingCursorsList;
+	typedef Vector<const char*> FormatsList;
+	typedef Vector<IListener*> IListenersList;
+
+public:
+	AsyncLog(void) :
+		m_File(NULL),
+		m_Thread(NULL),
+		m_Policy(OP_DROP),
+		m_RingSize(4096),
+		m_FlushInterval(10),
+		m_Running(false),
+		m_FlushingThread(0),
+		m_DroppedCount(0),
+		m_StartTicks(0),
+		m_Frequency(1),
+		m_StartMilliseconds(0),
+		m_PreviousFilter(NULL)
+	{
+		m_WakeEvent = CreateEventA(NULL, FALSE, FALSE, NULL);
+	}
+
+	~AsyncLog(void)
+	{
+		Stop();
+
+		for (unsigned int i = 0; i < m_Rings.GetSize(); i++)
+			delete m_Rings[i];
+
+		CloseHandle(m_WakeEvent);
+	}
+
+	//The AsyncLog the executable exports with EXPORT_ASYNC_LOG, or the one of this module if it doesn't
+	static AsyncLog &GetReference(void)
+	{
+		// constant initialized, threads which look it up at once find the same instance
+		static AsyncLog *volatile instance = NULL;
+
+		if (!instance)
+		{
+			GetAsyncLogFunction function = (GetAsyncLogFunction)GetProcAddress(GetModuleHandleA(NULL), GET_ASYNC_LOG_FUNCTION_STRING);
+
+			instance = (function ? function() : &GetModuleReference());
+		}
+
+		return *instance;
+	}
+
+	static AsyncLog &GetModuleReference(void)
+	{
+		static AsyncLog instance;
+
+		return instance;
+	}
+
+	//Starts the logging thread, it writes to File and deletes it on Stop.
+	//RingSize is the number of 64 bytes slots of each thread's ring, rounded up to a power of 2.
+	//The rings are flushed every FlushInterval milliseconds, or sooner when one gets half full
+	void Start(IFile *File, const OverflowPolicy &Policy = OP_DROP, const unsigned int &RingSize = 4096, const unsigned int &FlushInterval = 10)
+	{
+		if (m_Thread)
+			return;
+
+		m_File = File;
+		m_Policy = Policy;
+		m_FlushInterval = FlushInterval;
+
+		m_RingSize = 2 * MAX_RECORD_SIZE / SLOT_SIZE;
+		while (m_RingSize < RingSize)
+			m_RingSize *= 2;
+
+		LARGE_INTEGER value;
+		QueryPerformanceFrequency(&value);
+		m_Frequency = value.QuadPart;
+		QueryPerformanceCounter(&value);
+		m_StartTicks = value.QuadPart;
+
+		SYSTEMTIME time;
+		GetLocalTime(&time);
+		m_StartMilliseconds = ((time.wHour * 60 + time.wMinute) * 60 + time.wSecond) * 1000ULL + time.wMilliseconds;
+
+		m_Running.store(true, std::memory_order_release);
+
+		m_Thread = ThreadManager::GetReference().CreateThread(this);
+	}
+
+	//Writes what's queued and stops the logging thread, messages go to Log again
+	void Stop(void)
+	{
+		if (!m_Thread)
+			return;
+
+		m_Running.store(false, std::memory_order_release);
+		SetEvent(m_WakeEvent);
+
+		m_Thread->Join();
+		ThreadManager::GetReference().DestroyThread(m_Thread);
+		m_Thread = NULL;
+
+		// queued while the thread was stopping
+		Flush();
+
+		if (m_File)
+		{
+			m_File->Close();
+			delete m_File;
+			m_File = NULL;
+		}
+	}
+
+	const bool IsRunning(void) const
+	{
+		return m_Running.load(std::memory_order_acquire);
+	}
+
+	//Returns the ID of Format to pass to AddFormat, Format has to stay valid like a string literal
+	unsigned short RegisterFormat(const char *Format)
+	{
+		std::lock_guard<std::mutex> lock(m_FormatsLock);
+
+		for (unsigned int i = 0; i < m_Formats.GetSize(); i++)
+			if (m_Formats[i] == Format)
+				return (unsigned short)(i + 1);
+
+		if (m_Formats.GetSize() == 0xFFFF)
+			return 0;
+
+		m_Formats.Add(Format);
+
+		return (unsigned short)m_Formats.GetSize();
+	}
+
+	//ID of a call site of LOG_FORMAT, SiteID starts at 0 and Format is registered the first time.
+	//Threads which get there at once register the same Format, so they set the same ID
+	unsigned short GetFormatID(volatile long &SiteID, const char *Format)
+	{
+		if (!SiteID)
+			InterlockedCompareExchange(&SiteID, RegisterFormat(Format), 0);
+
+		return (unsigned short)SiteID;
+	}
+
+	void Add(const MessageType &Type, const String &Text)
+	{
+		if (!m_Running.load(std::memory_order_acquire))
+		{
+			AddToLog(Type, Text);
+			return;
+		}
+
+		unsigned long long record[MAX_RECORD_SIZE / sizeof(unsigned long long)];
+		RecordHeader &header = *reinterpret_cast<RecordHeader*>(record);
+
+		const unsigned int available = MAX_RECORD_SIZE - sizeof(RecordHeader);
+
+		header.Type = (unsigned char)Type;
+		header.FormatID = 0;
+		header.ArgumentCount = 0;
+		header.Size = (unsigned short)(Text.GetLength() < available ? Text.GetLength() : available);
+		memcpy(&header + 1, Text.GetBuffer(), header.Size);
+
+		Submit(header);
+	}
+
+	void AddFormat(const MessageType &Type, const unsigned short &FormatID, const Argument &Argument1, const Argument &Argument2 = Argument(), const Argument &Argument3 = Argument(), const Argument &Argument4 = Argument())
+	{
+		unsigned long long record[MAX_RECORD_SIZE / sizeof(unsigned long long)];
+		RecordHeader &header = *reinterpret_cast<RecordHeader*>(record);
+		unsigned char *payload = reinterpret_cast<unsigned char*>(&header + 1);
+
+		const unsigned int available = MAX_RECORD_SIZE - sizeof(RecordHeader);
+
+		header.Type = (unsigned char)Type;
+		header.FormatID = FormatID;
+		header.ArgumentCount = 0;
+		header.Size = 0;
+
+		const Argument *arguments[] = { &Argument1, &Argument2, &Argument3, &Argument4 };
+
+		for (unsigned int i = 0; i < 4 && arguments[i]->m_Type != Argument::T_NONE; i++)
+		{
+			const unsigned int size = arguments[i]->Write(payload + header.Size, available - header.Size);
+
+			if (!size)
+				break;
+
+			header.Size += size;
+			header.ArgumentCount++;
+		}
+
+		Submit(header);
+	}
+
+	//Writes every queued message now, returns how many were written
+	unsigned int Flush(void)
+	{
+		std::lock_guard<std::mutex> lock(m_FlushLock);
+
+		return FlushRecords();
+	}
+
+	//Flushes the rings when the process crashes, before the previous handler runs
+	void InstallCrashHandler(void)
+	{
+		m_PreviousFilter = SetUnhandledExceptionFilter(&AsyncLog::OnUnhandledException);
+	}
+
+	void AddListener(IListener *Listener)
+	{
+		std::lock_guard<std::mutex> lock(m_FlushLock);
+
+		m_Listeners.Add(Listener);
+	}
+
+	void RemoveListener(IListener *Listener)
+	{
+		std::lock_guard<std::mutex> lock(m_FlushLock);
+
+		for (unsigned int i = 0; i < m_Listeners.GetSize(); i++)
+			if (m_Listeners[i] == Listener)
+			{
+				m_Listeners.Remove(i);
+				return;
+			}
+	}
+
+	//Number of messages dropped because a ring was full
+	const unsigned int GetDroppedCount(void) const
+	{
+		return m_DroppedCount.load(std::memory_order_relaxed);
+	}
+
+	void Do(void)
+	{
+		while (m_Running.load(std::memory_order_acquire))
+		{
+			WaitForSingleObject(m_WakeEvent, m_FlushInterval);
+
+			Flush();
+		}
+	}
+
+private:
+	void Submit(RecordHeader &Header)
+	{
+		if (m_Running.load(std::memory_order_acquire) && Push(Header))
+			return;
+
+		std::string text;
+		FormatRecord(Header, text);
+
+		AddToLog((MessageType)Header.Type, String(text.c_str(), (int)text.size()));
+	}
+
+	//Copies the record to the ring of the calling thread, false if the logging thread stopped meanwhile
+	bool Push(RecordHeader &Header)
+	{
+		ThreadRing &ring = GetThreadRing();
+
+		const unsigned int slotCount = ((unsigned int)sizeof(RecordHeader) + Header.Size + SLOT_SIZE - 1) / SLOT_SIZE;
+		const unsigned int write = ring.Write.load(std::memory_order_relaxed);
+		const unsigned int position = write & (ring.SlotCount - 1);
+		const unsigned int padding = (position + slotCount > ring.SlotCount ? ring.SlotCount - position : 0);
+
+		unsigned int used = write - ring.Read.load(std::memory_order_acquire);
+
+		while (used + padding + slotCount > ring.SlotCount)
+		{
+			if (m_Policy == OP_DROP)
+			{
+				ring.Dropped.fetch_add(1, std::memory_order_relaxed);
+				return true;
+			}
+
+			if (!m_Running.load(std::memory_order_acquire))
+				return false;
+
+			SetEvent(m_WakeEvent);
+			Sleep(0);
+
+			used = write - ring.Read.load(std::memory_order_acquire);
+		}
+
+		if (padding)
+		{
+			RecordHeader &paddingHeader = ring.GetRecord(write);
+			paddingHeader.Type = PADDING_TYPE;
+			paddingHeader.SlotCount = (unsigned short)padding;
+		}
+
+		Header.Time = GetTicks();
+		Header.SlotCount = (unsigned short)slotCount;
+
+		memcpy(&ring.GetRecord(write + padding), &Header, sizeof(RecordHeader) + Header.Size);
+
+		ring.Write.store(write + padding + slotCount, std::memory_order_release);
+
+		// the logging thread is woken early once the ring gets half full
+		const unsigned int half = ring.SlotCount / 2;
+		if (used < half && used + padding + slotCount >= half)
+			SetEvent(m_WakeEvent);
+
+		return true;
+	}
+
+	ThreadRing &GetThreadRing(void)
+	{
+		static THREAD_LOCAL ThreadRing *ring = NULL;
+
+		if (!ring)
+		{
+			ring = new ThreadRing(m_RingSize);
+
+			std::lock_guard<std::mutex> lock(m_RingsLock);
+			m_Rings.Add(ring);
+		}
+
+		return *ring;
+	}
+
+	//Needs m_FlushLock
+	unsigned int FlushRecords(void)
+	{
+		m_FlushingThread.store(GetCurrentThreadId(), std::memory_order_relaxed);
+
+		{
+			std::lock_guard<std::mutex> lock(m_RingsLock);
+
+			for (unsigned int i = m_Cursors.GetSize(); i < m_Rings.GetSize(); i++)
+			{
+				RingCursor cursor;
+				cursor.Ring = m_Rings[i];
+
+				m_Cursors.Add(cursor);
+			}
+		}
+
+		for (unsigned int i = 0; i < m_Cursors.GetSize(); i++)
+		{
+			m_Cursors[i].Read = m_Cursors[i].Ring->Read.load(std::memory_order_relaxed);
+			m_Cursors[i].End = m_Cursors[i].Ring->Write.load(std::memory_order_acquire);
+		}
+
+		m_Buffer.clear();
+
+		unsigned int count = 0;
+
+		for (unsigned int i = 0; i < m_Cursors.GetSize(); i++)
+		{
+			const unsigned int dropped = m_Cursors[i].Ring->Dropped.exchange(0, std::memory_order_relaxed);
+
+			if (dropped)
+			{
+				m_DroppedCount.fetch_add(dropped, std::memory_order_relaxed);
+
+				char text[64];
+				sprintf_s(text, sizeof(text), "%u log messages were dropped", dropped);
+
+				WriteMessage(MT_WARNING, GetTicks(), text);
+			}
+		}
+
+		// the oldest record of all rings goes first
+		while (true)
+		{
+			RingCursor *oldest = NULL;
+
+			for (unsigned int i = 0; i < m_Cursors.GetSize(); i++)
+			{
+				RingCursor &cursor = m_Cursors[i];
+
+				while (cursor.Read != cursor.End && cursor.Ring->GetRecord(cursor.Read).Type == PADDING_TYPE)
+					cursor.Read += cursor.Ring->GetRecord(cursor.Read).SlotCount;
+
+				if (cursor.Read != cursor.End && (!oldest || cursor.Ring->GetRecord(cursor.Read).Time < oldest->Ring->GetRecord(oldest->Read).Time))
+					oldest = &cursor;
+			}
+
+			if (!oldest)
+				break;
+
+			const RecordHeader &header = oldest->Ring->GetRecord(oldest->Read);
+
+			m_Text.clear();
+			FormatRecord(header, m_Text);
+
+			WriteMessage((MessageType)header.Type, header.Time, m_Text);
+
+			oldest->Read += header.SlotCount;
+			oldest->Ring->Read.store(oldest->Read, std::memory_order_release);
+
+			count++;
+		}
+
+		for (unsigned int i = 0; i < m_Cursors.GetSize(); i++)
+			m_Cursors[i].Ring->Read.store(m_Cursors[i].Read, std::memory_order_release);
+
+		if (m_File && m_Buffer.size())
+			*m_File << String(m_Buffer.c_str(), (int)m_Buffer.size());
+
+		m_FlushingThread.store(0, std::memory_order_relaxed);
+
+		return count;
+	}
+
+	//Appends the line to the file buffer and notifies the listeners
+	void WriteMessage(const MessageType &Type, const unsigned long long &Time, const std::string &Text)
+	{
+		const unsigned long long milliseconds = (m_StartMilliseconds + (Time - m_StartTicks) * 1000 / m_Frequency) % (24 * 60 * 60 * 1000ULL);
+
+		char prefix[32];
+		sprintf_s(prefix, sizeof(prefix), "%02u:%02u:%02u.%03u ", (unsigned int)(milliseconds / 3600000), (unsigned int)(milliseconds / 60000 % 60), (unsigned int)(milliseconds / 1000 % 60), (unsigned int)(milliseconds % 1000));
+
+		m_Buffer += prefix;
+
+		if (Type == MT_WARNING)
+			m_Buffer += "[Warning] ";
+		else if (Type == MT_ERROR)
+			m_Buffer += "[Error] ";
+
+		m_Buffer += Text;
+		m_Buffer += '\n';
+
+		if (Type == MT_TEXT || !m_Listeners.GetSize())
+			return;
+
+		const String text(Text.c_str(), (int)Text.size());
+
+		for (unsigned int i = 0; i < m_Listeners.GetSize(); i++)
+			if (Type == MT_INFO)
+				m_Listeners[i]->OnAddInfo(text);
+			else if (Type == MT_WARNING)
+				m_Listeners[i]->OnAddWarning(text);
+			else
+				m_Listeners[i]->OnAddError(text);
+	}
+
+	//Appends the text of the record to Text, the arguments which don't have a {} left are appended after a space
+	void FormatRecord(const RecordHeader &Header, std::string &Text)
+	{
+		const unsigned char *payload = reinterpret_cast<const unsigned char*>(&Header + 1);
+
+		if (!Header.FormatID && !Header.ArgumentCount)
+		{
+			Text.append(reinterpret_cast<const char*>(payload), Header.Size);
+			return;
+		}
+
+		const char *format = "";
+
+		{
+			std::lock_guard<std::mutex> lock(m_FormatsLock);
+
+			if (Header.FormatID && Header.FormatID <= m_Formats.GetSize())
+				format = m_Formats[Header.FormatID - 1];
+		}
+
+		for (unsigned int i = 0; i < Header.ArgumentCount; i++)
+		{
+			const char *placeholder = strstr(format, "{}");
+
+			if (placeholder)
+			{
+				Text.append(format, placeholder - format);
+				format = placeholder + 2;
+			}
+			else
+			{
+				Text += format;
+				Text += ' ';
+				format = "";
+			}
+
+			payload += FormatArgument(payload, Text);
+		}
+
+		Text += format;
+	}
+
+	//Appends the argument at Data to Text, returns its size
+	static unsigned int FormatArgument(const unsigned char *Data, std::string &Text)
+	{
+		if (Data[0] == Argument::T_TEXT)
+		{
+			unsigned short length;
+			memcpy(&length, Data + 1, 2);
+
+			Text.append(reinterpret_cast<const char*>(Data + 3), length);
+
+			return 3 + length;
+		}
+
+		char text[32];
+
+		switch (Data[0])
+		{
+		case Argument::T_INTEGER:
+			{
+				long long value;
+				memcpy(&value, Data + 1, 8);
+				sprintf_s(text, sizeof(text), "%lld", value);
+			} break;
+
+		case Argument::T_UNSIGNED:
+			{
+				unsigned long long value;
+				memcpy(&value, Data + 1, 8);
+				sprintf_s(text, sizeof(text), "%llu", value);
+			} break;
+
+		case Argument::T_FLOAT:
+			{
+				double value;
+				memcpy(&value, Data + 1, 8);
+				sprintf_s(text, sizeof(text), "%g", value);
+			} break;
+
+		default:
+			{
+				unsigned long long value;
+				memcpy(&value, Data + 1, 8);
+				strcpy_s(text, sizeof(text), (value ? "true" : "false"));
+			}
+		}
+
+		Text += text;
+
+		return 9;
+	}
+
+	static void AddToLog(const MessageType &Type, const String &Text)
+	{
+		switch (Type)
+		{
+		case MT_INFO:
+			Log::GetReference().AddInfo(Text);
+			break;
+
+		case MT_WARNING:
+			Log::GetReference().AddWarning(Text);
+			break;
+
+		case MT_ERROR:
+			Log::GetReference().AddError(Text);
+			break;
+
+		default:
+			Log::GetReference().AddText(Text);
+		}
+	}
+
+	static unsigned long long GetTicks(void)
+	{
+		LARGE_INTEGER value;
+		QueryPerformanceCounter(&value);
+
+		return value.QuadPart;
+	}
+
+	static LONG WINAPI OnUnhandledException(EXCEPTION_POINTERS *Exception)
+	{
+		AsyncLog &log = GetReference();
+
+		// crashed while flushing, it would only crash again
+		if (log.m_Thread && log.m_FlushingThread.load(std::memory_order_relaxed) != GetCurrentThreadId())
+		{
+			bool locked = false;
+
+			for (unsigned int i = 0; i < 100 && !(locked = log.m_FlushLock.try_lock()); i++)
+				Sleep(1);
+
+			if (locked)
+			{
+				log.FlushRecords();
+
+				if (log.m_File)
+					log.m_File->Close();
+
+				log.m_FlushLock.unlock();
+			}
+		}
+
+		if (log.m_PreviousFilter)
+			return log.m_PreviousFilter(Exception);
+
+		return EXCEPTION_CONTINUE_SEARCH;
+	}
+
+private:
+	AsyncLog(const AsyncLog &Other);
+	void operator =(const AsyncLog &Other);
+
+private:
+	IFile *m_File;
+	IThread *m_Thread;
+	HANDLE m_WakeEvent;
+
+	OverflowPolicy m_Policy;
+	unsigned int m_RingSize;
+	unsigned int m_FlushInterval;
+
+	std::atomic<bool> m_Running;
+	std::atomic<unsigned long> m_FlushingThread;
+	std::atomic<unsigned int> m_DroppedCount;
+
+	std::mutex m_RingsLock;
+	ThreadRingsList m_Rings;
+
+	std::mutex m_FormatsLock;
+	FormatsList m_Formats;
+
+	//Guards the flush state and the listeners
+	std::mutex m_FlushLock;
+	RingCursorsList m_Cursors;
+	std::string m_Text;
+	std::string m_Buffer;
+	IListenersList m_Listeners;
+
+	unsigned long long m_StartTicks;
+	unsigned long long m_Frequency;
+	unsigned long long m_StartMilliseconds;
+
+	LPTOP_LEVEL_EXCEPTION_FILTER m_PreviousFilter;
+};
+
+END_NAMESPACE
+
+#endif
\ No newline at end of file
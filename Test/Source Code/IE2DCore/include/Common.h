@@ -23,6 +23,11 @@
 //#define LAUNCH_MODE
 
 
+#ifndef LAUNCH_MODE
+	#define USE_PROFILER
+#endif
+
+
 #define USE_BREAK_PROCESS_IF
 #ifdef USE_BREAK_PROCESS_IF
 	#define BREAK_PROCESS_IF(Value) if (Value) \
@@ -35,11 +40,19 @@
 
 
 #define USE_LOG
+#define USE_ASYNC_LOG
 #ifdef USE_LOG
-	#define LOG_TEXT(Text) Log::GetReference().AddText(Text);
-	#define LOG_INFO(Text) Log::GetReference().AddInfo(Text);
-	#define LOG_WARNING(Text) Log::GetReference().AddWarning(Text);
-	#define LOG_ERROR(Text) Log::GetReference().AddError(Text);
+	#ifdef USE_ASYNC_LOG
+		#define LOG_TEXT(Text) AsyncLog::GetReference().Add(AsyncLog::MT_TEXT, Text);
+		#define LOG_INFO(Text) AsyncLog::GetReference().Add(AsyncLog::MT_INFO, Text);
+		#define LOG_WARNING(Text) AsyncLog::GetReference().Add(AsyncLog::MT_WARNING, Text);
+		#define LOG_ERROR(Text) AsyncLog::GetReference().Add(AsyncLog::MT_ERROR, Text);
+	#else
+		#define LOG_TEXT(Text) Log::GetReference().AddText(Text);
+		#define LOG_INFO(Text) Log::GetReference().AddInfo(Text);
+		#define LOG_WARNING(Text) Log::GetReference().AddWarning(Text);
+		#define LOG_ERROR(Text) Log::GetReference().AddError(Text);
+	#endif
 #else
 	#define LOG_TEXT(Text);
 	#define LOG_INFO(Text);
@@ -42,6 +42,23 @@ public:
 		return m_Holder;
 	}
 
+	//Pooled components give their slot back to ComponentRegistry, Size is the one of the type deleted
+	static void *operator new(size_t Size)
+	{
+		return ::operator new(Size);
+	}
+
+	static void *operator new(size_t Size, void *Memory)
+	{
+		return Memory;
+	}
+
+	static void operator delete(void *Memory, size_t Size);
+
+	static void operator delete(void *Memory, void *Place)
+	{
+	}
+
 private:
 	void SetHolder(IGameObject *Holder)
 	{
@@ -58,7 +75,16 @@ private:
 		return new ComponentType; \
 	}
 
+//In place of DEFINE_COMPONENT, the components are allocated from the pool of their type, see ComponentRegistry
+#define DEFINE_POOLED_COMPONENT(ComponentType) \
+	extern "C" __declspec(dllexport) ComponentType *Instantiate##ComponentType(void) \
+	{ \
+		return ComponentRegistry::GetReference().Create<ComponentType>(); \
+	}
+
 #define DEFINE_ENTRY_POINT(ComponentType) \
 	extern "C" __declspec(dllexport) void EntryPoint(void)
 
-END_NAMESPACE
\ No newline at end of file
+END_NAMESPACE
+
+#include "ComponentPool.h"
\ No newline at end of file
@@ -0,0 +1,468 @@
+///////////////////////////////////////////////////////////////////////////////////
+///
+///  Impressive Engine 2D
+///
+/// Copyright (c) 2012-2013 Impressive Reality team
+///
+/// The license is
+///
+/// Permission is denied, to any person or company
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Project leader : O.Shahbazi <sh_omid_m@yahoo.com>
+///////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Common.h"
+#include "Component.h"
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <typeinfo>
+#include <malloc.h>
+#include <string.h>
+#include <Windows.h>
+
+BEGIN_NAMESPACE
+
+class ComponentRegistry;
+
+//<Description>
+//Refers to a pooled component, unlike a pointer it can still be tested after the component is destroyed
+class ComponentHandle
+{
+	friend class ComponentRegistry;
+
+public:
+	ComponentHandle(void) :
+		m_Pool(0xFFFFFFFF),
+		m_Slot(0),
+		m_Generation(0)
+	{
+	}
+
+	bool IsNull(void) const
+	{
+		return (m_Pool == 0xFFFFFFFF);
+	}
+
+	bool operator ==(const ComponentHandle &Other) const
+	{
+		return (m_Pool == Other.m_Pool && m_Slot == Other.m_Slot && m_Generation == Other.m_Generation);
+	}
+
+	bool operator !=(const ComponentHandle &Other) const
+	{
+		return !(*this == Other);
+	}
+
+private:
+	unsigned int m_Pool;
+	unsigned int m_Slot;
+	unsigned int m_Generation;
+};
+
+
+//<Description>
+//Allocates the components of every type from a pool of their own, DEFINE_POOLED_COMPONENT
+//creates them here and deleting them gives their slot back. A pool is chunks of slots which
+//never move, so the components of a type are next to each other in the order of their slots,
+//and a ComponentHandle of a destroyed component can still be tested.
+//The engine updates and renders them game object by game object like the others, which
+//is slower than with new, a pool keeps the components of a type together, not of a game object.
+//Deleting a component whose size is the one of no pooled type takes no lock.
+//The scripts and the plugins use the registry of the executable, so the components of every
+//module are found in one place. Components can be created and destroyed from any thread
+class ComponentRegistry
+{
+private:
+	enum
+	{
+		CHUNK_SIZE = 16384,
+		MIN_CHUNK_SLOTS = 16,
+		SLOT_ALIGNMENT = 16,
+		POOLED_SIZE_BITS = 256
+	};
+
+	struct Chunk
+	{
+	public:
+		char *Data;
+		std::vector<unsigned char> Live;
+		std::vector<unsigned int> Generations;
+	};
+
+	class Pool
+	{
+	public:
+		Pool(const unsigned int &PoolIndex, const unsigned int &ObjectSize, const char *Name) :
+			Index(PoolIndex),
+			SlotSize((ObjectSize + SLOT_ALIGNMENT - 1) & ~(SLOT_ALIGNMENT - 1)),
+			SlotsPerChunk(0),
+			TypeName(Name),
+			Count(0)
+		{
+			SlotsPerChunk = CHUNK_SIZE / SlotSize;
+
+			if (SlotsPerChunk < MIN_CHUNK_SLOTS)
+				SlotsPerChunk = MIN_CHUNK_SLOTS;
+		}
+
+		virtual ~Pool(void)
+		{
+			for (unsigned int i = 0; i < Chunks.size(); i++)
+				_aligned_free(Chunks[i].Data);
+		}
+
+		virtual Component *GetComponent(void *Slot) = 0;
+
+		//Slots are taken lowest first, so the live components stay packed at the front
+		unsigned int Allocate(void)
+		{
+			if (!FreeSlots.size())
+				AddChunk();
+
+			std::pop_heap(FreeSlots.begin(), FreeSlots.end(), std::greater<unsigned int>());
+			const unsigned int slot = FreeSlots.back();
+			FreeSlots.pop_back();
+
+			return slot;
+		}
+
+		void SetLive(const unsigned int &Slot)
+		{
+			Chunks[Slot / SlotsPerChunk].Live[Slot % SlotsPerChunk] = 1;
+			Count++;
+		}
+
+		void Free(const unsigned int &Slot)
+		{
+			Chunk &chunk = Chunks[Slot / SlotsPerChunk];
+
+			chunk.Live[Slot % SlotsPerChunk] = 0;
+			chunk.Generations[Slot % SlotsPerChunk]++;
+			Count--;
+
+			FreeSlots.push_back(Slot);
+			std::push_heap(FreeSlots.begin(), FreeSlots.end(), std::greater<unsigned int>());
+		}
+
+		void *GetSlot(const unsigned int &Slot) const
+		{
+			return Chunks[Slot / SlotsPerChunk].Data + (Slot % SlotsPerChunk) * SlotSize;
+		}
+
+		bool IsLive(const unsigned int &Slot, const unsigned int &Generation) const
+		{
+			if (Slot / SlotsPerChunk >= Chunks.size())
+				return false;
+
+			const Chunk &chunk = Chunks[Slot / SlotsPerChunk];
+
+			return (chunk.Live[Slot % SlotsPerChunk] && chunk.Generations[Slot % SlotsPerChunk] == Generation);
+		}
+
+	private:
+		void AddChunk(void)
+		{
+			const unsigned int first = (unsigned int)Chunks.size() * SlotsPerChunk;
+
+			Chunks.push_back(Chunk());
+
+			Chunk &chunk = Chunks.back();
+			chunk.Data = (char*)_aligned_malloc(SlotsPerChunk * SlotSize, SLOT_ALIGNMENT);
+			chunk.Live.assign(SlotsPerChunk, 0);
+			chunk.Generations.assign(SlotsPerChunk, 0);
+
+			for (unsigned int i = 0; i < SlotsPerChunk; i++)
+			{
+				FreeSlots.push_back(first + i);
+				std::push_heap(FreeSlots.begin(), FreeSlots.end(), std::greater<unsigned int>());
+			}
+
+			ComponentRegistry::GetReference().m_Chunks[chunk.Data] = ChunkLocation(this, (unsigned int)Chunks.size() - 1);
+		}
+
+	public:
+		unsigned int Index;
+		unsigned int SlotSize;
+		unsigned int SlotsPerChunk;
+		const char *TypeName;
+		unsigned int Count;
+
+		std::vector<Chunk> Chunks;
+		std::vector<unsigned int> FreeSlots;
+	};
+
+	template<class T> class TypedPool : public Pool
+	{
+	public:
+		TypedPool(const unsigned int &PoolIndex) :
+			Pool(PoolIndex, sizeof(T), typeid(T).name())
+		{
+		}
+
+		Component *GetComponent(void *Slot)
+		{
+			return static_cast<Component*>(reinterpret_cast<T*>(Slot));
+		}
+	};
+
+	struct ChunkLocation
+	{
+	public:
+		ChunkLocation(void) :
+			Owner(NULL),
+			Index(0)
+		{
+		}
+
+		ChunkLocation(Pool *ChunkOwner, const unsigned int &ChunkIndex) :
+			Owner(ChunkOwner),
+			Index(ChunkIndex)
+		{
+		}
+
+		Pool *Owner;
+		unsigned int Index;
+	};
+
+	typedef std::vector<Pool*> PoolsList;
+	typedef std::map<const char*, ChunkLocation> ChunksMap;
+
+public:
+	ComponentRegistry(void)
+	{
+		for (unsigned int i = 0; i < POOLED_SIZE_BITS / 32; i++)
+			m_PooledSizes[i].store(0, std::memory_order_relaxed);
+	}
+
+	~ComponentRegistry(void)
+	{
+		for (unsigned int i = 0; i < m_Pools.size(); i++)
+			delete m_Pools[i];
+	}
+
+	DECLARE_SHARED_SINGLETON(ComponentRegistry)
+
+public:
+	template<class T> T *Create(void)
+	{
+		std::lock_guard<std::recursive_mutex> lock(m_Lock);
+
+		Pool &pool = GetPool<T>();
+		const unsigned int slot = pool.Allocate();
+
+		T *component = new (pool.GetSlot(slot)) T;
+
+		// after the constructor, GetComponents never sees a component half made
+		pool.SetLive(slot);
+
+		return component;
+	}
+
+	//False when no pooled type has the size, the others can share it
+	bool IsPooledSize(const size_t &Size) const
+	{
+		const unsigned int bit = GetPooledSizeBit(Size);
+
+		return (m_PooledSizes[bit / 32].load(std::memory_order_acquire) & (1u << (bit % 32))) != 0;
+	}
+
+	//Gives the slot of Memory back if it's pooled, called by the delete of Component
+	bool Free(void *Memory)
+	{
+		std::lock_guard<std::recursive_mutex> lock(m_Lock);
+
+		unsigned int slot = 0;
+		Pool *pool = Find(Memory, slot);
+
+		if (!pool)
+			return false;
+
+		pool->Free(slot);
+
+		return true;
+	}
+
+	ComponentHandle GetHandle(Component *Component)
+	{
+		std::lock_guard<std::recursive_mutex> lock(m_Lock);
+
+		ComponentHandle handle;
+
+		if (!Component)
+			return handle;
+
+		unsigned int slot = 0;
+		Pool *pool = Find(dynamic_cast<void*>(Component), slot);
+
+		if (!pool)
+			return handle;
+
+		handle.m_Pool = pool->Index;
+		handle.m_Slot = slot;
+		handle.m_Generation = pool->Chunks[slot / pool->SlotsPerChunk].Generations[slot % pool->SlotsPerChunk];
+
+		return handle;
+	}
+
+	//NULL once the component is destroyed
+	Component *Get(const ComponentHandle &Handle)
+	{
+		std::lock_guard<std::recursive_mutex> lock(m_Lock);
+
+		if (Handle.IsNull() || Handle.m_Pool >= m_Pools.size())
+			return NULL;
+
+		Pool *pool = m_Pools[Handle.m_Pool];
+
+		if (!pool->IsLive(Handle.m_Slot, Handle.m_Generation))
+			return NULL;
+
+		return pool->GetComponent(pool->GetSlot(Handle.m_Slot));
+	}
+
+	template<class T> T *Get(const ComponentHandle &Handle)
+	{
+		std::lock_guard<std::recursive_mutex> lock(m_Lock);
+
+		Pool &pool = GetPool<T>();
+
+		if (Handle.m_Pool != pool.Index || !pool.IsLive(Handle.m_Slot, Handle.m_Generation))
+			return NULL;
+
+		return reinterpret_cast<T*>(pool.GetSlot(Handle.m_Slot));
+	}
+
+	//Adds the live components whose holder is one of Holders, which has to be sorted.
+	//Goes through every component, to be called for many holders at once
+	void GetComponents(const std::vector<IGameObject*> &Holders, std::vector<Component*> &Components)
+	{
+		std::lock_guard<std::recursive_mutex> lock(m_Lock);
+
+		for (unsigned int i = 0; i < m_Pools.size(); i++)
+		{
+			Pool &pool = *m_Pools[i];
+
+			for (unsigned int j = 0; j < pool.Chunks.size(); j++)
+				for (unsigned int k = 0; k < pool.SlotsPerChunk; k++)
+					if (pool.Chunks[j].Live[k])
+					{
+						Component *component = pool.GetComponent(pool.Chunks[j].Data + k * pool.SlotSize);
+
+						if (std::binary_search(Holders.begin(), Holders.end(), component->GetHolder()))
+							Components.push_back(component);
+					}
+		}
+	}
+
+	unsigned int GetPoolCount(void) const
+	{
+		return (unsigned int)m_Pools.size();
+	}
+
+	//Live components of all types
+	unsigned int GetCount(void)
+	{
+		std::lock_guard<std::recursive_mutex> lock(m_Lock);
+
+		unsigned int count = 0;
+
+		for (unsigned int i = 0; i < m_Pools.size(); i++)
+			count += m_Pools[i]->Count;
+
+		return count;
+	}
+
+	template<class T> unsigned int GetCount(void)
+	{
+		std::lock_guard<std::recursive_mutex> lock(m_Lock);
+
+		return GetPool<T>().Count;
+	}
+
+private:
+	//Needs m_Lock
+	template<class T> Pool &GetPool(void)
+	{
+		static Pool *pool = NULL;
+
+		if (pool)
+			return *pool;
+
+		// made by another module which uses the type too
+		for (unsigned int i = 0; i < m_Pools.size(); i++)
+			if (!strcmp(m_Pools[i]->TypeName, typeid(T).name()))
+			{
+				pool = m_Pools[i];
+				return *pool;
+			}
+
+		pool = new TypedPool<T>((unsigned int)m_Pools.size());
+		m_Pools.push_back(pool);
+
+		const unsigned int bit = GetPooledSizeBit(sizeof(T));
+		m_PooledSizes[bit / 32].fetch_or(1u << (bit % 32), std::memory_order_release);
+
+		return *pool;
+	}
+
+	// sizes are multiples of the pointer, beyond 256 of them they share bits
+	static unsigned int GetPooledSizeBit(const size_t &Size)
+	{
+		return (unsigned int)(Size / sizeof(void*)) % POOLED_SIZE_BITS;
+	}
+
+	//Needs m_Lock
+	Pool *Find(void *Memory, unsigned int &Slot)
+	{
+		const char *address = (const char*)Memory;
+
+		ChunksMap::iterator it = m_Chunks.upper_bound(address);
+
+		if (it == m_Chunks.begin())
+			return NULL;
+
+		it--;
+
+		Pool *pool = it->second.Owner;
+		const unsigned int offset = (unsigned int)(address - it->first);
+
+		if (address - it->first >= (ptrdiff_t)(pool->SlotsPerChunk * pool->SlotSize) || offset % pool->SlotSize)
+			return NULL;
+
+		Slot = it->second.Index * pool->SlotsPerChunk + offset / pool->SlotSize;
+
+		return pool;
+	}
+
+private:
+	ComponentRegistry(const ComponentRegistry &Other);
+	void operator =(const ComponentRegistry &Other);
+
+private:
+	std::recursive_mutex m_Lock;
+	PoolsList m_Pools;
+	ChunksMap m_Chunks;
+
+	// a bit for each size of the pooled types, set when their pool is made
+	std::atomic<unsigned int> m_PooledSizes[POOLED_SIZE_BITS / 32];
+};
+
+
+inline void Component::operator delete(void *Memory, size_t Size)
+{
+	ComponentRegistry &registry = ComponentRegistry::GetReference();
+
+	if (!registry.IsPooledSize(Size) || !registry.Free(Memory))
+		::operator delete(Memory);
+}
+
+END_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,513 @@
+///////////////////////////////////////////////////////////////////////////////////
+///
+///  Impressive Engine 2D
+///
+/// Copyright (c) 2012-2013 Impressive Reality team
+///
+/// The license is
+///
+/// Permission is denied, to any person or company
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Project leader : O.Shahbazi <sh_omid_m@yahoo.com>
+///////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Common.h"
+#include "Component.h"
+#include "Core.h"
+#include "IGameObject.h"
+#include "JobPool.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+
+BEGIN_NAMESPACE
+
+class ComponentScheduler;
+
+//<Description>
+//What the ScheduledUpdate of a component reads and writes, any object can be a resource:
+//the transform or the body of a game object, a game object as a whole, a shared service.
+//Components which write a resource don't run at the same time as others which use it,
+//components which only read it do
+class ComponentAccess
+{
+	friend class ComponentScheduler;
+
+private:
+	struct Entry
+	{
+	public:
+		const void *Resource;
+		bool Write;
+	};
+
+	typedef std::vector<Entry> EntriesList;
+
+public:
+	ComponentAccess(void) :
+		m_MainThreadOnly(false)
+	{
+	}
+
+	void Read(const void *Resource)
+	{
+		Add(Resource, false);
+	}
+
+	void Write(const void *Resource)
+	{
+		Add(Resource, true);
+	}
+
+	//For components which use what isn't thread safe, like creating game objects or the renderer
+	void SetMainThreadOnly(void)
+	{
+		m_MainThreadOnly = true;
+	}
+
+	const bool &IsMainThreadOnly(void) const
+	{
+		return m_MainThreadOnly;
+	}
+
+	void Clear(void)
+	{
+		m_Entries.clear();
+		m_MainThreadOnly = false;
+	}
+
+private:
+	void Add(const void *Resource, const bool &Write)
+	{
+		if (!Resource)
+			return;
+
+		Entry entry;
+		entry.Resource = Resource;
+		entry.Write = Write;
+
+		m_Entries.push_back(entry);
+	}
+
+private:
+	EntriesList m_Entries;
+	bool m_MainThreadOnly;
+};
+
+
+//<Description>
+//Component whose update runs on the job pool next to the updates of other components.
+//Its logic goes in ScheduledUpdate instead of Update, what it reads and writes is
+//declared in DeclareAccess. Without an attached ComponentScheduler, or when its game
+//object isn't in the current scene, ScheduledUpdate is called from Update like before
+class ScheduledComponent : public Component
+{
+	friend class ComponentScheduler;
+
+public:
+	ScheduledComponent(void);
+	virtual ~ScheduledComponent(void);
+
+	//By default the whole game object is written, so components of one game object never run together
+	virtual void DeclareAccess(ComponentAccess &Access)
+	{
+		Access.Write(GetHolder());
+	}
+
+	virtual void ScheduledUpdate(void)
+	{
+	}
+
+	//Has to be called when what DeclareAccess declares changes, like when a body is created
+	void InvalidateAccess(void);
+
+	//Called by the scene, the update itself is ScheduledUpdate
+	void Update(void);
+
+private:
+	unsigned int m_Index;
+	bool m_Scheduled;
+};
+
+
+//<Description>
+//Runs the ScheduledUpdate of the components of the current scene as a JobGraph on JobPool.
+//The graph follows the order the components are created in, a component waits for the
+//ones before it which write what it uses, or which use what it writes.
+//The graph is only built again when components are added or removed, when one of them
+//calls InvalidateAccess, or when the current scene changes.
+//The graph runs once a frame, when the scene calls Update of the first scheduled component.
+//Components created or destroyed while the graph runs, by a job which is main thread only,
+//join or leave it once every job of the run is done
+class ComponentScheduler : public Core::IListener
+{
+	friend class ScheduledComponent;
+
+private:
+	struct ResourceUse
+	{
+	public:
+		unsigned int Writer;
+		std::vector<unsigned int> Readers;
+	};
+
+	typedef std::vector<ScheduledComponent*> ComponentsList;
+	typedef std::vector<unsigned int> IndicesList;
+	typedef std::unordered_map<const void*, ResourceUse> ResourceUsesMap;
+
+public:
+	ComponentScheduler(void) :
+		m_SlotCount(0),
+		m_Attached(false),
+		m_FrameDue(false),
+		m_Dirty(true),
+		m_Running(false),
+		m_RemovedCount(0)
+	{
+	}
+
+	//The components of the scripts and the plugins are scheduled with the ones of the executable
+	DECLARE_SHARED_SINGLETON(ComponentScheduler)
+
+public:
+	//Scheduled updates run on JobPool from here on, it has to be started to run them in parallel
+	void Attach(void)
+	{
+		if (m_Attached)
+			return;
+
+		Core::GetReference().AddListener(this);
+		m_Attached = true;
+		m_Dirty = true;
+	}
+
+	void Detach(void)
+	{
+		if (!m_Attached)
+			return;
+
+		Core::GetReference().RemoveListener(this);
+		m_Attached = false;
+		m_FrameDue = false;
+
+		std::lock_guard<std::mutex> lock(m_Lock);
+
+		for (unsigned int i = 0; i < m_Components.size(); i++)
+			if (m_Components[i])
+				m_Components[i]->m_Scheduled = false;
+	}
+
+	const bool &IsAttached(void) const
+	{
+		return m_Attached;
+	}
+
+	//Runs the graph now, normally it runs from the first scheduled Update of a frame
+	void Run(void)
+	{
+		PROFILE_SCOPE("ComponentScheduler::Run")
+
+		m_FrameDue = false;
+
+		{
+			std::lock_guard<std::mutex> lock(m_Lock);
+
+			if (m_Dirty)
+				Build();
+
+			m_Running = true;
+		}
+
+		JobPool::GetReference().Run(m_Graph);
+
+		std::lock_guard<std::mutex> lock(m_Lock);
+		m_Running = false;
+
+		ApplyPending();
+	}
+
+	void Invalidate(void)
+	{
+		m_Dirty = true;
+	}
+
+	unsigned int GetComponentCount(void) const
+	{
+		return (unsigned int)m_Components.size() - m_RemovedCount;
+	}
+
+	const JobGraph &GetGraph(void) const
+	{
+		return m_Graph;
+	}
+
+private:
+	static void UpdateComponent(void *Data)
+	{
+		ScheduledComponent *component = GetReference().m_Slots[(unsigned int)(size_t)Data].load(std::memory_order_acquire);
+
+		// destroyed by a main thread job of this run
+		if (component)
+			component->ScheduledUpdate();
+	}
+
+	void Add(ScheduledComponent *Component)
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+
+		Component->m_Scheduled = false;
+
+		// m_Components is read by the run, it joins after it
+		if (m_Running)
+		{
+			Component->m_Index = PENDING;
+			m_Added.push_back(Component);
+
+			return;
+		}
+
+		Component->m_Index = (unsigned int)m_Components.size();
+		m_Components.push_back(Component);
+
+		m_Dirty = true;
+	}
+
+	void Remove(ScheduledComponent *Component)
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+
+		if (Component->m_Index == PENDING)
+		{
+			m_Added.erase(std::find(m_Added.begin(), m_Added.end(), Component));
+
+			return;
+		}
+
+		if (m_Running)
+		{
+			// its job may not have run yet
+			m_Slots[Component->m_Index].store(NULL, std::memory_order_release);
+			m_Removed.push_back(Component->m_Index);
+
+			return;
+		}
+
+		m_Components[Component->m_Index] = NULL;
+		m_RemovedCount++;
+
+		m_Dirty = true;
+
+		Compact();
+	}
+
+	void ApplyPending(void)
+	{
+		if (!m_Added.size() && !m_Removed.size())
+			return;
+
+		for (unsigned int i = 0; i < m_Removed.size(); i++)
+			m_Components[m_Removed[i]] = NULL;
+
+		m_RemovedCount += (unsigned int)m_Removed.size();
+		m_Removed.clear();
+
+		Compact();
+
+		for (unsigned int i = 0; i < m_Added.size(); i++)
+		{
+			m_Added[i]->m_Index = (unsigned int)m_Components.size();
+			m_Components.push_back(m_Added[i]);
+		}
+
+		m_Added.clear();
+
+		m_Dirty = true;
+	}
+
+	void Compact(void)
+	{
+		unsigned int count = 0;
+
+		for (unsigned int i = 0; i < m_Components.size(); i++)
+			if (m_Components[i])
+			{
+				m_Components[i]->m_Index = count;
+				m_Components[count++] = m_Components[i];
+			}
+
+		m_Components.resize(count);
+		m_RemovedCount = 0;
+	}
+
+	void Update(ScheduledComponent *Component)
+	{
+		if (m_FrameDue)
+			Run();
+
+		if (!Component->m_Scheduled)
+			Component->ScheduledUpdate();
+	}
+
+	void Build(void)
+	{
+		m_Graph.Clear();
+		m_Uses.clear();
+
+		if (m_Components.size() > m_SlotCount)
+		{
+			m_SlotCount = (unsigned int)m_Components.size();
+			m_Slots.reset(new std::atomic<ScheduledComponent*>[m_SlotCount]);
+		}
+
+		IScene *scene = Core::GetReference().GetCurrentScene();
+
+		for (unsigned int i = 0; i < m_Components.size(); i++)
+		{
+			ScheduledComponent *component = m_Components[i];
+
+			m_Slots[i].store(component, std::memory_order_relaxed);
+
+			if (!component)
+				continue;
+
+			component->m_Scheduled = (component->GetHolder() && component->GetHolder()->GetHolder() == scene);
+
+			if (!component->m_Scheduled)
+				continue;
+
+			m_Access.Clear();
+			component->DeclareAccess(m_Access);
+
+			const unsigned int job = m_Graph.AddJob(&UpdateComponent, (void*)(size_t)i, m_Access.IsMainThreadOnly());
+
+			for (unsigned int j = 0; j < m_Access.m_Entries.size(); j++)
+			{
+				const ComponentAccess::Entry &entry = m_Access.m_Entries[j];
+
+				ResourceUsesMap::iterator it = m_Uses.find(entry.Resource);
+
+				if (it == m_Uses.end())
+				{
+					it = m_Uses.insert(ResourceUsesMap::value_type(entry.Resource, ResourceUse())).first;
+					it->second.Writer = JobGraph::INVALID;
+				}
+
+				ResourceUse &use = it->second;
+
+				if (use.Writer != JobGraph::INVALID)
+					m_Graph.AddDependency(job, use.Writer);
+
+				if (entry.Write)
+				{
+					for (unsigned int k = 0; k < use.Readers.size(); k++)
+						m_Graph.AddDependency(job, use.Readers[k]);
+
+					use.Writer = job;
+					use.Readers.clear();
+				}
+				else
+					use.Readers.push_back(job);
+			}
+		}
+
+		m_Dirty = false;
+	}
+
+	void OnBeforeSceneRemoved(IScene *Scene)
+	{
+		m_Dirty = true;
+	}
+
+	void OnSceneAdded(IScene *Scene)
+	{
+	}
+
+	void OnSetCurrentScene(IScene *Scene)
+	{
+		m_Dirty = true;
+	}
+
+	void OnBeforeUpdate(void)
+	{
+		m_FrameDue = true;
+	}
+
+	void OnAfterUpdate(void)
+	{
+		m_FrameDue = false;
+	}
+
+	void OnBeforeRender(void)
+	{
+	}
+
+	void OnAfterRender(void)
+	{
+	}
+
+private:
+	ComponentScheduler(const ComponentScheduler &Other);
+	void operator =(const ComponentScheduler &Other);
+
+private:
+	// the index of a component created during a run
+	static const unsigned int PENDING = 0xFFFFFFFF;
+
+	ComponentsList m_Components;
+	JobGraph m_Graph;
+
+	// what the jobs of a run update, m_Components as it was when the graph was built
+	std::unique_ptr<std::atomic<ScheduledComponent*>[]> m_Slots;
+	unsigned int m_SlotCount;
+
+	// created during the run, and the indices of the ones destroyed, from any thread
+	ComponentsList m_Added;
+	IndicesList m_Removed;
+	std::mutex m_Lock;
+
+	// scratch of Build
+	ComponentAccess m_Access;
+	ResourceUsesMap m_Uses;
+
+	bool m_Attached;
+	bool m_FrameDue;
+	bool m_Dirty;
+	bool m_Running;
+	unsigned int m_RemovedCount;
+};
+
+
+inline ScheduledComponent::ScheduledComponent(void) :
+	m_Index(0),
+	m_Scheduled(false)
+{
+	ComponentScheduler::GetReference().Add(this);
+}
+
+inline ScheduledComponent::~ScheduledComponent(void)
+{
+	ComponentScheduler::GetReference().Remove(this);
+}
+
+inline void ScheduledComponent::InvalidateAccess(void)
+{
+	ComponentScheduler::GetReference().Invalidate();
+}
+
+inline void ScheduledComponent::Update(void)
+{
+	if (ComponentScheduler::GetReference().IsAttached())
+		ComponentScheduler::GetReference().Update(this);
+	else
+		ScheduledUpdate();
+}
+
+END_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,682 @@
+///////////////////////////////////////////////////////////////////////////////////
+///
+///  Impressive Engine 2D
+///
+/// Copyright (c) 2012-2013 Impressive Reality team
+///
+/// The license is
+///
+/// Permission is denied, to any person or company
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Project leader : O.Shahbazi <sh_omid_m@yahoo.com>
+///////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Common.h"
+#include "TreeElement.h"
+#include "Vector2D.h"
+#include "Vector3D.h"
+#include "Colour.h"
+#include "MappedFile.h"
+#include <Windows.h>
+#include <vector>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <string.h>
+#include <stdlib.h>
+
+BEGIN_NAMESPACE
+
+//<Description>
+//Binary form of the scene, animation and material files, written by the Cook tool.
+//The file is a header followed by flat arrays of strings, elements and attributes,
+//every reference is an index into one of them, so it's read in place from memory
+//without building a TreeElement DOM. Elements are stored breadth first, so the
+//children of an element are consecutive; attributes are sorted by name and numbers
+//are parsed once at cook time
+class CookedTree
+{
+public:
+	enum AttributeType
+	{
+		AT_STRING = 0,
+		AT_BOOLEAN,
+		AT_NUMBER
+	};
+
+	struct Header
+	{
+	public:
+		char Magic[4];
+		unsigned int Version;
+		unsigned int FileType;
+
+		unsigned int StringCount;
+		unsigned int StringsOffset;
+
+		unsigned int ElementCount;
+		unsigned int ElementsOffset;
+
+		unsigned int AttributeCount;
+		unsigned int AttributesOffset;
+
+		unsigned int CharactersOffset;
+		unsigned int Size;
+	};
+
+	struct StringRecord
+	{
+	public:
+		//Relative to Header::CharactersOffset, the characters are NULL terminated
+		unsigned int Offset;
+		unsigned int Length;
+	};
+
+	struct ElementRecord
+	{
+	public:
+		unsigned int Name;
+		unsigned int Value;
+
+		unsigned int Parent;
+
+		unsigned int FirstChild;
+		unsigned int ChildCount;
+
+		unsigned int FirstAttribute;
+		unsigned int AttributeCount;
+	};
+
+	struct AttributeRecord
+	{
+	public:
+		unsigned int Name;
+
+		//The text as it was in the source file
+		unsigned int Text;
+
+		unsigned short Type;
+		unsigned short ComponentCount;
+
+		//Set for booleans and numbers without fraction
+		int Integer;
+
+		float Components[4];
+	};
+
+	static const unsigned int VERSION = 1;
+	static const unsigned int INVALID_INDEX = 0xFFFFFFFF;
+
+public:
+	class Element
+	{
+	public:
+		Element(void) :
+			m_Tree(NULL),
+			m_Record(NULL)
+		{
+		}
+
+		Element(const CookedTree *Tree, const ElementRecord *Record) :
+			m_Tree(Tree),
+			m_Record(Record)
+		{
+		}
+
+		bool IsValid(void) const
+		{
+			return (m_Record != NULL);
+		}
+
+		const char *GetName(void) const
+		{
+			return m_Tree->GetString(m_Record->Name);
+		}
+
+		const char *GetValue(void) const
+		{
+			return m_Tree->GetString(m_Record->Value);
+		}
+
+		Element GetParent(void) const
+		{
+			if (m_Record->Parent == INVALID_INDEX)
+				return Element();
+
+			return m_Tree->GetElement(m_Record->Parent);
+		}
+
+		const unsigned int &GetChildCount(void) const
+		{
+			return m_Record->ChildCount;
+		}
+
+		Element GetChild(const unsigned int &Index) const
+		{
+			return m_Tree->GetElement(m_Record->FirstChild + Index);
+		}
+
+		//First child with the name, like TreeElement::GetChildren
+		Element GetChild(const char *Name) const
+		{
+			for (unsigned int i = 0; i < m_Record->ChildCount; i++)
+			{
+				Element child = GetChild(i);
+
+				if (strcmp(child.GetName(), Name) == 0)
+					return child;
+			}
+
+			return Element();
+		}
+
+		const unsigned int &GetAttributeCount(void) const
+		{
+			return m_Record->AttributeCount;
+		}
+
+		const AttributeRecord &GetAttribute(const unsigned int &Index) const
+		{
+			return m_Tree->m_Attributes[m_Record->FirstAttribute + Index];
+		}
+
+		const AttributeRecord *FindAttribute(const char *Name) const
+		{
+			const AttributeRecord *attributes = &m_Tree->m_Attributes[m_Record->FirstAttribute];
+
+			int low = 0;
+			int high = (int)m_Record->AttributeCount - 1;
+
+			while (low <= high)
+			{
+				const int middle = (low + high) / 2;
+				const int result = strcmp(m_Tree->GetString(attributes[middle].Name), Name);
+
+				if (result == 0)
+					return &attributes[middle];
+
+				if (result < 0)
+					low = middle + 1;
+				else
+					high = middle - 1;
+			}
+
+			return NULL;
+		}
+
+		bool Has(const char *Name) const
+		{
+			return (FindAttribute(Name) != NULL);
+		}
+
+		const char *GetString(const char *Name, const char *DefaultValue = "") const
+		{
+			const AttributeRecord *attribute = FindAttribute(Name);
+
+			if (!attribute)
+				return DefaultValue;
+
+			return m_Tree->GetString(attribute->Text);
+		}
+
+		bool GetBoolean(const char *Name, const bool &DefaultValue = false) const
+		{
+			const AttributeRecord *attribute = FindAttribute(Name);
+
+			if (!attribute || attribute->Type == AT_STRING)
+				return DefaultValue;
+
+			return (attribute->Integer != 0);
+		}
+
+		int GetInteger(const char *Name, const int &DefaultValue = 0) const
+		{
+			const AttributeRecord *attribute = FindAttribute(Name);
+
+			if (!attribute || attribute->Type != AT_NUMBER)
+				return DefaultValue;
+
+			return attribute->Integer;
+		}
+
+		float GetFloat(const char *Name, const float &DefaultValue = 0.f) const
+		{
+			const AttributeRecord *attribute = FindAttribute(Name);
+
+			if (!attribute || attribute->Type != AT_NUMBER)
+				return DefaultValue;
+
+			return attribute->Components[0];
+		}
+
+		Vector2D GetVector2D(const char *Name, const Vector2D &DefaultValue = Vector2D_ZERO) const
+		{
+			const AttributeRecord *attribute = FindAttribute(Name);
+
+			if (!attribute || attribute->Type != AT_NUMBER || attribute->ComponentCount < 2)
+				return DefaultValue;
+
+			return Vector2D(attribute->Components[0], attribute->Components[1]);
+		}
+
+		Vector3D GetVector3D(const char *Name, const Vector3D &DefaultValue = Vector3D_ZERO) const
+		{
+			const AttributeRecord *attribute = FindAttribute(Name);
+
+			if (!attribute || attribute->Type != AT_NUMBER || attribute->ComponentCount < 3)
+				return DefaultValue;
+
+			return Vector3D(attribute->Components[0], attribute->Components[1], attribute->Components[2]);
+		}
+
+		Colour GetColour(const char *Name, const Colour &DefaultValue = Colour_WHITE) const
+		{
+			const AttributeRecord *attribute = FindAttribute(Name);
+
+			if (!attribute || attribute->Type != AT_NUMBER || attribute->ComponentCount < 3)
+				return DefaultValue;
+
+			const float *c = attribute->Components;
+
+			return Colour((unsigned int)c[0], (unsigned int)c[1], (unsigned int)c[2], (attribute->ComponentCount == 4 ? (unsigned int)c[3] : 255));
+		}
+
+		//Builds the TreeElement DOM of this element, for the code which isn't reading cooked files yet
+		TreeElement *CreateTreeElement(TreeElement *Parent = NULL) const
+		{
+			TreeElement *element = new TreeElement(Parent);
+
+			element->Name = GetName();
+			element->Value = GetValue();
+
+			for (unsigned int i = 0; i < m_Record->AttributeCount; i++)
+			{
+				const AttributeRecord &attribute = GetAttribute(i);
+
+				element->Attributes[m_Tree->GetString(attribute.Name)] = m_Tree->GetString(attribute.Text);
+			}
+
+			for (unsigned int i = 0; i < m_Record->ChildCount; i++)
+				element->Children.Add(GetChild(i).CreateTreeElement(element));
+
+			return element;
+		}
+
+	private:
+		const CookedTree *m_Tree;
+		const ElementRecord *m_Record;
+	};
+
+public:
+	CookedTree(void) :
+		m_Header(NULL),
+		m_Strings(NULL),
+		m_Elements(NULL),
+		m_Attributes(NULL),
+		m_Characters(NULL)
+	{
+	}
+
+	//Data has to stay valid as long as the tree is used, nothing is copied.
+	//Returns false if Data isn't a cooked file of this version, or is damaged
+	bool Open(const void *Data, const unsigned int &Size)
+	{
+		*this = CookedTree();
+
+		if (!Data || Size < sizeof(Header) || (size_t)Data % 4 != 0)
+			return false;
+
+		const char *data = (const char*)Data;
+		const Header *header = (const Header*)data;
+
+		if (memcmp(header->Magic, "IE2C", 4) != 0 || header->Version != VERSION || header->Size != Size)
+			return false;
+
+		if (!IsInside(header->StringsOffset, header->StringCount, sizeof(StringRecord), Size) ||
+			!IsInside(header->ElementsOffset, header->ElementCount, sizeof(ElementRecord), Size) ||
+			!IsInside(header->AttributesOffset, header->AttributeCount, sizeof(AttributeRecord), Size) ||
+			header->CharactersOffset > Size || header->ElementCount == 0)
+			return false;
+
+		// the records are read in place
+		if (header->StringsOffset % 4 != 0 || header->ElementsOffset % 4 != 0 || header->AttributesOffset % 4 != 0)
+			return false;
+
+		const StringRecord *strings = (const StringRecord*)(data + header->StringsOffset);
+		const ElementRecord *elements = (const ElementRecord*)(data + header->ElementsOffset);
+		const AttributeRecord *attributes = (const AttributeRecord*)(data + header->AttributesOffset);
+		const char *characters = data + header->CharactersOffset;
+		const unsigned int charactersSize = Size - header->CharactersOffset;
+
+		// checked once here, so the getters can trust every index. Children come after their
+		// parent, as the writer lays the elements out breadth first, so walking down the tree ends
+		for (unsigned int i = 0; i < header->StringCount; i++)
+		{
+			const StringRecord &string = strings[i];
+
+			if (string.Offset >= charactersSize || string.Length >= charactersSize - string.Offset || characters[string.Offset + string.Length] != '\0')
+				return false;
+		}
+
+		for (unsigned int i = 0; i < header->ElementCount; i++)
+		{
+			const ElementRecord &element = elements[i];
+
+			if (element.Name >= header->StringCount || element.Value >= header->StringCount ||
+				(element.Parent != INVALID_INDEX && element.Parent >= header->ElementCount) ||
+				!IsInside(element.FirstChild, element.ChildCount, 1, header->ElementCount) ||
+				(element.ChildCount && element.FirstChild <= i) ||
+				!IsInside(element.FirstAttribute, element.AttributeCount, 1, header->AttributeCount))
+				return false;
+		}
+
+		for (unsigned int i = 0; i < header->AttributeCount; i++)
+		{
+			const AttributeRecord &attribute = attributes[i];
+
+			if (attribute.Name >= header->StringCount || attribute.Text >= header->StringCount || attribute.ComponentCount > 4)
+				return false;
+		}
+
+		m_Header = header;
+		m_Strings = strings;
+		m_Elements = elements;
+		m_Attributes = attributes;
+		m_Characters = characters;
+
+		return true;
+	}
+
+	bool IsOpen(void) const
+	{
+		return (m_Header != NULL);
+	}
+
+	const unsigned int &GetFileType(void) const
+	{
+		return m_Header->FileType;
+	}
+
+	Element GetRoot(void) const
+	{
+		return GetElement(0);
+	}
+
+	Element GetElement(const unsigned int &Index) const
+	{
+		return Element(this, &m_Elements[Index]);
+	}
+
+	const unsigned int &GetElementCount(void) const
+	{
+		return m_Header->ElementCount;
+	}
+
+	const char *GetString(const unsigned int &Index) const
+	{
+		return m_Characters + m_Strings[Index].Offset;
+	}
+
+public:
+	//Cooks the DOM read by a tree parser into Buffer
+	static void Write(TreeElement *Root, const unsigned int &FileType, std::vector<char> &Buffer)
+	{
+		typedef std::map<std::string, unsigned int> StringsMap;
+
+		StringsMap stringsMap;
+		std::vector<StringRecord> strings;
+		std::vector<char> characters;
+		std::vector<ElementRecord> elements;
+		std::vector<AttributeRecord> attributes;
+
+		// breadth first, the children of every element end up next to each other
+		std::vector<TreeElement*> queue;
+		std::vector<unsigned int> parents;
+		queue.push_back(Root);
+		parents.push_back((unsigned int)INVALID_INDEX);
+
+		unsigned int childIndex = 1;
+
+		for (unsigned int i = 0; i < queue.size(); i++)
+		{
+			TreeElement *element = queue[i];
+
+			ElementRecord record;
+			record.Name = AddString(element->Name.GetBuffer(), stringsMap, strings, characters);
+			record.Value = AddString(element->Value.GetBuffer(), stringsMap, strings, characters);
+			record.Parent = parents[i];
+			record.FirstChild = childIndex;
+			record.ChildCount = element->Children.GetSize();
+			record.FirstAttribute = attributes.size();
+			record.AttributeCount = element->Attributes.size();
+
+			std::vector<std::pair<std::string, std::string> > sorted;
+			FOR_EACH_MAP(it, element->Attributes)
+				sorted.push_back(std::make_pair(std::string(it->first.GetBuffer()), std::string(it->second.GetBuffer())));
+
+			// the reader does a binary search with strcmp
+			std::sort(sorted.begin(), sorted.end());
+
+			for (unsigned int j = 0; j < sorted.size(); j++)
+			{
+				AttributeRecord attribute;
+				attribute.Name = AddString(sorted[j].first.c_str(), stringsMap, strings, characters);
+				attribute.Text = AddString(sorted[j].second.c_str(), stringsMap, strings, characters);
+				ParseAttribute(sorted[j].second.c_str(), attribute);
+
+				attributes.push_back(attribute);
+			}
+
+			for (unsigned int j = 0; j < element->Children.GetSize(); j++)
+			{
+				queue.push_back(element->Children[j]);
+				parents.push_back(i);
+			}
+
+			childIndex += record.ChildCount;
+
+			elements.push_back(record);
+		}
+
+		Header header;
+		memcpy(header.Magic, "IE2C", 4);
+		header.Version = VERSION;
+		header.FileType = FileType;
+		header.StringCount = strings.size();
+		header.StringsOffset = sizeof(Header);
+		header.ElementCount = elements.size();
+		header.ElementsOffset = header.StringsOffset + strings.size() * sizeof(StringRecord);
+		header.AttributeCount = attributes.size();
+		header.AttributesOffset = header.ElementsOffset + elements.size() * sizeof(ElementRecord);
+		header.CharactersOffset = header.AttributesOffset + attributes.size() * sizeof(AttributeRecord);
+		header.Size = header.CharactersOffset + characters.size();
+
+		Buffer.resize(header.Size);
+		char *data = &Buffer[0];
+
+		memcpy(data, &header, sizeof(Header));
+		if (strings.size())
+			memcpy(data + header.StringsOffset, &strings[0], strings.size() * sizeof(StringRecord));
+		memcpy(data + header.ElementsOffset, &elements[0], elements.size() * sizeof(ElementRecord));
+		if (attributes.size())
+			memcpy(data + header.AttributesOffset, &attributes[0], attributes.size() * sizeof(AttributeRecord));
+		if (characters.size())
+			memcpy(data + header.CharactersOffset, &characters[0], characters.size());
+	}
+
+	//Path of the cooked file the Cook tool writes for FilePath
+	static String GetCookedFilePath(const String &FilePath)
+	{
+		return FilePath + ".cooked";
+	}
+
+private:
+	static bool IsInside(const unsigned int &Offset, const unsigned int &Count, const unsigned int &ItemSize, const unsigned int &Size)
+	{
+		return (Offset <= Size && Count <= (Size - Offset) / ItemSize);
+	}
+
+	static unsigned int AddString(const char *Value, std::map<std::string, unsigned int> &StringsMap, std::vector<StringRecord> &Strings, std::vector<char> &Characters)
+	{
+		std::map<std::string, unsigned int>::iterator it = StringsMap.find(Value);
+
+		if (it != StringsMap.end())
+			return it->second;
+
+		StringRecord record;
+		record.Offset = Characters.size();
+		record.Length = strlen(Value);
+
+		Characters.insert(Characters.end(), Value, Value + record.Length + 1);
+
+		const unsigned int index = Strings.size();
+		Strings.push_back(record);
+		StringsMap[Value] = index;
+
+		return index;
+	}
+
+	//Numbers are what StringConverter writes: up to four of them, separated by spaces
+	static void ParseAttribute(const char *Text, AttributeRecord &Attribute)
+	{
+		Attribute.Type = AT_STRING;
+		Attribute.ComponentCount = 0;
+		Attribute.Integer = 0;
+		Attribute.Components[0] = Attribute.Components[1] = Attribute.Components[2] = Attribute.Components[3] = 0.f;
+
+		if (strcmp(Text, "true") == 0 || strcmp(Text, "false") == 0 || strcmp(Text, "yes") == 0 || strcmp(Text, "no") == 0)
+		{
+			Attribute.Type = AT_BOOLEAN;
+			Attribute.Integer = (Text[0] == 't' || Text[0] == 'y');
+			return;
+		}
+
+		const char *position = Text;
+		unsigned int count = 0;
+		float components[4];
+		bool isInteger = true;
+
+		while (true)
+		{
+			while (*position == ' ' || *position == '\t')
+				position++;
+
+			if (*position == '\0')
+				break;
+
+			if (count == 4)
+				return;
+
+			char *end = NULL;
+			components[count] = (float)strtod(position, &end);
+
+			if (end == position || (*end != '\0' && *end != ' ' && *end != '\t'))
+				return;
+
+			for (const char *c = position; c != end; c++)
+				if (*c == '.' || *c == 'e' || *c == 'E' || *c == 'n' || *c == 'N' || *c == 'x' || *c == 'X')
+					isInteger = false;
+
+			position = end;
+			count++;
+		}
+
+		if (count == 0)
+			return;
+
+		Attribute.Type = AT_NUMBER;
+		Attribute.ComponentCount = count;
+		memcpy(Attribute.Components, components, count * sizeof(float));
+
+		if (count == 1 && isInteger)
+			Attribute.Integer = (int)strtol(Text, NULL, 10);
+		else
+			Attribute.Integer = (int)components[0];
+	}
+
+private:
+	const Header *m_Header;
+	const StringRecord *m_Strings;
+	const ElementRecord *m_Elements;
+	const AttributeRecord *m_Attributes;
+	const char *m_Characters;
+};
+
+//<Description>
+//Maps a cooked file into memory read only and opens its tree in place.
+//The pages are loaded by the OS as the tree is read and shared between processes
+class CookedTreeFile
+{
+public:
+	CookedTreeFile(void)
+	{
+	}
+
+	~CookedTreeFile(void)
+	{
+		Close();
+	}
+
+	bool Open(const String &FilePath)
+	{
+		Close();
+
+		if (!m_File.Open(FilePath) || !m_Tree.Open(m_File.GetData(), m_File.GetSize()))
+		{
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	//Opens a cooked tree that is already in memory, e.g. an entry of a mounted pack file
+	bool Open(const void *Data, const unsigned int &Size)
+	{
+		Close();
+
+		return m_Tree.Open(Data, Size);
+	}
+
+	void Close(void)
+	{
+		m_Tree = CookedTree();
+
+		m_File.Close();
+	}
+
+	const CookedTree &GetTree(void) const
+	{
+		return m_Tree;
+	}
+
+	//True if the cooked file of SourceFilePath exists and isn't older than it, then it can be loaded instead
+	static bool IsUpToDate(const String &SourceFilePath)
+	{
+		WIN32_FILE_ATTRIBUTE_DATA cooked;
+		if (!GetFileAttributesExA(CookedTree::GetCookedFilePath(SourceFilePath).GetBuffer(), GetFileExInfoStandard, &cooked))
+			return false;
+
+		// shipped without the source
+		WIN32_FILE_ATTRIBUTE_DATA source;
+		if (!GetFileAttributesExA(SourceFilePath.GetBuffer(), GetFileExInfoStandard, &source))
+			return true;
+
+		return (CompareFileTime(&cooked.ftLastWriteTime, &source.ftLastWriteTime) >= 0);
+	}
+
+private:
+	CookedTreeFile(const CookedTreeFile &Other);
+	void operator =(const CookedTreeFile &Other);
+
+private:
+	MappedFile m_File;
+
+	CookedTree m_Tree;
+};
+
+END_NAMESPACE
\ No newline at end of file
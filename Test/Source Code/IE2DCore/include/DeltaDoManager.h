@@ -0,0 +1,330 @@
+///////////////////////////////////////////////////////////////////////////////////
+///
+///  Impressive Engine 2D
+///
+/// Copyright (c) 2012-2013 Impressive Reality team
+///
+/// The license is
+///
+/// Permission is denied, to any person or company
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Project leader : O.Shahbazi <sh_omid_m@yahoo.com>
+///////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Common.h"
+#include "ISerializable.h"
+#include "HashedAttributes.h"
+#include <Windows.h>
+#include <vector>
+#include <deque>
+#include <algorithm>
+
+BEGIN_NAMESPACE
+
+//<Description>
+//Undo history of object changes, kept as the values which changed instead of copies of the objects.
+//A change is captured between BeginChange and EndChange through ISerializable, only the
+//attributes whose values differ are stored, as the binary form of HashedAttributes, once with
+//the old values and once with the new ones. Undo and Redo serialize the object, put the stored
+//values over its attributes and deserialize it, the object is changed in place.
+//Changes to the same object within the coalesce time are merged into one, like the steps
+//of dragging it, then the state after one change is taken as the state before the next
+//and the object is serialized once per change instead of twice.
+//The oldest changes are dropped when the history is over its byte budget.
+//Adding and removing objects are still DoManager actions
+class DeltaDoManager
+{
+private:
+	struct Change
+	{
+	public:
+		ISerializable *Object;
+
+		//Binary HashedAttributes of the changed attributes
+		std::vector<char> OldValues;
+		std::vector<char> NewValues;
+
+		unsigned long Time;
+
+		unsigned int GetSize(void) const
+		{
+			return sizeof(Change) + (unsigned int)(OldValues.capacity() + NewValues.capacity());
+		}
+	};
+
+	typedef std::deque<Change> ChangesList;
+
+public:
+	DeltaDoManager(void) :
+		m_Object(NULL),
+		m_Before(&m_Snapshots[0]),
+		m_After(&m_Snapshots[1]),
+		m_SnapshotObject(NULL),
+		m_MaxBytes(4 * 1024 * 1024),
+		m_MaxActionCount(0),
+		m_CoalesceTime(500),
+		m_Size(0)
+	{
+	}
+
+	static DeltaDoManager &GetReference(void)
+	{
+		static DeltaDoManager instance;
+
+		return instance;
+	}
+
+	//The oldest changes are dropped when the history takes more than Value bytes
+	void SetMaxBytes(const unsigned int &Value)
+	{
+		m_MaxBytes = Value;
+
+		Trim();
+	}
+
+	//0 for no limit but the bytes
+	void SetMaxActionCount(const unsigned int &Value)
+	{
+		m_MaxActionCount = Value;
+
+		Trim();
+	}
+
+	//Changes to the same object less than Value milliseconds apart are one change, 0 disables merging
+	void SetCoalesceTime(const unsigned int &Value)
+	{
+		m_CoalesceTime = Value;
+	}
+
+	//Takes the state of Object before it's changed
+	void BeginChange(ISerializable *Object)
+	{
+		m_Object = Object;
+
+		// merged with the last change, which left the state of Object in m_Before
+		if (Object == m_SnapshotObject && m_Undo.size() && m_Undo.back().Object == Object && GetTickCount() - m_Undo.back().Time < m_CoalesceTime)
+			return;
+
+		m_SnapshotObject = NULL;
+
+		m_Before->Clear();
+		Object->Serialize(m_Before);
+	}
+
+	//Stores what changed since BeginChange, returns false if nothing did
+	bool EndChange(void)
+	{
+		if (!m_Object)
+			return false;
+
+		ISerializable *object = m_Object;
+		m_Object = NULL;
+
+		m_After->Clear();
+		object->Serialize(m_After);
+
+		Change change;
+		change.Object = object;
+		change.Time = GetTickCount();
+		// too many attributes for the binary form, the change can't be stored
+		if (!m_After->WriteChanges(*m_Before, change.NewValues) || !m_Before->WriteChanges(*m_After, change.OldValues))
+		{
+			m_SnapshotObject = NULL;
+			return false;
+		}
+
+		// the state before the next change of the object, if it's merged with this one
+		std::swap(m_Before, m_After);
+		m_SnapshotObject = object;
+
+		// the count, nothing changed
+		if (change.NewValues.size() == 2 && change.OldValues.size() == 2)
+			return false;
+
+		ClearRedo();
+
+		if (m_Undo.size() && m_Undo.back().Object == object && change.Time - m_Undo.back().Time < m_CoalesceTime)
+		{
+			Change &last = m_Undo.back();
+			m_Size -= last.GetSize();
+
+			// the oldest old values and the newest new values are kept
+			Merge(change.OldValues, last.OldValues, last.OldValues);
+			Merge(last.NewValues, change.NewValues, last.NewValues);
+			last.Time = change.Time;
+
+			m_Size += last.GetSize();
+		}
+		else
+		{
+			m_Undo.push_back(Change());
+			m_Undo.back().Object = change.Object;
+			m_Undo.back().Time = change.Time;
+			m_Undo.back().OldValues.swap(change.OldValues);
+			m_Undo.back().NewValues.swap(change.NewValues);
+
+			m_Size += m_Undo.back().GetSize();
+		}
+
+		Trim();
+
+		return true;
+	}
+
+	bool IsUndoEmpty(void) const
+	{
+		return m_Undo.empty();
+	}
+
+	bool IsRedoEmpty(void) const
+	{
+		return m_Redo.empty();
+	}
+
+	void Undo(void)
+	{
+		if (m_Undo.empty())
+			return;
+
+		Change &change = m_Undo.back();
+		Apply(change.Object, change.OldValues);
+
+		m_SnapshotObject = NULL;
+
+		m_Redo.push_back(Change());
+		m_Redo.back().Object = change.Object;
+		m_Redo.back().Time = change.Time;
+		m_Redo.back().OldValues.swap(change.OldValues);
+		m_Redo.back().NewValues.swap(change.NewValues);
+
+		m_Undo.pop_back();
+	}
+
+	void Redo(void)
+	{
+		if (m_Redo.empty())
+			return;
+
+		Change &change = m_Redo.back();
+		Apply(change.Object, change.NewValues);
+
+		m_SnapshotObject = NULL;
+
+		m_Undo.push_back(Change());
+		m_Undo.back().Object = change.Object;
+		m_Undo.back().Time = change.Time;
+		m_Undo.back().OldValues.swap(change.OldValues);
+		m_Undo.back().NewValues.swap(change.NewValues);
+
+		m_Redo.pop_back();
+	}
+
+	//Has to be called when an object in the history is destroyed
+	void Remove(ISerializable *Object)
+	{
+		Remove(m_Undo, Object);
+		Remove(m_Redo, Object);
+
+		if (m_Object == Object)
+			m_Object = NULL;
+
+		if (m_SnapshotObject == Object)
+			m_SnapshotObject = NULL;
+	}
+
+	void Clear(void)
+	{
+		m_Undo.clear();
+		m_Redo.clear();
+		m_Size = 0;
+		m_Object = NULL;
+		m_SnapshotObject = NULL;
+	}
+
+	//Bytes taken by the history
+	const unsigned int &GetSize(void) const
+	{
+		return m_Size;
+	}
+
+private:
+	void Apply(ISerializable *Object, const std::vector<char> &Values)
+	{
+		m_Values.Clear();
+		Object->Serialize(&m_Values);
+
+		m_Values.Read(&Values[0], (unsigned int)Values.size());
+
+		Object->Deserialize(&m_Values);
+	}
+
+	//Values is Bottom with the values of Top over it, it can be one of them
+	void Merge(const std::vector<char> &Bottom, const std::vector<char> &Top, std::vector<char> &Values)
+	{
+		m_Values.Clear();
+		m_Values.Read(&Bottom[0], (unsigned int)Bottom.size());
+		m_Values.Read(&Top[0], (unsigned int)Top.size());
+
+		Values.clear();
+		m_Values.Write(Values);
+	}
+
+	void ClearRedo(void)
+	{
+		for (unsigned int i = 0; i < m_Redo.size(); i++)
+			m_Size -= m_Redo[i].GetSize();
+
+		m_Redo.clear();
+	}
+
+	void Trim(void)
+	{
+		while (m_Undo.size() && (m_Size > m_MaxBytes || (m_MaxActionCount && m_Undo.size() > m_MaxActionCount)))
+		{
+			m_Size -= m_Undo.front().GetSize();
+			m_Undo.pop_front();
+		}
+	}
+
+	void Remove(ChangesList &Changes, ISerializable *Object)
+	{
+		for (ChangesList::iterator it = Changes.begin(); it != Changes.end();)
+			if (it->Object == Object)
+			{
+				m_Size -= it->GetSize();
+				it = Changes.erase(it);
+			}
+			else
+				it++;
+	}
+
+private:
+	DeltaDoManager(const DeltaDoManager &Other);
+	void operator =(const DeltaDoManager &Other);
+
+private:
+	ChangesList m_Undo;
+	ChangesList m_Redo;
+
+	ISerializable *m_Object;
+
+	//Swapped after each change, m_Before then holds the state of m_SnapshotObject
+	HashedAttributes m_Snapshots[2];
+	HashedAttributes *m_Before;
+	HashedAttributes *m_After;
+	ISerializable *m_SnapshotObject;
+
+	//For Apply and Merge
+	HashedAttributes m_Values;
+
+	unsigned int m_MaxBytes;
+	unsigned int m_MaxActionCount;
+	unsigned int m_CoalesceTime;
+	unsigned int m_Size;
+};
+
+END_NAMESPACE
\ No newline at end of file
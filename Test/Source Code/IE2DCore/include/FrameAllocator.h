@@ -0,0 +1,546 @@
+///////////////////////////////////////////////////////////////////////////////////
+///
+///  Impressive Engine 2D
+///
+/// Copyright (c) 2012-2013 Impressive Reality team
+///
+/// The license is
+///
+/// Permission is denied, to any person or company
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Project leader : O.Shahbazi <sh_omid_m@yahoo.com>
+///////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Common.h"
+#include "Core.h"
+#include "IGameObject.h"
+#include "ITransform.h"
+#include "Profiler.h"
+#include <Windows.h>
+#include <mutex>
+#include <vector>
+#include <list>
+#include <string>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <stdlib.h>
+#include <string.h>
+
+BEGIN_NAMESPACE
+
+//<Description>
+//Bump allocator of one thread, what it hands out lives until Reset and isn't freed one by one.
+//When its block is full it takes another one from the heap, Reset puts all of them together
+//in one block, so a frame which needs as much as the ones before doesn't go to the heap
+class FrameArena
+{
+private:
+	struct Block
+	{
+	public:
+		Block *Previous;
+		size_t Size;
+	};
+
+public:
+	enum
+	{
+		DEFAULT_BLOCK_SIZE = 64 * 1024
+	};
+
+public:
+	FrameArena(const size_t &BlockSize = DEFAULT_BLOCK_SIZE) :
+		m_BlockSize(BlockSize),
+		m_Block(NULL),
+		m_Offset(0),
+		m_UsedSize(0),
+		m_HeapAllocationCount(0),
+		m_AllocationCount(0)
+	{
+	}
+
+	~FrameArena(void)
+	{
+		FreeBlocks();
+	}
+
+	void *Allocate(const size_t &Size, const size_t &Alignment = sizeof(void*))
+	{
+#ifdef _DEBUG
+		m_AllocationCount++;
+#endif
+
+		size_t padding = (m_Block ? GetPadding(GetBuffer(m_Block) + m_Offset, Alignment) : 0);
+
+		if (!m_Block || m_Offset + padding + Size > m_Block->Size)
+		{
+			AddBlock(Size + Alignment);
+
+			padding = GetPadding(GetBuffer(m_Block), Alignment);
+		}
+
+		char *pointer = GetBuffer(m_Block) + m_Offset + padding;
+
+		m_Offset += padding + Size;
+		m_UsedSize += padding + Size;
+
+		return pointer;
+	}
+
+	//Only the last allocation goes back to the arena, the rest waits for Reset
+	void Deallocate(void *Pointer, const size_t &Size)
+	{
+		if (!m_Block || (char*)Pointer + Size != GetBuffer(m_Block) + m_Offset)
+			return;
+
+		m_Offset -= Size;
+		m_UsedSize -= Size;
+	}
+
+	void Reset(void)
+	{
+		m_HeapAllocationCount = 0;
+		m_AllocationCount = 0;
+
+		if (m_Block && m_Block->Previous)
+		{
+			size_t size = 0;
+
+			for (Block *block = m_Block; block; block = block->Previous)
+				size += block->Size;
+
+			FreeBlocks();
+			AddBlock(size);
+		}
+
+		m_Offset = 0;
+		m_UsedSize = 0;
+	}
+
+	size_t GetCapacity(void) const
+	{
+		size_t size = 0;
+
+		for (Block *block = m_Block; block; block = block->Previous)
+			size += block->Size;
+
+		return size;
+	}
+
+	const size_t &GetUsedSize(void) const
+	{
+		return m_UsedSize;
+	}
+
+	//Blocks taken from the heap since Reset, including the one Reset itself takes
+	const unsigned int &GetHeapAllocationCount(void) const
+	{
+		return m_HeapAllocationCount;
+	}
+
+	//Allocations since Reset, only counted in debug builds
+	const unsigned int &GetAllocationCount(void) const
+	{
+		return m_AllocationCount;
+	}
+
+private:
+	static char *GetBuffer(Block *Block)
+	{
+		return (char*)(Block + 1);
+	}
+
+	static size_t GetPadding(const char *Pointer, const size_t &Alignment)
+	{
+		return (Alignment - ((size_t)Pointer & (Alignment - 1))) & (Alignment - 1);
+	}
+
+	void AddBlock(const size_t &MinimumSize)
+	{
+		const size_t size = (MinimumSize > m_BlockSize ? MinimumSize : m_BlockSize);
+
+		Block *block = (Block*)malloc(sizeof(Block) + size);
+		block->Previous = m_Block;
+		block->Size = size;
+
+		m_Block = block;
+		m_Offset = 0;
+		m_HeapAllocationCount++;
+	}
+
+	void FreeBlocks(void)
+	{
+		while (m_Block)
+		{
+			Block *previous = m_Block->Previous;
+
+			free(m_Block);
+
+			m_Block = previous;
+		}
+	}
+
+private:
+	FrameArena(const FrameArena &Other);
+	void operator =(const FrameArena &Other);
+
+private:
+	size_t m_BlockSize;
+
+	Block *m_Block;
+	size_t m_Offset;
+
+	size_t m_UsedSize;
+	unsigned int m_HeapAllocationCount;
+	unsigned int m_AllocationCount;
+};
+
+
+//<Description>
+//Hands out memory which lives for the current frame from a FrameArena of the calling thread.
+//Attached to Core, all arenas are reset at the end of every UpdateOneFrame, which is
+//OnAfterRender, or when the next frame begins if there wasn't a render.
+//Anything allocated here can't be kept after the frame, and only the main thread and the
+//jobs of JobPool, which finish inside the frame, can use it. The loading threads of
+//SceneLoader and WorldStreamer run across frames and use the heap.
+//Use the Frame containers, FrameVector, FrameList and FrameString, or FrameQuery instead
+//of the query functions which return a Vector, List or String
+class FrameAllocator : public Core::IListener
+{
+public:
+	struct Statistics
+	{
+	public:
+		size_t UsedSize;
+		size_t Capacity;
+		unsigned int HeapAllocationCount;
+
+		//Only counted in debug builds
+		unsigned int AllocationCount;
+	};
+
+	typedef std::vector<FrameArena*> ArenasList;
+
+public:
+	FrameAllocator(void) :
+		m_Attached(false),
+		m_FrameDue(false)
+	{
+		memset(&m_Statistics, 0, sizeof(Statistics));
+	}
+
+	~FrameAllocator(void)
+	{
+		for (unsigned int i = 0; i < m_Arenas.size(); i++)
+			delete m_Arenas[i];
+	}
+
+	//The arenas of the scripts and the plugins are reset with the ones of the executable
+	DECLARE_SHARED_SINGLETON(FrameAllocator)
+
+public:
+	void Attach(void)
+	{
+		if (m_Attached)
+			return;
+
+		Core::GetReference().AddListener(this);
+		m_Attached = true;
+	}
+
+	void Detach(void)
+	{
+		if (!m_Attached)
+			return;
+
+		Core::GetReference().RemoveListener(this);
+		m_Attached = false;
+	}
+
+	const bool &IsAttached(void) const
+	{
+		return m_Attached;
+	}
+
+	static void *Allocate(const size_t &Size, const size_t &Alignment = sizeof(void*))
+	{
+		return GetArena().Allocate(Size, Alignment);
+	}
+
+	static void Deallocate(void *Pointer, const size_t &Size)
+	{
+		GetArena().Deallocate(Pointer, Size);
+	}
+
+	//Resets the arenas of all threads, no other thread may be allocating
+	void Reset(void)
+	{
+		PROFILE_SCOPE("FrameAllocator::Reset")
+
+		std::lock_guard<std::mutex> lock(m_ArenasLock);
+
+		memset(&m_Statistics, 0, sizeof(Statistics));
+
+		for (unsigned int i = 0; i < m_Arenas.size(); i++)
+		{
+			FrameArena &arena = *m_Arenas[i];
+
+			m_Statistics.UsedSize += arena.GetUsedSize();
+			m_Statistics.HeapAllocationCount += arena.GetHeapAllocationCount();
+			m_Statistics.AllocationCount += arena.GetAllocationCount();
+
+			arena.Reset();
+
+			// taking the arenas together is counted in the frame which needed it
+			m_Statistics.HeapAllocationCount += arena.GetHeapAllocationCount();
+			m_Statistics.Capacity += arena.GetCapacity();
+		}
+
+		m_FrameDue = false;
+
+		PROFILE_COUNTER("FrameAllocator Used", (double)m_Statistics.UsedSize)
+		PROFILE_COUNTER("FrameAllocator Heap Allocations", m_Statistics.HeapAllocationCount)
+	}
+
+	//Of the frame before the last Reset, the heap allocations are zero once it has as much
+	//as the frames need
+	const Statistics &GetStatistics(void) const
+	{
+		return m_Statistics;
+	}
+
+private:
+	static FrameArena &GetArena(void)
+	{
+		static THREAD_LOCAL FrameArena *arena = NULL;
+
+		if (!arena)
+			arena = GetReference().AddArena();
+
+		return *arena;
+	}
+
+	FrameArena *AddArena(void)
+	{
+		FrameArena *arena = new FrameArena;
+
+		std::lock_guard<std::mutex> lock(m_ArenasLock);
+		m_Arenas.push_back(arena);
+
+		return arena;
+	}
+
+	void OnBeforeSceneRemoved(IScene *Scene)
+	{
+	}
+
+	void OnSceneAdded(IScene *Scene)
+	{
+	}
+
+	void OnSetCurrentScene(IScene *Scene)
+	{
+	}
+
+	void OnBeforeUpdate(void)
+	{
+		if (m_FrameDue)
+			Reset();
+
+		m_FrameDue = true;
+	}
+
+	void OnAfterUpdate(void)
+	{
+	}
+
+	void OnBeforeRender(void)
+	{
+	}
+
+	void OnAfterRender(void)
+	{
+		Reset();
+	}
+
+private:
+	FrameAllocator(const FrameAllocator &Other);
+	void operator =(const FrameAllocator &Other);
+
+private:
+	ArenasList m_Arenas;
+	std::mutex m_ArenasLock;
+
+	Statistics m_Statistics;
+
+	bool m_Attached;
+	bool m_FrameDue;
+};
+
+
+//<Description>
+//Standard allocator over FrameAllocator for the standard containers, freeing does nothing
+//until the frame ends
+template <class T> class FrameStdAllocator
+{
+public:
+	typedef T value_type;
+	typedef T *pointer;
+	typedef const T *const_pointer;
+	typedef T &reference;
+	typedef const T &const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+
+	template <class U> struct rebind
+	{
+	public:
+		typedef FrameStdAllocator<U> other;
+	};
+
+public:
+	FrameStdAllocator(void)
+	{
+	}
+
+	template <class U> FrameStdAllocator(const FrameStdAllocator<U> &Other)
+	{
+	}
+
+	pointer address(reference Value) const
+	{
+		return &Value;
+	}
+
+	const_pointer address(const_reference Value) const
+	{
+		return &Value;
+	}
+
+	pointer allocate(size_type Count, const void *Hint = NULL)
+	{
+		return (pointer)FrameAllocator::Allocate(Count * sizeof(T), std::alignment_of<T>::value);
+	}
+
+	void deallocate(pointer Pointer, size_type Count)
+	{
+		FrameAllocator::Deallocate(Pointer, Count * sizeof(T));
+	}
+
+	size_type max_size(void) const
+	{
+		return (size_type)-1 / sizeof(T);
+	}
+
+	template <class U, class... Arguments> void construct(U *Pointer, Arguments&&... Values)
+	{
+		::new ((void*)Pointer) U(std::forward<Arguments>(Values)...);
+	}
+
+	template <class U> void destroy(U *Pointer)
+	{
+		Pointer->~U();
+	}
+};
+
+template <class T, class U> bool operator ==(const FrameStdAllocator<T> &Left, const FrameStdAllocator<U> &Right)
+{
+	return true;
+}
+
+template <class T, class U> bool operator !=(const FrameStdAllocator<T> &Left, const FrameStdAllocator<U> &Right)
+{
+	return false;
+}
+
+template <class T> using FrameVector = std::vector<T, FrameStdAllocator<T> >;
+template <class T> using FrameList = std::list<T, FrameStdAllocator<T> >;
+typedef std::basic_string<char, std::char_traits<char>, FrameStdAllocator<char> > FrameString;
+
+
+//<Description>
+//The query functions of IGameObject, ITransform and String which return containers by value,
+//filling Frame containers instead. Results are added to what the container already has
+class FrameQuery
+{
+public:
+	typedef FrameVector<IGameObject*> GameObjectsList;
+	typedef FrameVector<ITransform*> TransformsList;
+	typedef FrameVector<FrameString> StringsList;
+
+public:
+	static void GetGameObjects(IGameObject *Parent, const String &Name, GameObjectsList &GameObjects, const bool &SearchInChildren = false)
+	{
+		ITransform::TransformsList &children = Parent->GetTransform()->GetChildren();
+
+		for (unsigned int i = 0; i < children.GetSize(); i++)
+		{
+			IGameObject *child = children[i]->GetHolder();
+
+			if (child->GetName() == Name)
+				GameObjects.push_back(child);
+
+			if (SearchInChildren)
+				GetGameObjects(child, Name, GameObjects, true);
+		}
+	}
+
+	static void GetGameObjects(IGameObject *Parent, const unsigned int &Tag, GameObjectsList &GameObjects, const bool &SearchInChildren = false)
+	{
+		ITransform::TransformsList &children = Parent->GetTransform()->GetChildren();
+
+		for (unsigned int i = 0; i < children.GetSize(); i++)
+		{
+			IGameObject *child = children[i]->GetHolder();
+
+			if (child->GetTag() == Tag)
+				GameObjects.push_back(child);
+
+			if (SearchInChildren)
+				GetGameObjects(child, Tag, GameObjects, true);
+		}
+	}
+
+	static void GetChildren(ITransform *Transform, TransformsList &Children)
+	{
+		ITransform::TransformsList &children = Transform->GetChildren();
+
+		Children.reserve(Children.size() + children.GetSize());
+
+		for (unsigned int i = 0; i < children.GetSize(); i++)
+			Children.push_back(children[i]);
+	}
+
+	//Parts between any of the characters of Delimiters, empty ones are skipped
+	static void Split(const String &Value, StringsList &Parts, const char *Delimiters = "\t\n ")
+	{
+		const char *buffer = Value.GetBuffer();
+		const unsigned int length = Value.GetLength();
+
+		unsigned int start = 0;
+
+		for (unsigned int i = 0; i <= length; i++)
+		{
+			if (i < length && !strchr(Delimiters, buffer[i]))
+				continue;
+
+			if (i > start)
+				Parts.push_back(FrameString(buffer + start, i - start));
+
+			start = i + 1;
+		}
+	}
+
+	//To keep a part after the frame
+	static String ToString(const FrameString &Value)
+	{
+		return String(Value.c_str(), (int)Value.size());
+	}
+};
+
+END_NAMESPACE
\ No newline at end of file
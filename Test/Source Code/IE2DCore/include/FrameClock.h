@@ -0,0 +1,359 @@
+///////////////////////////////////////////////////////////////////////////////////
+///
+///  Impressive Engine 2D
+///
+/// Copyright (c) 2012-2013 Impressive Reality team
+///
+/// The license is
+///
+/// Permission is denied, to any person or company
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Project leader : O.Shahbazi <sh_omid_m@yahoo.com>
+///////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Common.h"
+#include "Core.h"
+#include "Profiler.h"
+#include <Windows.h>
+
+#pragma comment(lib, "winmm.lib")
+
+BEGIN_NAMESPACE
+
+//<Description>
+//Time of the frames in nanoseconds of the performance counter, in place of the milliseconds
+//of CTime which make the delta time jump by a millisecond at high frame rates.
+//Attached to Core, a frame begins in OnBeforeUpdate, the total time is in double seconds from
+//the counter, so it doesn't gather rounding, and the smoothed delta time is steadier for
+//movement and animation.
+//It also paces the frames to a target frame time when they are faster, at the end of a frame:
+//sleeping gives the CPU back but wakes up late, spinning is exact but keeps a core busy,
+//PM_SLEEP_AND_SPIN sleeps until a bit before the target and spins the rest
+class FrameClock : public Core::IListener
+{
+public:
+	enum PacingMode
+	{
+		PM_NONE = 0,
+		PM_SLEEP,
+		PM_SPIN,
+		PM_SLEEP_AND_SPIN
+	};
+
+	//Longest delta time in the smoothed one, in nanoseconds, a break in the debugger or a
+	//loading hitch doesn't slow down the next frames
+	static const long long MAX_SMOOTHED_DELTA_TIME = 250000000;
+
+	//Time before the target PM_SLEEP_AND_SPIN spins, a sleep can wake up this late
+	static const long long DEFAULT_SPIN_TIME = 2000000;
+
+public:
+	FrameClock(void) :
+		m_Attached(false),
+		m_Mode(PM_NONE),
+		m_TargetFrameTime(0),
+		m_SpinTime(DEFAULT_SPIN_TIME),
+		m_TimerPeriodSet(false),
+		m_StartTime(0),
+		m_FrameStart(0),
+		m_FrameCount(0),
+		m_DeltaTime(0),
+		m_SmoothedDeltaTime(0.0),
+		m_Smoothing(0.1),
+		m_NextFrame(0),
+		m_WaitTime(0),
+		m_Paced(true)
+	{
+	}
+
+	~FrameClock(void)
+	{
+		SetTimerPeriod(false);
+	}
+
+	static FrameClock &GetReference(void)
+	{
+		static FrameClock instance;
+
+		return instance;
+	}
+
+	//Monotonic, in nanoseconds from the performance counter, from any thread
+	static long long GetTime(void)
+	{
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+
+		LARGE_INTEGER time;
+		QueryPerformanceCounter(&time);
+
+		// without overflowing for days of counter ticks
+		return (time.QuadPart / frequency.QuadPart) * 1000000000ll + (time.QuadPart % frequency.QuadPart) * 1000000000ll / frequency.QuadPart;
+	}
+
+	void Attach(void)
+	{
+		if (m_Attached)
+			return;
+
+		Core::GetReference().AddListener(this);
+		m_Attached = true;
+
+		Reset();
+
+		SetTimerPeriod(m_Mode == PM_SLEEP || m_Mode == PM_SLEEP_AND_SPIN);
+	}
+
+	void Detach(void)
+	{
+		if (!m_Attached)
+			return;
+
+		Core::GetReference().RemoveListener(this);
+		m_Attached = false;
+
+		SetTimerPeriod(false);
+	}
+
+	const bool &IsAttached(void) const
+	{
+		return m_Attached;
+	}
+
+	//The total time begins again from now
+	void Reset(void)
+	{
+		m_StartTime = GetTime();
+		m_FrameStart = m_StartTime;
+		m_FrameCount = 0;
+		m_DeltaTime = 0;
+		m_SmoothedDeltaTime = 0.0;
+		m_NextFrame = 0;
+		m_WaitTime = 0;
+		m_Paced = true;
+	}
+
+	//FrameRate of 0 doesn't pace
+	void SetPacing(const PacingMode &Mode, const double &FrameRate)
+	{
+		m_Mode = Mode;
+		m_TargetFrameTime = (FrameRate > 0.0 ? (long long)(1000000000.0 / FrameRate) : 0);
+		m_NextFrame = 0;
+
+		// Sleep is as long as the system timer period, 15.6 ms without this
+		if (m_Attached)
+			SetTimerPeriod(m_Mode == PM_SLEEP || m_Mode == PM_SLEEP_AND_SPIN);
+	}
+
+	const PacingMode &GetPacingMode(void) const
+	{
+		return m_Mode;
+	}
+
+	//In nanoseconds
+	const long long &GetTargetFrameTime(void) const
+	{
+		return m_TargetFrameTime;
+	}
+
+	//In nanoseconds
+	void SetSpinTime(const long long &Value)
+	{
+		m_SpinTime = Value;
+	}
+
+	const long long &GetSpinTime(void) const
+	{
+		return m_SpinTime;
+	}
+
+	//In seconds from Attach or Reset to the start of the current frame
+	double GetTotalTime(void) const
+	{
+		return (double)(m_FrameStart - m_StartTime) / 1000000000.0;
+	}
+
+	//In seconds from the start of the last frame to the start of the current one
+	double GetDeltaTime(void) const
+	{
+		return (double)m_DeltaTime / 1000000000.0;
+	}
+
+	//In seconds
+	const double &GetSmoothedDeltaTime(void) const
+	{
+		return m_SmoothedDeltaTime;
+	}
+
+	//Weight of a new delta time in the smoothed one, from 0 to 1
+	void SetSmoothing(const double &Value)
+	{
+		m_Smoothing = Value;
+	}
+
+	const double &GetSmoothing(void) const
+	{
+		return m_Smoothing;
+	}
+
+	//In nanoseconds of GetTime
+	const long long &GetFrameStart(void) const
+	{
+		return m_FrameStart;
+	}
+
+	const long long &GetDeltaTimeInNanoseconds(void) const
+	{
+		return m_DeltaTime;
+	}
+
+	const unsigned int &GetFrameCount(void) const
+	{
+		return m_FrameCount;
+	}
+
+	//In nanoseconds, how long the last frame waited for its target
+	const long long &GetWaitTime(void) const
+	{
+		return m_WaitTime;
+	}
+
+private:
+	void SetTimerPeriod(const bool &Value)
+	{
+		if (Value == m_TimerPeriodSet)
+			return;
+
+		if (Value)
+			timeBeginPeriod(1);
+		else
+			timeEndPeriod(1);
+
+		m_TimerPeriodSet = Value;
+	}
+
+	void Wait(void)
+	{
+		m_WaitTime = 0;
+
+		if (m_Mode == PM_NONE || !m_TargetFrameTime)
+			return;
+
+		const long long start = GetTime();
+
+		// frames are paced from the target of the last one, so they don't drift, unless it's
+		// more than a frame late, then the frames don't hurry to catch up
+		if (!m_NextFrame || start - m_NextFrame > m_TargetFrameTime)
+			m_NextFrame = m_FrameStart;
+
+		m_NextFrame += m_TargetFrameTime;
+
+		if (start >= m_NextFrame)
+			return;
+
+		PROFILE_SCOPE("FrameClock::Wait")
+
+		const long long spinTime = (m_Mode == PM_SLEEP ? 0 : m_Mode == PM_SPIN ? m_TargetFrameTime : m_SpinTime);
+
+		long long time = start;
+
+		while (time < m_NextFrame)
+		{
+			// whole milliseconds rounded down, as a sleep wakes up late, what is left under a
+			// millisecond is yielded with Sleep(0) and checked again
+			if (m_NextFrame - time > spinTime)
+				Sleep(m_Mode == PM_SLEEP ? (DWORD)((m_NextFrame - time) / 1000000) : 1);
+			else
+				YieldProcessor();
+
+			time = GetTime();
+		}
+
+		m_WaitTime = time - start;
+	}
+
+	void Tick(void)
+	{
+		const long long time = GetTime();
+
+		m_DeltaTime = time - m_FrameStart;
+		m_FrameStart = time;
+
+		const double deltaTime = (double)(m_DeltaTime < MAX_SMOOTHED_DELTA_TIME ? m_DeltaTime : MAX_SMOOTHED_DELTA_TIME) / 1000000000.0;
+
+		if (m_FrameCount++)
+			m_SmoothedDeltaTime += (deltaTime - m_SmoothedDeltaTime) * m_Smoothing;
+		else
+			m_SmoothedDeltaTime = deltaTime;
+
+		PROFILE_COUNTER("Frame Time", (double)m_DeltaTime / 1000000.0)
+	}
+
+	void OnBeforeSceneRemoved(IScene *Scene)
+	{
+	}
+
+	void OnSceneAdded(IScene *Scene)
+	{
+	}
+
+	void OnSetCurrentScene(IScene *Scene)
+	{
+	}
+
+	void OnBeforeUpdate(void)
+	{
+		// the frame before wasn't rendered
+		if (!m_Paced)
+			Wait();
+
+		m_Paced = false;
+
+		Tick();
+	}
+
+	void OnAfterUpdate(void)
+	{
+	}
+
+	void OnBeforeRender(void)
+	{
+	}
+
+	// waiting after the render, the input of the next frame isn't older for it
+	void OnAfterRender(void)
+	{
+		Wait();
+
+		m_Paced = true;
+	}
+
+private:
+	FrameClock(const FrameClock &Other);
+	void operator =(const FrameClock &Other);
+
+private:
+	bool m_Attached;
+
+	PacingMode m_Mode;
+	long long m_TargetFrameTime;
+	long long m_SpinTime;
+	bool m_TimerPeriodSet;
+
+	long long m_StartTime;
+	long long m_FrameStart;
+	unsigned int m_FrameCount;
+	long long m_DeltaTime;
+	double m_SmoothedDeltaTime;
+	double m_Smoothing;
+
+	long long m_NextFrame;
+	long long m_WaitTime;
+	bool m_Paced;
+};
+
+END_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,1038 @@
+///////////////////////////////////////////////////////////////////////////////////
+///
+///  Impressive Engine 2D
+///
+/// Copyright (c) 2012-2013 Impressive Reality team
+///
+/// The license is
+///
+/// Permission is denied, to any person or company
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Project leader : O.Shahbazi <sh_omid_m@yahoo.com>
+///////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "IAttributes.h"
+#include "TreeElement.h"
+#include "StreamTreeParser.h"
+#include "StringConverter.h"
+#include <vector>
+#include <string.h>
+
+BEGIN_NAMESPACE
+
+//FNV-1a of the first Index characters of Name, unrolled by the compiler for string literals
+template <unsigned int Length, unsigned int Index> struct AttributeNameHasher
+{
+public:
+	__forceinline static unsigned int Hash(const char (&Name)[Length])
+	{
+		return (AttributeNameHasher<Length, Index - 1>::Hash(Name) ^ (unsigned char)Name[Index - 1]) * 16777619u;
+	}
+};
+
+template <unsigned int Length> struct AttributeNameHasher<Length, 0>
+{
+public:
+	__forceinline static unsigned int Hash(const char (&Name)[Length])
+	{
+		return 2166136261u;
+	}
+};
+
+//<Description>
+//Name of an attribute as a 32 bit FNV-1a hash. A string literal is hashed at compile
+//time, like Attributes.Get("Mass", m_Mass), other names are hashed at run time.
+//A constant array is only taken for a literal when its NULL is its last character, the
+//name ends at the first NULL anyway, so it hashes the same as the literal
+class AttributeID
+{
+public:
+	template <unsigned int Length> AttributeID(const char (&Name)[Length]) :
+		m_Name(Name),
+		m_NameLength(GetLength(Name, Length)),
+		m_IsLiteral(m_NameLength == Length - 1)
+	{
+		m_Hash = (m_IsLiteral ? AttributeNameHasher<Length, Length - 1>::Hash(Name) : Hash(Name, m_NameLength));
+	}
+
+	//A buffer, like char name[32], is never a literal
+	template <unsigned int Length> AttributeID(char (&Name)[Length]) :
+		m_Hash(0),
+		m_Name(Name),
+		m_NameLength(GetLength(Name, Length)),
+		m_IsLiteral(false)
+	{
+		m_Hash = Hash(Name, m_NameLength);
+	}
+
+
+	explicit AttributeID(const String &Name) :
+		m_Hash(Hash(Name.GetBuffer(), Name.GetLength())),
+		m_Name(Name.GetBuffer()),
+		m_NameLength(Name.GetLength()),
+		m_IsLiteral(false)
+	{
+	}
+
+	AttributeID(const char *Name, const unsigned int &Length) :
+		m_Hash(Hash(Name, Length)),
+		m_Name(Name),
+		m_NameLength(Length),
+		m_IsLiteral(false)
+	{
+	}
+
+	const unsigned int &GetHash(void) const
+	{
+		return m_Hash;
+	}
+
+	//Not NULL terminated unless it's a literal, and only valid as long as the string the ID was made of
+	const char *GetName(void) const
+	{
+		return m_Name;
+	}
+
+	const unsigned int &GetNameLength(void) const
+	{
+		return m_NameLength;
+	}
+
+	const bool &IsLiteral(void) const
+	{
+		return m_IsLiteral;
+	}
+
+	static unsigned int Hash(const char *Name, const unsigned int &Length)
+	{
+		unsigned int hash = 2166136261u;
+
+		for (unsigned int i = 0; i < Length; i++)
+			hash = (hash ^ (unsigned char)Name[i]) * 16777619u;
+
+		return hash;
+	}
+
+private:
+	//Up to the first NULL, within Size
+	static unsigned int GetLength(const char *Name, const unsigned int &Size)
+	{
+		unsigned int length = 0;
+
+		while (length < Size && Name[length])
+			length++;
+
+		return length;
+	}
+
+private:
+	unsigned int m_Hash;
+	const char *m_Name;
+	unsigned int m_NameLength;
+	bool m_IsLiteral;
+};
+
+//<Description>
+//Attributes looked up by hashed IDs instead of compared by name, with the values kept
+//as numbers in a flat array instead of as text. The first 16 attributes need no allocation.
+//Read and Write with a buffer use a compact binary form holding the IDs but not the names,
+//the TreeElement and StreamTreeParser forms are the text one of IAttributes.
+//Read with a StreamTreeParser isn't part of IAttributes, it's a faster
+//StreamTreeParser::ReadAttributes for code which knows it has a HashedAttributes.
+//Values read as text are converted once, on the first Get of a type.
+//The names of the IAttributes functions are hashed on each call, the typed Set and Get
+//with a literal are the fast path
+class HashedAttributes : public IAttributes
+{
+public:
+	enum ValueType
+	{
+		VT_NONE = 0,
+		VT_BOOLEAN,
+		VT_INTEGER,
+		VT_FLOAT,
+		VT_STRING,
+		VT_COLOUR,
+		VT_VECTOR2D,
+		VT_VECTOR3D
+	};
+
+private:
+	struct TextRange
+	{
+	public:
+		unsigned int Offset;
+		unsigned int Length;
+	};
+
+	struct Entry
+	{
+	public:
+		unsigned int ID;
+		unsigned char Type;
+
+		//A literal, or NULL when the name is in m_Characters at NameOffset
+		const char *Name;
+		unsigned int NameOffset;
+
+		union
+		{
+			bool Boolean;
+			int Integer;
+			float Float;
+			float Vector[3];
+			unsigned int Colour[4];
+			TextRange Text;
+		};
+	};
+
+	static const unsigned int INLINE_CAPACITY = 16;
+
+	//The binary form counts the attributes in 16 bits
+	static const unsigned int MAX_BINARY_COUNT = 0xFFFF;
+	static const unsigned int INVALID_OFFSET = 0xFFFFFFFF;
+
+public:
+	HashedAttributes(void) :
+		m_Entries(m_InlineEntries),
+		m_Count(0),
+		m_Capacity(INLINE_CAPACITY),
+		m_TagName(GetDefaultTagName())
+	{
+	}
+
+	~HashedAttributes(void)
+	{
+		if (m_Entries != m_InlineEntries)
+			delete []m_Entries;
+	}
+
+	//Removes the attributes but keeps the memory, to serialize the next object
+	void Clear(void)
+	{
+		m_Count = 0;
+		m_Characters.clear();
+	}
+
+	const unsigned int &GetCount(void) const
+	{
+		return m_Count;
+	}
+
+	void Set(const AttributeID &ID, const bool &Value)
+	{
+		Insert(ID, VT_BOOLEAN).Boolean = Value;
+	}
+
+	void Set(const AttributeID &ID, const int &Value)
+	{
+		Insert(ID, VT_INTEGER).Integer = Value;
+	}
+
+	void Set(const AttributeID &ID, const float &Value)
+	{
+		Insert(ID, VT_FLOAT).Float = Value;
+	}
+
+	void Set(const AttributeID &ID, const char *Value)
+	{
+		SetText(Insert(ID, VT_STRING), Value, (unsigned int)strlen(Value));
+	}
+
+	void Set(const AttributeID &ID, const String &Value)
+	{
+		SetText(Insert(ID, VT_STRING), Value.GetBuffer(), Value.GetLength());
+	}
+
+	void Set(const AttributeID &ID, const Colour &Value)
+	{
+		Entry &entry = Insert(ID, VT_COLOUR);
+		entry.Colour[0] = Value.R;
+		entry.Colour[1] = Value.G;
+		entry.Colour[2] = Value.B;
+		entry.Colour[3] = Value.A;
+	}
+
+	void Set(const AttributeID &ID, const Vector2D &Value)
+	{
+		Entry &entry = Insert(ID, VT_VECTOR2D);
+		entry.Vector[0] = Value.X;
+		entry.Vector[1] = Value.Y;
+	}
+
+	void Set(const AttributeID &ID, const Vector3D &Value)
+	{
+		Entry &entry = Insert(ID, VT_VECTOR3D);
+		entry.Vector[0] = Value.X;
+		entry.Vector[1] = Value.Y;
+		entry.Vector[2] = Value.Z;
+	}
+
+	//Get leaves Value as it is and returns false when there's no such attribute or it can't be converted
+	bool Get(const AttributeID &ID, bool &Value)
+	{
+		Entry *entry = Find(ID.GetHash());
+
+		if (!entry || !Convert(*entry, VT_BOOLEAN))
+			return false;
+
+		Value = (entry->Type == VT_BOOLEAN ? entry->Boolean : (entry->Type == VT_INTEGER ? entry->Integer != 0 : entry->Float != 0.f));
+
+		return true;
+	}
+
+	bool Get(const AttributeID &ID, int &Value)
+	{
+		Entry *entry = Find(ID.GetHash());
+
+		if (!entry || !Convert(*entry, VT_INTEGER))
+			return false;
+
+		Value = (entry->Type == VT_INTEGER ? entry->Integer : (entry->Type == VT_FLOAT ? (int)entry->Float : (int)entry->Boolean));
+
+		return true;
+	}
+
+	bool Get(const AttributeID &ID, float &Value)
+	{
+		Entry *entry = Find(ID.GetHash());
+
+		if (!entry || !Convert(*entry, VT_FLOAT))
+			return false;
+
+		Value = (entry->Type == VT_FLOAT ? entry->Float : (entry->Type == VT_INTEGER ? (float)entry->Integer : (float)entry->Boolean));
+
+		return true;
+	}
+
+	bool Get(const AttributeID &ID, String &Value)
+	{
+		Entry *entry = Find(ID.GetHash());
+
+		if (!entry)
+			return false;
+
+		Value = ToText(*entry);
+
+		return true;
+	}
+
+	bool Get(const AttributeID &ID, Colour &Value)
+	{
+		Entry *entry = Find(ID.GetHash());
+
+		if (!entry || !Convert(*entry, VT_COLOUR) || entry->Type != VT_COLOUR)
+			return false;
+
+		Value = Colour(entry->Colour[0], entry->Colour[1], entry->Colour[2], entry->Colour[3]);
+
+		return true;
+	}
+
+	bool Get(const AttributeID &ID, Vector2D &Value)
+	{
+		Entry *entry = Find(ID.GetHash());
+
+		if (!entry || !Convert(*entry, VT_VECTOR2D) || entry->Type != VT_VECTOR2D)
+			return false;
+
+		Value = Vector2D(entry->Vector[0], entry->Vector[1]);
+
+		return true;
+	}
+
+	bool Get(const AttributeID &ID, Vector3D &Value)
+	{
+		Entry *entry = Find(ID.GetHash());
+
+		if (!entry || !Convert(*entry, VT_VECTOR3D) || entry->Type != VT_VECTOR3D)
+			return false;
+
+		Value = Vector3D(entry->Vector[0], entry->Vector[1], entry->Vector[2]);
+
+		return true;
+	}
+
+	const ValueType GetType(const AttributeID &ID)
+	{
+		const Entry *entry = Find(ID.GetHash());
+
+		return (entry ? (ValueType)entry->Type : VT_NONE);
+	}
+
+	const bool Has(const AttributeID &ID)
+	{
+		return (Find(ID.GetHash()) != NULL);
+	}
+
+	template <unsigned int Length> const bool Has(const char (&Name)[Length])
+	{
+		return Has(AttributeID(Name));
+	}
+
+	void Remove(const AttributeID &ID)
+	{
+		Entry *entry = Find(ID.GetHash());
+
+		if (!entry)
+			return;
+
+		*entry = m_Entries[--m_Count];
+	}
+
+	template <unsigned int Length> void Remove(const char (&Name)[Length])
+	{
+		Remove(AttributeID(Name));
+	}
+
+	//Appends the binary form to Buffer. Returns false and appends nothing if there are more
+	//than MAX_BINARY_COUNT attributes
+	bool Write(std::vector<char> &Buffer) const
+	{
+		if (m_Count > MAX_BINARY_COUNT)
+			return false;
+
+		const unsigned short count = (unsigned short)m_Count;
+		Append(Buffer, &count, 2);
+
+		for (unsigned int i = 0; i < m_Count; i++)
+			WriteEntry(m_Entries[i], Buffer);
+
+		return true;
+	}
+
+	//Appends the binary form of the attributes which Before doesn't have, or has with another value.
+	//Reading it over Before gives these attributes. Fails like Write
+	bool WriteChanges(const HashedAttributes &Before, std::vector<char> &Buffer) const
+	{
+		if (m_Count > MAX_BINARY_COUNT)
+			return false;
+
+		const unsigned int countOffset = (unsigned int)Buffer.size();
+		unsigned short count = 0;
+		Append(Buffer, &count, 2);
+
+		for (unsigned int i = 0; i < m_Count; i++)
+		{
+			const Entry *before = Before.Find(m_Entries[i].ID);
+
+			if (before && IsEqual(m_Entries[i], Before, *before))
+				continue;
+
+			WriteEntry(m_Entries[i], Buffer);
+			count++;
+		}
+
+		memcpy(&Buffer[countOffset], &count, 2);
+
+		return true;
+	}
+
+	//Reads the binary form over the attributes there are, returns the bytes read or 0 if Data isn't valid.
+	//The attributes which are added have no names, so they can't be written as text again
+	unsigned int Read(const char *Data, const unsigned int &Size)
+	{
+		if (Size < 2)
+			return 0;
+
+		unsigned short count;
+		memcpy(&count, Data, 2);
+
+		unsigned int offset = 2;
+
+		for (unsigned int i = 0; i < count; i++)
+		{
+			if (offset + 5 > Size)
+				return 0;
+
+			unsigned int id;
+			memcpy(&id, Data + offset, 4);
+
+			const unsigned char type = (unsigned char)Data[offset + 4];
+			offset += 5;
+
+			const unsigned int size = GetBinarySize(type, Data + offset, Size - offset);
+			if (!size || offset + size > Size)
+				return 0;
+
+			Entry &entry = Insert(id, type);
+
+			switch (type)
+			{
+			case VT_BOOLEAN:
+				entry.Boolean = (Data[offset] != 0);
+				break;
+
+			case VT_STRING:
+				SetText(entry, Data + offset + 2, size - 2);
+				break;
+
+			case VT_COLOUR:
+				for (unsigned int j = 0; j < 4; j++)
+					entry.Colour[j] = (unsigned char)Data[offset + j];
+				break;
+
+			default:
+				memcpy(&entry.Integer, Data + offset, size);
+			}
+
+			offset += size;
+		}
+
+		return offset;
+	}
+
+	void Read(TreeElement *Element)
+	{
+		m_TagName = Element->Name;
+
+		FOR_EACH_MAP(it, Element->Attributes)
+			SetText(Insert(AttributeID(it->first), VT_STRING), it->second.GetBuffer(), it->second.GetLength());
+	}
+
+	//After ET_ENTER, moves to the ET_LEAVE of the element
+	void Read(StreamTreeParser *Parser)
+	{
+		m_TagName = Parser->GetName().ToString();
+
+		const unsigned int depth = Parser->GetDepth();
+
+		StreamTreeParser::EventType event;
+
+		while ((event = Parser->Next()) == StreamTreeParser::ET_ATTRIBUTE)
+		{
+			const StringView &name = Parser->GetName();
+			const StringView &value = Parser->GetValue();
+
+			Entry &entry = Insert(AttributeID(name.Data, name.Length), VT_STRING);
+
+			if (memchr(value.Data, '&', value.Length))
+			{
+				const String decoded = StreamTreeParser::Decode(value);
+				SetText(entry, decoded.GetBuffer(), decoded.GetLength());
+			}
+			else
+				SetText(entry, value.Data, value.Length);
+		}
+
+		while (!(event == StreamTreeParser::ET_LEAVE && Parser->GetDepth() < depth) && event != StreamTreeParser::ET_END && event != StreamTreeParser::ET_ERROR)
+			event = Parser->Next();
+	}
+
+	//Attributes read from the binary form have no names and are skipped
+	void Write(TreeElement *Element)
+	{
+		Element->Name = m_TagName;
+
+		for (unsigned int i = 0; i < m_Count; i++)
+		{
+			const char *name = GetName(m_Entries[i]);
+
+			if (name)
+				Element->Attributes[name] = ToText(m_Entries[i]);
+		}
+	}
+
+	void AddBoolean(const String &Name, const bool &Value)
+	{
+		Set(AttributeID(Name), Value);
+	}
+
+	void AddInteger(const String &Name, const int &Value)
+	{
+		Set(AttributeID(Name), Value);
+	}
+
+	void AddFloat(const String &Name, const float &Value)
+	{
+		Set(AttributeID(Name), Value);
+	}
+
+	void AddString(const String &Name, const String &Value)
+	{
+		Set(AttributeID(Name), Value);
+	}
+
+	void AddColour(const String &Name, const Colour &Value)
+	{
+		Set(AttributeID(Name), Value);
+	}
+
+	void AddVector2D(const String &Name, const Vector2D &Value)
+	{
+		Set(AttributeID(Name), Value);
+	}
+
+	void AddVector3D(const String &Name, const Vector3D &Value)
+	{
+		Set(AttributeID(Name), Value);
+	}
+
+	void SetBoolean(const String &Name, const bool &Value)
+	{
+		Set(AttributeID(Name), Value);
+	}
+
+	void SetInteger(const String &Name, const int &Value)
+	{
+		Set(AttributeID(Name), Value);
+	}
+
+	void SetFloat(const String &Name, const float &Value)
+	{
+		Set(AttributeID(Name), Value);
+	}
+
+	void SetString(const String &Name, const String &Value)
+	{
+		Set(AttributeID(Name), Value);
+	}
+
+	void SetColour(const String &Name, const Colour &Value)
+	{
+		Set(AttributeID(Name), Value);
+	}
+
+	void SetVector2D(const String &Name, const Vector2D &Value)
+	{
+		Set(AttributeID(Name), Value);
+	}
+
+	void SetVector3D(const String &Name, const Vector3D &Value)
+	{
+		Set(AttributeID(Name), Value);
+	}
+
+	const bool GetBoolean(const String &Name)
+	{
+		bool value = false;
+		Get(AttributeID(Name), value);
+
+		return value;
+	}
+
+	//The references returned by the IAttributes getters are valid until the next call
+	const int &GetInteger(const String &Name)
+	{
+		m_Integer = 0;
+		Get(AttributeID(Name), m_Integer);
+
+		return m_Integer;
+	}
+
+	const float &GetFloat(const String &Name)
+	{
+		m_Float = 0.f;
+		Get(AttributeID(Name), m_Float);
+
+		return m_Float;
+	}
+
+	const String GetString(const String &Name)
+	{
+		String value;
+		Get(AttributeID(Name), value);
+
+		return value;
+	}
+
+	const Colour &GetColour(const String &Name)
+	{
+		m_Colour = Colour();
+		Get(AttributeID(Name), m_Colour);
+
+		return m_Colour;
+	}
+
+	const Vector2D &GetVector2D(const String &Name)
+	{
+		m_Vector2D = Vector2D();
+		Get(AttributeID(Name), m_Vector2D);
+
+		return m_Vector2D;
+	}
+
+	const Vector3D &GetVector3D(const String &Name)
+	{
+		m_Vector3D = Vector3D();
+		Get(AttributeID(Name), m_Vector3D);
+
+		return m_Vector3D;
+	}
+
+	void Remove(const String &Name)
+	{
+		Remove(AttributeID(Name));
+	}
+
+	const bool Has(const String &Name)
+	{
+		return Has(AttributeID(Name));
+	}
+
+	void SetTagName(const String &TagName)
+	{
+		m_TagName = TagName;
+	}
+
+	const String &GetTagName(void)
+	{
+		return m_TagName;
+	}
+
+private:
+	Entry *Find(const unsigned int &ID)
+	{
+		for (unsigned int i = 0; i < m_Count; i++)
+			if (m_Entries[i].ID == ID)
+				return &m_Entries[i];
+
+		return NULL;
+	}
+
+	const Entry *Find(const unsigned int &ID) const
+	{
+		for (unsigned int i = 0; i < m_Count; i++)
+			if (m_Entries[i].ID == ID)
+				return &m_Entries[i];
+
+		return NULL;
+	}
+
+	//Returns the entry of ID typed as Type, added if it's missing
+	Entry &Insert(const AttributeID &ID, const unsigned char &Type)
+	{
+		Entry *entry = Find(ID.GetHash());
+
+		if (entry)
+		{
+#ifdef _DEBUG
+			const char *name = GetName(*entry);
+
+			if (name && (strncmp(name, ID.GetName(), ID.GetNameLength()) != 0 || name[ID.GetNameLength()] != '\0'))
+				LOG_ERROR("Attributes [" + String(name) + "] and [" + String(ID.GetName(), ID.GetNameLength()) + "] have the same hash")
+#endif
+
+			ChangeType(*entry, Type);
+			return *entry;
+		}
+
+		entry = &Append(ID.GetHash(), Type);
+
+		if (ID.IsLiteral())
+			entry->Name = ID.GetName();
+		else
+		{
+			entry->NameOffset = (unsigned int)m_Characters.size();
+			m_Characters.insert(m_Characters.end(), ID.GetName(), ID.GetName() + ID.GetNameLength());
+			m_Characters.push_back('\0');
+		}
+
+		return *entry;
+	}
+
+	Entry &Insert(const unsigned int &ID, const unsigned char &Type)
+	{
+		Entry *entry = Find(ID);
+
+		if (entry)
+		{
+			ChangeType(*entry, Type);
+			return *entry;
+		}
+
+		return Append(ID, Type);
+	}
+
+	Entry &Append(const unsigned int &ID, const unsigned char &Type)
+	{
+		if (m_Count == m_Capacity)
+		{
+			Entry *entries = new Entry[m_Capacity * 2];
+			memcpy(entries, m_Entries, m_Count * sizeof(Entry));
+
+			if (m_Entries != m_InlineEntries)
+				delete []m_Entries;
+
+			m_Entries = entries;
+			m_Capacity *= 2;
+		}
+
+		Entry &entry = m_Entries[m_Count++];
+		entry.ID = ID;
+		entry.Type = Type;
+		entry.Name = NULL;
+		entry.NameOffset = INVALID_OFFSET;
+		entry.Text.Offset = INVALID_OFFSET;
+		entry.Text.Length = 0;
+
+		return entry;
+	}
+
+	//The value of an entry which wasn't a string doesn't point at any characters
+	void ChangeType(Entry &Entry, const unsigned char &Type)
+	{
+		if (Entry.Type == Type)
+			return;
+
+		if (Entry.Type != VT_STRING)
+		{
+			Entry.Text.Offset = INVALID_OFFSET;
+			Entry.Text.Length = 0;
+		}
+
+		Entry.Type = Type;
+	}
+
+	//Reuses the characters of the previous text of the entry when the new one fits
+	void SetText(Entry &Entry, const char *Value, const unsigned int &Length)
+	{
+		if (Entry.Text.Offset == INVALID_OFFSET || Entry.Text.Length < Length)
+		{
+			Entry.Text.Offset = (unsigned int)m_Characters.size();
+			m_Characters.resize(m_Characters.size() + Length + 1);
+		}
+
+		Entry.Type = VT_STRING;
+		Entry.Text.Length = Length;
+
+		memcpy(&m_Characters[Entry.Text.Offset], Value, Length);
+		m_Characters[Entry.Text.Offset + Length] = '\0';
+	}
+
+	//Parses text read from a file into Type, numbers of another type are converted when they're read
+	bool Convert(Entry &Entry, const unsigned char &Type)
+	{
+		if (Entry.Type == Type)
+			return true;
+
+		if (Entry.Type != VT_STRING)
+			return (Type <= VT_FLOAT && Entry.Type <= VT_FLOAT);
+
+		const String text(&m_Characters[Entry.Text.Offset], Entry.Text.Length);
+
+		switch (Type)
+		{
+		case VT_BOOLEAN:
+			Entry.Boolean = StringConverter::ParseBool(text);
+			break;
+
+		case VT_INTEGER:
+			Entry.Integer = StringConverter::ParseInteger(text);
+			break;
+
+		case VT_FLOAT:
+			Entry.Float = StringConverter::ParseFloat(text);
+			break;
+
+		case VT_COLOUR:
+			{
+				const Colour value = StringConverter::ParseColour(text);
+				Entry.Colour[0] = value.R;
+				Entry.Colour[1] = value.G;
+				Entry.Colour[2] = value.B;
+				Entry.Colour[3] = value.A;
+			} break;
+
+		case VT_VECTOR2D:
+			{
+				const Vector2D value = StringConverter::ParseVector2D(text);
+				Entry.Vector[0] = value.X;
+				Entry.Vector[1] = value.Y;
+			} break;
+
+		case VT_VECTOR3D:
+			{
+				const Vector3D value = StringConverter::ParseVector3D(text);
+				Entry.Vector[0] = value.X;
+				Entry.Vector[1] = value.Y;
+				Entry.Vector[2] = value.Z;
+			} break;
+
+		default:
+			return false;
+		}
+
+		Entry.Type = Type;
+
+		return true;
+	}
+
+	const String ToText(const Entry &Entry) const
+	{
+		switch (Entry.Type)
+		{
+		case VT_BOOLEAN:
+			return StringConverter::ToString(Entry.Boolean);
+
+		case VT_INTEGER:
+			return StringConverter::ToString(Entry.Integer);
+
+		case VT_FLOAT:
+			return StringConverter::ToString(Entry.Float);
+
+		case VT_STRING:
+			return String(&m_Characters[Entry.Text.Offset], Entry.Text.Length);
+
+		case VT_COLOUR:
+			return StringConverter::ToString(Colour(Entry.Colour[0], Entry.Colour[1], Entry.Colour[2], Entry.Colour[3]));
+
+		case VT_VECTOR2D:
+			return StringConverter::ToString(Vector2D(Entry.Vector[0], Entry.Vector[1]));
+
+		case VT_VECTOR3D:
+			return StringConverter::ToString(Vector3D(Entry.Vector[0], Entry.Vector[1], Entry.Vector[2]));
+		}
+
+		return "";
+	}
+
+	const char *GetName(const Entry &Entry) const
+	{
+		if (Entry.Name)
+			return Entry.Name;
+
+		if (Entry.NameOffset != INVALID_OFFSET)
+			return &m_Characters[Entry.NameOffset];
+
+		return NULL;
+	}
+
+	void WriteEntry(const Entry &Entry, std::vector<char> &Buffer) const
+	{
+		Append(Buffer, &Entry.ID, 4);
+		Buffer.push_back((char)Entry.Type);
+
+		switch (Entry.Type)
+		{
+		case VT_BOOLEAN:
+			Buffer.push_back((char)Entry.Boolean);
+			break;
+
+		case VT_INTEGER:
+		case VT_FLOAT:
+			Append(Buffer, &Entry.Integer, 4);
+			break;
+
+		case VT_STRING:
+			{
+				const unsigned short length = (unsigned short)(Entry.Text.Length < 0xFFFF ? Entry.Text.Length : 0xFFFF);
+
+				Append(Buffer, &length, 2);
+				Append(Buffer, &m_Characters[Entry.Text.Offset], length);
+			} break;
+
+		case VT_COLOUR:
+			for (unsigned int j = 0; j < 4; j++)
+				Buffer.push_back((char)Entry.Colour[j]);
+			break;
+
+		case VT_VECTOR2D:
+			Append(Buffer, Entry.Vector, 8);
+			break;
+
+		case VT_VECTOR3D:
+			Append(Buffer, Entry.Vector, 12);
+			break;
+		}
+	}
+
+	//Same type and value, bit for bit
+	bool IsEqual(const Entry &Entry, const HashedAttributes &Other, const HashedAttributes::Entry &OtherEntry) const
+	{
+		if (Entry.Type != OtherEntry.Type)
+			return false;
+
+		switch (Entry.Type)
+		{
+		case VT_BOOLEAN:
+			return (Entry.Boolean == OtherEntry.Boolean);
+
+		case VT_INTEGER:
+		case VT_FLOAT:
+			return (Entry.Integer == OtherEntry.Integer);
+
+		case VT_STRING:
+			return (Entry.Text.Length == OtherEntry.Text.Length && memcmp(&m_Characters[Entry.Text.Offset], &Other.m_Characters[OtherEntry.Text.Offset], Entry.Text.Length) == 0);
+
+		case VT_COLOUR:
+			return (memcmp(Entry.Colour, OtherEntry.Colour, sizeof(Entry.Colour)) == 0);
+
+		case VT_VECTOR2D:
+			return (memcmp(Entry.Vector, OtherEntry.Vector, 8) == 0);
+
+		case VT_VECTOR3D:
+			return (memcmp(Entry.Vector, OtherEntry.Vector, 12) == 0);
+		}
+
+		return true;
+	}
+
+	//Size of the binary value of Type at Data, 0 if it's invalid
+	static unsigned int GetBinarySize(const unsigned char &Type, const char *Data, const unsigned int &Available)
+	{
+		switch (Type)
+		{
+		case VT_BOOLEAN:
+			return 1;
+
+		case VT_INTEGER:
+		case VT_FLOAT:
+		case VT_COLOUR:
+			return 4;
+
+		case VT_VECTOR2D:
+			return 8;
+
+		case VT_VECTOR3D:
+			return 12;
+
+		case VT_STRING:
+			{
+				if (Available < 2)
+					return 0;
+
+				unsigned short length;
+				memcpy(&length, Data, 2);
+
+				return 2 + length;
+			}
+		}
+
+		return 0;
+	}
+
+	static void Append(std::vector<char> &Buffer, const void *Data, const unsigned int &Size)
+	{
+		const char *data = reinterpret_cast<const char*>(Data);
+
+		Buffer.insert(Buffer.end(), data, data + Size);
+	}
+
+private:
+	HashedAttributes(const HashedAttributes &Other);
+	void operator =(const HashedAttributes &Other);
+
+private:
+	Entry m_InlineEntries[INLINE_CAPACITY];
+	Entry *m_Entries;
+	unsigned int m_Count;
+	unsigned int m_Capacity;
+
+	//Names which aren't literals and the strings, NULL terminated
+	std::vector<char> m_Characters;
+
+	String m_TagName;
+
+	int m_Integer;
+	float m_Float;
+	Colour m_Colour;
+	Vector2D m_Vector2D;
+	Vector3D m_Vector3D;
+};
+
+END_NAMESPACE
\ No newline at end of file
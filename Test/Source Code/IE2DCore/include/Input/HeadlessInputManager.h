@@ -0,0 +1,381 @@
+///////////////////////////////////////////////////////////////////////////////////
+///
+///  Impressive Engine 2D
+///
+/// Copyright (c) 2012-2013 Impressive Reality team
+///
+/// The license is
+///
+/// Permission is denied, to any person or company
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Project leader : O.Shahbazi <sh_omid_m@yahoo.com>
+///////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Common.h"
+#include "IInputManager.h"
+#include "InputEventQueue.h"
+#include "IRenderWindow.h"
+#include "Vector2D.h"
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <string.h>
+
+BEGIN_NAMESPACE
+
+//<Description>
+//Input manager without a device, for tests and for running without a window.
+//What the player does is injected with PressKey, MoveMouse and the others, at a time which is
+//now by default, from any thread. Update applies what happened up to now to the state, so a
+//key pressed and released between two frames is still seen by IsKeyPressed.
+//The events also go to InputEventQueue like the ones of WindowInput.
+//It's set with Core::SetInputManager in place of the one of the engine
+class HeadlessInputManager : public IInputManager
+{
+private:
+	typedef std::vector<InputEvent> EventsList;
+
+public:
+	HeadlessInputManager(void) :
+		m_Window(NULL),
+		m_InjectedPosition(0.0F, 0.0F),
+		m_ControlDown(false),
+		m_ShiftDown(false),
+		m_AltDown(false),
+		m_MousePosition(0.0F, 0.0F),
+		m_CursorVisible(true),
+		m_Character('\0')
+	{
+		memset(m_KeyDown, 0, sizeof(m_KeyDown));
+		memset(m_KeyPressed, 0, sizeof(m_KeyPressed));
+		memset(m_MouseHold, 0, sizeof(m_MouseHold));
+		memset(m_MouseDown, 0, sizeof(m_MouseDown));
+		memset(m_MouseClicked, 0, sizeof(m_MouseClicked));
+	}
+
+	void Initialize(IRenderWindow *RenderWindow)
+	{
+		m_Window = RenderWindow;
+	}
+
+	void Update(void)
+	{
+		Apply(InputEventQueue::GetTime());
+	}
+
+	void PostUpdate(void)
+	{
+		memset(m_KeyPressed, 0, sizeof(m_KeyPressed));
+		memset(m_MouseDown, 0, sizeof(m_MouseDown));
+		memset(m_MouseClicked, 0, sizeof(m_MouseClicked));
+
+		m_Character = '\0';
+	}
+
+	//Applies the injected events up to Time to the state, Update does it up to now
+	void Apply(const long long &Time)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_PendingLock);
+
+			unsigned int kept = 0;
+
+			for (unsigned int i = 0; i < m_Pending.size(); i++)
+				if (m_Pending[i].Time <= Time)
+					m_Applying.push_back(m_Pending[i]);
+				else
+					m_Pending[kept++] = m_Pending[i];
+
+			m_Pending.resize(kept);
+		}
+
+		std::stable_sort(m_Applying.begin(), m_Applying.end(), &IsBefore);
+
+		for (unsigned int i = 0; i < m_Applying.size(); i++)
+			Apply(m_Applying[i]);
+
+		m_Applying.clear();
+	}
+
+	void PressKey(const KeyCodes &Code, const long long &Time = 0)
+	{
+		InputEvent event;
+		event.Type = InputEvent::ET_KEY_DOWN;
+		event.Key = Code;
+
+		Inject(event, Time);
+	}
+
+	void ReleaseKey(const KeyCodes &Code, const long long &Time = 0)
+	{
+		InputEvent event;
+		event.Type = InputEvent::ET_KEY_UP;
+		event.Key = Code;
+
+		Inject(event, Time);
+	}
+
+	void PressMouse(const MouseButtons &Button, const long long &Time = 0)
+	{
+		InputEvent event;
+		event.Type = InputEvent::ET_MOUSE_DOWN;
+		event.Button = Button;
+
+		Inject(event, Time);
+	}
+
+	void ReleaseMouse(const MouseButtons &Button, const long long &Time = 0)
+	{
+		InputEvent event;
+		event.Type = InputEvent::ET_MOUSE_UP;
+		event.Button = Button;
+
+		Inject(event, Time);
+	}
+
+	//In the client area of the window
+	void MoveMouse(const float &X, const float &Y, const long long &Time = 0)
+	{
+		InputEvent event;
+		event.Type = InputEvent::ET_MOUSE_MOVE;
+		event.X = X;
+		event.Y = Y;
+
+		Inject(event, Time);
+	}
+
+	//IInputManager has no state for the wheel, it's only in InputEventQueue
+	void ScrollMouse(const float &Notches, const long long &Time = 0)
+	{
+		InputEvent event;
+		event.Type = InputEvent::ET_MOUSE_WHEEL;
+		event.Wheel = Notches;
+
+		Inject(event, Time);
+	}
+
+	void TypeChar(const char &Character, const long long &Time = 0)
+	{
+		InputEvent event;
+		event.Type = InputEvent::ET_CHAR;
+		event.Character = Character;
+
+		Inject(event, Time);
+	}
+
+	const bool &IsKeyDown(const KeyCodes &Code) const
+	{
+		return m_KeyDown[Code];
+	}
+
+	//Pressed since the last frame
+	const bool &IsKeyPressed(const KeyCodes &Code) const
+	{
+		return m_KeyPressed[Code];
+	}
+
+	const bool &IsControlDown(void) const
+	{
+		return m_ControlDown;
+	}
+
+	const bool &IsShiftDown(void) const
+	{
+		return m_ShiftDown;
+	}
+
+	const bool &IsAltDown(void) const
+	{
+		return m_AltDown;
+	}
+
+	void SetCursorVisible(const bool &Value)
+	{
+		m_CursorVisible = Value;
+	}
+
+	const bool &IsCursorVisible(void) const
+	{
+		return m_CursorVisible;
+	}
+
+	const bool &IsMouseHold(const MouseButtons &Button)
+	{
+		return m_MouseHold[Button];
+	}
+
+	//Pressed since the last frame
+	const bool &IsMouseDown(const MouseButtons &Button)
+	{
+		return m_MouseDown[Button];
+	}
+
+	//Released since the last frame
+	const bool &IsMouseClicked(const MouseButtons &Button)
+	{
+		return m_MouseClicked[Button];
+	}
+
+	void SetMousePosition(const int &X, const int &Y)
+	{
+		SetMousePosition(Vector2D((float)X, (float)Y));
+	}
+
+	void SetMousePosition(const Vector2D &Position)
+	{
+		m_MousePosition = Position;
+
+		MoveMouse(Position.X, Position.Y);
+	}
+
+	const Vector2D &GetMousePosition(void)
+	{
+		return m_MousePosition;
+	}
+
+	void SetNormalizedMousePosition(const float &X, const float &Y)
+	{
+		SetNormalizedMousePosition(Vector2D(X, Y));
+	}
+
+	void SetNormalizedMousePosition(const Vector2D &Position)
+	{
+		const Vector2D size = GetWindowSize();
+
+		SetMousePosition(Vector2D(Position.X * size.X, Position.Y * size.Y));
+	}
+
+	const Vector2D GetNormalizedMousePosition(void) const
+	{
+		const Vector2D size = GetWindowSize();
+
+		return Vector2D(m_MousePosition.X / size.X, m_MousePosition.Y / size.Y);
+	}
+
+	void SetChar(const char &Character)
+	{
+		m_Character = Character;
+	}
+
+	const char &GetChar(void)
+	{
+		return m_Character;
+	}
+
+private:
+	static bool IsBefore(const InputEvent &Left, const InputEvent &Right)
+	{
+		return (Left.Time < Right.Time);
+	}
+
+	// without a window the positions are already normalized
+	Vector2D GetWindowSize(void) const
+	{
+		if (!m_Window)
+			return Vector2D(1.0F, 1.0F);
+
+		return m_Window->GetWindowSize();
+	}
+
+	void Inject(InputEvent &Event, const long long &Time)
+	{
+		Event.Time = (Time ? Time : InputEventQueue::GetTime());
+
+		{
+			std::lock_guard<std::mutex> lock(m_PendingLock);
+
+			// the mouse events have where the mouse is
+			if (Event.Type == InputEvent::ET_MOUSE_MOVE)
+				m_InjectedPosition = Vector2D(Event.X, Event.Y);
+			else if (Event.Type == InputEvent::ET_MOUSE_DOWN || Event.Type == InputEvent::ET_MOUSE_UP || Event.Type == InputEvent::ET_MOUSE_WHEEL)
+			{
+				Event.X = m_InjectedPosition.X;
+				Event.Y = m_InjectedPosition.Y;
+			}
+
+			m_Pending.push_back(Event);
+		}
+
+		InputEventQueue::GetReference().Push(Event);
+	}
+
+	void Apply(const InputEvent &Event)
+	{
+		switch (Event.Type)
+		{
+		case InputEvent::ET_KEY_DOWN:
+			if (!m_KeyDown[Event.Key])
+				m_KeyPressed[Event.Key] = true;
+
+			m_KeyDown[Event.Key] = true;
+			break;
+
+		case InputEvent::ET_KEY_UP:
+			m_KeyDown[Event.Key] = false;
+			break;
+
+		case InputEvent::ET_MOUSE_DOWN:
+			if (!m_MouseHold[Event.Button])
+				m_MouseDown[Event.Button] = true;
+
+			m_MouseHold[Event.Button] = true;
+			break;
+
+		case InputEvent::ET_MOUSE_UP:
+			if (m_MouseHold[Event.Button])
+				m_MouseClicked[Event.Button] = true;
+
+			m_MouseHold[Event.Button] = false;
+			break;
+
+		case InputEvent::ET_MOUSE_MOVE:
+			m_MousePosition = Vector2D(Event.X, Event.Y);
+			break;
+
+		case InputEvent::ET_MOUSE_WHEEL:
+			break;
+
+		case InputEvent::ET_CHAR:
+			m_Character = Event.Character;
+			break;
+		}
+
+		m_ControlDown = (m_KeyDown[K_LCONTROL] || m_KeyDown[K_RCONTROL]);
+		m_ShiftDown = (m_KeyDown[K_LSHIFT] || m_KeyDown[K_RSHIFT]);
+		m_AltDown = (m_KeyDown[K_LMENU] || m_KeyDown[K_RMENU]);
+	}
+
+private:
+	HeadlessInputManager(const HeadlessInputManager &Other);
+	void operator =(const HeadlessInputManager &Other);
+
+private:
+	IRenderWindow *m_Window;
+
+	EventsList m_Pending;
+	std::mutex m_PendingLock;
+	Vector2D m_InjectedPosition;
+
+	// scratch of Apply
+	EventsList m_Applying;
+
+	bool m_KeyDown[K_COUNT];
+	bool m_KeyPressed[K_COUNT];
+	bool m_ControlDown;
+	bool m_ShiftDown;
+	bool m_AltDown;
+
+	bool m_MouseHold[M_COUNT];
+	bool m_MouseDown[M_COUNT];
+	bool m_MouseClicked[M_COUNT];
+	Vector2D m_MousePosition;
+	bool m_CursorVisible;
+
+	char m_Character;
+};
+
+END_NAMESPACE
\ No newline at end of file
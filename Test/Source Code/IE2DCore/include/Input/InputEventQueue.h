@@ -0,0 +1,281 @@
+///////////////////////////////////////////////////////////////////////////////////
+///
+///  Impressive Engine 2D
+///
+/// Copyright (c) 2012-2013 Impressive Reality team
+///
+/// The license is
+///
+/// Permission is denied, to any person or company
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Project leader : O.Shahbazi <sh_omid_m@yahoo.com>
+///////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Common.h"
+#include "Core.h"
+#include "FrameClock.h"
+#include "IInputManager.h"
+#include <Windows.h>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+BEGIN_NAMESPACE
+
+//<Description>
+//Something which happened to an input device and when, in nanoseconds of InputEventQueue::GetTime
+struct InputEvent
+{
+public:
+	enum EventType
+	{
+		ET_KEY_DOWN = 0,
+		ET_KEY_UP,
+		ET_MOUSE_DOWN,
+		ET_MOUSE_UP,
+		ET_MOUSE_MOVE,
+		ET_MOUSE_WHEEL,
+		ET_CHAR
+	};
+
+public:
+	InputEvent(void) :
+		Type(ET_KEY_DOWN),
+		Time(0),
+		Key(K_UNASSIGNED),
+		Button(IInputManager::M_LEFT),
+		X(0.0F),
+		Y(0.0F),
+		Wheel(0.0F),
+		Character('\0')
+	{
+	}
+
+	EventType Type;
+	long long Time;
+
+	//Of key events
+	KeyCodes Key;
+
+	//Of mouse button events
+	IInputManager::MouseButtons Button;
+
+	//The mouse in the client area of the window, of all mouse events
+	float X;
+	float Y;
+
+	//Of wheel events, in notches
+	float Wheel;
+
+	//Of char events
+	char Character;
+};
+
+
+//<Description>
+//Input events of all sources in the order they happened, for gameplay which needs more
+//than the state IInputManager has once a frame: taps shorter than a frame, every position
+//of the mouse between frames, or the exact time of an input.
+//Sources push their events as they come, from any thread. Attached to Core, the events up
+//to the start of a frame are taken into the frame when it begins, GetEvents has them in order.
+//Fixed step logic applies the events of a step with GetEvents(StepStart, StepEnd, ...)
+class InputEventQueue : public Core::IListener
+{
+public:
+	typedef std::vector<InputEvent> EventsList;
+
+	enum
+	{
+		//Events waiting for a frame, older ones are dropped when nothing takes them
+		MAX_PENDING_COUNT = 4096
+	};
+
+public:
+	InputEventQueue(void) :
+		m_DroppedCount(0),
+		m_FrameStart(0),
+		m_FrameEnd(0),
+		m_Attached(false)
+	{
+	}
+
+	static InputEventQueue &GetReference(void)
+	{
+		static InputEventQueue instance;
+
+		return instance;
+	}
+
+	//The clock of FrameClock, so events compare with the start of the frames
+	static long long GetTime(void)
+	{
+		return FrameClock::GetTime();
+	}
+
+	void Attach(void)
+	{
+		if (m_Attached)
+			return;
+
+		Core::GetReference().AddListener(this);
+		m_Attached = true;
+
+		m_FrameEnd = GetTime();
+	}
+
+	void Detach(void)
+	{
+		if (!m_Attached)
+			return;
+
+		Core::GetReference().RemoveListener(this);
+		m_Attached = false;
+	}
+
+	const bool &IsAttached(void) const
+	{
+		return m_Attached;
+	}
+
+	//From any thread
+	void Push(const InputEvent &Event)
+	{
+		std::lock_guard<std::mutex> lock(m_PendingLock);
+
+		if (m_Pending.size() >= MAX_PENDING_COUNT)
+		{
+			m_Pending.erase(m_Pending.begin());
+			m_DroppedCount++;
+		}
+
+		m_Pending.push_back(Event);
+	}
+
+	//Takes the events up to Time in place of the ones of the last frame, Attach does it when
+	//a frame begins
+	void Collect(const long long &Time)
+	{
+		m_Events.clear();
+
+		{
+			std::lock_guard<std::mutex> lock(m_PendingLock);
+
+			unsigned int kept = 0;
+
+			for (unsigned int i = 0; i < m_Pending.size(); i++)
+				if (m_Pending[i].Time <= Time)
+					m_Events.push_back(m_Pending[i]);
+				else
+					m_Pending[kept++] = m_Pending[i];
+
+			m_Pending.resize(kept);
+		}
+
+		// sources push on their own threads, so they can be a bit out of order
+		std::stable_sort(m_Events.begin(), m_Events.end(), &IsBefore);
+
+		m_FrameStart = m_FrameEnd;
+		m_FrameEnd = Time;
+
+		// an event of a source which was late for the frame before
+		if (m_Events.size() && m_Events[0].Time < m_FrameStart)
+			m_FrameStart = m_Events[0].Time;
+	}
+
+	//The events of the current frame in the order they happened
+	const EventsList &GetEvents(void) const
+	{
+		return m_Events;
+	}
+
+	//The events of the current frame which happened after From, up to To.
+	//Returns false if there isn't one
+	bool GetEvents(const long long &From, const long long &To, unsigned int &First, unsigned int &Count) const
+	{
+		InputEvent event;
+
+		event.Time = From;
+		First = (unsigned int)(std::upper_bound(m_Events.begin(), m_Events.end(), event, &IsBefore) - m_Events.begin());
+
+		event.Time = To;
+		const unsigned int last = (unsigned int)(std::upper_bound(m_Events.begin(), m_Events.end(), event, &IsBefore) - m_Events.begin());
+
+		Count = (last > First ? last - First : 0);
+
+		return (Count != 0);
+	}
+
+	//The current frame has the events after the start, up to the end
+	const long long &GetFrameStart(void) const
+	{
+		return m_FrameStart;
+	}
+
+	const long long &GetFrameEnd(void) const
+	{
+		return m_FrameEnd;
+	}
+
+	unsigned int GetDroppedCount(void)
+	{
+		std::lock_guard<std::mutex> lock(m_PendingLock);
+
+		return m_DroppedCount;
+	}
+
+private:
+	static bool IsBefore(const InputEvent &Left, const InputEvent &Right)
+	{
+		return (Left.Time < Right.Time);
+	}
+
+	void OnBeforeSceneRemoved(IScene *Scene)
+	{
+	}
+
+	void OnSceneAdded(IScene *Scene)
+	{
+	}
+
+	void OnSetCurrentScene(IScene *Scene)
+	{
+	}
+
+	void OnBeforeUpdate(void)
+	{
+		Collect(GetTime());
+	}
+
+	void OnAfterUpdate(void)
+	{
+	}
+
+	void OnBeforeRender(void)
+	{
+	}
+
+	void OnAfterRender(void)
+	{
+	}
+
+private:
+	InputEventQueue(const InputEventQueue &Other);
+	void operator =(const InputEventQueue &Other);
+
+private:
+	EventsList m_Pending;
+	std::mutex m_PendingLock;
+	unsigned int m_DroppedCount;
+
+	EventsList m_Events;
+	long long m_FrameStart;
+	long long m_FrameEnd;
+
+	bool m_Attached;
+};
+
+END_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,373 @@
+///////////////////////////////////////////////////////////////////////////////////
+///
+///  Impressive Engine 2D
+///
+/// Copyright (c) 2012-2013 Impressive Reality team
+///
+/// The license is
+///
+/// Permission is denied, to any person or company
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Project leader : O.Shahbazi <sh_omid_m@yahoo.com>
+///////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Common.h"
+#include "IRenderWindow.h"
+#include "InputEventQueue.h"
+#include <Windows.h>
+#include <string.h>
+
+BEGIN_NAMESPACE
+
+//<Description>
+//Pushes the input messages of the window to InputEventQueue: keys in KeyCodes, mouse buttons,
+//moves and the wheel, and typed characters. The window procedure is subclassed, so the engine
+//still gets every message, the events are of the real messages and not of polled states.
+//Messages are read once a frame, their time is the one of GetMessageTime, when they were
+//posted, to the resolution of the system tick. Windows keeps only the last mouse move of the
+//ones waiting, the others are found again with GetMouseMovePointsEx.
+//What is held when the focus goes is released. It runs on the thread of the window
+class WindowInput
+{
+public:
+	enum
+	{
+		//Mouse positions GetMouseMovePointsEx can give
+		MAX_MOVE_POINT_COUNT = 64
+	};
+
+public:
+	WindowInput(void) :
+		m_Window(NULL),
+		m_Procedure(NULL),
+		m_MouseX(0),
+		m_MouseY(0)
+	{
+		memset(&m_LastMove, 0, sizeof(m_LastMove));
+		memset(m_KeyDown, 0, sizeof(m_KeyDown));
+		memset(m_MouseDown, 0, sizeof(m_MouseDown));
+	}
+
+	~WindowInput(void)
+	{
+		Detach();
+	}
+
+	static WindowInput &GetReference(void)
+	{
+		static WindowInput instance;
+
+		return instance;
+	}
+
+	//From the thread of the window
+	bool Attach(IRenderWindow *Window)
+	{
+		// still in the chain of a window after Detach
+		if (m_Window || m_Procedure || !Window)
+			return false;
+
+		HWND window = Window->GetHandle();
+
+		m_Procedure = (WNDPROC)SetWindowLongPtrA(window, GWLP_WNDPROC, (LONG_PTR)&WindowProcedure);
+
+		if (!m_Procedure)
+			return false;
+
+		m_Window = window;
+
+		memset(&m_LastMove, 0, sizeof(m_LastMove));
+
+		return true;
+	}
+
+	void Detach(void)
+	{
+		if (!m_Window)
+			return;
+
+		Release(InputEventQueue::GetTime());
+
+		// a subclass made after this one would be lost, so it stays, only the events stop
+		if (GetWindowLongPtrA(m_Window, GWLP_WNDPROC) == (LONG_PTR)&WindowProcedure)
+		{
+			SetWindowLongPtrA(m_Window, GWLP_WNDPROC, (LONG_PTR)m_Procedure);
+			m_Procedure = NULL;
+		}
+
+		m_Window = NULL;
+	}
+
+	bool IsAttached(void) const
+	{
+		return (m_Window != NULL);
+	}
+
+private:
+	static LRESULT CALLBACK WindowProcedure(HWND Window, UINT Message, WPARAM WParam, LPARAM LParam)
+	{
+		WindowInput &input = GetReference();
+
+		WNDPROC procedure = input.m_Procedure;
+
+		if (input.m_Window == Window)
+			input.OnMessage(Message, WParam, LParam);
+
+		if (Message == WM_NCDESTROY)
+		{
+			SetWindowLongPtrA(Window, GWLP_WNDPROC, (LONG_PTR)procedure);
+			input.m_Window = NULL;
+			input.m_Procedure = NULL;
+		}
+
+		return CallWindowProcA(procedure, Window, Message, WParam, LParam);
+	}
+
+	void OnMessage(const UINT &Message, const WPARAM &WParam, const LPARAM &LParam)
+	{
+		InputEvent event;
+
+		switch (Message)
+		{
+		case WM_KEYDOWN:
+		case WM_SYSKEYDOWN:
+		case WM_KEYUP:
+		case WM_SYSKEYUP:
+			{
+				event.Key = GetKeyCode(WParam, LParam);
+
+				const bool down = (Message == WM_KEYDOWN || Message == WM_SYSKEYDOWN);
+
+				// repeats of a held key
+				if (event.Key == K_UNASSIGNED || down == m_KeyDown[event.Key])
+					return;
+
+				m_KeyDown[event.Key] = down;
+
+				event.Type = (down ? InputEvent::ET_KEY_DOWN : InputEvent::ET_KEY_UP);
+			}
+			break;
+
+		case WM_LBUTTONDOWN:
+		case WM_LBUTTONUP:
+		case WM_RBUTTONDOWN:
+		case WM_RBUTTONUP:
+		case WM_MBUTTONDOWN:
+		case WM_MBUTTONUP:
+		case WM_XBUTTONDOWN:
+		case WM_XBUTTONUP:
+			{
+				const bool down = (Message == WM_LBUTTONDOWN || Message == WM_RBUTTONDOWN || Message == WM_MBUTTONDOWN || Message == WM_XBUTTONDOWN);
+
+				if (Message == WM_LBUTTONDOWN || Message == WM_LBUTTONUP)
+					event.Button = IInputManager::M_LEFT;
+				else if (Message == WM_RBUTTONDOWN || Message == WM_RBUTTONUP)
+					event.Button = IInputManager::M_RIGHT;
+				else if (Message == WM_MBUTTONDOWN || Message == WM_MBUTTONUP)
+					event.Button = IInputManager::M_MIDDLE;
+				else
+					event.Button = (GET_XBUTTON_WPARAM(WParam) == XBUTTON1 ? IInputManager::M_BUTTON3 : IInputManager::M_BUTTON4);
+
+				m_MouseDown[event.Button] = down;
+
+				SetMouse((short)LOWORD(LParam), (short)HIWORD(LParam));
+
+				event.Type = (down ? InputEvent::ET_MOUSE_DOWN : InputEvent::ET_MOUSE_UP);
+			}
+			break;
+
+		case WM_MOUSEMOVE:
+			OnMouseMove((short)LOWORD(LParam), (short)HIWORD(LParam));
+			return;
+
+		case WM_MOUSEWHEEL:
+			{
+				// in screen coordinates
+				POINT cursor = { (short)LOWORD(LParam), (short)HIWORD(LParam) };
+				ScreenToClient(m_Window, &cursor);
+
+				SetMouse(cursor.x, cursor.y);
+
+				event.Type = InputEvent::ET_MOUSE_WHEEL;
+				event.Wheel = (float)GET_WHEEL_DELTA_WPARAM(WParam) / WHEEL_DELTA;
+			}
+			break;
+
+		case WM_CHAR:
+			event.Type = InputEvent::ET_CHAR;
+			event.Character = (char)WParam;
+			break;
+
+		// sent, not posted, so GetMessageTime isn't of it
+		case WM_KILLFOCUS:
+			Release(InputEventQueue::GetTime());
+			return;
+
+		default:
+			return;
+		}
+
+		event.Time = GetMessageEventTime();
+		event.X = (float)m_MouseX;
+		event.Y = (float)m_MouseY;
+
+		InputEventQueue::GetReference().Push(event);
+	}
+
+	//The moves before the one of the message which weren't pushed yet, then the one of the message
+	void OnMouseMove(const int &X, const int &Y)
+	{
+		POINT cursor = { X, Y };
+		ClientToScreen(m_Window, &cursor);
+
+		// the points are in 16 bits of the display
+		MOUSEMOVEPOINT current;
+		current.x = cursor.x & 0xFFFF;
+		current.y = cursor.y & 0xFFFF;
+		current.time = (DWORD)GetMessageTime();
+		current.dwExtraInfo = 0;
+
+		MOUSEMOVEPOINT points[MAX_MOVE_POINT_COUNT];
+		int count = GetMouseMovePointsEx(sizeof(MOUSEMOVEPOINT), &current, points, MAX_MOVE_POINT_COUNT, GMMP_USE_DISPLAY_POINTS);
+
+		if (count < 1)
+		{
+			points[0] = current;
+			count = 1;
+		}
+
+		// newest first, up to the last one pushed, the first move after Attach has no history
+		int newCount = 1;
+
+		if (m_LastMove.time)
+			while (newCount < count && !IsSameMove(points[newCount], m_LastMove) && (int)(points[newCount].time - m_LastMove.time) >= 0)
+				newCount++;
+
+		if (IsSameMove(points[0], m_LastMove))
+			newCount = 0;
+
+		const long long now = InputEventQueue::GetTime();
+		const DWORD tickCount = GetTickCount();
+
+		InputEvent event;
+		event.Type = InputEvent::ET_MOUSE_MOVE;
+
+		for (int i = newCount - 1; i >= 0; i--)
+		{
+			POINT point = { (points[i].x > 32767 ? points[i].x - 65536 : points[i].x), (points[i].y > 32767 ? points[i].y - 65536 : points[i].y) };
+			ScreenToClient(m_Window, &point);
+
+			// a move message without a move
+			if (point.x == m_MouseX && point.y == m_MouseY)
+				continue;
+
+			SetMouse(point.x, point.y);
+
+			event.Time = GetEventTime(points[i].time, now, tickCount);
+			event.X = (float)point.x;
+			event.Y = (float)point.y;
+
+			InputEventQueue::GetReference().Push(event);
+		}
+
+		m_LastMove = points[0];
+	}
+
+	static bool IsSameMove(const MOUSEMOVEPOINT &A, const MOUSEMOVEPOINT &B)
+	{
+		return (A.x == B.x && A.y == B.y && A.time == B.time);
+	}
+
+	//Ups for what is held, at Time
+	void Release(const long long &Time)
+	{
+		InputEvent event;
+		event.Time = Time;
+		event.X = (float)m_MouseX;
+		event.Y = (float)m_MouseY;
+
+		event.Type = InputEvent::ET_KEY_UP;
+
+		for (unsigned int i = 0; i < K_COUNT; i++)
+			if (m_KeyDown[i])
+			{
+				event.Key = (KeyCodes)i;
+				InputEventQueue::GetReference().Push(event);
+
+				m_KeyDown[i] = false;
+			}
+
+		event.Type = InputEvent::ET_MOUSE_UP;
+
+		for (unsigned int i = 0; i < IInputManager::M_COUNT; i++)
+			if (m_MouseDown[i])
+			{
+				event.Button = (IInputManager::MouseButtons)i;
+				InputEventQueue::GetReference().Push(event);
+
+				m_MouseDown[i] = false;
+			}
+	}
+
+	void SetMouse(const int &X, const int &Y)
+	{
+		m_MouseX = X;
+		m_MouseY = Y;
+	}
+
+	//The time of the message being handled in the clock of InputEventQueue
+	static long long GetMessageEventTime(void)
+	{
+		return GetEventTime((DWORD)GetMessageTime(), InputEventQueue::GetTime(), GetTickCount());
+	}
+
+	//Tick is in milliseconds of GetTickCount, which was TickCount at Now
+	static long long GetEventTime(const DWORD &Tick, const long long &Now, const DWORD &TickCount)
+	{
+		const DWORD age = TickCount - Tick;
+
+		// a tick after TickCount, which was read after it
+		if ((int)age < 0)
+			return Now;
+
+		return Now - (long long)age * 1000000;
+	}
+
+	//Scan codes with 0x80 for the extended keys, the ones of Pause and Num Lock are the other
+	//way around in the messages
+	static KeyCodes GetKeyCode(const WPARAM &VirtualKey, const LPARAM &LParam)
+	{
+		if (VirtualKey == VK_PAUSE)
+			return K_PAUSE;
+
+		if (VirtualKey == VK_NUMLOCK)
+			return K_NUMLOCK;
+
+		const unsigned int scanCode = (LParam >> 16) & 0xFF;
+
+		if (!scanCode || scanCode >= 0x80)
+			return K_UNASSIGNED;
+
+		return (KeyCodes)(scanCode | ((LParam & (1 << 24)) ? 0x80 : 0));
+	}
+
+private:
+	WindowInput(const WindowInput &Other);
+	void operator =(const WindowInput &Other);
+
+private:
+	HWND m_Window;
+	WNDPROC m_Procedure;
+
+	MOUSEMOVEPOINT m_LastMove;
+	int m_MouseX;
+	int m_MouseY;
+	bool m_KeyDown[K_COUNT];
+	bool m_MouseDown[IInputManager::M_COUNT];
+};
+
+END_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,498 @@
+///////////////////////////////////////////////////////////////////////////////////
+///
+///  Impressive Engine 2D
+///
+/// Copyright (c) 2012-2013 Impressive Reality team
+///
+/// The license is
+///
+/// Permission is denied, to any person or company
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Project leader : O.Shahbazi <sh_omid_m@yahoo.com>
+///////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Common.h"
+#include "IThread.h"
+#include "IThreadWorker.h"
+#include "ThreadManager.h"
+#include "Profiler.h"
+#include <Windows.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <thread>
+
+BEGIN_NAMESPACE
+
+//<Description>
+//Jobs and the jobs each of them has to wait for, run by JobPool.
+//A job can only wait for jobs added before it, so a graph never has a cycle.
+//The graph is kept after running, it can be run again every frame without
+//being built again
+class JobGraph
+{
+	friend class JobPool;
+
+public:
+	typedef void (*JobFunction)(void *Data);
+
+	static const unsigned int INVALID = 0xFFFFFFFF;
+
+private:
+	struct Job
+	{
+	public:
+		JobFunction Function;
+		void *Data;
+		bool MainThreadOnly;
+	};
+
+	struct Dependency
+	{
+	public:
+		unsigned int Job;
+		unsigned int DependsOn;
+	};
+
+	//Jobs whose dependencies are done, every job is pushed once a run so the
+	//slots only fill up, a slot is 0 until its job is pushed
+	class ReadyQueue
+	{
+	public:
+		ReadyQueue(void) :
+			Size(0),
+			Write(0),
+			Read(0)
+		{
+		}
+
+		void Reset(const unsigned int &Capacity)
+		{
+			if (Capacity > Size)
+			{
+				Slots.reset(new std::atomic<unsigned int>[Capacity]);
+				Size = Capacity;
+			}
+
+			for (unsigned int i = 0; i < Capacity; i++)
+				Slots[i].store(0, std::memory_order_relaxed);
+
+			Write.store(0, std::memory_order_relaxed);
+			Read.store(0, std::memory_order_relaxed);
+		}
+
+		void Push(const unsigned int &Job)
+		{
+			Slots[Write.fetch_add(1, std::memory_order_relaxed)].store(Job + 1, std::memory_order_release);
+		}
+
+	public:
+		std::unique_ptr<std::atomic<unsigned int>[]> Slots;
+		unsigned int Size;
+		std::atomic<unsigned int> Write;
+		std::atomic<unsigned int> Read;
+	};
+
+public:
+	JobGraph(void) :
+		m_PendingSize(0),
+		m_MainThreadJobCount(0),
+		m_Built(false)
+	{
+	}
+
+	//Returns the index of the job
+	unsigned int AddJob(JobFunction Function, void *Data, const bool &MainThreadOnly = false)
+	{
+		Job job;
+		job.Function = Function;
+		job.Data = Data;
+		job.MainThreadOnly = MainThreadOnly;
+
+		m_Jobs.push_back(job);
+
+		if (MainThreadOnly)
+			m_MainThreadJobCount++;
+
+		m_Built = false;
+
+		return (unsigned int)m_Jobs.size() - 1;
+	}
+
+	//Job doesn't start before DependsOn is done, DependsOn has to be added before Job
+	bool AddDependency(const unsigned int &Job, const unsigned int &DependsOn)
+	{
+		if (DependsOn >= Job || Job >= m_Jobs.size())
+			return false;
+
+		Dependency dependency;
+		dependency.Job = Job;
+		dependency.DependsOn = DependsOn;
+
+		m_Dependencies.push_back(dependency);
+
+		m_Built = false;
+
+		return true;
+	}
+
+	void Clear(void)
+	{
+		m_Jobs.clear();
+		m_Dependencies.clear();
+		m_MainThreadJobCount = 0;
+
+		m_Built = false;
+	}
+
+	unsigned int GetJobCount(void) const
+	{
+		return (unsigned int)m_Jobs.size();
+	}
+
+	unsigned int GetDependencyCount(void) const
+	{
+		return (unsigned int)m_Dependencies.size();
+	}
+
+private:
+	//Lays the dependents of every job out one after another
+	void Build(void)
+	{
+		const unsigned int count = (unsigned int)m_Jobs.size();
+
+		m_DependentsOffset.assign(count + 1, 0);
+		m_DependencyCount.assign(count, 0);
+
+		for (unsigned int i = 0; i < m_Dependencies.size(); i++)
+		{
+			m_DependentsOffset[m_Dependencies[i].DependsOn + 1]++;
+			m_DependencyCount[m_Dependencies[i].Job]++;
+		}
+
+		for (unsigned int i = 0; i < count; i++)
+			m_DependentsOffset[i + 1] += m_DependentsOffset[i];
+
+		m_Dependents.resize(m_Dependencies.size());
+
+		std::vector<unsigned int> next(m_DependentsOffset.begin(), m_DependentsOffset.end() - 1);
+
+		for (unsigned int i = 0; i < m_Dependencies.size(); i++)
+			m_Dependents[next[m_Dependencies[i].DependsOn]++] = m_Dependencies[i].Job;
+
+		if (count > m_PendingSize)
+		{
+			m_Pending.reset(new std::atomic<unsigned int>[count]);
+			m_PendingSize = count;
+		}
+
+		m_Built = true;
+	}
+
+	void Prepare(void)
+	{
+		if (!m_Built)
+			Build();
+
+		const unsigned int count = (unsigned int)m_Jobs.size();
+
+		m_Queue.Reset(count - m_MainThreadJobCount);
+		m_MainThreadQueue.Reset(m_MainThreadJobCount);
+		m_Done.store(0, std::memory_order_relaxed);
+
+		for (unsigned int i = 0; i < count; i++)
+		{
+			m_Pending[i].store(m_DependencyCount[i], std::memory_order_relaxed);
+
+			if (!m_DependencyCount[i])
+				Push(i);
+		}
+	}
+
+	void Push(const unsigned int &Job)
+	{
+		if (m_Jobs[Job].MainThreadOnly)
+			m_MainThreadQueue.Push(Job);
+		else
+			m_Queue.Push(Job);
+	}
+
+	void Execute(const unsigned int &Job)
+	{
+		m_Jobs[Job].Function(m_Jobs[Job].Data);
+
+		for (unsigned int i = m_DependentsOffset[Job]; i < m_DependentsOffset[Job + 1]; i++)
+		{
+			const unsigned int dependent = m_Dependents[i];
+
+			if (m_Pending[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+				Push(dependent);
+		}
+
+		m_Done.fetch_add(1, std::memory_order_release);
+	}
+
+	//Claims the next job of the queue any thread runs, INVALID once all are claimed
+	unsigned int Claim(void)
+	{
+		const unsigned int index = m_Queue.Read.fetch_add(1, std::memory_order_relaxed);
+
+		return (index < m_Jobs.size() - m_MainThreadJobCount ? index : INVALID);
+	}
+
+	//The job of a claimed slot, 0 until it's pushed
+	unsigned int GetClaimed(const unsigned int &Index) const
+	{
+		return m_Queue.Slots[Index].load(std::memory_order_acquire);
+	}
+
+	//Main thread: runs the next main thread job if one is ready
+	bool ExecuteMainThreadJob(void)
+	{
+		const unsigned int index = m_MainThreadQueue.Read.load(std::memory_order_relaxed);
+
+		if (index >= m_MainThreadJobCount)
+			return false;
+
+		const unsigned int job = m_MainThreadQueue.Slots[index].load(std::memory_order_acquire);
+
+		if (!job)
+			return false;
+
+		m_MainThreadQueue.Read.store(index + 1, std::memory_order_relaxed);
+
+		Execute(job - 1);
+
+		return true;
+	}
+
+	bool IsDone(void) const
+	{
+		return m_Done.load(std::memory_order_acquire) == m_Jobs.size();
+	}
+
+private:
+	std::vector<Job> m_Jobs;
+	std::vector<Dependency> m_Dependencies;
+
+	std::vector<unsigned int> m_DependentsOffset;
+	std::vector<unsigned int> m_Dependents;
+	std::vector<unsigned int> m_DependencyCount;
+
+	std::unique_ptr<std::atomic<unsigned int>[]> m_Pending;
+	unsigned int m_PendingSize;
+
+	ReadyQueue m_Queue;
+	ReadyQueue m_MainThreadQueue;
+	unsigned int m_MainThreadJobCount;
+	std::atomic<unsigned int> m_Done;
+
+	bool m_Built;
+};
+
+
+//<Description>
+//Worker threads which run a JobGraph together with the main thread.
+//Run returns when every job of the graph is done, main thread only jobs are
+//run by the thread which calls Run while the workers run the others.
+//Without Start, or with no worker, Run runs the whole graph on the calling thread
+class JobPool
+{
+private:
+	class Worker : public IThreadWorker
+	{
+	public:
+		Worker(JobPool *Owner) :
+			Pool(Owner),
+			Thread(NULL),
+			WakeEvent(CreateEventA(NULL, FALSE, FALSE, NULL))
+		{
+		}
+
+		~Worker(void)
+		{
+			CloseHandle(WakeEvent);
+		}
+
+		void Do(void)
+		{
+			PROFILE_THREAD_NAME("JobPool")
+
+			Pool->Work(*this);
+		}
+
+	public:
+		JobPool *Pool;
+		IThread *Thread;
+		HANDLE WakeEvent;
+	};
+
+	typedef std::vector<Worker*> WorkersList;
+
+public:
+	JobPool(void) :
+		m_Graph(NULL),
+		m_Busy(0),
+		m_Running(false)
+	{
+	}
+
+	~JobPool(void)
+	{
+		Stop();
+	}
+
+	//The scripts and the plugins run their jobs on the workers started in main
+	DECLARE_SHARED_SINGLETON(JobPool)
+
+public:
+	//0 workers for one less than the processors
+	void Start(const unsigned int &WorkerCount = 0)
+	{
+		if (m_Workers.size())
+			return;
+
+		unsigned int count = WorkerCount;
+
+		if (!count)
+		{
+			const unsigned int processors = std::thread::hardware_concurrency();
+			count = (processors > 1 ? processors - 1 : 0);
+		}
+
+		m_Running.store(true, std::memory_order_release);
+
+		for (unsigned int i = 0; i < count; i++)
+		{
+			Worker *worker = new Worker(this);
+			worker->Thread = ThreadManager::GetReference().CreateThread(worker);
+
+			m_Workers.push_back(worker);
+		}
+	}
+
+	void Stop(void)
+	{
+		if (!m_Workers.size())
+			return;
+
+		m_Running.store(false, std::memory_order_release);
+
+		for (unsigned int i = 0; i < m_Workers.size(); i++)
+			SetEvent(m_Workers[i]->WakeEvent);
+
+		for (unsigned int i = 0; i < m_Workers.size(); i++)
+		{
+			m_Workers[i]->Thread->Join();
+			ThreadManager::GetReference().DestroyThread(m_Workers[i]->Thread);
+
+			delete m_Workers[i];
+		}
+
+		m_Workers.clear();
+	}
+
+	unsigned int GetWorkerCount(void) const
+	{
+		return (unsigned int)m_Workers.size();
+	}
+
+	//Runs Graph and waits for it, from the main thread
+	void Run(JobGraph &Graph)
+	{
+		if (!Graph.GetJobCount())
+			return;
+
+		Graph.Prepare();
+
+		const unsigned int parallelCount = Graph.GetJobCount() - Graph.m_MainThreadJobCount;
+
+		// the calling thread takes one of the jobs, unless it has main thread jobs of its own
+		unsigned int wake = parallelCount;
+		if (!Graph.m_MainThreadJobCount && wake)
+			wake--;
+		if (wake > m_Workers.size())
+			wake = (unsigned int)m_Workers.size();
+
+		m_Graph = &Graph;
+		m_Busy.store(wake, std::memory_order_release);
+
+		for (unsigned int i = 0; i < wake; i++)
+			SetEvent(m_Workers[i]->WakeEvent);
+
+		while (!Graph.IsDone())
+		{
+			if (Graph.ExecuteMainThreadJob())
+				continue;
+
+			const unsigned int index = Graph.Claim();
+
+			if (index == JobGraph::INVALID)
+			{
+				// the rest is running on the workers or waits for them
+				Sleep(0);
+				continue;
+			}
+
+			unsigned int job = 0;
+
+			// what it waits for can be a main thread job
+			while (!(job = Graph.GetClaimed(index)))
+				if (!Graph.ExecuteMainThreadJob())
+					Sleep(0);
+
+			Graph.Execute(job - 1);
+		}
+
+		// the workers may still be on their way out of the graph
+		while (m_Busy.load(std::memory_order_acquire))
+			Sleep(0);
+
+		m_Graph = NULL;
+	}
+
+private:
+	void Work(Worker &Self)
+	{
+		while (true)
+		{
+			WaitForSingleObject(Self.WakeEvent, INFINITE);
+
+			if (!m_Running.load(std::memory_order_acquire))
+				break;
+
+			JobGraph &graph = *m_Graph;
+
+			unsigned int index = 0;
+
+			while ((index = graph.Claim()) != JobGraph::INVALID)
+			{
+				unsigned int job = 0;
+
+				while (!(job = graph.GetClaimed(index)))
+					Sleep(0);
+
+				graph.Execute(job - 1);
+			}
+
+			m_Busy.fetch_sub(1, std::memory_order_release);
+		}
+	}
+
+private:
+	JobPool(const JobPool &Other);
+	void operator =(const JobPool &Other);
+
+private:
+	WorkersList m_Workers;
+
+	JobGraph *m_Graph;
+	std::atomic<unsigned int> m_Busy;
+	std::atomic<bool> m_Running;
+};
+
+END_NAMESPACE
\ No newline at end of file
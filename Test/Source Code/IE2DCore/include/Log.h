@@ -58,4 +58,8 @@ public:
 
 END_NAMESPACE
 
+#ifdef USE_ASYNC_LOG
+#include "AsyncLog.h"
+#endif
+
 #endif
\ No newline at end of file
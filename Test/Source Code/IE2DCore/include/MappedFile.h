@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////////////////
+///
+///  Impressive Engine 2D
+///
+/// Copyright (c) 2012-2013 Impressive Reality team
+///
+/// The license is
+///
+/// Permission is denied, to any person or company
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Project leader : O.Shahbazi <sh_omid_m@yahoo.com>
+///////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Common.h"
+#include <Windows.h>
+
+BEGIN_NAMESPACE
+
+//<Description>
+//Maps a whole file into memory read only.
+//The pages are loaded by the OS when they're first touched and shared between processes
+class MappedFile
+{
+public:
+	MappedFile(void) :
+		m_File(INVALID_HANDLE_VALUE),
+		m_Mapping(NULL),
+		m_Data(NULL),
+		m_Size(0)
+	{
+	}
+
+	~MappedFile(void)
+	{
+		Close();
+	}
+
+	bool Open(const String &FilePath)
+	{
+		Close();
+
+		m_File = CreateFileA(FilePath.GetBuffer(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+		if (m_File == INVALID_HANDLE_VALUE)
+			return false;
+
+		const DWORD size = GetFileSize(m_File, NULL);
+
+		if (size == INVALID_FILE_SIZE || size == 0)
+		{
+			Close();
+			return false;
+		}
+
+		m_Mapping = CreateFileMappingA(m_File, NULL, PAGE_READONLY, 0, 0, NULL);
+
+		if (m_Mapping)
+			m_Data = MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0);
+
+		if (!m_Data)
+		{
+			Close();
+			return false;
+		}
+
+		m_Size = size;
+
+		return true;
+	}
+
+	void Close(void)
+	{
+		if (m_Data)
+			UnmapViewOfFile(m_Data);
+
+		if (m_Mapping)
+			CloseHandle(m_Mapping);
+
+		if (m_File != INVALID_HANDLE_VALUE)
+			CloseHandle(m_File);
+
+		m_File = INVALID_HANDLE_VALUE;
+		m_Mapping = NULL;
+		m_Data = NULL;
+		m_Size = 0;
+	}
+
+	bool IsOpen(void) const
+	{
+		return (m_Data != NULL);
+	}
+
+	const void *GetData(void) const
+	{
+		return m_Data;
+	}
+
+	const unsigned int &GetSize(void) const
+	{
+		return m_Size;
+	}
+
+private:
+	MappedFile(const MappedFile &Other);
+	void operator =(const MappedFile &Other);
+
+private:
+	HANDLE m_File;
+	HANDLE m_Mapping;
+	void *m_Data;
+	unsigned int m_Size;
+};
+
+END_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,547 @@
+///////////////////////////////////////////////////////////////////////////////////
+///
+///  Impressive Engine 2D
+///
+/// Copyright (c) 2012-2013 Impressive Reality team
+///
+/// The license is
+///
+/// Permission is denied, to any person or company
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Project leader : O.Shahbazi <sh_omid_m@yahoo.com>
+///////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Common.h"
+#include <vector>
+#include <string>
+#include <string.h>
+
+BEGIN_NAMESPACE
+
+//<Description>
+//Read only archive of data files, written by the Cook tool and read in place from memory.
+//The file is a header followed by a hash table of the paths, the entries and their names;
+//the data of every entry is 16 bytes aligned. Entries are either stored as they are, so
+//they're used without any copy, or compressed with the LZ4 block format.
+//Paths are relative to the packed directory, lower case and separated by '/'; lookups
+//accept any case and '\' as separator
+class PackFile
+{
+public:
+	enum Compression
+	{
+		C_STORED = 0,
+		C_LZ4
+	};
+
+	struct Header
+	{
+	public:
+		char Magic[4];
+		unsigned int Version;
+
+		unsigned int EntryCount;
+		unsigned int EntriesOffset;
+
+		//Power of 2, every bucket is the index of the first entry of its chain
+		unsigned int BucketCount;
+		unsigned int BucketsOffset;
+
+		unsigned int NamesOffset;
+		unsigned int Size;
+	};
+
+	struct EntryRecord
+	{
+	public:
+		unsigned int Hash;
+
+		//Relative to Header::NamesOffset, the names are NULL terminated
+		unsigned int Name;
+		unsigned int NameLength;
+
+		//Next entry in the same bucket
+		unsigned int Next;
+
+		unsigned int Offset;
+		unsigned int Size;
+		unsigned int OriginalSize;
+		unsigned int Compression;
+	};
+
+	struct SourceFile
+	{
+	public:
+		SourceFile(const std::string &Path, const char *Data, const unsigned int &Size) :
+			Path(Path),
+			Data(Data),
+			Size(Size)
+		{
+		}
+
+	public:
+		std::string Path;
+		const char *Data;
+		unsigned int Size;
+	};
+
+	typedef std::vector<SourceFile> SourceFilesList;
+
+	static const unsigned int VERSION = 1;
+	static const unsigned int INVALID_INDEX = 0xFFFFFFFF;
+	static const unsigned int DATA_ALIGNMENT = 16;
+
+public:
+	PackFile(void) :
+		m_Header(NULL),
+		m_Buckets(NULL),
+		m_Entries(NULL),
+		m_Names(NULL),
+		m_Data(NULL)
+	{
+	}
+
+	//Data has to stay valid as long as the pack is used, nothing is copied.
+	//Returns false if Data isn't a pack file of this version, or is damaged
+	bool Open(const void *Data, const unsigned int &Size)
+	{
+		*this = PackFile();
+
+		if (!Data || Size < sizeof(Header) || (size_t)Data % 4 != 0)
+			return false;
+
+		const char *data = (const char*)Data;
+		const Header *header = (const Header*)data;
+
+		if (memcmp(header->Magic, "IE2P", 4) != 0 || header->Version != VERSION || header->Size != Size)
+			return false;
+
+		if (header->BucketCount == 0 || (header->BucketCount & (header->BucketCount - 1)) != 0 ||
+			header->BucketsOffset % 4 != 0 || header->EntriesOffset % 4 != 0 ||
+			!IsInside(header->BucketsOffset, header->BucketCount, sizeof(unsigned int), Size) ||
+			!IsInside(header->EntriesOffset, header->EntryCount, sizeof(EntryRecord), Size) ||
+			header->NamesOffset > Size)
+			return false;
+
+		const unsigned int *buckets = (const unsigned int*)(data + header->BucketsOffset);
+		const EntryRecord *entries = (const EntryRecord*)(data + header->EntriesOffset);
+		const unsigned int namesSize = Size - header->NamesOffset;
+
+		for (unsigned int i = 0; i < header->BucketCount; i++)
+			if (buckets[i] != INVALID_INDEX && buckets[i] >= header->EntryCount)
+				return false;
+
+		for (unsigned int i = 0; i < header->EntryCount; i++)
+		{
+			const EntryRecord &entry = entries[i];
+
+			// chains only go forward, so a damaged file can't make a lookup loop
+			if (entry.Next != INVALID_INDEX && (entry.Next <= i || entry.Next >= header->EntryCount))
+				return false;
+
+			if (entry.Name >= namesSize || entry.NameLength >= namesSize - entry.Name || data[header->NamesOffset + entry.Name + entry.NameLength] != '\0')
+				return false;
+
+			if (entry.Offset > Size || entry.Size > Size - entry.Offset)
+				return false;
+
+			if (entry.Compression == C_STORED ? entry.Size != entry.OriginalSize : entry.Compression != C_LZ4)
+				return false;
+		}
+
+		m_Header = header;
+		m_Buckets = buckets;
+		m_Entries = entries;
+		m_Names = data + header->NamesOffset;
+		m_Data = data;
+
+		return true;
+	}
+
+	bool IsOpen(void) const
+	{
+		return (m_Header != NULL);
+	}
+
+	//Returns NULL if there's no such file in the pack
+	const EntryRecord *Find(const char *Path) const
+	{
+		if (!m_Header)
+			return NULL;
+
+		Path = SkipRoot(Path);
+		const unsigned int length = strlen(Path);
+		const unsigned int hash = HashPath(Path, length);
+
+		for (unsigned int index = m_Buckets[hash & (m_Header->BucketCount - 1)]; index != INVALID_INDEX; index = m_Entries[index].Next)
+		{
+			const EntryRecord &entry = m_Entries[index];
+
+			if (entry.Hash == hash && entry.NameLength == length && IsSamePath(m_Names + entry.Name, Path, length))
+				return &entry;
+		}
+
+		return NULL;
+	}
+
+	//Data of a stored entry, NULL if the entry is compressed
+	const char *GetData(const EntryRecord *Entry) const
+	{
+		if (Entry->Compression != C_STORED)
+			return NULL;
+
+		return m_Data + Entry->Offset;
+	}
+
+	//Decompresses or copies the entry into Destination, which has to hold Entry->OriginalSize bytes
+	bool Read(const EntryRecord *Entry, char *Destination) const
+	{
+		if (Entry->Compression == C_STORED)
+		{
+			memcpy(Destination, m_Data + Entry->Offset, Entry->Size);
+			return true;
+		}
+
+		return DecompressLZ4(m_Data + Entry->Offset, Entry->Size, Destination, Entry->OriginalSize);
+	}
+
+	const unsigned int GetEntryCount(void) const
+	{
+		return (m_Header ? m_Header->EntryCount : 0);
+	}
+
+	const EntryRecord *GetEntry(const unsigned int &Index) const
+	{
+		return &m_Entries[Index];
+	}
+
+	const char *GetName(const EntryRecord *Entry) const
+	{
+		return m_Names + Entry->Name;
+	}
+
+	//Writes Files into Buffer, files that don't get at least 1/8 smaller compressed are stored
+	static void Write(const SourceFilesList &Files, std::vector<char> &Buffer, const bool &Compress = true)
+	{
+		const unsigned int entryCount = Files.size();
+
+		unsigned int bucketCount = 1;
+		while (bucketCount < entryCount)
+			bucketCount <<= 1;
+
+		std::vector<EntryRecord> entries(entryCount);
+		std::vector<unsigned int> buckets(bucketCount, (unsigned int)INVALID_INDEX);
+		std::vector<std::string> names(entryCount);
+		unsigned int namesSize = 0;
+
+		for (unsigned int i = 0; i < entryCount; i++)
+		{
+			const char *path = SkipRoot(Files[i].Path.c_str());
+
+			std::string &name = names[i];
+			for (; *path; path++)
+				name += NormalizeCharacter(*path);
+
+			EntryRecord &entry = entries[i];
+			memset(&entry, 0, sizeof(EntryRecord));
+			entry.Hash = HashPath(name.c_str(), name.size());
+			entry.Name = namesSize;
+			entry.NameLength = name.size();
+			entry.Next = INVALID_INDEX;
+
+			namesSize += name.size() + 1;
+		}
+
+		// chained from the back, so every chain goes forward
+		for (unsigned int i = entryCount; i-- > 0;)
+		{
+			unsigned int &bucket = buckets[entries[i].Hash & (bucketCount - 1)];
+			entries[i].Next = bucket;
+			bucket = i;
+		}
+
+		Header header;
+		memcpy(header.Magic, "IE2P", 4);
+		header.Version = VERSION;
+		header.EntryCount = entryCount;
+		header.BucketCount = bucketCount;
+		header.BucketsOffset = sizeof(Header);
+		header.EntriesOffset = header.BucketsOffset + bucketCount * sizeof(unsigned int);
+		header.NamesOffset = header.EntriesOffset + entryCount * sizeof(EntryRecord);
+
+		Buffer.clear();
+		Buffer.resize(Align(header.NamesOffset + namesSize));
+
+		for (unsigned int i = 0; i < entryCount; i++)
+			memcpy(&Buffer[header.NamesOffset + entries[i].Name], names[i].c_str(), names[i].size() + 1);
+
+		std::vector<char> compressed;
+
+		for (unsigned int i = 0; i < entryCount; i++)
+		{
+			const SourceFile &file = Files[i];
+			EntryRecord &entry = entries[i];
+
+			const char *data = file.Data;
+			entry.Size = file.Size;
+			entry.OriginalSize = file.Size;
+			entry.Compression = C_STORED;
+
+			if (Compress && file.Size)
+			{
+				CompressLZ4(file.Data, file.Size, compressed);
+
+				if (compressed.size() <= file.Size - file.Size / 8)
+				{
+					data = &compressed[0];
+					entry.Size = compressed.size();
+					entry.Compression = C_LZ4;
+				}
+			}
+
+			entry.Offset = Buffer.size();
+
+			Buffer.resize(Align(entry.Offset + entry.Size));
+			if (entry.Size)
+				memcpy(&Buffer[entry.Offset], data, entry.Size);
+		}
+
+		header.Size = Buffer.size();
+
+		memcpy(&Buffer[0], &header, sizeof(Header));
+		if (bucketCount)
+			memcpy(&Buffer[header.BucketsOffset], &buckets[0], bucketCount * sizeof(unsigned int));
+		if (entryCount)
+			memcpy(&Buffer[header.EntriesOffset], &entries[0], entryCount * sizeof(EntryRecord));
+	}
+
+	//Compresses Size bytes of Source into Destination in the LZ4 block format
+	static void CompressLZ4(const char *Source, const unsigned int &Size, std::vector<char> &Destination)
+	{
+		const unsigned int HASH_BITS = 12;
+
+		Destination.clear();
+		Destination.reserve(Size + Size / 255 + 16);
+
+		const unsigned char *source = (const unsigned char*)Source;
+
+		unsigned int table[1 << HASH_BITS];
+		memset(table, 0xFF, sizeof(table));
+
+		unsigned int anchor = 0;
+		unsigned int position = 0;
+
+		// the last match has to start 12 bytes and end 5 bytes before the end
+		if (Size > 12)
+			while (position < Size - 12)
+			{
+				const unsigned int sequence = ReadSequence(source + position);
+				unsigned int &slot = table[(sequence * 2654435761U) >> (32 - HASH_BITS)];
+				const unsigned int candidate = slot;
+				slot = position;
+
+				if (candidate == INVALID_INDEX || position - candidate > 0xFFFF || ReadSequence(source + candidate) != sequence)
+				{
+					position++;
+					continue;
+				}
+
+				const unsigned int maximumLength = Size - 5 - position;
+				unsigned int length = 4;
+				while (length < maximumLength && source[candidate + length] == source[position + length])
+					length++;
+
+				WriteLZ4Sequence(Destination, source + anchor, position - anchor, position - candidate, length);
+
+				position += length;
+				anchor = position;
+			}
+
+		WriteLZ4Sequence(Destination, source + anchor, Size - anchor, 0, 0);
+	}
+
+	//Returns false if Source is damaged or doesn't decompress to exactly DestinationSize bytes
+	static bool DecompressLZ4(const char *Source, const unsigned int &SourceSize, char *Destination, const unsigned int &DestinationSize)
+	{
+		const unsigned char *source = (const unsigned char*)Source;
+		const unsigned char *sourceEnd = source + SourceSize;
+		unsigned char *destination = (unsigned char*)Destination;
+		unsigned int written = 0;
+
+		while (source < sourceEnd)
+		{
+			const unsigned int token = *source++;
+
+			unsigned int literalLength = token >> 4;
+			if (literalLength == 15 && !ReadLZ4Length(source, sourceEnd, literalLength))
+				return false;
+
+			if (literalLength > (unsigned int)(sourceEnd - source) || literalLength > DestinationSize - written)
+				return false;
+
+			if (literalLength)
+				memcpy(destination + written, source, literalLength);
+			source += literalLength;
+			written += literalLength;
+
+			// the last sequence has no match
+			if (source == sourceEnd)
+				break;
+
+			if (sourceEnd - source < 2)
+				return false;
+
+			const unsigned int offset = source[0] | (source[1] << 8);
+			source += 2;
+
+			if (offset == 0 || offset > written)
+				return false;
+
+			unsigned int matchLength = token & 15;
+			if (matchLength == 15 && !ReadLZ4Length(source, sourceEnd, matchLength))
+				return false;
+			matchLength += 4;
+
+			if (matchLength > DestinationSize - written)
+				return false;
+
+			const unsigned char *match = destination + written - offset;
+			unsigned char *output = destination + written;
+
+			if (offset >= matchLength)
+				memcpy(output, match, matchLength);
+			else
+				for (unsigned int i = 0; i < matchLength; i++)
+					output[i] = match[i];
+
+			written += matchLength;
+		}
+
+		return (written == DestinationSize);
+	}
+
+	//Paths are compared in lower case with '/' as separator
+	static char NormalizeCharacter(const char &Character)
+	{
+		if (Character == '\\')
+			return '/';
+
+		if (Character >= 'A' && Character <= 'Z')
+			return Character - 'A' + 'a';
+
+		return Character;
+	}
+
+private:
+	static bool IsInside(const unsigned int &Offset, const unsigned int &Count, const unsigned int &RecordSize, const unsigned int &Size)
+	{
+		return (Offset <= Size && Count <= (Size - Offset) / RecordSize);
+	}
+
+	static unsigned int Align(const unsigned int &Size)
+	{
+		return (Size + DATA_ALIGNMENT - 1) & ~(DATA_ALIGNMENT - 1);
+	}
+
+	static const char *SkipRoot(const char *Path)
+	{
+		while (true)
+		{
+			if (*Path == '/' || *Path == '\\')
+				Path++;
+			else if (Path[0] == '.' && (Path[1] == '/' || Path[1] == '\\'))
+				Path += 2;
+			else
+				return Path;
+		}
+	}
+
+	//FNV-1a of the normalized path
+	static unsigned int HashPath(const char *Path, const unsigned int &Length)
+	{
+		unsigned int hash = 2166136261U;
+
+		for (unsigned int i = 0; i < Length; i++)
+		{
+			hash ^= (unsigned char)NormalizeCharacter(Path[i]);
+			hash *= 16777619U;
+		}
+
+		return hash;
+	}
+
+	static bool IsSamePath(const char *Name, const char *Path, const unsigned int &Length)
+	{
+		for (unsigned int i = 0; i < Length; i++)
+			if (Name[i] != NormalizeCharacter(Path[i]))
+				return false;
+
+		return true;
+	}
+
+	static unsigned int ReadSequence(const unsigned char *Data)
+	{
+		unsigned int value;
+		memcpy(&value, Data, sizeof(value));
+		return value;
+	}
+
+	static void WriteLZ4Length(std::vector<char> &Destination, unsigned int Length)
+	{
+		for (; Length >= 255; Length -= 255)
+			Destination.push_back((char)255);
+
+		Destination.push_back((char)Length);
+	}
+
+	static bool ReadLZ4Length(const unsigned char *&Source, const unsigned char *SourceEnd, unsigned int &Length)
+	{
+		unsigned int value;
+
+		do
+		{
+			if (Source == SourceEnd)
+				return false;
+
+			value = *Source++;
+			Length += value;
+		} while (value == 255);
+
+		return true;
+	}
+
+	static void WriteLZ4Sequence(std::vector<char> &Destination, const unsigned char *Literals, const unsigned int &LiteralLength, const unsigned int &Offset, const unsigned int &MatchLength)
+	{
+		const unsigned int literalToken = (LiteralLength < 15 ? LiteralLength : 15);
+		const unsigned int matchToken = (MatchLength == 0 ? 0 : (MatchLength - 4 < 15 ? MatchLength - 4 : 15));
+
+		Destination.push_back((char)((literalToken << 4) | matchToken));
+
+		if (literalToken == 15)
+			WriteLZ4Length(Destination, LiteralLength - 15);
+
+		Destination.insert(Destination.end(), Literals, Literals + LiteralLength);
+
+		if (MatchLength == 0)
+			return;
+
+		Destination.push_back((char)(Offset & 0xFF));
+		Destination.push_back((char)(Offset >> 8));
+
+		if (matchToken == 15)
+			WriteLZ4Length(Destination, MatchLength - 4 - 15);
+	}
+
+private:
+	const Header *m_Header;
+	const unsigned int *m_Buckets;
+	const EntryRecord *m_Entries;
+	const char *m_Names;
+	const char *m_Data;
+};
+
+END_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,295 @@
+///////////////////////////////////////////////////////////////////////////////////
+///
+///  Impressive Engine 2D
+///
+/// Copyright (c) 2012-2013 Impressive Reality team
+///
+/// The license is
+///
+/// Permission is denied, to any person or company
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Project leader : O.Shahbazi <sh_omid_m@yahoo.com>
+///////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "FileIO.h"
+#include "PackFile.h"
+#include "MappedFile.h"
+
+BEGIN_NAMESPACE
+
+//<Description>
+//Read only file of a mounted pack. Stored entries point straight into the mapped pack,
+//compressed entries are decompressed once when the file is opened.
+//GetData isn't part of IFile, the files of FileIO are made in the engine and have no such view
+class PackedFile : public IFile
+{
+public:
+	PackedFile(const String &FilePath, const char *Data, const unsigned int &Size, char *OwnedData = NULL) :
+		m_FilePath(FilePath),
+		m_Data(Data),
+		m_OwnedData(OwnedData),
+		m_Size(Size),
+		m_HasText(false),
+		m_WriteMode(false)
+	{
+	}
+
+	~PackedFile(void)
+	{
+		Close();
+	}
+
+	const String &ReadText(void)
+	{
+		if (!m_HasText && m_Data)
+		{
+			m_Text = String(m_Data, m_Size);
+			m_HasText = true;
+		}
+
+		return m_Text;
+	}
+
+	void WriteText(const String &Text)
+	{
+		LOG_WARNING("Writing to a packed file isn't possible [" + m_FilePath + "]")
+	}
+
+	bool IsOpen(void) const
+	{
+		return (m_Data != NULL);
+	}
+
+	void Close(void)
+	{
+		if (m_OwnedData)
+			delete []m_OwnedData;
+
+		m_Data = NULL;
+		m_OwnedData = NULL;
+	}
+
+	IFile &operator <<(const String &Text)
+	{
+		WriteText(Text);
+
+		return *this;
+	}
+
+	const String &GetFilePath(void) const
+	{
+		return m_FilePath;
+	}
+
+	const long &GetSize(void) const
+	{
+		return m_Size;
+	}
+
+	const bool &IsWriteMode(void) const
+	{
+		return m_WriteMode;
+	}
+
+	const char *GetData(void) const
+	{
+		return m_Data;
+	}
+
+private:
+	PackedFile(const PackedFile &Other);
+	void operator =(const PackedFile &Other);
+
+private:
+	String m_FilePath;
+
+	const char *m_Data;
+	char *m_OwnedData;
+	long m_Size;
+
+	String m_Text;
+	bool m_HasText;
+
+	bool m_WriteMode;
+};
+
+//<Description>
+//Mounts pack files as a read only overlay over the data directories.
+//A file is looked up in the packs first, the most recently mounted one wins, and only
+//opened from disk through FileIO when no pack has it. A lookup is a hash and a few
+//compares on the mapped memory, no system call is made for packed files.
+//Files opened from a pack must be closed before it's unmounted.
+//It's an overlay only for code which opens its files through it, the engine reads the
+//scenes and the resources with its own FileIO and doesn't see the mounted packs, so the
+//Launcher mounts nothing
+class PackFileSystem
+{
+private:
+	struct MountedPack
+	{
+	public:
+		String FilePath;
+
+		//Normalized like the paths of the pack, empty or ending with '/'
+		std::string MountPath;
+
+		MappedFile File;
+		PackFile Pack;
+	};
+
+	typedef Vector<MountedPack*> MountedPacksList;
+
+public:
+	PackFileSystem(void)
+	{
+	}
+
+	~PackFileSystem(void)
+	{
+		UnmountAll();
+	}
+
+	//The files of the pack are found under MountPath, like Core::GetDataPath() for a pack of the whole data directory
+	bool Mount(const String &PackFilePath, const String &MountPath = "")
+	{
+		MountedPack *mount = new MountedPack;
+
+		if (!mount->File.Open(PackFilePath) || !mount->Pack.Open(mount->File.GetData(), mount->File.GetSize()))
+		{
+			LOG_ERROR("Couldn't mount pack file [" + PackFilePath + "]")
+
+			delete mount;
+			return false;
+		}
+
+		mount->FilePath = PackFilePath;
+
+		for (const char *path = MountPath.GetBuffer(); *path; path++)
+			mount->MountPath += PackFile::NormalizeCharacter(*path);
+
+		if (mount->MountPath.size() && mount->MountPath[mount->MountPath.size() - 1] != '/')
+			mount->MountPath += '/';
+
+		m_Mounts.Add(mount);
+
+		return true;
+	}
+
+	void Unmount(const String &PackFilePath)
+	{
+		for (unsigned int i = 0; i < m_Mounts.GetSize(); i++)
+			if (m_Mounts[i]->FilePath == PackFilePath)
+			{
+				delete m_Mounts[i];
+				m_Mounts.Remove(i);
+				return;
+			}
+	}
+
+	void UnmountAll(void)
+	{
+		for (unsigned int i = 0; i < m_Mounts.GetSize(); i++)
+			delete m_Mounts[i];
+
+		m_Mounts.Clear();
+	}
+
+	bool Contains(const String &FilePath) const
+	{
+		const PackFile *pack;
+		return (Find(FilePath, pack) != NULL);
+	}
+
+	//Zero copy view of a packed file, NULL if it isn't in any pack or is compressed.
+	//Valid as long as the pack is mounted
+	const char *GetData(const String &FilePath, unsigned int &Size) const
+	{
+		const PackFile *pack;
+		const PackFile::EntryRecord *entry = Find(FilePath, pack);
+
+		if (!entry || entry->Compression != PackFile::C_STORED)
+			return NULL;
+
+		Size = entry->Size;
+
+		return pack->GetData(entry);
+	}
+
+	//Opens FilePath from the packs, or from disk if no pack has it
+	IFile *OpenFile(const String &FilePath)
+	{
+		const PackFile *pack;
+		const PackFile::EntryRecord *entry = Find(FilePath, pack);
+
+		if (!entry)
+			return FileIO::GetReference().OpenFile(FilePath);
+
+		if (entry->Compression == PackFile::C_STORED)
+			return new PackedFile(FilePath, pack->GetData(entry), entry->Size);
+
+		char *data = new char[entry->OriginalSize + 1];
+
+		if (!pack->Read(entry, data))
+		{
+			LOG_ERROR("Packed file is damaged [" + FilePath + "]")
+
+			delete []data;
+			return NULL;
+		}
+
+		data[entry->OriginalSize] = '\0';
+
+		return new PackedFile(FilePath, data, entry->OriginalSize, data);
+	}
+
+	const unsigned int GetMountCount(void) const
+	{
+		return m_Mounts.GetSize();
+	}
+
+private:
+	const PackFile::EntryRecord *Find(const String &FilePath, const PackFile *&Pack) const
+	{
+		for (unsigned int i = m_Mounts.GetSize(); i-- > 0;)
+		{
+			const MountedPack *mount = m_Mounts[i];
+
+			const char *path = SkipMountPath(FilePath.GetBuffer(), mount->MountPath);
+			if (!path)
+				continue;
+
+			const PackFile::EntryRecord *entry = mount->Pack.Find(path);
+
+			if (entry)
+			{
+				Pack = &mount->Pack;
+				return entry;
+			}
+		}
+
+		return NULL;
+	}
+
+	//Returns the rest of FilePath after MountPath, NULL if FilePath isn't under it
+	static const char *SkipMountPath(const char *FilePath, const std::string &MountPath)
+	{
+		for (unsigned int i = 0; i < MountPath.size(); i++, FilePath++)
+			if (PackFile::NormalizeCharacter(*FilePath) != MountPath[i])
+				return NULL;
+
+		return FilePath;
+	}
+
+private:
+	PackFileSystem(const PackFileSystem &Other);
+	void operator =(const PackFileSystem &Other);
+
+private:
+	MountedPacksList m_Mounts;
+};
+
+END_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,156 @@
+///////////////////////////////////////////////////////////////////////////////////
+///
+///  Impressive Engine 2D
+///
+/// Copyright (c) 2012-2013 Impressive Reality team
+///
+/// The license is
+///
+/// Permission is denied, to any person or company
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Project leader : O.Shahbazi <sh_omid_m@yahoo.com>
+///////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Common.h"
+#include "IPlugin.h"
+#include <Windows.h>
+#include <vector>
+#include <string>
+
+BEGIN_NAMESPACE
+
+//<Description>
+//Loads the plugins of the game, DLLs which export LOAD_PLUGIN_FUNCTION, from a directory.
+//Find only lists the DLLs, so it can run on a thread of its own while Core is being
+//initialized. Load then loads them, creates and installs the plugins on the main thread after
+//Core is initialized, the DllMain and the static objects of a plugin may use the engine.
+//They aren't called at the same time.
+//The DLLs stay loaded until the process ends, what the plugins install lives in them
+class PluginLoader
+{
+public:
+	typedef std::vector<IPlugin*> PluginsList;
+
+private:
+	typedef std::vector<std::string> FilesList;
+
+public:
+	PluginLoader(void)
+	{
+	}
+
+	static PluginLoader &GetReference(void)
+	{
+		static PluginLoader instance;
+
+		return instance;
+	}
+
+	//The Plugins directory next to the executable
+	static std::string GetDefaultDirectory(void)
+	{
+		char path[MAX_PATH];
+		const DWORD length = GetModuleFileNameA(NULL, path, MAX_PATH);
+
+		std::string directory(path, length);
+		directory.erase(directory.find_last_of("\\/") + 1);
+
+		return directory + "Plugins\\";
+	}
+
+	//Directory ends with a separator, returns the number of DLLs found in it
+	unsigned int Find(const std::string &Directory)
+	{
+		WIN32_FIND_DATAA data;
+		HANDLE find = FindFirstFileA((Directory + "*.dll").c_str(), &data);
+
+		if (find == INVALID_HANDLE_VALUE)
+			return 0;
+
+		unsigned int count = 0;
+
+		do
+		{
+			m_Files.push_back(Directory + data.cFileName);
+			count++;
+		} while (FindNextFileA(find, &data));
+
+		FindClose(find);
+
+		return count;
+	}
+
+	unsigned int Find(void)
+	{
+		return Find(GetDefaultDirectory());
+	}
+
+	//Loads the DLLs found since the last Load and installs their plugins, from the main thread
+	//after Core is initialized. Returns the number of plugins it installed
+	unsigned int Load(void)
+	{
+		unsigned int count = 0;
+
+		for (unsigned int i = 0; i < m_Files.size(); i++)
+		{
+			const String fileName(m_Files[i].c_str());
+
+			HMODULE module = LoadLibraryA(m_Files[i].c_str());
+
+			if (!module)
+			{
+				LOG_ERROR("Couldn't load plugin [" + fileName + "]")
+				continue;
+			}
+
+			LoadPluginFunction function = (LoadPluginFunction)GetProcAddress(module, LOAD_PLUGIN_FUNCTION_STRING);
+
+			// a DLL the plugins use, not a plugin
+			if (!function)
+			{
+				FreeLibrary(module);
+				continue;
+			}
+
+			IPlugin *plugin = function();
+
+			if (!plugin)
+			{
+				LOG_ERROR("Plugin [" + fileName + "] didn't create its plugin")
+				continue;
+			}
+
+			LOG_INFO("Installing plugin [" + plugin->GetName() + "] " + plugin->GetVersion())
+
+			plugin->Install();
+
+			m_Plugins.push_back(plugin);
+			count++;
+		}
+
+		m_Files.clear();
+
+		return count;
+	}
+
+	const PluginsList &GetPlugins(void) const
+	{
+		return m_Plugins;
+	}
+
+private:
+	PluginLoader(const PluginLoader &Other);
+	void operator =(const PluginLoader &Other);
+
+private:
+	PluginsList m_Plugins;
+
+	// found on the loading thread, loaded by Load
+	FilesList m_Files;
+};
+
+END_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,487 @@
+///////////////////////////////////////////////////////////////////////////////////
+///
+///  Impressive Engine 2D
+///
+/// Copyright (c) 2012-2013 Impressive Reality team
+///
+/// The license is
+///
+/// Permission is denied, to any person or company
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Project leader : O.Shahbazi <sh_omid_m@yahoo.com>
+///////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Common.h"
+#include "Core.h"
+#include "IScene.h"
+#include "IGameObject.h"
+#include "ITransform.h"
+#include "Component.h"
+#include "Profiler.h"
+#include "Physics\IBody.h"
+#include <stdio.h>
+#include <vector>
+#include <map>
+#include <string>
+#include <algorithm>
+#include <unordered_map>
+
+BEGIN_NAMESPACE
+
+//<Description>
+//Implemented by components which keep state that has to be reset when their game object
+//goes back to a PrefabPool, next to deriving from Component.
+//The pool finds them in ComponentRegistry, so they're made with DEFINE_POOLED_COMPONENT,
+//in any module
+class IPoolable
+{
+public:
+	virtual ~IPoolable(void) {}
+
+	//The game object is handed out again, after its transform and body are reset
+	virtual void OnAcquire(void) = 0;
+
+	//The game object went back to the pool
+	virtual void OnRelease(void) = 0;
+};
+
+
+//<Description>
+//Instances of a prefab game object which are made once and used again, instead of cloning
+//a game object for every bullet and destroying it afterwards.
+//The pool clones the prefab in batches. Release hides an instance and deactivates its
+//body. Acquire gives a released instance back with the transform of the prefab, an
+//awake body without velocity, and OnAcquire called on its IPoolable components.
+//Instances which are destroyed by someone else are forgotten, the prefab has to stay in
+//the scene as long as the pool is used. Made with PrefabPoolManager, which puts the
+//statistics into the profiler every frame
+class PrefabPool : public IScene::IListener
+{
+	friend class PrefabPoolManager;
+
+public:
+	struct Statistics
+	{
+	public:
+		const char *Name;
+
+		//Instances made, and the ones handed out right now
+		unsigned int Count;
+		unsigned int ActiveCount;
+		unsigned int PeakActiveCount;
+
+		unsigned int AcquireCount;
+		unsigned int GrowCount;
+	};
+
+private:
+	struct Instance
+	{
+	public:
+		std::vector<IPoolable*> Poolables;
+		bool Active;
+	};
+
+	typedef std::unordered_map<IGameObject*, Instance> InstancesMap;
+	typedef std::vector<IGameObject*> GameObjectsList;
+
+private:
+	PrefabPool(IGameObject *Prefab, const String &Name, IGameObject *Parent, const unsigned int &Count, const unsigned int &BatchSize) :
+		m_Prefab(Prefab),
+		m_Scene(Prefab->GetHolder()),
+		m_Parent(Parent),
+		m_Name(Name.GetBuffer()),
+		m_BatchSize(BatchSize ? BatchSize : 1),
+		m_Destroying(false)
+	{
+		m_Statistics.Name = m_Name.c_str();
+		m_Statistics.Count = 0;
+		m_Statistics.ActiveCount = 0;
+		m_Statistics.PeakActiveCount = 0;
+		m_Statistics.AcquireCount = 0;
+		m_Statistics.GrowCount = 0;
+
+		m_CountCounterName = "PrefabPool " + m_Name + " Count";
+		m_ActiveCounterName = "PrefabPool " + m_Name + " Active";
+
+		m_Position = Prefab->GetTransform()->GetPosition();
+		m_Rotation = Prefab->GetTransform()->GetRotation();
+		m_Visible = Prefab->GetVisible();
+
+		if (m_Scene)
+			m_Scene->AddListener(this);
+
+		Reserve(Count);
+	}
+
+	//Destroys the instances, the ones handed out too
+	~PrefabPool(void)
+	{
+		if (m_Scene)
+			m_Scene->RemoveListener(this);
+
+		m_Destroying = true;
+
+		FOR_EACH_MAP(it, m_Instances)
+			it->first->Destroy();
+	}
+
+public:
+	//NULL if the prefab is gone
+	IGameObject *Acquire(void)
+	{
+		if (!m_Free.size())
+			Grow(m_BatchSize);
+
+		if (!m_Free.size())
+			return NULL;
+
+		IGameObject *gameObject = m_Free.back();
+		m_Free.pop_back();
+
+		Instance &instance = m_Instances[gameObject];
+		instance.Active = true;
+
+		gameObject->GetTransform()->SetPosition(m_Position);
+		gameObject->GetTransform()->SetRotation(m_Rotation);
+		gameObject->SetVisible(m_Visible);
+
+		IBody *body = gameObject->GetBody();
+
+		if (body)
+		{
+			body->SetTransform(Vector2D(m_Position.X, m_Position.Y), m_Rotation);
+			body->SetLinearVelocity(Vector2D(0.0f, 0.0f));
+			body->SetAngularVelocity(0.0f);
+			body->SetActive(true);
+			body->SetAwake(true);
+		}
+
+		for (unsigned int i = 0; i < instance.Poolables.size(); i++)
+			instance.Poolables[i]->OnAcquire();
+
+		m_Statistics.AcquireCount++;
+		m_Statistics.ActiveCount++;
+
+		if (m_Statistics.ActiveCount > m_Statistics.PeakActiveCount)
+			m_Statistics.PeakActiveCount = m_Statistics.ActiveCount;
+
+		return gameObject;
+	}
+
+	//Game objects which aren't handed out by this pool are ignored
+	void Release(IGameObject *GameObject)
+	{
+		InstancesMap::iterator it = m_Instances.find(GameObject);
+
+		if (it == m_Instances.end() || !it->second.Active)
+			return;
+
+		Deactivate(GameObject, it->second);
+
+		m_Free.push_back(GameObject);
+		m_Statistics.ActiveCount--;
+	}
+
+	//Makes instances until there are Count free ones
+	void Reserve(const unsigned int &Count)
+	{
+		if (m_Free.size() < Count)
+			Grow(Count - (unsigned int)m_Free.size());
+	}
+
+	const Statistics &GetStatistics(void) const
+	{
+		return m_Statistics;
+	}
+
+	const std::string &GetName(void) const
+	{
+		return m_Name;
+	}
+
+private:
+	void Grow(const unsigned int &Count)
+	{
+		PROFILE_SCOPE("PrefabPool::Grow")
+
+		if (!m_Prefab)
+			return;
+
+		GameObjectsList gameObjects;
+		gameObjects.reserve(Count);
+
+		char suffix[16];
+
+		for (unsigned int i = 0; i < Count; i++)
+		{
+			sprintf_s(suffix, sizeof(suffix), "#%u", m_Statistics.Count + i);
+
+			IGameObject *gameObject = m_Prefab->Clone((m_Name + suffix).c_str(), m_Parent);
+
+			if (gameObject)
+				gameObjects.push_back(gameObject);
+		}
+
+		// the IPoolable components of the whole batch in one pass over the components
+		std::sort(gameObjects.begin(), gameObjects.end());
+
+		std::vector<Component*> components;
+		ComponentRegistry::GetReference().GetComponents(gameObjects, components);
+
+		for (unsigned int i = 0; i < gameObjects.size(); i++)
+			m_Instances[gameObjects[i]].Active = false;
+
+		for (unsigned int i = 0; i < components.size(); i++)
+		{
+			IPoolable *poolable = dynamic_cast<IPoolable*>(components[i]);
+
+			if (poolable)
+				m_Instances[components[i]->GetHolder()].Poolables.push_back(poolable);
+		}
+
+		for (unsigned int i = 0; i < gameObjects.size(); i++)
+		{
+			Deactivate(gameObjects[i], m_Instances[gameObjects[i]]);
+			m_Free.push_back(gameObjects[i]);
+		}
+
+		m_Statistics.Count += (unsigned int)gameObjects.size();
+		m_Statistics.GrowCount++;
+	}
+
+	void Deactivate(IGameObject *GameObject, Instance &Instance)
+	{
+		for (unsigned int i = 0; i < Instance.Poolables.size(); i++)
+			Instance.Poolables[i]->OnRelease();
+
+		Instance.Active = false;
+
+		GameObject->SetVisible(false);
+
+		IBody *body = GameObject->GetBody();
+
+		if (body)
+			body->SetActive(false);
+	}
+
+	//The scene is going away with the instances
+	void Abandon(void)
+	{
+		if (m_Scene)
+			m_Scene->RemoveListener(this);
+
+		m_Scene = NULL;
+		m_Prefab = NULL;
+
+		m_Instances.clear();
+		m_Free.clear();
+
+		m_Statistics.Count = 0;
+		m_Statistics.ActiveCount = 0;
+	}
+
+	void OnReloadAll(IGameObject *RootGameObject)
+	{
+	}
+
+	void OnGameObjectAdded(IGameObject *GameObject)
+	{
+	}
+
+	void OnBeforeGameObjectRemoved(IGameObject *GameObject)
+	{
+		if (m_Destroying)
+			return;
+
+		if (GameObject == m_Prefab)
+		{
+			m_Prefab = NULL;
+			return;
+		}
+
+		InstancesMap::iterator it = m_Instances.find(GameObject);
+
+		if (it == m_Instances.end())
+			return;
+
+		if (it->second.Active)
+			m_Statistics.ActiveCount--;
+		else
+			m_Free.erase(std::find(m_Free.begin(), m_Free.end(), GameObject));
+
+		m_Instances.erase(it);
+		m_Statistics.Count--;
+	}
+
+	void OnAfterGameObjectRemoved(void)
+	{
+	}
+
+	void OnBeforeGameModified(IGameObject *GameObject)
+	{
+	}
+
+	void OnAfterGameModified(IGameObject *GameObject)
+	{
+	}
+
+private:
+	PrefabPool(const PrefabPool &Other);
+	void operator =(const PrefabPool &Other);
+
+private:
+	IGameObject *m_Prefab;
+	IScene *m_Scene;
+	IGameObject *m_Parent;
+	std::string m_Name;
+	unsigned int m_BatchSize;
+
+	// of the prefab, given back to the instances
+	Vector3D m_Position;
+	float m_Rotation;
+	bool m_Visible;
+
+	InstancesMap m_Instances;
+	GameObjectsList m_Free;
+
+	Statistics m_Statistics;
+	std::string m_CountCounterName;
+	std::string m_ActiveCounterName;
+
+	bool m_Destroying;
+};
+
+
+//<Description>
+//Makes the prefab pools and finds them by name. The pools of a scene are forgotten when
+//the scene is removed, the size of every pool is a profiler counter
+class PrefabPoolManager : public Core::IListener
+{
+private:
+	typedef std::map<std::string, PrefabPool*> PoolsMap;
+
+public:
+	PrefabPoolManager(void) :
+		m_Attached(false)
+	{
+	}
+
+	~PrefabPoolManager(void)
+	{
+		FOR_EACH_MAP(it, m_Pools)
+			delete it->second;
+	}
+
+	static PrefabPoolManager &GetReference(void)
+	{
+		static PrefabPoolManager instance;
+
+		return instance;
+	}
+
+	//Clones Prefab Count times under Parent and grows by BatchSize when it runs out, NULL if Name is used
+	PrefabPool *CreatePool(IGameObject *Prefab, const String &Name, IGameObject *Parent = NULL, const unsigned int &Count = 16, const unsigned int &BatchSize = 16)
+	{
+		if (m_Pools.find(Name.GetBuffer()) != m_Pools.end())
+			return NULL;
+
+		if (!m_Attached)
+		{
+			Core::GetReference().AddListener(this);
+			m_Attached = true;
+		}
+
+		PrefabPool *pool = new PrefabPool(Prefab, Name, Parent, Count, BatchSize);
+		m_Pools[pool->GetName()] = pool;
+
+		return pool;
+	}
+
+	PrefabPool *GetPool(const String &Name)
+	{
+		PoolsMap::iterator it = m_Pools.find(Name.GetBuffer());
+
+		return (it == m_Pools.end() ? NULL : it->second);
+	}
+
+	//Destroys the pool and its instances
+	void DestroyPool(const String &Name)
+	{
+		PoolsMap::iterator it = m_Pools.find(Name.GetBuffer());
+
+		if (it == m_Pools.end())
+			return;
+
+		delete it->second;
+		m_Pools.erase(it);
+
+		if (!m_Pools.size() && m_Attached)
+		{
+			Core::GetReference().RemoveListener(this);
+			m_Attached = false;
+		}
+	}
+
+	void GetStatistics(std::vector<PrefabPool::Statistics> &Statistics) const
+	{
+		Statistics.clear();
+
+		FOR_EACH_MAP(it, m_Pools)
+			Statistics.push_back(it->second->GetStatistics());
+	}
+
+private:
+	void OnBeforeSceneRemoved(IScene *Scene)
+	{
+		FOR_EACH_MAP(it, m_Pools)
+			if (it->second->m_Scene == Scene)
+				it->second->Abandon();
+	}
+
+	void OnSceneAdded(IScene *Scene)
+	{
+	}
+
+	void OnSetCurrentScene(IScene *Scene)
+	{
+	}
+
+	void OnBeforeUpdate(void)
+	{
+	}
+
+	// the values the frame ends with
+	void OnAfterUpdate(void)
+	{
+		FOR_EACH_MAP(it, m_Pools)
+		{
+			PrefabPool &pool = *it->second;
+
+			PROFILE_COUNTER(pool.m_CountCounterName.c_str(), pool.m_Statistics.Count)
+			PROFILE_COUNTER(pool.m_ActiveCounterName.c_str(), pool.m_Statistics.ActiveCount)
+		}
+	}
+
+	void OnBeforeRender(void)
+	{
+	}
+
+	void OnAfterRender(void)
+	{
+	}
+
+private:
+	PrefabPoolManager(const PrefabPoolManager &Other);
+	void operator =(const PrefabPoolManager &Other);
+
+private:
+	PoolsMap m_Pools;
+	bool m_Attached;
+};
+
+END_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,889 @@
+///////////////////////////////////////////////////////////////////////////////////
+///
+///  Impressive Engine 2D
+///
+/// Copyright (c) 2012-2013 Impressive Reality team
+///
+/// The license is
+///
+/// Permission is denied, to any person or company
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Project leader : O.Shahbazi <sh_omid_m@yahoo.com>
+///////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Common.h"
+
+#ifdef USE_PROFILER
+
+#include "Core.h"
+#include "FileIO.h"
+#include "IFile.h"
+#include <Windows.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <map>
+#include <string>
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+
+#define PROFILER_CONCATENATE_INNER(A, B) A##B
+#define PROFILER_CONCATENATE(A, B) PROFILER_CONCATENATE_INNER(A, B)
+
+//Profiles the rest of the scope as Name, which has to be a string literal
+#define PROFILE_SCOPE(Name) Profiler::Scope PROFILER_CONCATENATE(__profilerScope, __LINE__)(Name);
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+
+//Names the calling thread in the trace, Name has to be a string literal
+#define PROFILE_THREAD_NAME(Name) Profiler::GetReference().SetThreadName(Name);
+
+//Sets the value of a counter for the current frame, on the main thread
+#define PROFILE_COUNTER(Name, Value) Profiler::GetReference().SetCounter(Name, Value);
+
+
+BEGIN_NAMESPACE
+
+//<Description>
+//Measures scopes marked with PROFILE_SCOPE on any thread with the performance counter.
+//Every thread writes its finished scopes into its own lock free ring, the main thread
+//collects them when a frame ends, adds up the time of every marker in the frame and
+//keeps it for the last frames, see GetStatistics. The scopes of the last frames are
+//also kept for the trace, which is written as Chrome trace_event JSON by SaveTrace.
+//Attached to Core, a frame is from one OnBeforeUpdate to the next one, with Update
+//and Render markers between the hooks.
+//Counters are values like the number of live objects, set any time in a frame with
+//PROFILE_COUNTER, their value at the end of the frame is kept like the time of a marker
+//and is in the trace as a graph.
+//Without USE_PROFILER the macros are empty and nothing of this is compiled
+class Profiler : public Core::IListener
+{
+private:
+	enum
+	{
+		// of one thread, collected every frame
+		EVENT_RING_SIZE = 8192,
+		MAX_DEPTH = 64
+	};
+
+	struct Event
+	{
+	public:
+		const char *Name;
+		long long Begin;
+		long long End;
+		unsigned int Depth;
+		unsigned int ThreadID;
+	};
+
+	class ThreadBuffer
+	{
+	public:
+		ThreadBuffer(void) :
+			Events(EVENT_RING_SIZE),
+			Write(0),
+			Read(0),
+			Dropped(0),
+			Name(NULL),
+			ThreadID(GetCurrentThreadId()),
+			Depth(0)
+		{
+		}
+
+		void Begin(const char *ScopeName)
+		{
+			if (Depth < MAX_DEPTH)
+			{
+				Open[Depth].Name = ScopeName;
+				Open[Depth].Begin = GetTime();
+			}
+
+			Depth++;
+		}
+
+		void End(void)
+		{
+			const long long time = GetTime();
+
+			// more ends than begins
+			if (!Depth)
+				return;
+
+			Depth--;
+
+			if (Depth >= MAX_DEPTH)
+				return;
+
+			const unsigned int write = Write.load(std::memory_order_relaxed);
+
+			if (write - Read.load(std::memory_order_acquire) >= EVENT_RING_SIZE)
+			{
+				Dropped.store(Dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+				return;
+			}
+
+			Event &event = Events[write & (EVENT_RING_SIZE - 1)];
+			event.Name = Open[Depth].Name;
+			event.Begin = Open[Depth].Begin;
+			event.End = time;
+			event.Depth = Depth;
+			event.ThreadID = ThreadID;
+
+			Write.store(write + 1, std::memory_order_release);
+		}
+
+	public:
+		std::vector<Event> Events;
+		std::atomic<unsigned int> Write;
+		std::atomic<unsigned int> Read;
+		std::atomic<unsigned int> Dropped;
+		std::atomic<const char*> Name;
+		unsigned int ThreadID;
+
+	private:
+		struct OpenScope
+		{
+		public:
+			const char *Name;
+			long long Begin;
+		};
+
+		// only touched by the thread of the buffer
+		OpenScope Open[MAX_DEPTH];
+		unsigned int Depth;
+	};
+
+	struct Sample
+	{
+	public:
+		Sample(void) :
+			Time(0),
+			Calls(0)
+		{
+		}
+
+		unsigned long long Time;
+		unsigned int Calls;
+	};
+
+	struct Marker
+	{
+	public:
+		const char *Name;
+		unsigned int FirstFrame;
+
+		// of the current frame
+		long long Time;
+		unsigned int Calls;
+
+		std::vector<Sample> History;
+	};
+
+	struct Counter
+	{
+	public:
+		std::string Name;
+		unsigned int FirstFrame;
+
+		double Value;
+
+		std::vector<double> History;
+	};
+
+	struct CounterSample
+	{
+	public:
+		unsigned int Counter;
+		long long Time;
+		double Value;
+	};
+
+	typedef std::vector<ThreadBuffer*> ThreadBuffersList;
+	typedef std::vector<Marker> MarkersList;
+	typedef std::map<const char*, unsigned int> MarkerPointersMap;
+	typedef std::map<std::string, unsigned int> MarkerNamesMap;
+	typedef std::vector<Counter> CountersList;
+
+public:
+	struct MarkerStatistics
+	{
+	public:
+		const char *Name;
+
+		//Milliseconds in a frame, of the frames since the marker was first seen
+		double Minimum;
+		double Average;
+		double Percentile99;
+		double Maximum;
+
+		//Calls in a frame
+		double Calls;
+	};
+
+	typedef std::vector<MarkerStatistics> MarkerStatisticsList;
+
+	struct CounterStatistics
+	{
+	public:
+		const char *Name;
+
+		//Of the values at the ends of the frames since the counter was first set
+		double Minimum;
+		double Average;
+		double Maximum;
+
+		double Last;
+	};
+
+	typedef std::vector<CounterStatistics> CounterStatisticsList;
+
+	//Marks a scope, use PROFILE_SCOPE
+	class Scope
+	{
+	public:
+		Scope(const char *Name) :
+			m_Buffer(Profiler::GetThreadBuffer())
+		{
+			m_Buffer.Begin(Name);
+		}
+
+		~Scope(void)
+		{
+			m_Buffer.End();
+		}
+
+	private:
+		Scope(const Scope &Other);
+		void operator =(const Scope &Other);
+
+	private:
+		ThreadBuffer &m_Buffer;
+	};
+
+public:
+	Profiler(void) :
+		m_Origin(GetTime()),
+		m_HistorySize(300),
+		m_FrameCount(0),
+		m_FrameOpen(false),
+		m_Attached(false),
+		m_TraceSize(65536),
+		m_TraceCount(0),
+		m_CounterTraceCount(0)
+	{
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		m_Frequency = frequency.QuadPart;
+
+		m_Trace.resize(m_TraceSize);
+		m_CounterTrace.resize(m_TraceSize);
+	}
+
+	~Profiler(void)
+	{
+		for (unsigned int i = 0; i < m_Buffers.size(); i++)
+			delete m_Buffers[i];
+	}
+
+	//Has to be called first on the main thread, before other threads are profiled.
+	//The markers of the scripts and the plugins go to the Profiler of the executable
+	DECLARE_SHARED_SINGLETON(Profiler)
+
+public:
+	//Frames begin and end with the frames of Core
+	void Attach(void)
+	{
+		if (m_Attached)
+			return;
+
+		Core::GetReference().AddListener(this);
+		m_Attached = true;
+	}
+
+	void Detach(void)
+	{
+		if (!m_Attached)
+			return;
+
+		Core::GetReference().RemoveListener(this);
+		m_Attached = false;
+
+		EndFrame();
+	}
+
+	//Ends the current frame if there's one and begins the next one, on the main thread.
+	//Only needed without Attach
+	void BeginFrame(void)
+	{
+		EndFrame();
+
+		GetThreadBuffer().Begin("Frame");
+		m_FrameOpen = true;
+	}
+
+	void EndFrame(void)
+	{
+		if (!m_FrameOpen)
+			return;
+
+		GetThreadBuffer().End();
+		m_FrameOpen = false;
+
+		Collect();
+
+		const unsigned int slot = m_FrameCount % m_HistorySize;
+
+		for (unsigned int i = 0; i < m_Markers.size(); i++)
+		{
+			Marker &marker = m_Markers[i];
+
+			marker.History[slot].Time = ToNanoseconds(marker.Time);
+			marker.History[slot].Calls = marker.Calls;
+
+			marker.Time = 0;
+			marker.Calls = 0;
+		}
+
+		const long long time = GetTime();
+
+		for (unsigned int i = 0; i < m_Counters.size(); i++)
+		{
+			m_Counters[i].History[slot] = m_Counters[i].Value;
+
+			CounterSample &sample = m_CounterTrace[m_CounterTraceCount % m_TraceSize];
+			sample.Counter = i;
+			sample.Time = time;
+			sample.Value = m_Counters[i].Value;
+
+			m_CounterTraceCount++;
+		}
+
+		m_FrameCount++;
+	}
+
+	void SetThreadName(const char *Name)
+	{
+		GetThreadBuffer().Name.store(Name, std::memory_order_relaxed);
+	}
+
+	//Keeps its value until it's set again, use PROFILE_COUNTER
+	void SetCounter(const char *Name, const double &Value)
+	{
+		GetCounter(Name).Value = Value;
+	}
+
+	//Frames the statistics are taken of, the statistics so far are dropped
+	void SetHistorySize(const unsigned int &Value)
+	{
+		m_HistorySize = (Value ? Value : 1);
+
+		for (unsigned int i = 0; i < m_Markers.size(); i++)
+		{
+			m_Markers[i].History.assign(m_HistorySize, Sample());
+			m_Markers[i].FirstFrame = m_FrameCount;
+		}
+
+		for (unsigned int i = 0; i < m_Counters.size(); i++)
+		{
+			m_Counters[i].History.assign(m_HistorySize, 0.0);
+			m_Counters[i].FirstFrame = m_FrameCount;
+		}
+	}
+
+	const unsigned int &GetHistorySize(void) const
+	{
+		return m_HistorySize;
+	}
+
+	//Scopes kept for the trace, the trace so far is dropped
+	void SetTraceSize(const unsigned int &Value)
+	{
+		m_TraceSize = (Value ? Value : 1);
+		m_TraceCount = 0;
+		m_CounterTraceCount = 0;
+
+		m_Trace.clear();
+		m_Trace.resize(m_TraceSize);
+
+		m_CounterTrace.clear();
+		m_CounterTrace.resize(m_TraceSize);
+	}
+
+	const unsigned int &GetTraceSize(void) const
+	{
+		return m_TraceSize;
+	}
+
+	const unsigned int &GetFrameCount(void) const
+	{
+		return m_FrameCount;
+	}
+
+	//Scopes which didn't fit in the ring of their thread, it's collected once a frame
+	unsigned int GetDroppedCount(void)
+	{
+		std::lock_guard<std::mutex> lock(m_BuffersLock);
+
+		unsigned int count = 0;
+
+		for (unsigned int i = 0; i < m_Buffers.size(); i++)
+			count += m_Buffers[i]->Dropped.load(std::memory_order_relaxed);
+
+		return count;
+	}
+
+	void GetStatistics(MarkerStatisticsList &Statistics)
+	{
+		Statistics.clear();
+
+		for (unsigned int i = 0; i < m_Markers.size(); i++)
+		{
+			MarkerStatistics statistics;
+
+			if (GetStatistics(m_Markers[i], statistics))
+				Statistics.push_back(statistics);
+		}
+	}
+
+	//Returns false if Name hasn't been in a whole frame yet
+	bool GetStatistics(const char *Name, MarkerStatistics &Statistics)
+	{
+		MarkerNamesMap::iterator it = m_MarkerNames.find(Name);
+
+		if (it == m_MarkerNames.end())
+			return false;
+
+		return GetStatistics(m_Markers[it->second], Statistics);
+	}
+
+	void GetCounterStatistics(CounterStatisticsList &Statistics)
+	{
+		Statistics.clear();
+
+		for (unsigned int i = 0; i < m_Counters.size(); i++)
+		{
+			CounterStatistics statistics;
+
+			if (GetCounterStatistics(m_Counters[i], statistics))
+				Statistics.push_back(statistics);
+		}
+	}
+
+	//Returns false if Name hasn't been set in a whole frame yet
+	bool GetCounterStatistics(const char *Name, CounterStatistics &Statistics)
+	{
+		MarkerNamesMap::iterator it = m_CounterNames.find(Name);
+
+		if (it == m_CounterNames.end())
+			return false;
+
+		return GetCounterStatistics(m_Counters[it->second], Statistics);
+	}
+
+	//The scopes of the last frames as Chrome trace_event JSON, for chrome://tracing
+	void WriteTrace(std::string &Json)
+	{
+		Json.clear();
+		Json.reserve(64 + (m_TraceCount < m_TraceSize ? m_TraceCount : m_TraceSize) * 96);
+
+		Json += "{\"traceEvents\":[";
+
+		bool first = true;
+		// the longest is an event, two 20 digit times and a thread ID
+		char number[128];
+
+		{
+			std::lock_guard<std::mutex> lock(m_BuffersLock);
+
+			for (unsigned int i = 0; i < m_Buffers.size(); i++)
+			{
+				const char *name = m_Buffers[i]->Name.load(std::memory_order_relaxed);
+
+				if (!name)
+					continue;
+
+				Json += (first ? "\n" : ",\n");
+				first = false;
+
+				sprintf_s(number, sizeof(number), "%u", m_Buffers[i]->ThreadID);
+
+				Json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":";
+				Json += number;
+				Json += ",\"args\":{\"name\":\"";
+				AppendEscaped(Json, name);
+				Json += "\"}}";
+			}
+		}
+
+		const unsigned int count = (m_TraceCount < m_TraceSize ? m_TraceCount : m_TraceSize);
+
+		for (unsigned int i = m_TraceCount - count; i != m_TraceCount; i++)
+		{
+			const Event &event = m_Trace[i % m_TraceSize];
+
+			Json += (first ? "\n" : ",\n");
+			first = false;
+
+			Json += "{\"name\":\"";
+			AppendEscaped(Json, event.Name);
+			Json += "\",\"cat\":\"IE2D\",\"ph\":\"X\",\"pid\":0,\"tid\":";
+
+			// microseconds with nanosecond digits
+			const unsigned long long begin = ToNanoseconds(event.Begin - m_Origin);
+			const unsigned long long duration = ToNanoseconds(event.End - event.Begin);
+
+			sprintf_s(number, sizeof(number), "%u,\"ts\":%llu.%03u,\"dur\":%llu.%03u}", event.ThreadID, begin / 1000, (unsigned int)(begin % 1000), duration / 1000, (unsigned int)(duration % 1000));
+			Json += number;
+		}
+
+		const unsigned int counterCount = (m_CounterTraceCount < m_TraceSize ? m_CounterTraceCount : m_TraceSize);
+
+		for (unsigned int i = m_CounterTraceCount - counterCount; i != m_CounterTraceCount; i++)
+		{
+			const CounterSample &sample = m_CounterTrace[i % m_TraceSize];
+
+			Json += (first ? "\n" : ",\n");
+			first = false;
+
+			Json += "{\"name\":\"";
+			AppendEscaped(Json, m_Counters[sample.Counter].Name.c_str());
+			Json += "\",\"cat\":\"IE2D\",\"ph\":\"C\",\"pid\":0,\"tid\":0,";
+
+			const unsigned long long time = ToNanoseconds(sample.Time - m_Origin);
+
+			sprintf_s(number, sizeof(number), "\"ts\":%llu.%03u,\"args\":{\"value\":%.17g}}", time / 1000, (unsigned int)(time % 1000), sample.Value);
+			Json += number;
+		}
+
+		Json += "\n],\"displayTimeUnit\":\"ns\"}";
+	}
+
+	bool SaveTrace(const String &FilePath)
+	{
+		IFile *file = FileIO::GetReference().OpenFile(FilePath, false);
+
+		if (!file)
+			return false;
+
+		std::string json;
+		WriteTrace(json);
+
+		*file << String(json.c_str(), (int)json.size());
+
+		file->Close();
+		delete file;
+
+		return true;
+	}
+
+private:
+	static long long GetTime(void)
+	{
+		LARGE_INTEGER time;
+		QueryPerformanceCounter(&time);
+
+		return time.QuadPart;
+	}
+
+	static ThreadBuffer &GetThreadBuffer(void)
+	{
+		static THREAD_LOCAL ThreadBuffer *buffer = NULL;
+
+		if (!buffer)
+			buffer = GetReference().AddThreadBuffer();
+
+		return *buffer;
+	}
+
+	ThreadBuffer *AddThreadBuffer(void)
+	{
+		ThreadBuffer *buffer = new ThreadBuffer;
+
+		std::lock_guard<std::mutex> lock(m_BuffersLock);
+		m_Buffers.push_back(buffer);
+
+		return buffer;
+	}
+
+	// without overflowing for days of counter ticks
+	unsigned long long ToNanoseconds(const long long &Ticks) const
+	{
+		if (Ticks <= 0)
+			return 0;
+
+		return (Ticks / m_Frequency) * 1000000000ull + (Ticks % m_Frequency) * 1000000000ull / m_Frequency;
+	}
+
+	//Takes the finished scopes of all threads into the current frame and the trace
+	void Collect(void)
+	{
+		std::lock_guard<std::mutex> lock(m_BuffersLock);
+
+		for (unsigned int i = 0; i < m_Buffers.size(); i++)
+		{
+			ThreadBuffer &buffer = *m_Buffers[i];
+
+			const unsigned int end = buffer.Write.load(std::memory_order_acquire);
+			unsigned int read = buffer.Read.load(std::memory_order_relaxed);
+
+			for (; read != end; read++)
+			{
+				const Event &event = buffer.Events[read & (EVENT_RING_SIZE - 1)];
+
+				Marker &marker = GetMarker(event.Name);
+				marker.Time += event.End - event.Begin;
+				marker.Calls++;
+
+				m_Trace[m_TraceCount % m_TraceSize] = event;
+				m_TraceCount++;
+			}
+
+			buffer.Read.store(read, std::memory_order_release);
+		}
+	}
+
+	//Names are looked up by pointer first, the same literal can have a different address in every module
+	Marker &GetMarker(const char *Name)
+	{
+		MarkerPointersMap::iterator it = m_MarkerPointers.find(Name);
+
+		if (it != m_MarkerPointers.end())
+			return m_Markers[it->second];
+
+		unsigned int index = 0;
+		MarkerNamesMap::iterator nameIt = m_MarkerNames.find(Name);
+
+		if (nameIt != m_MarkerNames.end())
+			index = nameIt->second;
+		else
+		{
+			index = (unsigned int)m_Markers.size();
+
+			m_Markers.push_back(Marker());
+
+			Marker &marker = m_Markers.back();
+			marker.Name = Name;
+			marker.FirstFrame = m_FrameCount;
+			marker.Time = 0;
+			marker.Calls = 0;
+			marker.History.resize(m_HistorySize);
+
+			m_MarkerNames[Name] = index;
+		}
+
+		m_MarkerPointers[Name] = index;
+
+		return m_Markers[index];
+	}
+
+	Counter &GetCounter(const char *Name)
+	{
+		MarkerPointersMap::iterator it = m_CounterPointers.find(Name);
+
+		if (it != m_CounterPointers.end() && m_Counters[it->second].Name == Name)
+			return m_Counters[it->second];
+
+		unsigned int index = 0;
+		MarkerNamesMap::iterator nameIt = m_CounterNames.find(Name);
+
+		if (nameIt != m_CounterNames.end())
+			index = nameIt->second;
+		else
+		{
+			index = (unsigned int)m_Counters.size();
+
+			m_Counters.push_back(Counter());
+
+			Counter &counter = m_Counters.back();
+			counter.Name = Name;
+			counter.FirstFrame = m_FrameCount;
+			counter.Value = 0.0;
+			counter.History.resize(m_HistorySize);
+
+			m_CounterNames[Name] = index;
+		}
+
+		m_CounterPointers[Name] = index;
+
+		return m_Counters[index];
+	}
+
+	bool GetCounterStatistics(const Counter &Entry, CounterStatistics &Statistics)
+	{
+		unsigned int frames = m_FrameCount - Entry.FirstFrame;
+
+		if (!frames)
+			return false;
+
+		if (frames > m_HistorySize)
+			frames = m_HistorySize;
+
+		double total = 0.0;
+
+		Statistics.Name = Entry.Name.c_str();
+		Statistics.Last = Entry.History[(m_FrameCount - 1) % m_HistorySize];
+		Statistics.Minimum = Statistics.Last;
+		Statistics.Maximum = Statistics.Last;
+
+		for (unsigned int i = 0; i < frames; i++)
+		{
+			const double value = Entry.History[(m_FrameCount - 1 - i) % m_HistorySize];
+
+			total += value;
+
+			if (value < Statistics.Minimum)
+				Statistics.Minimum = value;
+
+			if (value > Statistics.Maximum)
+				Statistics.Maximum = value;
+		}
+
+		Statistics.Average = total / frames;
+
+		return true;
+	}
+
+	bool GetStatistics(const Marker &Entry, MarkerStatistics &Statistics)
+	{
+		unsigned int frames = m_FrameCount - Entry.FirstFrame;
+
+		if (!frames)
+			return false;
+
+		if (frames > m_HistorySize)
+			frames = m_HistorySize;
+
+		m_Times.resize(frames);
+
+		unsigned long long total = 0;
+		unsigned long long calls = 0;
+
+		for (unsigned int i = 0; i < frames; i++)
+		{
+			const Sample &sample = Entry.History[(m_FrameCount - 1 - i) % m_HistorySize];
+
+			m_Times[i] = sample.Time;
+			total += sample.Time;
+			calls += sample.Calls;
+		}
+
+		// nearest rank
+		const unsigned int rank = (frames * 99 + 99) / 100 - 1;
+		std::nth_element(m_Times.begin(), m_Times.begin() + rank, m_Times.end());
+		const unsigned long long percentile = m_Times[rank];
+
+		Statistics.Name = Entry.Name;
+		Statistics.Minimum = *std::min_element(m_Times.begin(), m_Times.end()) / 1000000.0;
+		Statistics.Maximum = *std::max_element(m_Times.begin(), m_Times.end()) / 1000000.0;
+		Statistics.Average = (double)total / frames / 1000000.0;
+		Statistics.Percentile99 = percentile / 1000000.0;
+		Statistics.Calls = (double)calls / frames;
+
+		return true;
+	}
+
+	static void AppendEscaped(std::string &Json, const char *Text)
+	{
+		for (; *Text; Text++)
+		{
+			const unsigned char c = *Text;
+
+			if (c == '"' || c == '\\')
+			{
+				Json += '\\';
+				Json += c;
+			}
+			else if (c < ' ')
+			{
+				char code[8];
+				sprintf_s(code, sizeof(code), "\\u%04x", c);
+				Json += code;
+			}
+			else
+				Json += c;
+		}
+	}
+
+	void OnBeforeSceneRemoved(IScene *Scene)
+	{
+	}
+
+	void OnSceneAdded(IScene *Scene)
+	{
+	}
+
+	void OnSetCurrentScene(IScene *Scene)
+	{
+	}
+
+	void OnBeforeUpdate(void)
+	{
+		BeginFrame();
+
+		GetThreadBuffer().Begin("Update");
+	}
+
+	void OnAfterUpdate(void)
+	{
+		GetThreadBuffer().End();
+	}
+
+	void OnBeforeRender(void)
+	{
+		GetThreadBuffer().Begin("Render");
+	}
+
+	void OnAfterRender(void)
+	{
+		GetThreadBuffer().End();
+	}
+
+private:
+	Profiler(const Profiler &Other);
+	void operator =(const Profiler &Other);
+
+private:
+	std::mutex m_BuffersLock;
+	ThreadBuffersList m_Buffers;
+
+	long long m_Frequency;
+	long long m_Origin;
+
+	MarkersList m_Markers;
+	MarkerPointersMap m_MarkerPointers;
+	MarkerNamesMap m_MarkerNames;
+	unsigned int m_HistorySize;
+	unsigned int m_FrameCount;
+	bool m_FrameOpen;
+	bool m_Attached;
+
+	std::vector<Event> m_Trace;
+	unsigned int m_TraceSize;
+	unsigned int m_TraceCount;
+
+	CountersList m_Counters;
+	MarkerPointersMap m_CounterPointers;
+	MarkerNamesMap m_CounterNames;
+
+	std::vector<CounterSample> m_CounterTrace;
+	unsigned int m_CounterTraceCount;
+
+	// scratch of GetStatistics
+	std::vector<unsigned long long> m_Times;
+};
+
+END_NAMESPACE
+
+#else
+
+#define PROFILE_SCOPE(Name)
+#define PROFILE_FUNCTION()
+#define PROFILE_THREAD_NAME(Name)
+#define PROFILE_COUNTER(Name, Value)
+
+#endif
\ No newline at end of file
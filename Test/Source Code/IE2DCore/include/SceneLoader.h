@@ -0,0 +1,644 @@
+///////////////////////////////////////////////////////////////////////////////////
+///
+///  Impressive Engine 2D
+///
+/// Copyright (c) 2012-2013 Impressive Reality team
+///
+/// The license is
+///
+/// Permission is denied, to any person or company
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Project leader : O.Shahbazi <sh_omid_m@yahoo.com>
+///////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Common.h"
+#include "Core.h"
+#include "FileIO.h"
+#include "StreamTreeParser.h"
+#include "IScene.h"
+#include "IThread.h"
+#include "IThreadWorker.h"
+#include "ThreadManager.h"
+#include "Profiler.h"
+#include "Renderer\IRenderEngine.h"
+#include <Windows.h>
+#include <atomic>
+#include <mutex>
+#include <deque>
+#include <set>
+#include <string>
+#include <vector>
+
+BEGIN_NAMESPACE
+
+//<Description>
+//Loads scenes in stages so a level can load behind a loading screen without dropping frames.
+//On the loading threads the scene file is read and decrypted, the textures, animation sets and
+//materials it names are found and their files read through in parallel, so they come from the
+//system cache afterwards. On the main thread the assets are created a few at a time within the
+//frame budget, then Core loads the scene asynchronously, which finds its assets already in the
+//renderer, and the scene is made current when it's loaded.
+//Only the creation of the assets is time-sliced. Core::CreateScene takes a file name, not a
+//parsed tree, so it reads, decrypts and parses the scene file again; the loading threads only
+//stream through the text for the names and build no tree.
+//Listeners are told about the progress every frame
+class SceneLoader : public Core::IListener
+{
+public:
+	enum LoadStage
+	{
+		LS_PARSING = 0,
+		LS_READING_ASSETS,
+		LS_CREATING_ASSETS,
+		LS_LOADING_SCENE,
+		LS_DONE,
+		LS_FAILED
+	};
+
+	//<Description>
+	//Notified on the main thread
+	class ILoadListener
+	{
+	public:
+		//Progress is from 0 to 1
+		virtual void OnSceneLoadProgress(const String &FileName, const LoadStage &Stage, const float &Progress) = 0;
+
+		virtual void OnSceneLoaded(const String &FileName, IScene *Scene) = 0;
+
+		virtual void OnSceneLoadFailed(const String &FileName) = 0;
+	};
+
+private:
+	enum AssetType
+	{
+		AT_TEXTURE = 0,
+		AT_ANIMATION_SET,
+		AT_MATERIAL,
+		AT_COUNT
+	};
+
+	struct Asset
+	{
+	public:
+		AssetType Type;
+		std::string Name;
+	};
+
+	typedef std::vector<Asset> AssetsList;
+
+	struct Load
+	{
+	public:
+		Load(void) :
+			Stage(LS_PARSING),
+			ReadCount(0),
+			NameCount(0),
+			CreateCount(0),
+			Scene(NULL),
+			LastProgress(-1.0f)
+		{
+		}
+
+		String FileName;
+		std::string FilePath;
+		bool SetCurrent;
+
+		std::atomic<int> Stage;
+
+		//Names in the scene file which might be assets, read to find out
+		std::vector<std::string> Names;
+		std::atomic<unsigned int> ReadCount;
+		unsigned int NameCount;
+
+		//Found while reading, filled in before the stage is LS_CREATING_ASSETS
+		std::mutex AssetsLock;
+		AssetsList Assets;
+		unsigned int CreateCount;
+
+		IScene *Scene;
+		float LastProgress;
+	};
+
+	struct Task
+	{
+	public:
+		Load *Owner;
+
+		//Of the name to read, INVALID to parse the scene file
+		unsigned int Name;
+	};
+
+	class Worker : public IThreadWorker
+	{
+	public:
+		Worker(SceneLoader *Owner) :
+			Loader(Owner),
+			Thread(NULL)
+		{
+		}
+
+		void Do(void)
+		{
+			PROFILE_THREAD_NAME("SceneLoader")
+
+			Loader->Work();
+		}
+
+	public:
+		SceneLoader *Loader;
+		IThread *Thread;
+	};
+
+	typedef std::vector<Worker*> WorkersList;
+	typedef std::vector<Load*> LoadsList;
+	typedef std::deque<Task> TasksList;
+	typedef Vector<ILoadListener*> ILoadListenersList;
+
+	static const unsigned int INVALID = 0xFFFFFFFF;
+
+public:
+	SceneLoader(void) :
+		m_Running(false),
+		m_FrameBudget(4.0f)
+	{
+		m_WakeEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		m_Frequency = frequency.QuadPart;
+	}
+
+	~SceneLoader(void)
+	{
+		Stop();
+
+		CloseHandle(m_WakeEvent);
+	}
+
+	static SceneLoader &GetReference(void)
+	{
+		static SceneLoader instance;
+
+		return instance;
+	}
+
+	//Starts the loading threads and steps the loads in the frames of Core
+	void Start(const unsigned int &ThreadCount = 2)
+	{
+		if (m_Workers.size())
+			return;
+
+		Core &core = Core::GetReference();
+		m_Paths[AT_TEXTURE] = core.GetTexturePath().GetBuffer();
+		m_Paths[AT_ANIMATION_SET] = core.GetAnimationPath().GetBuffer();
+		m_Paths[AT_MATERIAL] = core.GetMaterialPath().GetBuffer();
+
+		m_Running.store(true, std::memory_order_release);
+
+		for (unsigned int i = 0; i < (ThreadCount ? ThreadCount : 1); i++)
+		{
+			Worker *worker = new Worker(this);
+			worker->Thread = ThreadManager::GetReference().CreateThread(worker);
+
+			m_Workers.push_back(worker);
+		}
+
+		core.AddListener(this);
+	}
+
+	//Loads which aren't done are dropped
+	void Stop(void)
+	{
+		if (!m_Workers.size())
+			return;
+
+		Core::GetReference().RemoveListener(this);
+
+		{
+			std::lock_guard<std::mutex> lock(m_TasksLock);
+
+			m_Running.store(false, std::memory_order_release);
+			m_Tasks.clear();
+			SetEvent(m_WakeEvent);
+		}
+
+		for (unsigned int i = 0; i < m_Workers.size(); i++)
+		{
+			m_Workers[i]->Thread->Join();
+			ThreadManager::GetReference().DestroyThread(m_Workers[i]->Thread);
+
+			delete m_Workers[i];
+		}
+
+		m_Workers.clear();
+
+		for (unsigned int i = 0; i < m_Loads.size(); i++)
+			delete m_Loads[i];
+
+		m_Loads.clear();
+	}
+
+	//FileName is like for Core::CreateScene, the scene is made current when it's loaded if SetCurrent
+	void LoadScene(const String &FileName, const bool &SetCurrent = true)
+	{
+		Load *load = new Load;
+		load->FileName = FileName;
+		load->FilePath = (Core::GetReference().GetScenePath() + FileName).GetBuffer();
+		load->SetCurrent = SetCurrent;
+
+		m_Loads.push_back(load);
+
+		Task task;
+		task.Owner = load;
+		task.Name = INVALID;
+
+		AddTask(task);
+	}
+
+	bool IsLoading(void) const
+	{
+		return (m_Loads.size() != 0);
+	}
+
+	//Milliseconds of a frame the main thread part of the loads can take
+	void SetFrameBudget(const float &Milliseconds)
+	{
+		m_FrameBudget = Milliseconds;
+	}
+
+	const float &GetFrameBudget(void) const
+	{
+		return m_FrameBudget;
+	}
+
+	void AddListener(ILoadListener *Listener)
+	{
+		m_Listeners.Add(Listener);
+	}
+
+	void RemoveListener(ILoadListener *Listener)
+	{
+		for (unsigned int i = 0; i < m_Listeners.GetSize(); i++)
+			if (m_Listeners[i] == Listener)
+			{
+				m_Listeners.Remove(i);
+				return;
+			}
+	}
+
+private:
+	void AddTask(const Task &Task)
+	{
+		std::lock_guard<std::mutex> lock(m_TasksLock);
+
+		m_Tasks.push_back(Task);
+		SetEvent(m_WakeEvent);
+	}
+
+	void Work(void)
+	{
+		while (true)
+		{
+			WaitForSingleObject(m_WakeEvent, INFINITE);
+
+			Task task;
+
+			{
+				std::lock_guard<std::mutex> lock(m_TasksLock);
+
+				if (!m_Running.load(std::memory_order_acquire))
+					break;
+
+				if (!m_Tasks.size())
+				{
+					ResetEvent(m_WakeEvent);
+					continue;
+				}
+
+				task = m_Tasks.front();
+				m_Tasks.pop_front();
+			}
+
+			if (task.Name == INVALID)
+				Parse(*task.Owner);
+			else
+				Read(*task.Owner, task.Name);
+		}
+	}
+
+	//Loading thread: finds the names in the scene file and queues them to be read
+	void Parse(Load &Load)
+	{
+		PROFILE_SCOPE("SceneLoader::Parse")
+
+		StreamTreeParser parser(FileIO::GetReference().ReadText(FileIO::FT_SCENE, Load.FilePath.c_str()));
+
+		std::set<std::string> names;
+		bool hasElement = false;
+
+		for (StreamTreeParser::EventType event = parser.Next(); event != StreamTreeParser::ET_END; event = parser.Next())
+		{
+			if (event == StreamTreeParser::ET_ERROR)
+			{
+				Load.Stage.store(LS_FAILED, std::memory_order_release);
+				return;
+			}
+
+			if (event == StreamTreeParser::ET_ENTER)
+				hasElement = true;
+			else if (event == StreamTreeParser::ET_ATTRIBUTE || event == StreamTreeParser::ET_VALUE)
+				AddName(parser.GetValue(), names);
+		}
+
+		// a missing file reads as no text
+		if (!hasElement)
+		{
+			Load.Stage.store(LS_FAILED, std::memory_order_release);
+			return;
+		}
+
+		Load.Names.assign(names.begin(), names.end());
+
+		Load.NameCount = (unsigned int)Load.Names.size();
+
+		if (!Load.NameCount)
+		{
+			Load.Stage.store(LS_CREATING_ASSETS, std::memory_order_release);
+			return;
+		}
+
+		Load.Stage.store(LS_READING_ASSETS, std::memory_order_release);
+
+		std::lock_guard<std::mutex> lock(m_TasksLock);
+
+		for (unsigned int i = 0; i < Load.NameCount; i++)
+		{
+			Task task;
+			task.Owner = &Load;
+			task.Name = i;
+
+			m_Tasks.push_back(task);
+		}
+
+		SetEvent(m_WakeEvent);
+	}
+
+	//Values which look like file names, with a short extension of letters
+	static void AddName(const StringView &Value, std::set<std::string> &Names)
+	{
+		if (!IsFileName(Value))
+			return;
+
+		// only values with entities are decoded, the rest are copied from the text
+		if (memchr(Value.Data, '&', Value.Length))
+			Names.insert(StreamTreeParser::Decode(Value).GetBuffer());
+		else
+			Names.insert(std::string(Value.Data, Value.Length));
+	}
+
+	static bool IsFileName(const StringView &Value)
+	{
+		const char *end = Value.Data + Value.Length;
+		const char *dot = end;
+
+		while (dot != Value.Data && *(dot - 1) != '.')
+			dot--;
+
+		if (dot == Value.Data || dot - 1 == Value.Data || end - dot < 2 || end - dot > 4)
+			return false;
+
+		for (const char *c = dot; c != end; c++)
+			if (!((*c >= 'a' && *c <= 'z') || (*c >= 'A' && *c <= 'Z')))
+				return false;
+
+		return true;
+	}
+
+	//Loading thread: reads the file of a name through if it's under one of the asset directories
+	void Read(Load &Load, const unsigned int &Index)
+	{
+		PROFILE_SCOPE("SceneLoader::Read")
+
+		const std::string &name = Load.Names[Index];
+		const unsigned int count = Load.NameCount;
+
+		for (unsigned int type = 0; type < AT_COUNT; type++)
+		{
+			HANDLE file = CreateFileA((m_Paths[type] + name).c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+			if (file == INVALID_HANDLE_VALUE)
+				continue;
+
+			char buffer[64 * 1024];
+			DWORD read;
+
+			while (ReadFile(file, buffer, sizeof(buffer), &read, NULL) && read)
+				;
+
+			CloseHandle(file);
+
+			Asset asset;
+			asset.Type = (AssetType)type;
+			asset.Name = name;
+
+			std::lock_guard<std::mutex> lock(Load.AssetsLock);
+			Load.Assets.push_back(asset);
+
+			break;
+		}
+
+		// the last one hands the load to the main thread, which can free it right away
+		if (Load.ReadCount.fetch_add(1, std::memory_order_acq_rel) + 1 == count)
+			Load.Stage.store(LS_CREATING_ASSETS, std::memory_order_release);
+	}
+
+	//Main thread: creates one asset in the renderer, which keeps it for the scene
+	void Create(const Asset &Asset)
+	{
+		IRenderEngine *renderer = Core::GetReference().GetRenderer();
+
+		if (!renderer)
+			return;
+
+		const String name = Asset.Name.c_str();
+
+		if (Asset.Type == AT_TEXTURE)
+			renderer->LoadTexture(name);
+		else if (Asset.Type == AT_ANIMATION_SET)
+			renderer->LoadAnimationSet(name);
+		else
+			renderer->LoadMaterial(name);
+	}
+
+	long long GetTime(void) const
+	{
+		LARGE_INTEGER time;
+		QueryPerformanceCounter(&time);
+
+		return time.QuadPart;
+	}
+
+	//Main thread: moves the loads on until the frame budget is used up
+	void Step(void)
+	{
+		PROFILE_SCOPE("SceneLoader::Step")
+
+		const long long end = GetTime() + (long long)(m_FrameBudget * m_Frequency / 1000.0f);
+
+		for (unsigned int i = 0; i < m_Loads.size();)
+		{
+			Load &load = *m_Loads[i];
+
+			if (load.Stage.load(std::memory_order_acquire) == LS_CREATING_ASSETS)
+			{
+				// the reads are done, the list doesn't change anymore
+				while (load.CreateCount < load.Assets.size() && GetTime() < end)
+					Create(load.Assets[load.CreateCount++]);
+
+				if (load.CreateCount == load.Assets.size())
+				{
+					load.Scene = Core::GetReference().CreateScene(load.FileName, false, false);
+					load.Stage.store((load.Scene ? LS_LOADING_SCENE : LS_FAILED), std::memory_order_relaxed);
+				}
+			}
+
+			const int stage = load.Stage.load(std::memory_order_acquire);
+
+			if (stage == LS_LOADING_SCENE && load.Scene->GetLoaded())
+			{
+				if (load.SetCurrent)
+					Core::GetReference().SetCurrentScene(load.Scene);
+
+				load.Stage.store(LS_DONE, std::memory_order_relaxed);
+			}
+
+			if (!Finish(load))
+			{
+				i++;
+				continue;
+			}
+
+			delete m_Loads[i];
+			m_Loads.erase(m_Loads.begin() + i);
+		}
+	}
+
+	//Tells the listeners about a load, returns true if it's over
+	bool Finish(Load &Load)
+	{
+		const int stage = Load.Stage.load(std::memory_order_acquire);
+
+		if (stage == LS_FAILED)
+		{
+			LOG_ERROR("Couldn't load the scene [" + Load.FileName + "]")
+
+			for (unsigned int i = 0; i < m_Listeners.GetSize(); i++)
+				m_Listeners[i]->OnSceneLoadFailed(Load.FileName);
+
+			return true;
+		}
+
+		const float progress = GetProgress(Load);
+
+		if (progress != Load.LastProgress)
+		{
+			Load.LastProgress = progress;
+
+			for (unsigned int i = 0; i < m_Listeners.GetSize(); i++)
+				m_Listeners[i]->OnSceneLoadProgress(Load.FileName, (LoadStage)stage, progress);
+		}
+
+		if (stage != LS_DONE)
+			return false;
+
+		for (unsigned int i = 0; i < m_Listeners.GetSize(); i++)
+			m_Listeners[i]->OnSceneLoaded(Load.FileName, Load.Scene);
+
+		return true;
+	}
+
+	//Parsing is the first tenth, reading and creating the assets four tenths each, the scene the last tenth
+	float GetProgress(Load &Load) const
+	{
+		switch (Load.Stage.load(std::memory_order_acquire))
+		{
+		case LS_PARSING:
+			return 0.0f;
+
+		case LS_READING_ASSETS:
+			return 0.1f + 0.4f * Load.ReadCount.load(std::memory_order_relaxed) / Load.NameCount;
+
+		case LS_CREATING_ASSETS:
+			return 0.5f + (Load.Assets.size() ? 0.4f * Load.CreateCount / Load.Assets.size() : 0.4f);
+
+		case LS_LOADING_SCENE:
+			return 0.9f;
+
+		default:
+			return 1.0f;
+		}
+	}
+
+	void OnBeforeSceneRemoved(IScene *Scene)
+	{
+		for (unsigned int i = 0; i < m_Loads.size(); i++)
+			if (m_Loads[i]->Scene == Scene)
+			{
+				m_Loads[i]->Scene = NULL;
+				m_Loads[i]->Stage.store(LS_FAILED, std::memory_order_relaxed);
+			}
+	}
+
+	void OnSceneAdded(IScene *Scene)
+	{
+	}
+
+	void OnSetCurrentScene(IScene *Scene)
+	{
+	}
+
+	void OnBeforeUpdate(void)
+	{
+		if (m_Loads.size())
+			Step();
+	}
+
+	void OnAfterUpdate(void)
+	{
+	}
+
+	void OnBeforeRender(void)
+	{
+	}
+
+	void OnAfterRender(void)
+	{
+	}
+
+private:
+	SceneLoader(const SceneLoader &Other);
+	void operator =(const SceneLoader &Other);
+
+private:
+	WorkersList m_Workers;
+
+	std::mutex m_TasksLock;
+	TasksList m_Tasks;
+	HANDLE m_WakeEvent;
+	std::atomic<bool> m_Running;
+
+	// copied on the main thread, the loading threads only use std::string
+	std::string m_Paths[AT_COUNT];
+
+	LoadsList m_Loads;
+	ILoadListenersList m_Listeners;
+
+	float m_FrameBudget;
+	long long m_Frequency;
+};
+
+END_NAMESPACE
\ No newline at end of file
@@ -38,4 +38,11 @@
 #else
 	#define DLL_DECLARATION
 	//#define EXTERN_TEMPLATE extern
+#endif
+
+
+#ifdef _MSC_VER
+	#define THREAD_LOCAL __declspec(thread)
+#else
+	#define THREAD_LOCAL __thread
 #endif
\ No newline at end of file
@@ -98,4 +98,41 @@
 		return &m_Instance; \
 	} \
 	\
-	Class Class::m_Instance;
\ No newline at end of file
+	Class Class::m_Instance;
+
+
+//The instance the executable exports with EXPORT_SHARED_SINGLETON, or the one of the module
+//if it doesn't. The scripts and the plugins are modules with their own copy of every static,
+//with this they use the instance of the executable, like AsyncLog::GetReference.
+//The header of Class has to include Windows.h
+#define SHARED_SINGLETON_FUNCTION_STRING(Class) "IE2DGetShared" #Class
+
+#define DECLARE_SHARED_SINGLETON(Class) \
+	public: \
+		static Class &GetReference(void) \
+		{ \
+			static Class *volatile instance = NULL; \
+			\
+			if (!instance) \
+			{ \
+				typedef Class *(*GetSharedFunction)(void); \
+				GetSharedFunction function = (GetSharedFunction)GetProcAddress(GetModuleHandleA(NULL), SHARED_SINGLETON_FUNCTION_STRING(Class)); \
+				\
+				instance = (function ? function() : &GetModuleReference()); \
+			} \
+			\
+			return *instance; \
+		} \
+		\
+		static Class &GetModuleReference(void) \
+		{ \
+			static Class instance; \
+			\
+			return instance; \
+		}
+
+//In one source file of the executable, after USING_NAMESPACE
+#define EXPORT_SHARED_SINGLETON(Class) extern "C" __declspec(dllexport) Class *IE2DGetShared##Class(void) \
+	{ \
+		return &Class::GetModuleReference(); \
+	}
\ No newline at end of file
@@ -0,0 +1,286 @@
+///////////////////////////////////////////////////////////////////////////////////
+///
+///  Impressive Engine 2D
+///
+/// Copyright (c) 2012-2013 Impressive Reality team
+///
+/// The license is
+///
+/// Permission is denied, to any person or company
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Project leader : O.Shahbazi <sh_omid_m@yahoo.com>
+///////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Common.h"
+#include "JobPool.h"
+#include "Profiler.h"
+#include <Windows.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <stdio.h>
+
+BEGIN_NAMESPACE
+
+//<Description>
+//Starting up of the game as tasks and the tasks each of them needs, run as a JobGraph on JobPool.
+//Tasks which don't need each other run at the same time, the ones which have to be on the
+//main thread, like Core::Initialize which creates the window and the render device, run on
+//the thread which calls Run. Every task is timed, GetReport shows where the time went.
+//Names have to be string literals, like the names of PROFILE_SCOPE
+class Startup
+{
+public:
+	typedef JobGraph::JobFunction TaskFunction;
+
+	struct TaskTiming
+	{
+	public:
+		const char *Name;
+		unsigned int ThreadID;
+		bool MainThreadOnly;
+
+		//In milliseconds from the start of Run
+		double Start;
+		double Duration;
+	};
+
+	typedef std::vector<TaskTiming> TimelineList;
+
+	static const unsigned int INVALID = JobGraph::INVALID;
+
+private:
+	struct Task
+	{
+	public:
+		const char *Name;
+		TaskFunction Function;
+		void *Data;
+		bool MainThreadOnly;
+
+		long long Start;
+		long long End;
+		unsigned int ThreadID;
+	};
+
+	struct Dependency
+	{
+	public:
+		unsigned int Task;
+		unsigned int DependsOn;
+	};
+
+	typedef std::vector<Task> TasksList;
+	typedef std::vector<Dependency> DependenciesList;
+
+public:
+	Startup(void) :
+		m_Start(0),
+		m_End(0)
+	{
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+
+		m_Frequency = frequency.QuadPart;
+	}
+
+	//Returns the index of the task
+	unsigned int AddTask(const char *Name, TaskFunction Function, void *Data = NULL, const bool &MainThreadOnly = false)
+	{
+		Task task;
+		task.Name = Name;
+		task.Function = Function;
+		task.Data = Data;
+		task.MainThreadOnly = MainThreadOnly;
+		task.Start = 0;
+		task.End = 0;
+		task.ThreadID = 0;
+
+		m_Tasks.push_back(task);
+
+		return (unsigned int)m_Tasks.size() - 1;
+	}
+
+	//Task doesn't start before DependsOn is done, DependsOn has to be added before Task
+	bool AddDependency(const unsigned int &Task, const unsigned int &DependsOn)
+	{
+		if (DependsOn >= Task || Task >= m_Tasks.size())
+			return false;
+
+		Dependency dependency;
+		dependency.Task = Task;
+		dependency.DependsOn = DependsOn;
+
+		m_Dependencies.push_back(dependency);
+
+		return true;
+	}
+
+	//Runs the tasks and waits for them, from the main thread.
+	//Without a started JobPool they run one after another on the calling thread
+	void Run(void)
+	{
+		PROFILE_SCOPE("Startup::Run")
+
+		JobGraph graph;
+
+		for (unsigned int i = 0; i < m_Tasks.size(); i++)
+			graph.AddJob(&RunTask, &m_Tasks[i], m_Tasks[i].MainThreadOnly);
+
+		for (unsigned int i = 0; i < m_Dependencies.size(); i++)
+			graph.AddDependency(m_Dependencies[i].Task, m_Dependencies[i].DependsOn);
+
+		m_Start = GetTime();
+
+		JobPool::GetReference().Run(graph);
+
+		m_End = GetTime();
+	}
+
+	//In milliseconds
+	double GetDuration(void) const
+	{
+		return ToMilliseconds(m_End - m_Start);
+	}
+
+	//The tasks of the last Run in the order they started
+	void GetTimeline(TimelineList &Timeline) const
+	{
+		Timeline.clear();
+
+		for (unsigned int i = 0; i < m_Tasks.size(); i++)
+		{
+			const Task &task = m_Tasks[i];
+
+			TaskTiming timing;
+			timing.Name = task.Name;
+			timing.ThreadID = task.ThreadID;
+			timing.MainThreadOnly = task.MainThreadOnly;
+			timing.Start = ToMilliseconds(task.Start - m_Start);
+			timing.Duration = ToMilliseconds(task.End - task.Start);
+
+			Timeline.push_back(timing);
+		}
+
+		std::stable_sort(Timeline.begin(), Timeline.end(), &IsStartedBefore);
+	}
+
+	//A line for every task with its thread, its start, its time and a bar of when it ran
+	void GetReport(std::string &Report) const
+	{
+		const unsigned int BAR_WIDTH = 40;
+
+		TimelineList timeline;
+		GetTimeline(timeline);
+
+		const double duration = GetDuration();
+		double work = 0.0;
+
+		for (unsigned int i = 0; i < timeline.size(); i++)
+			work += timeline[i].Duration;
+
+		char line[256];
+
+		sprintf_s(line, sizeof(line), "Startup took %.2f ms for %.2f ms of tasks\n", duration, work);
+		Report += line;
+
+		for (unsigned int i = 0; i < timeline.size(); i++)
+		{
+			const TaskTiming &timing = timeline[i];
+
+			unsigned int first = 0;
+			unsigned int last = 0;
+
+			if (duration > 0.0)
+			{
+				first = (unsigned int)(timing.Start / duration * BAR_WIDTH);
+				last = (unsigned int)((timing.Start + timing.Duration) / duration * BAR_WIDTH);
+			}
+
+			if (first >= BAR_WIDTH)
+				first = BAR_WIDTH - 1;
+
+			if (last >= BAR_WIDTH)
+				last = BAR_WIDTH - 1;
+
+			char bar[BAR_WIDTH + 1];
+
+			for (unsigned int j = 0; j < BAR_WIDTH; j++)
+				bar[j] = (j >= first && j <= last ? '#' : '.');
+
+			bar[BAR_WIDTH] = '\0';
+
+			sprintf_s(line, sizeof(line), "  %-24.24s %-6s %5u %9.2f ms %9.2f ms |%s|\n", timing.Name, (timing.MainThreadOnly ? "main" : "worker"), timing.ThreadID, timing.Start, timing.Duration, bar);
+			Report += line;
+		}
+	}
+
+	void LogReport(void) const
+	{
+		std::string report;
+		GetReport(report);
+
+		unsigned int start = 0;
+
+		for (unsigned int i = 0; i < report.size(); i++)
+			if (report[i] == '\n')
+			{
+				LOG_INFO(String(report.c_str() + start, i - start))
+
+				start = i + 1;
+			}
+	}
+
+private:
+	static void RunTask(void *Data)
+	{
+		Task &task = *(Task*)Data;
+
+#ifdef USE_PROFILER
+		Profiler::Scope scope(task.Name);
+#endif
+
+		task.ThreadID = GetCurrentThreadId();
+		task.Start = GetTime();
+
+		task.Function(task.Data);
+
+		task.End = GetTime();
+	}
+
+	static bool IsStartedBefore(const TaskTiming &Left, const TaskTiming &Right)
+	{
+		return (Left.Start < Right.Start);
+	}
+
+	static long long GetTime(void)
+	{
+		LARGE_INTEGER time;
+		QueryPerformanceCounter(&time);
+
+		return time.QuadPart;
+	}
+
+	double ToMilliseconds(const long long &Ticks) const
+	{
+		return (double)Ticks * 1000.0 / (double)m_Frequency;
+	}
+
+private:
+	Startup(const Startup &Other);
+	void operator =(const Startup &Other);
+
+private:
+	TasksList m_Tasks;
+	DependenciesList m_Dependencies;
+
+	long long m_Frequency;
+	long long m_Start;
+	long long m_End;
+};
+
+END_NAMESPACE
\ No newline at end of file
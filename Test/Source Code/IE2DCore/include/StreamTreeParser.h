@@ -0,0 +1,647 @@
+///////////////////////////////////////////////////////////////////////////////////
+///
+///  Impressive Engine 2D
+///
+/// Copyright (c) 2012-2013 Impressive Reality team
+///
+/// The license is
+///
+/// Permission is denied, to any person or company
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Project leader : O.Shahbazi <sh_omid_m@yahoo.com>
+///////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "ITreeParser.h"
+#include "IAttributes.h"
+#include <vector>
+#include <string.h>
+
+BEGIN_NAMESPACE
+
+//<Description>
+//Characters inside a buffer somebody else owns, not NULL terminated
+struct StringView
+{
+public:
+	StringView(void) :
+		Data(NULL),
+		Length(0)
+	{
+	}
+
+	StringView(const char *Data, const unsigned int &Length) :
+		Data(Data),
+		Length(Length)
+	{
+	}
+
+	bool operator ==(const char *Value) const
+	{
+		return (strncmp(Data, Value, Length) == 0 && Value[Length] == '\0');
+	}
+
+	bool operator !=(const char *Value) const
+	{
+		return !(*this == Value);
+	}
+
+	bool operator ==(const StringView &Value) const
+	{
+		return (Length == Value.Length && memcmp(Data, Value.Data, Length) == 0);
+	}
+
+	String ToString(void) const
+	{
+		return String(Data, Length);
+	}
+
+public:
+	const char *Data;
+	unsigned int Length;
+};
+
+//<Description>
+//Reads a tree file element by element instead of building the TreeElement DOM.
+//Next() returns one event at a time, names and values are views into the text, so
+//nothing is allocated while reading except the stack of open elements.
+//Entered elements are followed by ET_ATTRIBUTE events for their attributes, then by
+//their values and children, and end with ET_LEAVE; also for <Element/>.
+//Values are trimmed, escaped characters like &amp; are left as they are, use
+//Decode() for the values which may contain them.
+//GetRoot() still builds the DOM, for the code which needs the whole tree
+class StreamTreeParser : public ITreeParser
+{
+public:
+	enum EventType
+	{
+		ET_NONE = 0,
+		ET_ENTER,
+		ET_ATTRIBUTE,
+		ET_VALUE,
+		ET_LEAVE,
+		ET_END,
+		ET_ERROR
+	};
+
+public:
+	//Keeps a copy of Text, like FileIO::ReadText returns it
+	StreamTreeParser(const String &Text) :
+		m_Text(Text),
+		m_Root(NULL)
+	{
+		Reset(m_Text.GetBuffer(), m_Text.GetLength());
+	}
+
+	//Data has to stay valid as long as the parser is used, nothing is copied
+	StreamTreeParser(const char *Data, const unsigned int &Size) :
+		m_Root(NULL)
+	{
+		Reset(Data, Size);
+	}
+
+	~StreamTreeParser(void)
+	{
+		if (m_Root)
+			delete m_Root;
+	}
+
+	const String ToString(void)
+	{
+		return String(m_Begin, m_End - m_Begin);
+	}
+
+	//The document as a DOM, its children are the top level elements. Built on first call, NULL if the text is invalid
+	TreeElement *GetRoot(void)
+	{
+		if (!m_Root)
+			m_Root = CreateTreeElement(m_Begin, m_End - m_Begin);
+
+		return m_Root;
+	}
+
+	//Starts from the beginning of the text again
+	void Rewind(void)
+	{
+		Reset(m_Begin, m_End - m_Begin);
+	}
+
+	EventType Next(void)
+	{
+		if (m_Event == ET_END || m_Event == ET_ERROR)
+			return m_Event;
+
+		if (m_CloseEmpty)
+		{
+			m_CloseEmpty = false;
+			return Leave();
+		}
+
+		if (m_InsideTag)
+		{
+			SkipWhiteSpaces();
+
+			if (m_Current == m_End)
+				return Error();
+
+			if (*m_Current == '/')
+			{
+				if (m_Current + 1 == m_End || m_Current[1] != '>')
+					return Error();
+
+				m_Current += 2;
+				m_InsideTag = false;
+				return Leave();
+			}
+
+			if (*m_Current == '>')
+			{
+				m_Current++;
+				m_InsideTag = false;
+			}
+			else
+				return ReadAttribute();
+		}
+
+		return ReadContent();
+	}
+
+	const EventType &GetEvent(void) const
+	{
+		return m_Event;
+	}
+
+	//Element name on ET_ENTER and ET_LEAVE, attribute name on ET_ATTRIBUTE
+	const StringView &GetName(void) const
+	{
+		return m_Name;
+	}
+
+	//Attribute value on ET_ATTRIBUTE, text on ET_VALUE
+	const StringView &GetValue(void) const
+	{
+		return m_Value;
+	}
+
+	//Number of open elements, the one just entered included
+	const unsigned int GetDepth(void) const
+	{
+		return m_Stack.size();
+	}
+
+	//After ET_ENTER or ET_ATTRIBUTE, moves to the ET_LEAVE of the current element
+	bool SkipElement(void)
+	{
+		const unsigned int depth = m_Stack.size();
+
+		while (true)
+		{
+			const EventType event = Next();
+
+			if (event == ET_LEAVE && m_Stack.size() < depth)
+				return true;
+
+			if (event == ET_END || event == ET_ERROR)
+				return false;
+		}
+	}
+
+	//Moves to the ET_ENTER of the next element named Name below the current depth,
+	//returns false when the current element ends first
+	bool FindElement(const char *Name)
+	{
+		const unsigned int depth = m_Stack.size();
+
+		while (true)
+		{
+			switch (Next())
+			{
+			case ET_ENTER:
+				if (m_Name == Name)
+					return true;
+
+				if (!SkipElement())
+					return false;
+				break;
+
+			case ET_LEAVE:
+				if (m_Stack.size() < depth)
+					return false;
+				break;
+
+			case ET_END:
+			case ET_ERROR:
+				return false;
+
+			default:
+				break;
+			}
+		}
+	}
+
+	//After ET_ENTER, reads the attributes of the element into Attributes with SetString, the way
+	//IAttributes::Read does from a TreeElement, and moves to the ET_LEAVE of the element.
+	//Returns false if the text ends first
+	bool ReadAttributes(IAttributes *Attributes)
+	{
+		Attributes->SetTagName(m_Name.ToString());
+
+		const unsigned int depth = m_Stack.size();
+
+		EventType event;
+
+		while ((event = Next()) == ET_ATTRIBUTE)
+			Attributes->SetString(m_Name.ToString(), Decode(m_Value));
+
+		while (!(event == ET_LEAVE && m_Stack.size() < depth))
+		{
+			if (event == ET_END || event == ET_ERROR)
+				return false;
+
+			event = Next();
+		}
+
+		return true;
+	}
+
+	//Line of the current position, to report errors
+	unsigned int GetLine(void) const
+	{
+		unsigned int line = 1;
+
+		for (const char *c = m_Begin; c != m_Current; c++)
+			if (*c == '\n')
+				line++;
+
+		return line;
+	}
+
+	//Replaces escaped characters like &amp; and &#65; in Value
+	static String Decode(const StringView &Value)
+	{
+		if (!memchr(Value.Data, '&', Value.Length))
+			return Value.ToString();
+
+		std::vector<char> result;
+		result.reserve(Value.Length);
+
+		const char *end = Value.Data + Value.Length;
+
+		for (const char *c = Value.Data; c != end; c++)
+		{
+			if (*c != '&')
+			{
+				result.push_back(*c);
+				continue;
+			}
+
+			const char *semicolon = (const char*)memchr(c, ';', end - c);
+
+			if (!semicolon)
+			{
+				result.push_back(*c);
+				continue;
+			}
+
+			const StringView entity(c + 1, semicolon - c - 1);
+			unsigned int code = 0;
+
+			if (entity == "amp")
+				code = '&';
+			else if (entity == "lt")
+				code = '<';
+			else if (entity == "gt")
+				code = '>';
+			else if (entity == "quot")
+				code = '"';
+			else if (entity == "apos")
+				code = '\'';
+			else if (entity.Length > 1 && entity.Data[0] == '#')
+			{
+				const bool hex = (entity.Data[1] == 'x' || entity.Data[1] == 'X');
+
+				for (unsigned int i = (hex ? 2 : 1); i < entity.Length; i++)
+				{
+					const char digit = entity.Data[i];
+
+					if (digit >= '0' && digit <= '9')
+						code = code * (hex ? 16 : 10) + (digit - '0');
+					else if (hex && (digit | 0x20) >= 'a' && (digit | 0x20) <= 'f')
+						code = code * 16 + ((digit | 0x20) - 'a' + 10);
+					else
+					{
+						code = 0;
+						break;
+					}
+
+					if (code > 0x10FFFF)
+						break;
+				}
+			}
+
+			if (code == 0 || code > 0x10FFFF)
+			{
+				result.push_back(*c);
+				continue;
+			}
+
+			// UTF-8
+			if (code < 0x80)
+				result.push_back((char)code);
+			else if (code < 0x800)
+			{
+				result.push_back((char)(0xC0 | (code >> 6)));
+				result.push_back((char)(0x80 | (code & 0x3F)));
+			}
+			else if (code < 0x10000)
+			{
+				result.push_back((char)(0xE0 | (code >> 12)));
+				result.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+				result.push_back((char)(0x80 | (code & 0x3F)));
+			}
+			else
+			{
+				result.push_back((char)(0xF0 | (code >> 18)));
+				result.push_back((char)(0x80 | ((code >> 12) & 0x3F)));
+				result.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+				result.push_back((char)(0x80 | (code & 0x3F)));
+			}
+
+			c = semicolon;
+		}
+
+		return String(result.empty() ? "" : &result[0], result.size());
+	}
+
+	//Builds the DOM of a text the same way GetRoot() does, the caller deletes it
+	static TreeElement *CreateTreeElement(const char *Data, const unsigned int &Size)
+	{
+		StreamTreeParser parser(Data, Size);
+
+		TreeElement *root = new TreeElement;
+		TreeElement *current = root;
+
+		while (true)
+		{
+			switch (parser.Next())
+			{
+			case ET_ENTER:
+				{
+					TreeElement *element = new TreeElement(current);
+					element->Name = parser.GetName().ToString();
+
+					current->Children.Add(element);
+					current = element;
+				}
+				break;
+
+			case ET_ATTRIBUTE:
+				current->Attributes[Decode(parser.GetName())] = Decode(parser.GetValue());
+				break;
+
+			case ET_VALUE:
+				current->Value += Decode(parser.GetValue());
+				break;
+
+			case ET_LEAVE:
+				current = current->ParentElement;
+				break;
+
+			case ET_END:
+				return root;
+
+			default:
+				delete root;
+				return NULL;
+			}
+		}
+	}
+
+private:
+	void Reset(const char *Data, const unsigned int &Size)
+	{
+		m_Begin = Data;
+		m_Current = Data;
+		m_End = Data + Size;
+
+		m_Event = ET_NONE;
+		m_InsideTag = false;
+		m_CloseEmpty = false;
+
+		m_Name = StringView();
+		m_Value = StringView();
+
+		m_Stack.clear();
+		m_Stack.reserve(16);
+	}
+
+	EventType ReadContent(void)
+	{
+		while (true)
+		{
+			SkipWhiteSpaces();
+
+			if (m_Current == m_End)
+				return (m_Stack.empty() ? (m_Event = ET_END) : Error());
+
+			if (*m_Current != '<')
+			{
+				const char *start = m_Current;
+				const char *end = (const char*)memchr(m_Current, '<', m_End - m_Current);
+
+				if (!end || m_Stack.empty())
+					return Error();
+
+				m_Current = end;
+
+				while (end != start && IsWhiteSpace(end[-1]))
+					end--;
+
+				m_Value = StringView(start, end - start);
+
+				return (m_Event = ET_VALUE);
+			}
+
+			if (StartsWith("<?"))
+			{
+				if (!SkipPast("?>"))
+					return Error();
+			}
+			else if (StartsWith("<!--"))
+			{
+				if (!SkipPast("-->"))
+					return Error();
+			}
+			else if (StartsWith("<![CDATA["))
+			{
+				const char *start = m_Current + 9;
+
+				if (!SkipPast("]]>") || m_Stack.empty())
+					return Error();
+
+				m_Value = StringView(start, m_Current - 3 - start);
+
+				return (m_Event = ET_VALUE);
+			}
+			else if (StartsWith("<!"))
+			{
+				if (!SkipPast(">"))
+					return Error();
+			}
+			else if (StartsWith("</"))
+			{
+				m_Current += 2;
+
+				if (!ReadName(m_Name) || m_Stack.empty() || !(m_Name == m_Stack.back()))
+					return Error();
+
+				SkipWhiteSpaces();
+
+				if (m_Current == m_End || *m_Current != '>')
+					return Error();
+
+				m_Current++;
+
+				return Leave();
+			}
+			else
+			{
+				m_Current++;
+
+				if (!ReadName(m_Name))
+					return Error();
+
+				m_Stack.push_back(m_Name);
+				m_InsideTag = true;
+
+				return (m_Event = ET_ENTER);
+			}
+		}
+	}
+
+	EventType ReadAttribute(void)
+	{
+		if (!ReadName(m_Name))
+			return Error();
+
+		SkipWhiteSpaces();
+
+		if (m_Current == m_End || *m_Current != '=')
+			return Error();
+
+		m_Current++;
+
+		SkipWhiteSpaces();
+
+		if (m_Current == m_End || (*m_Current != '"' && *m_Current != '\''))
+			return Error();
+
+		const char quote = *m_Current++;
+		const char *end = (const char*)memchr(m_Current, quote, m_End - m_Current);
+
+		if (!end)
+			return Error();
+
+		m_Value = StringView(m_Current, end - m_Current);
+		m_Current = end + 1;
+
+		// <Element/> has no separate closing tag, its ET_LEAVE follows the last attribute
+		SkipWhiteSpaces();
+
+		if (m_End - m_Current >= 2 && m_Current[0] == '/' && m_Current[1] == '>')
+		{
+			m_Current += 2;
+			m_InsideTag = false;
+			m_CloseEmpty = true;
+		}
+
+		return (m_Event = ET_ATTRIBUTE);
+	}
+
+	EventType Leave(void)
+	{
+		m_Name = m_Stack.back();
+		m_Stack.pop_back();
+
+		return (m_Event = ET_LEAVE);
+	}
+
+	EventType Error(void)
+	{
+		m_Name = StringView();
+		m_Value = StringView();
+
+		return (m_Event = ET_ERROR);
+	}
+
+	bool ReadName(StringView &Name)
+	{
+		const char *start = m_Current;
+
+		while (m_Current != m_End && !IsWhiteSpace(*m_Current) && *m_Current != '=' && *m_Current != '/' && *m_Current != '>' && *m_Current != '<')
+			m_Current++;
+
+		Name = StringView(start, m_Current - start);
+
+		return (Name.Length != 0);
+	}
+
+	bool StartsWith(const char *Value) const
+	{
+		const unsigned int length = strlen(Value);
+
+		return ((unsigned int)(m_End - m_Current) >= length && memcmp(m_Current, Value, length) == 0);
+	}
+
+	bool SkipPast(const char *Value)
+	{
+		const unsigned int length = strlen(Value);
+
+		for (const char *c = m_Current; m_End - c >= (int)length; c++)
+			if (*c == *Value && memcmp(c, Value, length) == 0)
+			{
+				m_Current = c + length;
+				return true;
+			}
+
+		return false;
+	}
+
+	void SkipWhiteSpaces(void)
+	{
+		while (m_Current != m_End && IsWhiteSpace(*m_Current))
+			m_Current++;
+	}
+
+	static bool IsWhiteSpace(const char &Character)
+	{
+		return (Character == ' ' || Character == '\t' || Character == '\n' || Character == '\r');
+	}
+
+private:
+	StreamTreeParser(const StreamTreeParser &Other);
+	void operator =(const StreamTreeParser &Other);
+
+private:
+	String m_Text;
+
+	const char *m_Begin;
+	const char *m_Current;
+	const char *m_End;
+
+	EventType m_Event;
+	bool m_InsideTag;
+	bool m_CloseEmpty;
+
+	StringView m_Name;
+	StringView m_Value;
+
+	std::vector<StringView> m_Stack;
+
+	TreeElement *m_Root;
+};
+
+END_NAMESPACE
\ No newline at end of file
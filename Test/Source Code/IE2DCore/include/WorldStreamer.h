@@ -0,0 +1,980 @@
+///////////////////////////////////////////////////////////////////////////////////
+///
+///  Impressive Engine 2D
+///
+/// Copyright (c) 2012-2013 Impressive Reality team
+///
+/// The license is
+///
+/// Permission is denied, to any person or company
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// Project leader : O.Shahbazi <sh_omid_m@yahoo.com>
+///////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Common.h"
+#include "Core.h"
+#include "IScene.h"
+#include "IGameObject.h"
+#include "ITransform.h"
+#include "IThread.h"
+#include "IThreadWorker.h"
+#include "ThreadManager.h"
+#include "HashedAttributes.h"
+#include "Profiler.h"
+#include "Physics\IBody.h"
+#include "Renderer\ICamera.h"
+#include <Windows.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <mutex>
+#include <deque>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+BEGIN_NAMESPACE
+
+//<Description>
+//Streams the game objects of a large scene in square chunks around its camera.
+//Each chunk is a file next to the scene, [Name]_[X]_[Y].chunk, holding the name, the prefab
+//and the binary HashedAttributes of each of its game objects. Serialize keeps the attributes
+//of a game object, not its components, children, body or render operation, so a game object
+//is made again as a clone of its prefab with its own attributes on top, see AddPrefab.
+//The chunks within the load radius of
+//the camera are read and parsed on the streaming thread, their game objects are created
+//on the main thread at the start of a frame within the frame budget, nearest chunk first.
+//A chunk is unloaded once the camera is farther than the unload radius, which is larger,
+//so a camera going back and forth over a border doesn't load and unload it every time.
+//Unloading serializes the game objects of the chunk, the file is written on the streaming
+//thread, and destroys them, so they don't update, render or have bodies anymore.
+//No more chunks are loaded while the streamed game objects, by the sizes of their prefabs,
+//and the chunks read but not created yet are over the memory budget, and the
+//farthest ones which are only kept by the unload radius are unloaded first.
+//Only the root game objects given to Adopt, or loaded from the chunks, are streamed.
+//To split a scene into chunks, Start streaming it, add the prefabs, Adopt its game objects and Stop
+class WorldStreamer : public IThreadWorker, public Core::IListener, public IScene::IListener
+{
+public:
+	//<Description>
+	//Notified on the main thread
+	class IStreamListener
+	{
+	public:
+		virtual void OnChunkLoaded(const int &X, const int &Y) = 0;
+
+		virtual void OnBeforeChunkUnloaded(const int &X, const int &Y) = 0;
+	};
+
+private:
+	enum ChunkState
+	{
+		CS_READING = 0,
+		CS_READ,
+		CS_LOADED
+	};
+
+	//Parsed on the streaming thread
+	struct Record
+	{
+	public:
+		std::string Name;
+		std::string Prefab;
+		HashedAttributes *Attributes;
+
+		//Of the prefab, counted on the main thread
+		unsigned int Size;
+	};
+
+	typedef std::vector<Record> RecordsList;
+	typedef std::vector<IGameObject*> GameObjectsList;
+
+	struct Chunk
+	{
+	public:
+		int X;
+		int Y;
+
+		std::atomic<int> State;
+
+		//Filled on the streaming thread before the state is CS_READ,
+		//Size is the bytes of the file and then of the game objects to create too
+		RecordsList Records;
+		unsigned int Size;
+		bool Exists;
+
+		//Records already created
+		unsigned int CreateCount;
+
+		//Records whose prefab wasn't there, written back with the chunk
+		RecordsList Orphans;
+
+		//Size is counted into the loaded size until the records are created
+		bool Counted;
+
+		GameObjectsList GameObjects;
+	};
+
+	//Reads Target if it isn't NULL, otherwise writes Data
+	struct Task
+	{
+	public:
+		Chunk *Target;
+		std::string FilePath;
+		std::vector<char> Data;
+	};
+
+	struct StreamedPrefab
+	{
+	public:
+		IGameObject *GameObject;
+		unsigned int Size;
+	};
+
+	struct StreamedGameObject
+	{
+	public:
+		Chunk *Owner;
+		const std::string *Prefab;
+		unsigned int Size;
+	};
+
+	typedef std::unordered_map<long long, Chunk*> ChunksMap;
+	typedef std::unordered_map<IGameObject*, StreamedGameObject> GameObjectChunksMap;
+	typedef std::unordered_map<std::string, StreamedPrefab> PrefabsMap;
+	typedef std::deque<Task> TasksList;
+	typedef Vector<IStreamListener*> IStreamListenersList;
+
+	static const unsigned int FILE_ID = 0x4B484332;
+	static const unsigned int FILE_VERSION = 2;
+
+	//Chunks being read at once, so the memory budget is checked with what they turned out to be
+	static const unsigned int MAX_READING_COUNT = 4;
+
+public:
+	WorldStreamer(void) :
+		m_Thread(NULL),
+		m_Running(false),
+		m_Scene(NULL),
+		m_ChunkSize(1024.0f),
+		m_LoadRadius(1),
+		m_UnloadRadius(2),
+		m_MemoryBudget(64 * 1024 * 1024),
+		m_FrameBudget(2.0f),
+		m_LoadedSize(0),
+		m_ReadingCount(0),
+		m_Destroying(false)
+	{
+		m_WakeEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		m_Frequency = frequency.QuadPart;
+	}
+
+	~WorldStreamer(void)
+	{
+		Stop();
+
+		CloseHandle(m_WakeEvent);
+	}
+
+	static WorldStreamer &GetReference(void)
+	{
+		static WorldStreamer instance;
+
+		return instance;
+	}
+
+	//Name is the start of the file names of the chunks in the scene directory, ChunkSize is in world units
+	void Start(IScene *Scene, const String &Name, const float &ChunkSize)
+	{
+		Stop();
+
+		m_Scene = Scene;
+		m_ChunkSize = ChunkSize;
+		m_FilePath = (Core::GetReference().GetScenePath() + Name).GetBuffer();
+
+		m_Running.store(true, std::memory_order_release);
+		m_Thread = ThreadManager::GetReference().CreateThread(this);
+
+		m_Scene->AddListener(this);
+		Core::GetReference().AddListener(this);
+	}
+
+	//Writes the loaded chunks, their game objects stay in the scene
+	void Stop(void)
+	{
+		if (!m_Thread)
+			return;
+
+		Core::GetReference().RemoveListener(this);
+
+		Release();
+
+		{
+			std::lock_guard<std::mutex> lock(m_TasksLock);
+
+			m_Running.store(false, std::memory_order_release);
+			SetEvent(m_WakeEvent);
+		}
+
+		// the writes are done before the thread ends
+		m_Thread->Join();
+		ThreadManager::GetReference().DestroyThread(m_Thread);
+		m_Thread = NULL;
+	}
+
+	//The streamed game objects made from Prefab are its clones, found by its name, so it has
+	//to stay in the scene while streaming. Size is the memory an instance takes with its
+	//components, children, body and render operation, which the memory budget counts.
+	//The prefabs are added after Start
+	void AddPrefab(IGameObject *Prefab, const unsigned int &Size)
+	{
+		StreamedPrefab &prefab = m_Prefabs[Prefab->GetName().GetBuffer()];
+		prefab.GameObject = Prefab;
+		prefab.Size = Size;
+	}
+
+	//Streams a root game object of the scene, which is a clone of Prefab, with the chunk it's in.
+	//False if Prefab wasn't added
+	bool Adopt(IGameObject *GameObject, IGameObject *Prefab)
+	{
+		if (!m_Scene || m_GameObjects.find(GameObject) != m_GameObjects.end())
+			return false;
+
+		PrefabsMap::iterator prefab = m_Prefabs.find(Prefab->GetName().GetBuffer());
+
+		if (prefab == m_Prefabs.end() || prefab->second.GameObject != Prefab)
+		{
+			LOG_ERROR("The prefab [" + Prefab->GetName() + "] of the game object [" + GameObject->GetName() + "] isn't added to be streamed")
+			return false;
+		}
+
+		int x, y;
+		GetChunkCoordinates(GameObject->GetTransform()->GetWorldPosition(), x, y);
+
+		Chunk *chunk = GetChunk(x, y);
+
+		// its file is loaded before the chunk can be written
+		if (!chunk)
+			chunk = AddChunk(x, y);
+
+		AddGameObject(*chunk, GameObject, prefab);
+
+		return true;
+	}
+
+	//Radii in chunks around the one the camera is in, Unload is at least Load + 1
+	void SetRadii(const unsigned int &Load, const unsigned int &Unload)
+	{
+		m_LoadRadius = Load;
+		m_UnloadRadius = (Unload > Load ? Unload : Load + 1);
+	}
+
+	//Bytes of the streamed game objects, by the sizes of their prefabs, and of the chunks
+	//read but not created yet
+	void SetMemoryBudget(const unsigned int &Bytes)
+	{
+		m_MemoryBudget = Bytes;
+	}
+
+	//Milliseconds of a frame creating game objects can take
+	void SetFrameBudget(const float &Milliseconds)
+	{
+		m_FrameBudget = Milliseconds;
+	}
+
+	bool IsChunkLoaded(const int &X, const int &Y)
+	{
+		Chunk *chunk = GetChunk(X, Y);
+
+		return (chunk && chunk->State.load(std::memory_order_acquire) == CS_LOADED);
+	}
+
+	unsigned int GetChunkCount(void) const
+	{
+		return (unsigned int)m_Chunks.size();
+	}
+
+	const unsigned int &GetLoadedSize(void) const
+	{
+		return m_LoadedSize;
+	}
+
+	unsigned int GetGameObjectCount(void) const
+	{
+		return (unsigned int)m_GameObjects.size();
+	}
+
+	void AddListener(IStreamListener *Listener)
+	{
+		m_Listeners.Add(Listener);
+	}
+
+	void RemoveListener(IStreamListener *Listener)
+	{
+		for (unsigned int i = 0; i < m_Listeners.GetSize(); i++)
+			if (m_Listeners[i] == Listener)
+			{
+				m_Listeners.Remove(i);
+				return;
+			}
+	}
+
+private:
+	void Do(void)
+	{
+		PROFILE_THREAD_NAME("WorldStreamer")
+
+		while (true)
+		{
+			WaitForSingleObject(m_WakeEvent, INFINITE);
+
+			Task task;
+
+			{
+				std::lock_guard<std::mutex> lock(m_TasksLock);
+
+				if (!m_Tasks.size())
+				{
+					if (!m_Running.load(std::memory_order_acquire))
+						break;
+
+					ResetEvent(m_WakeEvent);
+					continue;
+				}
+
+				task = m_Tasks.front();
+				m_Tasks.pop_front();
+			}
+
+			if (task.Target)
+				ReadChunk(*task.Target, task.FilePath);
+			else
+				WriteChunk(task.FilePath, task.Data);
+		}
+	}
+
+	void AddTask(const Task &Task)
+	{
+		std::lock_guard<std::mutex> lock(m_TasksLock);
+
+		m_Tasks.push_back(Task);
+		SetEvent(m_WakeEvent);
+	}
+
+	//Streaming thread
+	void ReadChunk(Chunk &Chunk, const std::string &FilePath)
+	{
+		PROFILE_SCOPE("WorldStreamer::ReadChunk")
+
+		Chunk.Size = 0;
+		Chunk.Exists = false;
+
+		HANDLE file = CreateFileA(FilePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+		if (file != INVALID_HANDLE_VALUE)
+		{
+			std::vector<char> data(GetFileSize(file, NULL));
+			DWORD read = 0;
+
+			if (data.size())
+				ReadFile(file, &data[0], (DWORD)data.size(), &read, NULL);
+
+			CloseHandle(file);
+
+			Chunk.Exists = true;
+			Chunk.Size = read;
+
+			if (read != data.size() || !Parse(data, Chunk.Records))
+				LOG_ERROR("Couldn't read the chunk [" + String(FilePath.c_str()) + "]")
+		}
+
+		Chunk.State.store(CS_READ, std::memory_order_release);
+	}
+
+	static bool Parse(const std::vector<char> &Data, RecordsList &Records)
+	{
+		const unsigned int size = (unsigned int)Data.size();
+
+		if (size < 12)
+			return false;
+
+		unsigned int header[3];
+		memcpy(header, &Data[0], 12);
+
+		if (header[0] != FILE_ID || header[1] != FILE_VERSION)
+			return false;
+
+		unsigned int offset = 12;
+
+		for (unsigned int i = 0; i < header[2]; i++)
+		{
+			Record record;
+
+			if (!ParseString(Data, offset, record.Name) || !ParseString(Data, offset, record.Prefab))
+				return false;
+
+			record.Attributes = new HashedAttributes;
+
+			const unsigned int read = (offset < size ? record.Attributes->Read(&Data[0] + offset, size - offset) : 0);
+
+			if (!read)
+			{
+				delete record.Attributes;
+				return false;
+			}
+
+			offset += read;
+
+			Records.push_back(record);
+		}
+
+		return true;
+	}
+
+	static bool ParseString(const std::vector<char> &Data, unsigned int &Offset, std::string &String)
+	{
+		unsigned short length;
+
+		if (Offset + 2 > Data.size())
+			return false;
+
+		memcpy(&length, &Data[Offset], 2);
+		Offset += 2;
+
+		if (Offset + length > Data.size())
+			return false;
+
+		String.assign(&Data[0] + Offset, length);
+		Offset += length;
+
+		return true;
+	}
+
+	//Streaming thread, through a temporary file so a chunk is never half written
+	void WriteChunk(const std::string &FilePath, const std::vector<char> &Data)
+	{
+		PROFILE_SCOPE("WorldStreamer::WriteChunk")
+
+		const std::string temporaryPath = FilePath + ".tmp";
+
+		HANDLE file = CreateFileA(temporaryPath.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+
+		DWORD written = 0;
+
+		if (file != INVALID_HANDLE_VALUE)
+		{
+			WriteFile(file, &Data[0], (DWORD)Data.size(), &written, NULL);
+			CloseHandle(file);
+		}
+
+		if (written != Data.size() || !MoveFileExA(temporaryPath.c_str(), FilePath.c_str(), MOVEFILE_REPLACE_EXISTING))
+			LOG_ERROR("Couldn't write the chunk [" + String(FilePath.c_str()) + "]")
+	}
+
+	std::string GetFilePath(const int &X, const int &Y) const
+	{
+		char suffix[32];
+		sprintf_s(suffix, sizeof(suffix), "_%d_%d.chunk", X, Y);
+
+		return m_FilePath + suffix;
+	}
+
+	void GetChunkCoordinates(const Vector3D &Position, int &X, int &Y) const
+	{
+		X = (int)floorf(Position.X / m_ChunkSize);
+		Y = (int)floorf(Position.Y / m_ChunkSize);
+	}
+
+	static long long GetKey(const int &X, const int &Y)
+	{
+		return (long long)(((unsigned long long)(unsigned int)X << 32) | (unsigned int)Y);
+	}
+
+	Chunk *GetChunk(const int &X, const int &Y)
+	{
+		ChunksMap::iterator it = m_Chunks.find(GetKey(X, Y));
+
+		return (it == m_Chunks.end() ? NULL : it->second);
+	}
+
+	//Starts reading the chunk
+	Chunk *AddChunk(const int &X, const int &Y)
+	{
+		Chunk *chunk = new Chunk;
+		chunk->X = X;
+		chunk->Y = Y;
+		chunk->State.store(CS_READING, std::memory_order_relaxed);
+		chunk->Size = 0;
+		chunk->Exists = false;
+		chunk->CreateCount = 0;
+		chunk->Counted = false;
+
+		m_Chunks[GetKey(X, Y)] = chunk;
+		m_ReadingCount++;
+
+		Task task;
+		task.Target = chunk;
+		task.FilePath = GetFilePath(X, Y);
+
+		AddTask(task);
+
+		return chunk;
+	}
+
+	static unsigned int GetDistance(const Chunk &Chunk, const int &X, const int &Y)
+	{
+		const unsigned int x = (unsigned int)abs(Chunk.X - X);
+		const unsigned int y = (unsigned int)abs(Chunk.Y - Y);
+
+		return (x > y ? x : y);
+	}
+
+	void AddGameObject(Chunk &Chunk, IGameObject *GameObject, PrefabsMap::iterator Prefab)
+	{
+		StreamedGameObject &streamed = m_GameObjects[GameObject];
+		streamed.Owner = &Chunk;
+		streamed.Prefab = &Prefab->first;
+		streamed.Size = Prefab->second.Size;
+
+		Chunk.GameObjects.push_back(GameObject);
+		m_LoadedSize += streamed.Size;
+	}
+
+	//Main thread: serializes the game objects of the chunk, and the records which aren't created yet, and queues the write
+	void Save(Chunk &Chunk)
+	{
+		PROFILE_SCOPE("WorldStreamer::Save")
+
+		const unsigned int recordCount = (unsigned int)(Chunk.Records.size() - Chunk.CreateCount + Chunk.Orphans.size());
+
+		// nothing was there and nothing is
+		if (!Chunk.Exists && !Chunk.GameObjects.size())
+			return;
+
+		Task task;
+		task.Target = NULL;
+		task.FilePath = GetFilePath(Chunk.X, Chunk.Y);
+
+		const unsigned int header[3] = { FILE_ID, FILE_VERSION, (unsigned int)Chunk.GameObjects.size() + recordCount };
+		task.Data.insert(task.Data.end(), (const char*)header, (const char*)header + 12);
+
+		for (unsigned int i = 0; i < Chunk.GameObjects.size(); i++)
+		{
+			m_Attributes.Clear();
+			Chunk.GameObjects[i]->Serialize(&m_Attributes);
+
+			AddRecord(task.Data, Chunk.GameObjects[i]->GetName().GetBuffer(), *m_GameObjects[Chunk.GameObjects[i]].Prefab, m_Attributes);
+		}
+
+		for (unsigned int i = Chunk.CreateCount; i < Chunk.Records.size(); i++)
+			AddRecord(task.Data, Chunk.Records[i].Name.c_str(), Chunk.Records[i].Prefab, *Chunk.Records[i].Attributes);
+
+		for (unsigned int i = 0; i < Chunk.Orphans.size(); i++)
+			AddRecord(task.Data, Chunk.Orphans[i].Name.c_str(), Chunk.Orphans[i].Prefab, *Chunk.Orphans[i].Attributes);
+
+		AddTask(task);
+	}
+
+	static void AddRecord(std::vector<char> &Data, const char *Name, const std::string &Prefab, const HashedAttributes &Attributes)
+	{
+		const unsigned int start = (unsigned int)Data.size();
+		const unsigned short nameLength = (unsigned short)strlen(Name);
+		const unsigned short prefabLength = (unsigned short)Prefab.size();
+
+		Data.insert(Data.end(), (const char*)&nameLength, (const char*)&nameLength + 2);
+		Data.insert(Data.end(), Name, Name + nameLength);
+		Data.insert(Data.end(), (const char*)&prefabLength, (const char*)&prefabLength + 2);
+		Data.insert(Data.end(), Prefab.c_str(), Prefab.c_str() + prefabLength);
+
+		if (!Attributes.Write(Data))
+		{
+			Data.resize(start);
+
+			LOG_ERROR("Too many attributes to save the game object [" + String(Name) + "]")
+		}
+	}
+
+	//Main thread: saves the chunk, destroys its game objects and forgets it
+	void Unload(Chunk *Chunk)
+	{
+		for (unsigned int i = 0; i < m_Listeners.GetSize(); i++)
+			m_Listeners[i]->OnBeforeChunkUnloaded(Chunk->X, Chunk->Y);
+
+		// game objects which moved into another loaded chunk go with that one
+		for (unsigned int i = 0; i < Chunk->GameObjects.size();)
+		{
+			IGameObject *gameObject = Chunk->GameObjects[i];
+
+			int x, y;
+			GetChunkCoordinates(gameObject->GetTransform()->GetWorldPosition(), x, y);
+
+			WorldStreamer::Chunk *other = GetChunk(x, y);
+
+			if (other && other != Chunk && other->State.load(std::memory_order_relaxed) == CS_LOADED)
+			{
+				other->GameObjects.push_back(gameObject);
+				m_GameObjects[gameObject].Owner = other;
+
+				Chunk->GameObjects[i] = Chunk->GameObjects.back();
+				Chunk->GameObjects.pop_back();
+			}
+			else
+				i++;
+		}
+
+		Save(*Chunk);
+
+		m_Destroying = true;
+
+		for (unsigned int i = 0; i < Chunk->GameObjects.size(); i++)
+		{
+			GameObjectChunksMap::iterator it = m_GameObjects.find(Chunk->GameObjects[i]);
+
+			m_LoadedSize -= it->second.Size;
+			m_GameObjects.erase(it);
+
+			Chunk->GameObjects[i]->Destroy();
+		}
+
+		m_Destroying = false;
+
+		DeleteChunk(Chunk);
+	}
+
+	//Main thread: forgets a chunk with what's left of its records
+	void DeleteChunk(Chunk *Chunk)
+	{
+		for (unsigned int i = Chunk->CreateCount; i < Chunk->Records.size(); i++)
+			delete Chunk->Records[i].Attributes;
+
+		for (unsigned int i = 0; i < Chunk->Orphans.size(); i++)
+			delete Chunk->Orphans[i].Attributes;
+
+		// the records are counted until they're all created
+		if (Chunk->Counted)
+			m_LoadedSize -= Chunk->Size;
+
+		m_Chunks.erase(GetKey(Chunk->X, Chunk->Y));
+		delete Chunk;
+	}
+
+	//Main thread: creates the game objects of a read chunk until the time is up, returns true when they're all created
+	bool Create(Chunk &Chunk, const long long &EndTime)
+	{
+		while (Chunk.CreateCount < Chunk.Records.size())
+		{
+			if (GetTime() >= EndTime)
+				return false;
+
+			Record &record = Chunk.Records[Chunk.CreateCount++];
+
+			// counted with the game object from here on
+			Chunk.Size -= record.Size;
+			m_LoadedSize -= record.Size;
+
+			PrefabsMap::iterator prefab = m_Prefabs.find(record.Prefab);
+			IGameObject *gameObject = NULL;
+
+			if (prefab != m_Prefabs.end() && prefab->second.GameObject)
+				gameObject = prefab->second.GameObject->Clone(record.Name.c_str(), NULL);
+
+			// written back as it is, so it's made once its prefab is there again
+			if (!gameObject)
+			{
+				LOG_ERROR("The prefab [" + String(record.Prefab.c_str()) + "] of the game object [" + String(record.Name.c_str()) + "] isn't there to stream it")
+
+				Chunk.Orphans.push_back(record);
+				continue;
+			}
+
+			gameObject->Deserialize(record.Attributes);
+
+			delete record.Attributes;
+
+			// the body of the prefab's clone is where the prefab is
+			IBody *body = gameObject->GetBody();
+
+			if (body)
+			{
+				const Vector3D &position = gameObject->GetTransform()->GetPosition();
+
+				body->SetTransform(Vector2D(position.X, position.Y), gameObject->GetTransform()->GetRotation());
+			}
+
+			AddGameObject(Chunk, gameObject, prefab);
+		}
+
+		RecordsList().swap(Chunk.Records);
+		Chunk.CreateCount = 0;
+
+		m_LoadedSize -= Chunk.Size;
+		Chunk.Size = 0;
+
+		Chunk.State.store(CS_LOADED, std::memory_order_relaxed);
+
+		for (unsigned int i = 0; i < m_Listeners.GetSize(); i++)
+			m_Listeners[i]->OnChunkLoaded(Chunk.X, Chunk.Y);
+
+		return true;
+	}
+
+	long long GetTime(void) const
+	{
+		LARGE_INTEGER time;
+		QueryPerformanceCounter(&time);
+
+		return time.QuadPart;
+	}
+
+	void Stream(void)
+	{
+		PROFILE_SCOPE("WorldStreamer::Stream")
+
+		ICamera *camera = m_Scene->GetCamera();
+
+		if (!camera)
+			return;
+
+		int x, y;
+		GetChunkCoordinates(camera->GetPosition(), x, y);
+
+		const long long endTime = GetTime() + (long long)(m_FrameBudget * m_Frequency / 1000.0f);
+
+		// chunks which were read and the farthest loaded one beyond the load radius
+		Chunk *nearestRead = NULL;
+		Chunk *farthestKept = NULL;
+
+		for (ChunksMap::iterator it = m_Chunks.begin(); it != m_Chunks.end();)
+		{
+			Chunk *chunk = it->second;
+			it++;
+
+			const int state = chunk->State.load(std::memory_order_acquire);
+			const unsigned int distance = GetDistance(*chunk, x, y);
+
+			if (state == CS_READING)
+				continue;
+
+			if (state == CS_READ)
+			{
+				if (!chunk->Counted)
+				{
+					chunk->Counted = true;
+					m_ReadingCount--;
+
+					// what the game objects take once they're created
+					for (unsigned int i = 0; i < chunk->Records.size(); i++)
+					{
+						PrefabsMap::iterator prefab = m_Prefabs.find(chunk->Records[i].Prefab);
+
+						chunk->Records[i].Size = (prefab != m_Prefabs.end() ? prefab->second.Size : 0);
+						chunk->Size += chunk->Records[i].Size;
+					}
+
+					m_LoadedSize += chunk->Size;
+				}
+
+				// out of range before its game objects were created, the file still has them
+				if (!chunk->CreateCount && !chunk->GameObjects.size() && distance > m_UnloadRadius)
+				{
+					DeleteChunk(chunk);
+					continue;
+				}
+
+				if (!nearestRead || distance < GetDistance(*nearestRead, x, y))
+					nearestRead = chunk;
+
+				continue;
+			}
+
+			if (distance > m_UnloadRadius)
+				Unload(chunk);
+			else if (distance > m_LoadRadius && (!farthestKept || distance > GetDistance(*farthestKept, x, y)))
+				farthestKept = chunk;
+		}
+
+		// the budget stops the loading from here on
+		if (m_LoadedSize >= m_MemoryBudget && farthestKept)
+			Unload(farthestKept);
+
+		// nearest first, a ring at a time
+		for (unsigned int radius = 0; radius <= m_LoadRadius && m_LoadedSize < m_MemoryBudget && m_ReadingCount < MAX_READING_COUNT; radius++)
+			for (int j = y - (int)radius; j <= y + (int)radius; j++)
+				for (int i = x - (int)radius; i <= x + (int)radius; i++)
+				{
+					if ((unsigned int)abs(i - x) != radius && (unsigned int)abs(j - y) != radius)
+						continue;
+
+					if (m_ReadingCount < MAX_READING_COUNT && !GetChunk(i, j))
+						AddChunk(i, j);
+				}
+
+		// create game objects for the read chunks, nearest first, until the time is up
+		while (nearestRead && Create(*nearestRead, endTime))
+		{
+			nearestRead = NULL;
+
+			FOR_EACH_MAP(it, m_Chunks)
+				if (it->second->Counted && it->second->State.load(std::memory_order_relaxed) == CS_READ && (!nearestRead || GetDistance(*it->second, x, y) < GetDistance(*nearestRead, x, y)))
+					nearestRead = it->second;
+		}
+	}
+
+	//Saves the loaded chunks and forgets them all, waits for the ones being read
+	void Release(void)
+	{
+		if (!m_Scene)
+			return;
+
+		m_Scene->RemoveListener(this);
+
+		std::vector<Chunk*> chunks;
+
+		FOR_EACH_MAP(it, m_Chunks)
+			chunks.push_back(it->second);
+
+		for (unsigned int i = 0; i < chunks.size(); i++)
+		{
+			Chunk *chunk = chunks[i];
+
+			while (chunk->State.load(std::memory_order_acquire) == CS_READING)
+				Sleep(1);
+
+			Save(*chunk);
+			DeleteChunk(chunk);
+		}
+
+		m_GameObjects.clear();
+		m_Prefabs.clear();
+
+		m_LoadedSize = 0;
+		m_ReadingCount = 0;
+		m_Scene = NULL;
+	}
+
+	void OnReloadAll(IGameObject *RootGameObject)
+	{
+	}
+
+	void OnGameObjectAdded(IGameObject *GameObject)
+	{
+	}
+
+	void OnBeforeGameObjectRemoved(IGameObject *GameObject)
+	{
+		if (m_Destroying)
+			return;
+
+		// its records wait for it to be added again
+		FOR_EACH_MAP(prefab, m_Prefabs)
+			if (prefab->second.GameObject == GameObject)
+				prefab->second.GameObject = NULL;
+
+		GameObjectChunksMap::iterator it = m_GameObjects.find(GameObject);
+
+		if (it == m_GameObjects.end())
+			return;
+
+		m_LoadedSize -= it->second.Size;
+
+		GameObjectsList &gameObjects = it->second.Owner->GameObjects;
+
+		for (unsigned int i = 0; i < gameObjects.size(); i++)
+			if (gameObjects[i] == GameObject)
+			{
+				gameObjects[i] = gameObjects.back();
+				gameObjects.pop_back();
+				break;
+			}
+
+		m_GameObjects.erase(it);
+	}
+
+	void OnAfterGameObjectRemoved(void)
+	{
+	}
+
+	void OnBeforeGameModified(IGameObject *GameObject)
+	{
+	}
+
+	void OnAfterGameModified(IGameObject *GameObject)
+	{
+	}
+
+	void OnBeforeSceneRemoved(IScene *Scene)
+	{
+		if (Scene == m_Scene)
+			Release();
+	}
+
+	void OnSceneAdded(IScene *Scene)
+	{
+	}
+
+	void OnSetCurrentScene(IScene *Scene)
+	{
+	}
+
+	void OnBeforeUpdate(void)
+	{
+		if (m_Scene)
+			Stream();
+	}
+
+	void OnAfterUpdate(void)
+	{
+	}
+
+	void OnBeforeRender(void)
+	{
+	}
+
+	void OnAfterRender(void)
+	{
+	}
+
+private:
+	WorldStreamer(const WorldStreamer &Other);
+	void operator =(const WorldStreamer &Other);
+
+private:
+	IThread *m_Thread;
+	std::mutex m_TasksLock;
+	TasksList m_Tasks;
+	HANDLE m_WakeEvent;
+	std::atomic<bool> m_Running;
+
+	IScene *m_Scene;
+	std::string m_FilePath;
+	float m_ChunkSize;
+
+	unsigned int m_LoadRadius;
+	unsigned int m_UnloadRadius;
+	unsigned int m_MemoryBudget;
+	float m_FrameBudget;
+	long long m_Frequency;
+
+	ChunksMap m_Chunks;
+	GameObjectChunksMap m_GameObjects;
+	PrefabsMap m_Prefabs;
+	unsigned int m_LoadedSize;
+	unsigned int m_ReadingCount;
+
+	// scratch of Save
+	HashedAttributes m_Attributes;
+
+	bool m_Destroying;
+
+	IStreamListenersList m_Listeners;
+};
+
+END_NAMESPACE
\ No newline at end of file
@@ -17,14 +17,79 @@
 #include "Core.h"
 #include "IRenderWindow.h"
 #include "IScene.h"
+#include "FileIO.h"
+#include "Profiler.h"
+#include "ComponentScheduler.h"
+#include "Startup.h"
+#include "PluginLoader.h"
+#include "FrameClock.h"
+#include "FrameAllocator.h"
+#include "Input\WindowInput.h"
 
 #ifdef FULL_DEBUG_MODE
 #include "Utility.h"
-#include "FileIO.h"
+#include "StreamTreeParser.h"
+#include "AssetWatcher.h"
 #endif
 
 USING_NAMESPACE
 
+// the scripts and the plugins log through the AsyncLog started in main
+EXPORT_ASYNC_LOG
+
+#ifdef USE_PROFILER
+// and profile into the Profiler attached in main
+EXPORT_SHARED_SINGLETON(Profiler)
+#endif
+
+// their scheduled components run with the ones of the executable on its workers
+EXPORT_SHARED_SINGLETON(JobPool)
+EXPORT_SHARED_SINGLETON(ComponentScheduler)
+
+// their pooled components are in one registry, where PrefabPool finds them
+EXPORT_SHARED_SINGLETON(ComponentRegistry)
+
+// and allocate from the arenas reset in the frames of main
+EXPORT_SHARED_SINGLETON(FrameAllocator)
+
+// the tasks of Startup
+
+static void InitializeCore(void *Data)
+{
+	*(IRenderWindow**)Data = Core::GetReference().Initialize();
+}
+
+static void FindPlugins(void *Data)
+{
+	PluginLoader::GetReference().Find();
+}
+
+static void LoadPlugins(void *Data)
+{
+	PluginLoader::GetReference().Load();
+}
+
+#ifdef FULL_DEBUG_MODE
+static void ReadEditorSettings(void *Data)
+{
+	const String settingFileName("EditorSettings.s");
+
+	if (Utility::FileExists(Core::GetReference().GetInitializePath() + settingFileName))
+	{
+		StreamTreeParser parser(FileIO::GetReference().ReadText("IE2DSettingFile", Core::GetReference().GetInitializePath() + settingFileName));
+
+		// stops at Settings, the rest of the file isn't parsed
+		parser.FindElement("Settings");
+	}
+}
+
+static void StartAssetWatcher(void *Data)
+{
+	// assets loaded through the watcher are reloaded when their files are saved
+	AssetWatcher::GetReference().Start();
+}
+#endif
+
 //#ifndef LAUNCH_MODE
 //#error To building Launcher.exe, you must define LAUNCH_MODE preprocessor in Common.h
 //#endif
@@ -37,22 +102,57 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE prevInstance, LPSTR cmdLine, in
 {
 	Core &core = Core::GetReference();
 
-	IRenderWindow *rw = core.Initialize();
+#ifdef USE_PROFILER
+	PROFILE_THREAD_NAME("Main")
+	Profiler::GetReference().Attach();
+#endif
 
-#ifdef FULL_DEBUG_MODE
-	const String settingFileName("EditorSettings.s");
+	// the startup tasks and later the scheduled components run on the job pool
+	JobPool::GetReference().Start();
 
-	if (Utility::FileExists(Core::GetReference().GetInitializePath() + settingFileName))
-	{
-		ITreeParser *tr = FileIO::GetReference().CreateTreeParser("IE2DSettingFile", Core::GetReference().GetInitializePath() + settingFileName);
+	IRenderWindow *rw = NULL;
 
-		TreeElement *stateElem = tr->GetRoot()->GetChildren("Settings");
+	// the window and the render device are created on the main thread while the plugins are
+	// found, they're loaded on the main thread after it
+	Startup startup;
+	const unsigned int initializeTask = startup.AddTask("Core::Initialize", &InitializeCore, &rw, true);
+	const unsigned int findPluginsTask = startup.AddTask("Find plugins", &FindPlugins);
+	const unsigned int loadPluginsTask = startup.AddTask("Load plugins", &LoadPlugins, NULL, true);
+	startup.AddDependency(loadPluginsTask, initializeTask);
+	startup.AddDependency(loadPluginsTask, findPluginsTask);
 
-		delete tr;
-	}
+#ifdef FULL_DEBUG_MODE
+	startup.AddDependency(startup.AddTask("Read editor settings", &ReadEditorSettings), initializeTask);
+	startup.AddDependency(startup.AddTask("Start asset watcher", &StartAssetWatcher, NULL, true), initializeTask);
 #endif
 
+	startup.Run();
+
+	// from here on the game logs on a background thread
+	AsyncLog::GetReference().Start(FileIO::GetReference().OpenFile(core.GetInitializePath() + "IE2DGame.log", false));
+	AsyncLog::GetReference().InstallCrashHandler();
+
+	startup.LogReport();
+
+	// scheduled components update on the job pool
+	ComponentScheduler::GetReference().Attach();
+
+	// times the frames, they aren't paced unless SetPacing is called
+	FrameClock::GetReference().Attach();
+
+	// memory of the frame, given back at its end
+	FrameAllocator::GetReference().Attach();
+
+	// input events with the time of their messages
+	InputEventQueue::GetReference().Attach();
+	WindowInput::GetReference().Attach(rw);
+
+#ifdef FULL_DEBUG_MODE
+	// loaded through the watcher, so it's reloaded when its file is saved
+	IScene *scene = AssetWatcher::GetReference().CreateScene("", true);
+#else
 	IScene *scene = core.CreateScene("", true);
+#endif
 	scene->CreateGameObject("aaaa")->AddComponent("DummyCom");
 
 	core.SetCurrentScene(scene);
@@ -60,5 +160,24 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE prevInstance, LPSTR cmdLine, in
 	while (!rw->IsClosed())
 		core.UpdateOneFrame();
 
+	WindowInput::GetReference().Detach();
+	InputEventQueue::GetReference().Detach();
+	FrameAllocator::GetReference().Detach();
+	FrameClock::GetReference().Detach();
+
+#ifdef FULL_DEBUG_MODE
+	AssetWatcher::GetReference().Stop();
+#endif
+
+	ComponentScheduler::GetReference().Detach();
+	JobPool::GetReference().Stop();
+
+#ifdef USE_PROFILER
+	Profiler::GetReference().Detach();
+	Profiler::GetReference().SaveTrace(core.GetInitializePath() + "IE2DGame.trace.json");
+#endif
+
+	AsyncLog::GetReference().Stop();
+
 	return core.Shutdown();
 }
\ No newline at end of file